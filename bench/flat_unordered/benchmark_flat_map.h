@@ -12,6 +12,10 @@
 // Src
 #include "indivi/flat_umap.h"
 #include "indivi/flat_wmap.h"
+#include "indivi/concurrent_flat_map.h"
+#include "indivi/incremental_map.h"
+#include "indivi/frozen_map.h"
+#include "indivi/flat_split_map.h"
 
 // 3rd-parties
 // #pragma GCC diagnostic push
@@ -31,8 +35,12 @@
 // Std
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <iostream>
+#include <mutex>
 #include <random>
+#include <shared_mutex>
+#include <string>
 
 #include <cassert>
 #include <cstdint>
@@ -90,6 +98,16 @@ struct uint64_murmur
   }
 };
 
+struct string_wyhash // portable string hashing (reference for hardware-accelerated path)
+{
+  using is_avalanching = std::true_type;
+  
+  std::size_t operator()(const std::string& key) const
+  {
+    return (std::size_t)indivi::detail::wyhash::hash(key.data(), key.size());
+  }
+};
+
 
 template <typename K>
 static void shuffle(std::vector<K>& vec, uint64_t seed = SRAND_SEED)
@@ -254,6 +272,41 @@ void Emplace_Random_Reserve(benchmark::State& state)
   }
 }
 
+//
+template <class M, bool uniqueRange>
+void Build_Range(benchmark::State& state)
+{
+  using key_t = typename M::key_type;
+  using val_t = typename M::mapped_type;
+  
+  int64_t range = state.range(0);
+  std::vector<std::pair<key_t, val_t>> values;
+  values.reserve(range);
+  RomuDuoJr gen(SRAND_SEED);
+  for (int64_t j = 0; j < range; ++j) {
+    key_t key = (key_t)gen();
+    values.emplace_back(key, (val_t)key + 1);
+  }
+  
+  for (auto _ : state)
+  {
+    {
+      M map;
+      if (uniqueRange)
+        map.insert_unique_range(values.begin(), values.end());
+      else
+        map.insert(values.begin(), values.end());
+      
+      state.PauseTiming();
+      benchmark::DoNotOptimize(map);
+      
+      if (map.size() != (size_t)range) // with good seed no collision
+        std::cout << "Error: " << map.size() << " != " << range << std::endl;
+    }
+    state.ResumeTiming();
+  }
+}
+
 //
 template <class M, int count = 1000>
 void Find_Existing_Sequence(benchmark::State& state)
@@ -368,6 +421,64 @@ void Find_Existing_Random(benchmark::State& state)
   }
 }
 
+//
+template <class M, int count = 1000>
+void Find_Existing_Random_Batch(benchmark::State& state)
+{
+  using key_t = typename M::key_type;
+  using val_t = typename M::mapped_type;
+  
+  int64_t range = state.range(0);
+  if (count > range)
+    std::cout << "Error: count > map size " << std::endl;
+  
+  M map0;
+  map0.reserve(range);
+  std::vector<key_t> keys;
+  keys.reserve(range);
+  RomuDuoJr gen(SRAND_SEED);
+  
+  while (map0.size() < (size_t)range) {
+    key_t key = (key_t)gen();
+    map0.emplace(key, (val_t)key + 1);
+    keys.emplace_back(key);
+  }
+  
+  std::array<M, INNER_MAPS> maps;
+  for (auto& map : maps)
+    map = map0;
+  
+  shuffle(keys);
+  
+  std::vector<typename M::const_iterator> its(count);
+  int64_t k = 0;
+  int64_t sz = (int64_t)keys.size();
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    flush_cache();
+    
+    for (const auto& map : maps)
+    {
+      uint64_t accu = 0u;
+      k = (k + count <= sz) ? k : 0;
+      state.ResumeTiming();
+      
+      map.find_batch(keys.data() + k, count, its.data());
+      for (int64_t j = 0; j < count; ++j)
+        accu += its[j]->second;
+      
+      state.PauseTiming();
+      k += count;
+      benchmark::DoNotOptimize(accu);
+      
+      if (accu == 0u)
+        std::cout << "Error: " << accu << std::endl;
+    }
+    state.ResumeTiming();
+  }
+}
+
 //
 template <class M, int count = 1000>
 void Find_NonExisting_Sequence(benchmark::State& state)
@@ -840,6 +951,607 @@ void Rehash_Random(benchmark::State& state)
   }
 }
 
+//
+template <class M, int length = 40>
+void Rehash_String(benchmark::State& state)
+{
+  using val_t = typename M::mapped_type;
+  
+  int64_t range = state.range(0);
+  
+  M map0;
+  map0.reserve(range);
+  RomuDuoJr gen(SRAND_SEED);
+  
+  while (map0.size() < (size_t)range) {
+    std::string key(length, '\0');
+    for (auto& c : key)
+      c = (char)('a' + gen() % 26);
+    map0.emplace(std::move(key), (val_t)map0.size());
+  }
+  
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    {
+      M map = map0;
+      state.ResumeTiming();
+      
+      map.rehash((std::size_t)(map.size() * 3.0));
+      
+      state.PauseTiming();
+      benchmark::DoNotOptimize(map);
+      
+      if (map.size() != map0.size())
+        std::cout << "Error: " << map.size() << std::endl;
+    }
+    state.ResumeTiming();
+  }
+}
+
+//
+// Find probe stats (needs INDIVI_FLAT_U_STATS/INDIVI_FLAT_W_STATS, no-op otherwise)
+template <class M>
+static inline void reset_find_stats(M&) {}
+
+template <class M>
+static inline void report_find_stats(benchmark::State&, const M&) {}
+
+template <class S>
+static inline void set_find_counters(benchmark::State& state, const S& stats, int simdWidth)
+{
+  state.counters["simd_width"] = simdWidth;
+  state.counters["prob_hit_avg"] = stats.prob_len_hit_avg;
+  state.counters["prob_hit_max"] = (double)stats.prob_len_hit_max;
+  state.counters["prob_miss_avg"] = stats.prob_len_miss_avg;
+  state.counters["prob_miss_max"] = (double)stats.prob_len_miss_max;
+  state.counters["cmp_hit_avg"] = stats.compare_hit_avg;
+  state.counters["cmp_miss_avg"] = stats.compare_miss_avg;
+}
+
+#ifdef INDIVI_FLAT_U_STATS
+template <class K, class V, class H, class E, class A>
+static inline void reset_find_stats(indivi::flat_umap<K, V, H, E, A>& map) { map.reset_find_stats(); }
+
+template <class K, class V, class H, class E, class A>
+static inline void report_find_stats(benchmark::State& state, const indivi::flat_umap<K, V, H, E, A>& map)
+{
+  set_find_counters(state, map.get_find_stats(), 16);
+}
+#endif
+#ifdef INDIVI_FLAT_W_STATS
+template <class K, class V, class H, class E, class A>
+static inline void reset_find_stats(indivi::flat_wmap<K, V, H, E, A>& map) { map.reset_find_stats(); }
+
+template <class K, class V, class H, class E, class A>
+static inline void report_find_stats(benchmark::State& state, const indivi::flat_wmap<K, V, H, E, A>& map)
+{
+  set_find_counters(state, map.get_find_stats(), INDIVI_FLAT_W_SIMD_WIDTH);
+}
+#endif
+
+// Half hits/half misses at max load factor (i.e. longest probe sequences)
+// Build once per ISA (e.g. '-msse2', '-mavx2', '-mavx512bw' with INDIVI_FLAT_W_WIDE_SIMD)
+template <class M, int count = 1000>
+void Find_Max_Load(benchmark::State& state)
+{
+  using key_t = typename M::key_type;
+  using val_t = typename M::mapped_type;
+  constexpr uint64_t Mask = 0x0000000001000000ull; // arbitrary (single bit should avoid bias)
+  
+  int64_t range = state.range(0);
+  
+  M map0;
+  map0.reserve(range);
+  std::vector<key_t> keys;
+  keys.reserve(range);
+  RomuDuoJr gen(SRAND_SEED);
+  
+  std::size_t maxSize = (std::size_t)(map0.bucket_count() * map0.max_load_factor());
+  while (map0.size() < maxSize) {
+    key_t key = (key_t)(gen() & ~Mask); // force unset bit
+    if (map0.emplace(key, (val_t)key + 1).second)
+      keys.emplace_back(key);
+  }
+  shuffle(keys);
+  
+  std::array<M, INNER_MAPS> maps;
+  for (auto& map : maps)
+  {
+    map = map0;
+    reset_find_stats(map);
+  }
+  
+  int64_t k = 0;
+  int64_t sz = (int64_t)keys.size();
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    flush_cache();
+    
+    for (const auto& map : maps)
+    {
+      uint64_t accu = 0u;
+      state.ResumeTiming();
+      
+      for (int64_t j = 0; j < count; j += 2, ++k) {
+        k = k < sz ? k : 0;
+        accu += map.find(keys[k])->second;
+        key_t key = (key_t)(keys[k] | Mask); // force set bit
+        accu += map.find(key) == map.end() ? 0u : 1u;
+      }
+      
+      state.PauseTiming();
+      benchmark::DoNotOptimize(accu);
+      
+      if (accu == 0u)
+        std::cout << "Error: " << accu << std::endl;
+    }
+    state.ResumeTiming();
+  }
+  report_find_stats(state, maps[0]);
+}
+
+//
+// Per-insertion latency percentiles (rehash stalls show in p99.9/max, not in mean)
+template <class M>
+void Insert_Tail_Latency(benchmark::State& state)
+{
+  using clock = std::chrono::steady_clock;
+  using key_t = typename M::key_type;
+  using val_t = typename M::mapped_type;
+  
+  int64_t range = state.range(0);
+  std::vector<key_t> keys;
+  keys.reserve(range);
+  RomuDuoJr gen(SRAND_SEED);
+  for (int64_t i = 0; i < range; ++i)
+    keys.emplace_back((key_t)gen());
+  
+  std::vector<int64_t> latencies((std::size_t)range);
+  int64_t maxNs = 0;
+  for (auto _ : state)
+  {
+    M map;
+    for (int64_t i = 0; i < range; ++i)
+    {
+      auto start = clock::now();
+      map.emplace(keys[i], (val_t)i);
+      latencies[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+    }
+    benchmark::DoNotOptimize(map);
+    
+    state.PauseTiming();
+    std::sort(latencies.begin(), latencies.end());
+    maxNs = std::max(maxNs, latencies.back());
+    state.ResumeTiming();
+  }
+  state.counters["p50_ns"] = (double)latencies[(std::size_t)(range * 0.5)];
+  state.counters["p99_ns"] = (double)latencies[(std::size_t)(range * 0.99)];
+  state.counters["p999_ns"] = (double)latencies[(std::size_t)(range * 0.999)];
+  state.counters["max_ns"] = (double)maxNs;
+}
+
+//
+template <class M, unsigned int threadCount>
+void Rehash_Parallel(benchmark::State& state)
+{
+  using key_t = typename M::key_type;
+  using val_t = typename M::mapped_type;
+  
+  int64_t range = state.range(0);
+  
+  M map0;
+  map0.reserve(range);
+  RomuDuoJr gen(SRAND_SEED);
+  
+  while (map0.size() < (size_t)range)
+    map0.emplace((key_t)gen(), (val_t)map0.size());
+  
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    {
+      M map = map0;
+      state.ResumeTiming();
+      
+      map.rehash(map.bucket_count() * 2, threadCount);
+      
+      state.PauseTiming();
+      benchmark::DoNotOptimize(map);
+      
+      if (map.size() != map0.size())
+        std::cout << "Error: " << map.size() << std::endl;
+    }
+    state.ResumeTiming();
+  }
+}
+
+//
+// Lookups in a map built once from another (e.g. frozen_map), hits or misses, one by one or batched
+template <class M, bool existing, bool batch = false, int count = 1000>
+void Find_Built_Random(benchmark::State& state)
+{
+  using key_t = typename M::key_type;
+  using val_t = typename M::mapped_type;
+  
+  int64_t range = state.range(0);
+  
+  indivi::flat_wmap<key_t, val_t> source;
+  source.reserve(range);
+  std::vector<key_t> keys;
+  keys.reserve(range);
+  RomuDuoJr gen(SRAND_SEED);
+  
+  while (source.size() < (size_t)range) {
+    key_t key = (key_t)gen();
+    if (source.emplace(key, (val_t)key + 1).second && existing)
+      keys.emplace_back(key);
+  }
+  while (keys.size() < (size_t)range) {
+    key_t key = (key_t)gen();
+    if (!source.contains(key))
+      keys.emplace_back(key);
+  }
+  
+  std::vector<M> maps;
+  maps.reserve(INNER_MAPS);
+  for (int i = 0; i < INNER_MAPS; ++i)
+    maps.emplace_back(source.begin(), source.end());
+  
+  shuffle(keys);
+  
+  std::vector<typename M::const_iterator> its(count);
+  int64_t k = 0;
+  int64_t sz = (int64_t)keys.size();
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    flush_cache();
+    
+    for (const auto& map : maps)
+    {
+      uint64_t accu = 0u;
+      k = (k + count <= sz) ? k : 0;
+      state.ResumeTiming();
+      
+      if (batch)
+        map.find_batch(keys.data() + k, count, its.data());
+      else
+        for (int64_t j = 0; j < count; ++j)
+          its[j] = map.find(keys[k + j]);
+      for (int64_t j = 0; j < count; ++j)
+        accu += its[j] == map.end() ? 1u : its[j]->second;
+      
+      state.PauseTiming();
+      k += count;
+      benchmark::DoNotOptimize(accu);
+      
+      if (accu == 0u)
+        std::cout << "Error: " << accu << std::endl;
+    }
+    state.ResumeTiming();
+  }
+}
+
+//
+// Large mapped values (200 Bytes), for split key/mapped layout
+struct Payload200
+{
+  uint64_t data[25];
+  Payload200() = default;
+  explicit Payload200(uint64_t v) { for (auto& d : data) d = v; }
+};
+
+template <class K, class V, class H, class E, class A, std::size_t N>
+static inline const V* find_mapped(const indivi::flat_umap<K, V, H, E, A, N>& map, const K& key)
+{
+  auto it = map.find(key);
+  return (it != map.end()) ? &it->second : nullptr;
+}
+
+template <class K, class V, class H, class E, class A>
+static inline const V* find_mapped(const indivi::flat_split_map<K, V, H, E, A>& map, const K& key)
+{
+  auto it = map.find(key);
+  return (it != map.end()) ? &it.mapped() : nullptr;
+}
+
+template <class M, int hitPercent, int count = 1000>
+void Find_Large_Value(benchmark::State& state)
+{
+  using key_t = typename M::key_type;
+  using val_t = typename M::mapped_type;
+  constexpr uint64_t Mask = 0x0000000001000000ull; // arbitrary (single bit should avoid bias)
+  
+  int64_t range = state.range(0);
+  
+  M map0;
+  map0.reserve(range);
+  std::vector<key_t> keys;
+  keys.reserve(range);
+  RomuDuoJr gen(SRAND_SEED);
+  while (map0.size() < (size_t)range) {
+    key_t key = (key_t)(gen() & ~Mask); // force unset bit
+    if (map0.try_emplace(key, (uint64_t)key).second)
+      keys.emplace_back(key);
+  }
+  for (auto& key : keys)
+    if ((int)(gen() % 100) >= hitPercent)
+      key |= Mask; // miss
+  shuffle(keys);
+  
+  std::array<M, INNER_MAPS> maps;
+  for (auto& map : maps)
+    map = map0;
+  
+  int64_t k = 0;
+  int64_t sz = (int64_t)keys.size();
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    flush_cache();
+    
+    for (const auto& map : maps)
+    {
+      uint64_t accu = 1u;
+      k = (k + count <= sz) ? k : 0;
+      state.ResumeTiming();
+      
+      for (int64_t j = 0; j < count; ++j)
+      {
+        const val_t* value = find_mapped(map, keys[k + j]);
+        accu += value ? value->data[0] : 0u;
+      }
+      
+      state.PauseTiming();
+      k += count;
+      benchmark::DoNotOptimize(accu);
+    }
+    state.ResumeTiming();
+  }
+}
+
+//
+// Single flat_wmap behind a global reader-writer lock (baseline for concurrent maps)
+template <class K, class V, class H = indivi::hash<K>>
+class shared_mutex_wmap
+{
+#ifdef INDIVI_CPP17
+  using mutex_type = std::shared_mutex;
+#else
+  using mutex_type = std::shared_timed_mutex;
+#endif
+  
+  indivi::flat_wmap<K, V, H> map;
+  mutable mutex_type mutex;
+  
+public:
+  void reserve(std::size_t count)
+  {
+    std::unique_lock<mutex_type> lock(mutex);
+    map.reserve(count);
+  }
+  
+  template <class F>
+  std::size_t cvisit(const K& key, F f) const
+  {
+    std::shared_lock<mutex_type> lock(mutex);
+    auto it = map.find(key);
+    if (it == map.end())
+      return 0u;
+    f(*it);
+    return 1u;
+  }
+  
+  template <class M>
+  bool insert_or_assign(const K& key, M&& obj)
+  {
+    std::unique_lock<mutex_type> lock(mutex);
+    return map.insert_or_assign(key, std::forward<M>(obj)).second;
+  }
+  
+  std::size_t erase(const K& key)
+  {
+    std::unique_lock<mutex_type> lock(mutex);
+    return map.erase(key);
+  }
+};
+
+// Shared map, each thread runs a mix of lookups (readPercent) and insert/erase (half each)
+// Keys are drawn from a 2x range so that about half of lookups hit
+template <class M, int readPercent, int count = 1000>
+void Concurrent_Mixed(benchmark::State& state)
+{
+  static M* map = nullptr;
+  static std::vector<uint64_t> keys;
+  
+  int64_t range = state.range(0);
+  if (state.thread_index() == 0)
+  {
+    map = new M();
+    map->reserve((std::size_t)range);
+    keys.resize((std::size_t)range * 2);
+    RomuDuoJr gen(SRAND_SEED);
+    for (auto& key : keys)
+      key = gen();
+    for (int64_t i = 0; i < range; ++i)
+      map->insert_or_assign(keys[(std::size_t)i * 2], keys[(std::size_t)i * 2] + 1);
+  }
+  
+  RomuDuoJr gen(SRAND_SEED + (uint64_t)state.thread_index());
+  uint64_t accu = 0u;
+  for (auto _ : state)
+  {
+    uint64_t mask = keys.size() - 1u; // range is a power of 2 (read after start barrier)
+    for (int j = 0; j < count; ++j)
+    {
+      uint64_t rnd = gen();
+      const uint64_t& key = keys[(std::size_t)((rnd >> 8) & mask)];
+      int op = (int)(rnd % 100u);
+      if (op < readPercent)
+        accu += map->cvisit(key, [&](const std::pair<const uint64_t, uint64_t>& kv) { accu += kv.second; });
+      else if (op & 1)
+        accu += map->insert_or_assign(key, key + 1) ? 1u : 0u;
+      else
+        accu += map->erase(key);
+    }
+  }
+  benchmark::DoNotOptimize(accu);
+  state.SetItemsProcessed(state.iterations() * count);
+  
+  if (state.thread_index() == 0)
+  {
+    delete map;
+    map = nullptr;
+  }
+}
+
+//
+// Steady-state churn: erase a random existing key then insert a new one (size stays at 'range', tombstones accumulate)
+template <class M, int count = 1000>
+void Churn_Steady(benchmark::State& state)
+{
+  using key_t = typename M::key_type;
+  using val_t = typename M::mapped_type;
+  
+  int64_t range = state.range(0);
+  
+  M map;
+  map.reserve(range);
+  std::vector<key_t> keys;
+  keys.reserve(range);
+  RomuDuoJr gen(SRAND_SEED);
+  
+  while (map.size() < (size_t)range) {
+    key_t key = (key_t)gen();
+    if (map.emplace(key, (val_t)key + 1).second)
+      keys.emplace_back(key);
+  }
+  
+  std::size_t bucketCount = map.bucket_count();
+  for (auto _ : state)
+  {
+    std::size_t accu = 0u;
+    for (int64_t j = 0; j < count; ++j) {
+      std::size_t pos = (std::size_t)gen() % keys.size();
+      accu += map.erase(keys[pos]);
+      key_t key = (key_t)gen();
+      accu += map.emplace(key, (val_t)key + 1).second;
+      keys[pos] = key;
+    }
+    benchmark::DoNotOptimize(accu);
+  }
+  state.counters["buckets_growth"] = (double)map.bucket_count() / (double)bucketCount;
+}
+
+//
+// Re-insert after erase all: erase every key, then insert as many new ones
+template <class M>
+void Reinsert_Erase_All(benchmark::State& state)
+{
+  using key_t = typename M::key_type;
+  using val_t = typename M::mapped_type;
+  
+  int64_t range = state.range(0);
+  
+  M map0;
+  std::vector<key_t> keys;
+  std::vector<key_t> newKeys;
+  keys.reserve(range);
+  newKeys.reserve(range);
+  RomuDuoJr gen(SRAND_SEED);
+  
+  while (map0.size() < (size_t)range) {
+    key_t key = (key_t)gen();
+    if (map0.emplace(key, (val_t)key + 1).second)
+      keys.emplace_back(key);
+  }
+  for (int64_t i = 0; i < range; ++i)
+    newKeys.emplace_back((key_t)gen());
+  
+  M map;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    map = map0;
+    state.ResumeTiming();
+    
+    std::size_t accu = 0u;
+    for (const key_t& key : keys)
+      accu += map.erase(key);
+    for (const key_t& key : newKeys)
+      accu += map.emplace(key, (val_t)key + 1).second;
+    
+    benchmark::DoNotOptimize(accu);
+  }
+}
+
+//
+// Hash throughput: 'range' is the key length in bytes (same 256 random keys hashed per loop)
+template <class H>
+void Hash_String(benchmark::State& state)
+{
+  int64_t range = state.range(0);
+  
+  std::vector<std::string> keys(256);
+  RomuDuoJr gen(SRAND_SEED);
+  for (auto& key : keys) {
+    key.resize((std::size_t)range);
+    for (auto& c : key)
+      c = (char)gen();
+  }
+  
+  H hasher;
+  for (auto _ : state)
+  {
+    std::size_t accu = 0u;
+    for (const std::string& key : keys)
+      accu += hasher(key);
+    
+    benchmark::DoNotOptimize(accu);
+  }
+  state.SetBytesProcessed(state.iterations() * (int64_t)keys.size() * range);
+}
+
+//
+// Segmented keys hashing: 'range' bytes in 4 segments, streamed (`hash_state`) or concatenated in a temporary string
+template <bool streaming>
+void Hash_Segments(benchmark::State& state)
+{
+  int64_t range = state.range(0);
+  
+  std::vector<std::string> segments(256 * 4);
+  RomuDuoJr gen(SRAND_SEED);
+  for (auto& segment : segments) {
+    segment.resize((std::size_t)range / 4);
+    for (auto& c : segment)
+      c = (char)gen();
+  }
+  
+  for (auto _ : state)
+  {
+    std::size_t accu = 0u;
+    for (std::size_t i = 0u; i < segments.size(); i += 4)
+    {
+      if (streaming) {
+        indivi::hash_state hs;
+        for (std::size_t j = i; j < i + 4; ++j)
+          hs.update(segments[j]);
+        accu += hs.finish();
+      }
+      else {
+        std::string key;
+        for (std::size_t j = i; j < i + 4; ++j)
+          key += segments[j];
+        accu += indivi::hash<std::string>()(key);
+      }
+    }
+    benchmark::DoNotOptimize(accu);
+  }
+  state.SetBytesProcessed(state.iterations() * (int64_t)(segments.size() / 4) * range);
+}
+
 //
 void Warm_Up(benchmark::State& state)
 {
@@ -915,6 +1627,12 @@ BENCHMARK_TEMPLATE(Find_Existing_Random, indivi::flat_wmap<uint64_t, uint64_t>
 // BENCHMARK_TEMPLATE(Find_Existing_Random, boost::unordered_flat_map<uint64_t, uint64_t, uint64_murmur> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
 // BENCHMARK_TEMPLATE(Find_Existing_Random, absl::flat_hash_map<uint64_t, uint64_t, uint64_murmur>       )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
 
+// BENCHMARK_TEMPLATE(Find_Existing_Random_Batch, indivi::flat_umap<uint64_t, uint64_t>         )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Existing_Random_Batch, indivi::flat_wmap<uint64_t, uint64_t>         )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+
+// BENCHMARK_TEMPLATE(Find_Existing_Random_Batch, indivi::flat_umap<uint64_t, uint64_t, uint64_murmur>         )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Existing_Random_Batch, indivi::flat_wmap<uint64_t, uint64_t, uint64_murmur>         )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+
 // BENCHMARK_TEMPLATE(Find_NonExisting_Sequence, indivi::flat_umap<uint64_t, uint64_t>         )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
 // BENCHMARK_TEMPLATE(Find_NonExisting_Sequence, indivi::flat_wmap<uint64_t, uint64_t>         )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
 // BENCHMARK_TEMPLATE(Find_NonExisting_Sequence, boost::unordered_flat_map<uint64_t, uint64_t> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
@@ -935,6 +1653,11 @@ BENCHMARK_TEMPLATE(Find_NonExisting_Random, indivi::flat_wmap<uint64_t, uint64_t
 // BENCHMARK_TEMPLATE(Find_NonExisting_Random, boost::unordered_flat_map<uint64_t, uint64_t, uint64_murmur> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
 // BENCHMARK_TEMPLATE(Find_NonExisting_Random, absl::flat_hash_map<uint64_t, uint64_t, uint64_murmur>       )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
 
+// BENCHMARK_TEMPLATE(Find_Max_Load, indivi::flat_umap<uint64_t, uint64_t>         )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Max_Load, indivi::flat_wmap<uint64_t, uint64_t>         )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Max_Load, indivi::flat_umap<uint64_t, uint64_t, uint64_murmur>         )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Max_Load, indivi::flat_wmap<uint64_t, uint64_t, uint64_murmur>         )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+
 // BENCHMARK_TEMPLATE(Replace_Sequence, indivi::flat_umap<uint64_t, uint64_t>         )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
 // BENCHMARK_TEMPLATE(Replace_Sequence, indivi::flat_wmap<uint64_t, uint64_t>         )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
 // BENCHMARK_TEMPLATE(Replace_Sequence, boost::unordered_flat_map<uint64_t, uint64_t> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
@@ -1014,3 +1737,75 @@ BENCHMARK_TEMPLATE(Find_NonExisting_Random, indivi::flat_wmap<uint64_t, uint64_t
 // BENCHMARK_TEMPLATE(Rehash_Random, indivi::flat_wmap<uint64_t, uint64_t, uint64_murmur>         )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
 // BENCHMARK_TEMPLATE(Rehash_Random, boost::unordered_flat_map<uint64_t, uint64_t, uint64_murmur> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
 // BENCHMARK_TEMPLATE(Rehash_Random, absl::flat_hash_map<uint64_t, uint64_t, uint64_murmur>       )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+
+// BENCHMARK_TEMPLATE(Rehash_String, indivi::flat_umap<std::string, uint64_t>                                              )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Rehash_String, indivi::flat_umap<std::string, uint64_t, indivi::stored_hash<indivi::hash<std::string>>> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Rehash_String, indivi::flat_wmap<std::string, uint64_t>                                              )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Rehash_String, indivi::flat_wmap<std::string, uint64_t, indivi::stored_hash<indivi::hash<std::string>>> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+
+// BENCHMARK_TEMPLATE(Concurrent_Mixed, indivi::concurrent_flat_map<uint64_t, uint64_t>, 90 )->Arg(1<<20)->ThreadRange(1, 16)->UseRealTime()->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Concurrent_Mixed, shared_mutex_wmap<uint64_t, uint64_t>,          90 )->Arg(1<<20)->ThreadRange(1, 16)->UseRealTime()->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Concurrent_Mixed, indivi::concurrent_flat_map<uint64_t, uint64_t>, 50 )->Arg(1<<20)->ThreadRange(1, 16)->UseRealTime()->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Concurrent_Mixed, shared_mutex_wmap<uint64_t, uint64_t>,          50 )->Arg(1<<20)->ThreadRange(1, 16)->UseRealTime()->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Concurrent_Mixed, indivi::concurrent_flat_map<uint64_t, uint64_t>, 10 )->Arg(1<<20)->ThreadRange(1, 16)->UseRealTime()->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Concurrent_Mixed, shared_mutex_wmap<uint64_t, uint64_t>,          10 )->Arg(1<<20)->ThreadRange(1, 16)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+// BENCHMARK_TEMPLATE(Insert_Tail_Latency, indivi::flat_umap<uint64_t, uint64_t>                             )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMillisecond);
+// BENCHMARK_TEMPLATE(Insert_Tail_Latency, indivi::incremental_map<indivi::flat_umap<uint64_t, uint64_t>>    )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMillisecond);
+// BENCHMARK_TEMPLATE(Insert_Tail_Latency, indivi::flat_wmap<uint64_t, uint64_t>                             )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMillisecond);
+// BENCHMARK_TEMPLATE(Insert_Tail_Latency, indivi::incremental_map<indivi::flat_wmap<uint64_t, uint64_t>>    )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMillisecond);
+
+// BENCHMARK_TEMPLATE(Rehash_Parallel, indivi::flat_umap<uint64_t, uint64_t>, 1 )->RangeMultiplier(MULT)->Range(RMAX/64, RMAX/1)->UseRealTime()->Unit(benchmark::kMillisecond);
+// BENCHMARK_TEMPLATE(Rehash_Parallel, indivi::flat_umap<uint64_t, uint64_t>, 4 )->RangeMultiplier(MULT)->Range(RMAX/64, RMAX/1)->UseRealTime()->Unit(benchmark::kMillisecond);
+// BENCHMARK_TEMPLATE(Rehash_Parallel, indivi::flat_wmap<uint64_t, uint64_t>, 1 )->RangeMultiplier(MULT)->Range(RMAX/64, RMAX/1)->UseRealTime()->Unit(benchmark::kMillisecond);
+// BENCHMARK_TEMPLATE(Rehash_Parallel, indivi::flat_wmap<uint64_t, uint64_t>, 4 )->RangeMultiplier(MULT)->Range(RMAX/64, RMAX/1)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// BENCHMARK_TEMPLATE(Build_Range, indivi::flat_umap<uint64_t, uint64_t>, false )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Build_Range, indivi::flat_umap<uint64_t, uint64_t>, true  )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Build_Range, indivi::flat_wmap<uint64_t, uint64_t>, false )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Build_Range, indivi::flat_wmap<uint64_t, uint64_t>, true  )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+
+// BENCHMARK_TEMPLATE(Find_Built_Random, indivi::flat_wmap<uint64_t, uint64_t>,   true  )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Built_Random, indivi::frozen_map<uint64_t, uint64_t>,  true  )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Built_Random, indivi::flat_wmap<uint64_t, uint64_t>,   false )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Built_Random, indivi::frozen_map<uint64_t, uint64_t>,  false )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Built_Random, indivi::flat_wmap<uint64_t, uint64_t>,   true, true )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Built_Random, indivi::frozen_map<uint64_t, uint64_t>,  true, true )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+
+// BENCHMARK_TEMPLATE(Find_Large_Value, indivi::flat_umap<uint64_t, Payload200>,       10  )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/4)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Large_Value, indivi::flat_split_map<uint64_t, Payload200>,  10  )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/4)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Large_Value, indivi::flat_umap<uint64_t, Payload200>,       100 )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/4)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Large_Value, indivi::flat_split_map<uint64_t, Payload200>,  100 )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/4)->Unit(benchmark::kMicrosecond);
+
+// BENCHMARK_TEMPLATE(Churn_Steady, indivi::flat_umap<uint64_t, uint64_t> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Churn_Steady, indivi::flat_wmap<uint64_t, uint64_t> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Reinsert_Erase_All, indivi::flat_umap<uint64_t, uint64_t> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Reinsert_Erase_All, indivi::flat_wmap<uint64_t, uint64_t> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+
+// BENCHMARK_TEMPLATE(Emplace_Random, indivi::flat_umap<uint64_t, uint64_t, indivi::seeded_hash<uint64_t>> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Emplace_Random, indivi::flat_wmap<uint64_t, uint64_t, indivi::seeded_hash<uint64_t>> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Existing_Random, indivi::flat_umap<uint64_t, uint64_t, indivi::seeded_hash<uint64_t>> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Existing_Random, indivi::flat_wmap<uint64_t, uint64_t, indivi::seeded_hash<uint64_t>> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_NonExisting_Random, indivi::flat_umap<uint64_t, uint64_t, indivi::seeded_hash<uint64_t>> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_NonExisting_Random, indivi::flat_wmap<uint64_t, uint64_t, indivi::seeded_hash<uint64_t>> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Rehash_String, indivi::flat_umap<std::string, uint64_t, indivi::seeded_hash<std::string>> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Rehash_String, indivi::flat_wmap<std::string, uint64_t, indivi::seeded_hash<std::string>> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+
+// BENCHMARK_TEMPLATE(Emplace_Random, indivi::flat_umap<uint32_t, uint32_t> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Emplace_Random, indivi::flat_umap<uint32_t, uint32_t, indivi::hash_32bits<indivi::hash<uint32_t>>> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Emplace_Random, indivi::flat_wmap<uint32_t, uint32_t> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Emplace_Random, indivi::flat_wmap<uint32_t, uint32_t, indivi::hash_32bits<indivi::hash<uint32_t>>> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Existing_Random, indivi::flat_umap<uint32_t, uint32_t> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Existing_Random, indivi::flat_umap<uint32_t, uint32_t, indivi::hash_32bits<indivi::hash<uint32_t>>> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Existing_Random, indivi::flat_wmap<uint32_t, uint32_t> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_Existing_Random, indivi::flat_wmap<uint32_t, uint32_t, indivi::hash_32bits<indivi::hash<uint32_t>>> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_NonExisting_Random, indivi::flat_umap<uint32_t, uint32_t> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_NonExisting_Random, indivi::flat_umap<uint32_t, uint32_t, indivi::hash_32bits<indivi::hash<uint32_t>>> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_NonExisting_Random, indivi::flat_wmap<uint32_t, uint32_t> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+// BENCHMARK_TEMPLATE(Find_NonExisting_Random, indivi::flat_wmap<uint32_t, uint32_t, indivi::hash_32bits<indivi::hash<uint32_t>>> )->RangeMultiplier(MULT)->Range(RMIN/1, RMAX/1)->Unit(benchmark::kMicrosecond);
+
+// BENCHMARK_TEMPLATE(Hash_String, indivi::hash<std::string> )->RangeMultiplier(2)->Range(8, 4096);
+// BENCHMARK_TEMPLATE(Hash_String, string_wyhash )->RangeMultiplier(2)->Range(8, 4096);
+
+// BENCHMARK_TEMPLATE(Hash_Segments, true  )->RangeMultiplier(4)->Range(16, 4096);
+// BENCHMARK_TEMPLATE(Hash_Segments, false )->RangeMultiplier(4)->Range(16, 4096);
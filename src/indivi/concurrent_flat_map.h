@@ -0,0 +1,410 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#ifndef INDIVI_CONCURRENT_FLAT_MAP_H
+#define INDIVI_CONCURRENT_FLAT_MAP_H
+
+#include "indivi/hash.h"
+#include "indivi/detail/flat_wtable.h"
+#include "indivi/detail/rw_spinlock.h"
+
+#include <functional> // for std::equal_to
+#include <mutex>      // for std::lock_guard
+
+namespace indivi
+{
+/*
+ * Concurrent_flat_map is a thread-safe associative container that stores unordered unique key-value pairs.
+ * Sharded `flat_wmap`: keys are dispatched to a fixed number of `flat_wtable` (power of 2), each with its own reader-writer spinlock.
+ * Hash is computed once per operation, and used for both shard selection and lookup.
+ * Shards use hash bits right above hash fragments (highest bits are used by shard tables for bucket positions).
+ *
+ * No iterators: elements are accessed through visitation (`visit`/`cvisit`, `insert_or_visit`, `erase_if`),
+ * with the shard locked during the call (exclusive for `visit`, shared for `cvisit`).
+ * Visitors must not access the same container (not recursive, could deadlock).
+ * Global operations (`size`, `clear`, `visit_all`...) lock shards one at a time (i.e. not a consistent snapshot).
+ * Allocator-aware: shards and their storage are allocated through rebound `Allocator`.
+ */
+template<
+  class Key,
+  class T,
+  class Hash = indivi::hash<Key>,
+  class KeyEqual = std::equal_to<Key>,
+  class Allocator = std::allocator<std::pair<const Key, T>> >
+class concurrent_flat_map
+{
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using size_type = std::size_t;
+  using difference_type = std::make_signed<size_type>::type;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+
+  static constexpr size_type DEFAULT_SHARD_COUNT{ 64u };
+
+private:
+  using nc_key_type = typename std::remove_const<Key>::type;
+  using nc_mapped_type = typename std::remove_const<T>::type;
+  using item_type = std::pair<nc_key_type, nc_mapped_type>;
+  using init_type = item_type;
+  using flat_wtable = detail::flat_wtable<key_type, mapped_type, value_type, item_type, size_type, hasher, key_equal, allocator_type>;
+  using lock_type = detail::rw_spinlock;
+  using unique_lock = std::lock_guard<lock_type>;
+  using shared_lock = detail::shared_lock_guard<lock_type>;
+
+  static_assert(std::is_same<typename Allocator::value_type, value_type>::value,
+                "concurrent_flat_map: Allocator::value_type must be the same as value_type");
+
+  static constexpr size_type CACHE_LINE{ 64u };
+  static constexpr size_type FRAG_BITS{ 8u }; // lowest hash bits, used by shard tables as hash fragments
+
+  struct Shard
+  {
+    flat_wtable table;
+    mutable lock_type lock;
+    char padding[CACHE_LINE]; // avoid false sharing between neighbour shards (without over-aligned allocation)
+
+    Shard(const Hash& hash, const key_equal& equal, const allocator_type& alloc)
+      : table(0, hash, equal, alloc)
+    {}
+  };
+  using shard_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Shard>;
+  using shard_traits = std::allocator_traits<shard_allocator>;
+
+  // Members
+  Shard* mShards;
+  size_type mShardMask;
+
+  // Heterogeneous lookup (if both Hash and KeyEqual define 'is_transparent')
+  template< class K, class R >
+  using if_transparent = typename std::enable_if<detail::traits::are_transparent<K, Hash, KeyEqual>::value, R>::type;
+  template< class K, class R >
+  using if_transparent_key = typename std::enable_if<
+    detail::traits::are_transparent<K, Hash, KeyEqual>::value && !detail::traits::is_similar<K, Key>::value, R>::type;
+
+public:
+  // Ctr/Dtr
+  concurrent_flat_map() : concurrent_flat_map(DEFAULT_SHARD_COUNT)
+  {}
+
+  explicit concurrent_flat_map(const allocator_type& alloc)
+    : concurrent_flat_map(DEFAULT_SHARD_COUNT, Hash(), key_equal(), alloc)
+  {}
+
+  // 'shard_count' is rounded up to a power of 2
+  explicit concurrent_flat_map(size_type shard_count, const Hash& hash = Hash(), const key_equal& equal = key_equal(),
+                               const allocator_type& alloc = allocator_type())
+    : mShards(nullptr)
+    , mShardMask(0u)
+  {
+    size_type count = shard_count > 1u ? detail::round_up_pow2(shard_count) : 1u;
+    shard_allocator shardAlloc(alloc);
+    mShards = std::addressof(*shard_traits::allocate(shardAlloc, count));
+
+    size_type i = 0u;
+    try {
+      for (; i < count; ++i)
+        shard_traits::construct(shardAlloc, mShards + i, hash, equal, alloc);
+    }
+    catch (...)
+    {
+      while (i > 0u)
+        shard_traits::destroy(shardAlloc, mShards + --i);
+      shard_traits::deallocate(shardAlloc, mShards, count);
+      throw;
+    }
+    mShardMask = count - 1u;
+  }
+
+  concurrent_flat_map(const concurrent_flat_map&) = delete;
+  concurrent_flat_map& operator=(const concurrent_flat_map&) = delete;
+
+  ~concurrent_flat_map()
+  {
+    shard_allocator shardAlloc(mShards[0].table.get_allocator());
+    for (size_type i = 0u; i <= mShardMask; ++i)
+      shard_traits::destroy(shardAlloc, mShards + i);
+    shard_traits::deallocate(shardAlloc, mShards, mShardMask + 1u);
+  }
+
+  // Capacity
+  bool empty() const noexcept { return size() == 0u; }
+
+  size_type size() const noexcept
+  {
+    size_type total = 0u;
+    for (size_type i = 0u; i <= mShardMask; ++i)
+    {
+      shared_lock guard(mShards[i].lock);
+      total += mShards[i].table.size();
+    }
+    return total;
+  }
+
+  size_type shard_count() const noexcept { return mShardMask + 1u; }
+
+  // Hash policy
+  // 'count' is spread evenly across shards
+  void reserve(size_type count)
+  {
+    size_type perShard = (count + mShardMask) / (mShardMask + 1u);
+    for (size_type i = 0u; i <= mShardMask; ++i)
+    {
+      unique_lock guard(mShards[i].lock);
+      mShards[i].table.reserve(perShard);
+    }
+  }
+
+  // Observers
+  hasher hash_function() const { return mShards[0].table.hash_function(); }
+  key_equal key_eq() const { return mShards[0].table.key_eq(); }
+  allocator_type get_allocator() const noexcept { return mShards[0].table.get_allocator(); }
+
+  // Lookup
+  size_type count(const Key& key) const { return contains(key); }
+  bool contains(const Key& key) const { return cvisit(key, [](const value_type&) {}) != 0u; }
+  template< class K >
+  if_transparent<K, size_type> count(const K& key) const { return contains(key); }
+  template< class K >
+  if_transparent<K, bool> contains(const K& key) const { return cvisit(key, [](const value_type&) {}) != 0u; }
+
+  // Visitation (return number of visited elements)
+  template< class F >
+  size_type visit(const Key& key, F f) { return visit_impl(key, f); }
+  template< class F >
+  size_type visit(const Key& key, F f) const { return cvisit_impl(key, f); }
+  template< class F >
+  size_type cvisit(const Key& key, F f) const { return cvisit_impl(key, f); }
+  template< class K, class F >
+  if_transparent<K, size_type> visit(const K& key, F f) { return visit_impl(key, f); }
+  template< class K, class F >
+  if_transparent<K, size_type> visit(const K& key, F f) const { return cvisit_impl(key, f); }
+  template< class K, class F >
+  if_transparent<K, size_type> cvisit(const K& key, F f) const { return cvisit_impl(key, f); }
+
+  template< class F >
+  size_type visit_all(F f)
+  {
+    size_type visited = 0u;
+    for (size_type i = 0u; i <= mShardMask; ++i)
+    {
+      unique_lock guard(mShards[i].lock);
+      for (value_type& value : mShards[i].table)
+        f(value);
+      visited += mShards[i].table.size();
+    }
+    return visited;
+  }
+  template< class F >
+  size_type visit_all(F f) const { return cvisit_all(f); }
+  template< class F >
+  size_type cvisit_all(F f) const
+  {
+    size_type visited = 0u;
+    for (size_type i = 0u; i <= mShardMask; ++i)
+    {
+      shared_lock guard(mShards[i].lock);
+      const flat_wtable& table = mShards[i].table;
+      for (auto it = table.begin(); it != table.cend(); ++it)
+        f(*it);
+      visited += table.size();
+    }
+    return visited;
+  }
+
+  // Modifiers (return true if inserted)
+  void clear() noexcept
+  {
+    for (size_type i = 0u; i <= mShardMask; ++i)
+    {
+      unique_lock guard(mShards[i].lock);
+      mShards[i].table.clear();
+    }
+  }
+
+  template< class P >
+  bool insert(P&& value) { return insert_impl(std::forward<P>(value)); }
+  bool insert(init_type&& value) { return insert_impl(std::move(value)); }
+
+  template< class... Args >
+  bool emplace(Args&&... args) { return insert_impl(init_type(std::forward<Args>(args)...)); }
+
+  template< class... Args >
+  bool try_emplace(const Key& key, Args&&... args) { return try_emplace_impl(key, std::forward<Args>(args)...); }
+  template< class... Args >
+  bool try_emplace(Key&& key, Args&&... args) { return try_emplace_impl(std::move(key), std::forward<Args>(args)...); }
+  template< class K, class... Args >
+  if_transparent_key<K, bool> try_emplace(K&& key, Args&&... args) { return try_emplace_impl(std::forward<K>(key), std::forward<Args>(args)...); }
+
+  template< class M >
+  bool insert_or_assign(const Key& key, M&& obj) { return insert_or_assign_impl(key, std::forward<M>(obj)); }
+  template< class M >
+  bool insert_or_assign(Key&& key, M&& obj) { return insert_or_assign_impl(std::move(key), std::forward<M>(obj)); }
+
+  // Visit existing element instead of inserting (exclusive or shared access)
+  template< class P, class F >
+  bool insert_or_visit(P&& value, F f) { return insert_or_visit_impl(std::forward<P>(value), f); }
+  template< class F >
+  bool insert_or_visit(init_type&& value, F f) { return insert_or_visit_impl(std::move(value), f); }
+  template< class P, class F >
+  bool insert_or_cvisit(P&& value, F f) { return insert_or_cvisit_impl(std::forward<P>(value), f); }
+  template< class F >
+  bool insert_or_cvisit(init_type&& value, F f) { return insert_or_cvisit_impl(std::move(value), f); }
+
+  size_type erase(const Key& key) { return erase_if(key, [](const value_type&) { return true; }); }
+  template< class K >
+  if_transparent_key<K, size_type> erase(const K& key) { return erase_if(key, [](const value_type&) { return true; }); }
+
+  // Erase element matching key if 'pred(value)' is true
+  template< class F >
+  size_type erase_if(const Key& key, F pred) { return erase_if_impl(key, pred); }
+  template< class K, class F >
+  if_transparent_key<K, size_type> erase_if(const K& key, F pred) { return erase_if_impl(key, pred); }
+
+  // Erase all elements for which 'pred(value)' is true
+  template< class F >
+  size_type erase_if(F pred)
+  {
+    size_type erased = 0u;
+    for (size_type i = 0u; i <= mShardMask; ++i)
+    {
+      unique_lock guard(mShards[i].lock);
+      erased += mShards[i].table.erase_if(pred);
+    }
+    return erased;
+  }
+
+private:
+  template< class K >
+  std::size_t hash_key(const K& key) const
+  {
+    return mShards[0].table.hash_key(key); // same hasher for all shards (never modified)
+  }
+
+  Shard& shard_of(std::size_t hash) const noexcept
+  {
+    return mShards[(hash >> FRAG_BITS) & mShardMask];
+  }
+
+  template< class K, class F >
+  size_type visit_impl(const K& key, F& f)
+  {
+    std::size_t hash = hash_key(key);
+    Shard& shard = shard_of(hash);
+    unique_lock guard(shard.lock);
+
+    auto it = shard.table.find_hashed(key, hash);
+    if (it == shard.table.end())
+      return 0u;
+    f(*it);
+    return 1u;
+  }
+
+  template< class K, class F >
+  size_type cvisit_impl(const K& key, F& f) const
+  {
+    std::size_t hash = hash_key(key);
+    const Shard& shard = shard_of(hash);
+    shared_lock guard(shard.lock);
+
+    auto it = shard.table.find_hashed(key, hash);
+    if (it == shard.table.cend())
+      return 0u;
+    f(*it);
+    return 1u;
+  }
+
+  template< class V >
+  bool insert_impl(V&& value)
+  {
+    std::size_t hash = hash_key(value.first);
+    Shard& shard = shard_of(hash);
+    unique_lock guard(shard.lock);
+
+    return shard.table.insert_hashed(hash, std::forward<V>(value)).second;
+  }
+
+  template< class K, class... Args >
+  bool try_emplace_impl(K&& key, Args&&... args)
+  {
+    std::size_t hash = hash_key(key);
+    Shard& shard = shard_of(hash);
+    unique_lock guard(shard.lock);
+
+    return shard.table.try_emplace_hashed(hash, std::forward<K>(key), std::forward<Args>(args)...).second;
+  }
+
+  template< class K, class M >
+  bool insert_or_assign_impl(K&& key, M&& obj)
+  {
+    std::size_t hash = hash_key(key);
+    Shard& shard = shard_of(hash);
+    unique_lock guard(shard.lock);
+
+    auto it = shard.table.find_hashed(key, hash);
+    if (it != shard.table.end())
+    {
+      it->second = std::forward<M>(obj);
+      return false;
+    }
+    shard.table.try_emplace_hashed(hash, std::forward<K>(key), std::forward<M>(obj));
+    return true;
+  }
+
+  template< class V, class F >
+  bool insert_or_visit_impl(V&& value, F& f)
+  {
+    std::size_t hash = hash_key(value.first);
+    Shard& shard = shard_of(hash);
+    unique_lock guard(shard.lock);
+
+    auto res = shard.table.insert_hashed(hash, std::forward<V>(value));
+    if (!res.second)
+      f(*res.first);
+    return res.second;
+  }
+
+  template< class V, class F >
+  bool insert_or_cvisit_impl(V&& value, F& f)
+  {
+    std::size_t hash = hash_key(value.first);
+    Shard& shard = shard_of(hash);
+    unique_lock guard(shard.lock);
+
+    auto res = shard.table.insert_hashed(hash, std::forward<V>(value));
+    if (!res.second)
+      f(static_cast<const value_type&>(*res.first));
+    return res.second;
+  }
+
+  template< class K, class F >
+  size_type erase_if_impl(const K& key, F& pred)
+  {
+    std::size_t hash = hash_key(key);
+    Shard& shard = shard_of(hash);
+    unique_lock guard(shard.lock);
+
+    auto it = shard.table.find_hashed(key, hash);
+    if (it == shard.table.end() || !pred(static_cast<const value_type&>(*it)))
+      return 0u;
+    shard.table.erase(it);
+    return 1u;
+  }
+};
+
+template< class Key, class T, class Hash, class KeyEqual, class Allocator >
+constexpr typename concurrent_flat_map<Key, T, Hash, KeyEqual, Allocator>::size_type
+  concurrent_flat_map<Key, T, Hash, KeyEqual, Allocator>::DEFAULT_SHARD_COUNT;
+
+} // namespace indivi
+
+#endif // INDIVI_CONCURRENT_FLAT_MAP_H
@@ -0,0 +1,159 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#ifndef INDIVI_FLAT_NODE_H
+#define INDIVI_FLAT_NODE_H
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <cstddef>
+
+namespace indivi
+{
+namespace detail
+{
+/*
+ * Node handle of flat containers (see `extract()`), owning an element moved out of its table along with its hash.
+ * Unlike node-based containers, the element itself is moved (no relinking, no allocator involved).
+ * The hash is reused on insertion if Hash is stateless (e.g. between `flat_umap` and `flat_wmap` of same Hash),
+ * unless the key was accessed through non-const `key()`/`value()`.
+ */
+template< class Key, class T, class value_type, class item_type, class Hash >
+class flat_node
+{
+public:
+  using key_type = Key;
+  using mapped_type = T;
+
+private:
+  static constexpr bool IS_MAP{ !std::is_same<value_type, Key>::value };
+
+  using nc_key_type = typename std::remove_const<Key>::type;
+  using storage_type = typename std::aligned_storage<sizeof(item_type), alignof(item_type)>::type;
+
+  // Members
+  storage_type mStorage;
+  std::size_t mHash = 0u;
+  bool mEmpty = true;
+  bool mHashed = false; // mHash still matches key
+
+  template< class, class, class, class, class, class, class, class, std::size_t > friend class flat_utable;
+  template< class, class, class, class, class, class, class, class > friend class flat_wtable;
+
+  struct from_table {}; // private tag, keeps `insert({k, v})` unambiguous
+
+  template< typename U >
+  flat_node(from_table, std::size_t hash, U&& value)
+    : mHash(hash)
+  {
+    ::new (&mStorage) item_type(std::forward<U>(value));
+    mEmpty = false;
+    mHashed = true;
+  }
+
+  item_type& item() const noexcept { return *reinterpret_cast<item_type*>(const_cast<storage_type*>(&mStorage)); }
+  std::size_t hash() const noexcept { return mHash; }
+  bool hashed() const noexcept { return mHashed; }
+
+  void reset() noexcept
+  {
+    if (!mEmpty)
+    {
+      item().~item_type();
+      mEmpty = true;
+    }
+  }
+
+public:
+  // Ctr/Dtr
+  flat_node() noexcept = default;
+
+  flat_node(flat_node&& other) noexcept(std::is_nothrow_move_constructible<item_type>::value)
+    : mHash(other.mHash)
+    , mHashed(other.mHashed)
+  {
+    if (!other.mEmpty)
+    {
+      ::new (&mStorage) item_type(std::move(other.item()));
+      mEmpty = false;
+      other.reset();
+    }
+  }
+
+  ~flat_node() { reset(); }
+
+  // Assignment
+  flat_node& operator=(flat_node&& other) noexcept(std::is_nothrow_move_constructible<item_type>::value)
+  {
+    if (this != &other)
+    {
+      reset();
+      mHash = other.mHash;
+      mHashed = other.mHashed;
+      if (!other.mEmpty)
+      {
+        ::new (&mStorage) item_type(std::move(other.item()));
+        mEmpty = false;
+        other.reset();
+      }
+    }
+    return *this;
+  }
+
+  flat_node(const flat_node&) = delete;
+  flat_node& operator=(const flat_node&) = delete;
+
+  // Observers
+  bool empty() const noexcept { return mEmpty; }
+  explicit operator bool() const noexcept { return !mEmpty; }
+
+  // map only
+  nc_key_type& key() noexcept
+  {
+    static_assert(IS_MAP, "flat_node: key() is only available for maps (see value())");
+    mHashed = false; // may be modified
+    return item().first;
+  }
+  const nc_key_type& key() const noexcept
+  {
+    static_assert(IS_MAP, "flat_node: key() is only available for maps (see value())");
+    return item().first;
+  }
+  mapped_type& mapped() const noexcept
+  {
+    static_assert(IS_MAP, "flat_node: mapped() is only available for maps");
+    return item().second;
+  }
+
+  // set only
+  value_type& value() noexcept
+  {
+    static_assert(!IS_MAP, "flat_node: value() is only available for sets (see key() and mapped())");
+    mHashed = false; // may be modified
+    return item();
+  }
+  const value_type& value() const noexcept
+  {
+    static_assert(!IS_MAP, "flat_node: value() is only available for sets (see key() and mapped())");
+    return item();
+  }
+
+  // Modifiers
+  void swap(flat_node& other) noexcept(std::is_nothrow_move_constructible<item_type>::value)
+  {
+    flat_node tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  friend void swap(flat_node& lhs, flat_node& rhs) noexcept(noexcept(lhs.swap(rhs))) { lhs.swap(rhs); }
+};
+
+} // namespace detail
+} // namespace indivi
+
+#endif // INDIVI_FLAT_NODE_H
@@ -0,0 +1,176 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#ifndef INDIVI_FLAT_SNAPSHOT_H
+#define INDIVI_FLAT_SNAPSHOT_H
+
+#include <algorithm>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace indivi
+{
+template< class Map >
+class flat_mapped; // see 'flat_mapped.h'
+
+namespace detail
+{
+/*
+ * Snapshot file of a flat table (see 'flat_mapped.h'): a header, then the table storage in its native layout.
+ * Storage starts at `BLOCK_OFFSET` (aligned like a page-aligned mapping would be), unused value slots are zeroed.
+ * Only readable on a machine/build with the same layout (checked), by a table using the same hash function
+ * (checked by re-hashing a few keys, i.e. 'fingerprint').
+ */
+struct snapshot_header
+{
+  static constexpr std::size_t BLOCK_OFFSET{ 128u };
+  static constexpr std::size_t BLOCK_ALIGN{ 64u };   // guaranteed storage alignment (relative to mapping)
+  static constexpr uint32_t VERSION{ 2u };
+  static constexpr uint32_t ENDIAN_TAG{ 0x01020304u };
+  static constexpr unsigned int FINGERPRINT_KEYS{ 16u };
+
+  char magic[8];
+  uint32_t version;
+  uint32_t endian;
+  uint64_t layout;      // table type and options
+  uint64_t itemSize;
+  uint64_t itemAlign;
+  uint64_t size;
+  uint64_t shift;
+  uint64_t gMask;
+  uint64_t maxSize;
+  uint64_t fingerprint; // hashes of first keys
+  uint64_t blockBytes;
+
+  static const char* magic_tag() noexcept { return "INDIVIFT"; }
+
+  // 'storedHashSize' is 0 without stored hashes
+  static uint64_t make_layout(char tableType, std::size_t groupWidth, std::size_t storedHashSize, std::size_t sizeTypeSize) noexcept
+  {
+    return (uint64_t)(uint8_t)tableType | ((uint64_t)groupWidth << 8) | ((uint64_t)storedHashSize << 16)
+           | ((uint64_t)sizeTypeSize << 24) | ((uint64_t)sizeof(std::size_t) << 32);
+  }
+
+  void init(uint64_t layout_, uint64_t itemSize_, uint64_t itemAlign_) noexcept
+  {
+    std::memset((void*)this, 0, sizeof(snapshot_header));
+    std::memcpy(magic, magic_tag(), sizeof(magic));
+    version = VERSION;
+    endian = ENDIAN_TAG;
+    layout = layout_;
+    itemSize = itemSize_;
+    itemAlign = itemAlign_;
+  }
+
+  // Same format and table layout (values are checked by the table)
+  bool compatible(uint64_t layout_, uint64_t itemSize_, uint64_t itemAlign_) const noexcept
+  {
+    return std::memcmp(magic, magic_tag(), sizeof(magic)) == 0 && version == VERSION && endian == ENDIAN_TAG
+           && layout == layout_ && itemSize == itemSize_ && itemAlign == itemAlign_;
+  }
+};
+
+static_assert(sizeof(snapshot_header) <= snapshot_header::BLOCK_OFFSET, "snapshot_header: too big");
+
+// Items can be saved as raw bytes (std::pair is never trivially copyable, so check its members)
+template< class T >
+struct is_snapshot_safe : std::is_trivially_copyable<T> {};
+
+template< class T1, class T2 >
+struct is_snapshot_safe<std::pair<T1, T2>>
+  : std::integral_constant<bool, std::is_trivially_copyable<T1>::value && std::is_trivially_copyable<T2>::value> {};
+
+static inline uint64_t snapshot_fingerprint(uint64_t accu, std::size_t hash) noexcept
+{
+  return (accu ^ (uint64_t)hash) * UINT64_C(0x9E3779B97F4A7C15) + 1u;
+}
+
+// Buffered sequential writer (tracks offset, for padding)
+class snapshot_writer
+{
+  std::ostream& mOut;
+  std::size_t mOffset = 0u;
+  std::size_t mUsed = 0u;
+  std::vector<char> mBuffer;
+
+public:
+  explicit snapshot_writer(std::ostream& out) : mOut(out), mBuffer(std::size_t(1u) << 16) {}
+  ~snapshot_writer() { flush(); }
+
+  snapshot_writer(const snapshot_writer&) = delete;
+  snapshot_writer& operator=(const snapshot_writer&) = delete;
+
+  std::size_t offset() const noexcept { return mOffset; }
+
+  void write(const void* data, std::size_t bytes)
+  {
+    const char* src = static_cast<const char*>(data);
+    while (bytes)
+    {
+      std::size_t count = std::min(bytes, mBuffer.size() - mUsed);
+      std::memcpy(mBuffer.data() + mUsed, src, count);
+      advance(count);
+      src += count;
+      bytes -= count;
+    }
+  }
+
+  void zeros(std::size_t bytes)
+  {
+    while (bytes)
+    {
+      std::size_t count = std::min(bytes, mBuffer.size() - mUsed);
+      std::memset(mBuffer.data() + mUsed, 0, count);
+      advance(count);
+      bytes -= count;
+    }
+  }
+
+  void pad_to(std::size_t offset) { zeros(offset - mOffset); }
+
+  void flush()
+  {
+    if (mUsed)
+      mOut.write(mBuffer.data(), (std::streamsize)mUsed);
+    mUsed = 0u;
+  }
+
+private:
+  void advance(std::size_t count)
+  {
+    mUsed += count;
+    mOffset += count;
+    if (mUsed == mBuffer.size())
+      flush();
+  }
+};
+
+// Write 'table' snapshot to file at 'path' (overwritten), throws `std::runtime_error` on failure
+template< class Table >
+void save_snapshot_file(const Table& table, const std::string& path)
+{
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file)
+    throw std::runtime_error("flat snapshot: cannot open file for writing");
+
+  table.save_snapshot(file);
+  file.flush();
+  if (!file)
+    throw std::runtime_error("flat snapshot: write failed");
+}
+
+} // namespace detail
+} // namespace indivi
+
+#endif // INDIVI_FLAT_SNAPSHOT_H
@@ -0,0 +1,156 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#ifndef INDIVI_FLAT_TELEMETRY_H
+#define INDIVI_FLAT_TELEMETRY_H
+
+#include <atomic>
+#include <chrono>
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef INDIVI_FLAT_TELEMETRY_SAMPLING
+  #define INDIVI_FLAT_TELEMETRY_SAMPLING 64 // one lookup out of N is sampled (power of 2)
+#endif
+
+namespace indivi
+{
+/*
+ * Telemetry of a flat table, see `get_telemetry()` (enabled by 'INDIVI_FLAT_U_TELEMETRY' or 'INDIVI_FLAT_W_TELEMETRY').
+ * Cheap enough for production builds: single-key lookups are sampled, other counters are updated on rare events only.
+ * Probe lengths are in groups (flat_utable) or probing windows (flat_wtable), binned as: 1, 2, 3, 4, 5-8, 9-16, 17-32, 33+.
+ */
+struct flat_telemetry
+{
+  static constexpr unsigned int PROBE_BINS{ 8u };
+
+  uint64_t probe_hits[PROBE_BINS] = {};   // sampled successful lookups, by probe length
+  uint64_t probe_misses[PROBE_BINS] = {}; // sampled unsuccessful lookups, by probe length
+  uint64_t sampled_compares = 0u;         // key comparisons in sampled lookups (i.e. hash fragment collisions)
+  uint64_t rehash_count = 0u;             // storage rebuilds with items (rehash, growth, tombstones purge)
+  uint64_t rehash_nanoseconds = 0u;       // total time spent in storage rebuilds
+  uint64_t overflow_saturations = 0u;     // flat_utable only: insertions past a saturated overflow counter
+  float tombstone_ratio = 0.f;            // flat_wtable only: tombstones per bucket
+
+  uint64_t sampled_lookups() const noexcept
+  {
+    uint64_t count = 0u;
+    for (unsigned int i = 0u; i < PROBE_BINS; ++i)
+      count += probe_hits[i] + probe_misses[i];
+    return count;
+  }
+
+  // Bin of a probe length (>= 1)
+  static unsigned int probe_bin(std::size_t probeLen) noexcept
+  {
+    if (probeLen <= 4u)
+      return (unsigned int)probeLen - 1u;
+    unsigned int bin = 4u;
+    for (std::size_t bound = 8u; probeLen > bound && bin < PROBE_BINS - 1u; bound *= 2u)
+      ++bin;
+    return bin;
+  }
+};
+
+namespace detail
+{
+/*
+ * Per-table telemetry counters, not copied, moved or swapped with table content.
+ * Sampled lookups counters are relaxed atomics (const lookups may run concurrently), others are updated by mutating operations.
+ */
+class flat_telemetry_counters
+{
+  static constexpr uint32_t SAMPLING{ INDIVI_FLAT_TELEMETRY_SAMPLING };
+  static_assert(SAMPLING && (SAMPLING & (SAMPLING - 1u)) == 0u, "flat_telemetry: INDIVI_FLAT_TELEMETRY_SAMPLING must be a power of 2");
+
+  mutable std::atomic<uint64_t> mProbeHits[flat_telemetry::PROBE_BINS];
+  mutable std::atomic<uint64_t> mProbeMisses[flat_telemetry::PROBE_BINS];
+  mutable std::atomic<uint64_t> mCompares;
+  uint64_t mRehashCount = 0u;
+  uint64_t mRehashNanos = 0u;
+  uint64_t mSaturations = 0u;
+
+public:
+  flat_telemetry_counters() noexcept { reset(); }
+  flat_telemetry_counters(const flat_telemetry_counters&) noexcept : flat_telemetry_counters() {}
+  flat_telemetry_counters& operator=(const flat_telemetry_counters&) noexcept { return *this; }
+
+  // Per-thread countdown (shared by all tables, no write to table memory when not sampling)
+  static bool sample() noexcept
+  {
+    static thread_local uint32_t countdown = 0u;
+    countdown = (countdown - 1u) & (SAMPLING - 1u);
+    return countdown == 0u;
+  }
+
+  void record_lookup(bool hit, std::size_t probeLen, std::size_t compares) const noexcept
+  {
+    unsigned int bin = flat_telemetry::probe_bin(probeLen);
+    (hit ? mProbeHits : mProbeMisses)[bin].fetch_add(1u, std::memory_order_relaxed);
+    mCompares.fetch_add(compares, std::memory_order_relaxed);
+  }
+
+  void record_saturation() noexcept { ++mSaturations; }
+
+  // Times a storage rebuild, if 'enabled'
+  class rehash_scope
+  {
+    flat_telemetry_counters* mCounters;
+    std::chrono::steady_clock::time_point mStart;
+
+  public:
+    rehash_scope(flat_telemetry_counters& counters, bool enabled = true) noexcept
+      : mCounters(enabled ? &counters : nullptr)
+      , mStart(enabled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+    {}
+    rehash_scope(const rehash_scope&) = delete;
+    rehash_scope& operator=(const rehash_scope&) = delete;
+
+    ~rehash_scope()
+    {
+      if (mCounters)
+      {
+        ++mCounters->mRehashCount;
+        mCounters->mRehashNanos += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now() - mStart).count();
+      }
+    }
+  };
+
+  // Table-specific fields (tombstones, saturations) are completed by the table
+  flat_telemetry get() const noexcept
+  {
+    flat_telemetry telemetry;
+    for (unsigned int i = 0u; i < flat_telemetry::PROBE_BINS; ++i)
+    {
+      telemetry.probe_hits[i] = mProbeHits[i].load(std::memory_order_relaxed);
+      telemetry.probe_misses[i] = mProbeMisses[i].load(std::memory_order_relaxed);
+    }
+    telemetry.sampled_compares = mCompares.load(std::memory_order_relaxed);
+    telemetry.rehash_count = mRehashCount;
+    telemetry.rehash_nanoseconds = mRehashNanos;
+    telemetry.overflow_saturations = mSaturations;
+    return telemetry;
+  }
+
+  void reset() noexcept
+  {
+    for (unsigned int i = 0u; i < flat_telemetry::PROBE_BINS; ++i)
+    {
+      mProbeHits[i].store(0u, std::memory_order_relaxed);
+      mProbeMisses[i].store(0u, std::memory_order_relaxed);
+    }
+    mCompares.store(0u, std::memory_order_relaxed);
+    mRehashCount = 0u;
+    mRehashNanos = 0u;
+    mSaturations = 0u;
+  }
+};
+
+} // namespace detail
+} // namespace indivi
+
+#endif // INDIVI_FLAT_TELEMETRY_H
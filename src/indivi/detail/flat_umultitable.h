@@ -0,0 +1,631 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#ifndef INDIVI_FLAT_UMULTITABLE_H
+#define INDIVI_FLAT_UMULTITABLE_H
+
+#include "indivi/hash.h"
+#include "indivi/detail/flat_utable.h"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace indivi
+{
+namespace detail
+{
+/*
+ * Entry of `flat_umultitable`: an item and its rank among items with equivalent key.
+ * Ranks of a key are dense (0 to count - 1), the first item (rank 0) also holds their count.
+ */
+template< class V >
+struct multi_item
+{
+  static constexpr uint32_t HEAD{ UINT32_C(1) << 31 }; // first item flag
+  static constexpr uint32_t MAX_COUNT{ HEAD - 1u };    // max items per key
+
+  V value; // first member (iterators point to it)
+  uint32_t link; // rank (> 0), or HEAD | count
+
+  template< class... Args >
+  explicit multi_item(uint32_t link_, Args&&... args)
+    : value(std::forward<Args>(args)...)
+    , link(link_)
+  {}
+
+  uint32_t rank() const noexcept { return (link & HEAD) ? 0u : link; }
+  uint32_t count() const noexcept { return link & ~HEAD; } // first item only
+};
+
+// Lookup of an item by key and rank (with precomputed key hash, see `multi_hash::key_hash`)
+template< class K >
+struct multi_ref
+{
+  const K& key;
+  std::size_t hash;
+  uint32_t rank;
+};
+
+// Key of an item (pair for maps)
+template< class Key >
+struct multi_key
+{
+  static const Key& item_key(const Key& key) noexcept { return key; }
+  template< typename P >
+  static const Key& item_key(const P& value) noexcept { return value.first; }
+};
+
+template< class Hash, bool = hash_is_stored<Hash>::value >
+struct multi_hash_base : Hash
+{
+  multi_hash_base() = default;
+  multi_hash_base(const Hash& hash) : Hash(hash) {}
+};
+
+template< class Hash >
+struct multi_hash_base<Hash, true> : Hash
+{
+  using is_stored = void;
+
+  multi_hash_base() = default;
+  multi_hash_base(const Hash& hash) : Hash(hash) {}
+};
+
+/*
+ * Hasher of `flat_umultitable` entries: key hash mixed with rank, so items with equivalent keys spread over the table
+ * (first item at the key position). Recomputed from entries on rehash, like any key.
+ */
+template< class Hash, class Key >
+struct multi_hash : multi_hash_base<Hash>
+{
+  using is_avalanching = void;
+  using is_transparent = void;
+
+  multi_hash() = default;
+  multi_hash(const Hash& hash) : multi_hash_base<Hash>(hash) {}
+
+  template< class K >
+  std::size_t key_hash(const K& key) const
+  {
+    return hash_mixer<Hash>::mix(static_cast<const Hash&>(*this), key);
+  }
+
+  template< class V >
+  std::size_t operator()(const multi_item<V>& item) const
+  {
+    return rank_hash(key_hash(multi_key<Key>::item_key(item.value)), item.rank());
+  }
+
+  template< class K >
+  std::size_t operator()(const multi_ref<K>& ref) const noexcept
+  {
+    return rank_hash(ref.hash, ref.rank);
+  }
+
+  static std::size_t rank_hash(std::size_t hash, uint32_t rank) noexcept
+  {
+    return rank ? bit_mix::mix_hash(hash, (uint64_t)rank * UINT64_C(0x9E3779B97F4A7C15)) : hash;
+  }
+};
+
+// Key equality of `flat_umultitable` entries: same rank and equivalent keys
+template< class KeyEqual, class Key >
+struct multi_equal : KeyEqual
+{
+  using is_transparent = void;
+
+  multi_equal() = default;
+  multi_equal(const KeyEqual& equal) : KeyEqual(equal) {}
+
+  template< class V >
+  bool operator()(const multi_item<V>& lhs, const multi_item<V>& rhs) const
+  {
+    return lhs.rank() == rhs.rank()
+           && KeyEqual::operator()(multi_key<Key>::item_key(lhs.value), multi_key<Key>::item_key(rhs.value));
+  }
+
+  template< class K, class V >
+  bool operator()(const multi_ref<K>& ref, const multi_item<V>& item) const
+  {
+    return ref.rank == item.rank() && KeyEqual::operator()(ref.key, multi_key<Key>::item_key(item.value));
+  }
+};
+
+/*
+ * Underlying class of `flat_umultimap` and `flat_umultiset`.
+ * Items with equivalent keys are separate entries of a `flat_utable`, found by rank (`multi_item`): no per-key allocation,
+ * and each item has its own probing sequence (no long lists filling the same groups).
+ * Count and insertion are a single key lookup, `equal_range` iterates over ranks (one lookup per item).
+ * Hash policy (load factor, rehash, stats) applies to all items.
+ */
+template<
+  class Key,
+  class value_type,
+  class item_type,
+  class size_type,
+  class Hash,
+  class KeyEqual,
+  class Allocator >
+class flat_umultitable
+{
+public:
+  using key_type = Key;
+  using difference_type = typename std::make_signed<size_type>::type;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using iter_reference = typename std::conditional<std::is_same<key_type, value_type>::value, const key_type&, value_type&>::type;
+  using iter_const_reference = const value_type&; // for flat_umultiset, iter_reference is also const
+  using iter_pointer = value_type*;
+  using iter_const_pointer = const value_type*;
+
+private:
+  using entry_type = multi_item<item_type>;
+  using entry_hash = multi_hash<Hash, Key>;
+  using entry_equal = multi_equal<KeyEqual, Key>;
+  using entry_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<entry_type>;
+  using entry_table = flat_utable<entry_type, void*, entry_type, entry_type, size_type, entry_hash, entry_equal, entry_allocator>;
+  using entry_iterator = typename entry_table::const_iterator;
+
+  static constexpr uint32_t HEAD{ entry_type::HEAD };
+
+  // Members
+  entry_table mTable;
+
+public:
+  template <typename Pointer, typename Reference>
+  class Iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = typename flat_umultitable::difference_type;
+    using pointer = Pointer;
+    using reference = Reference;
+
+  private:
+    friend flat_umultitable;
+    template <typename, typename> friend class Iterator;
+
+    entry_iterator mIt;
+
+    explicit Iterator(const entry_iterator& it) : mIt(it) {}
+
+  public:
+    Iterator() = default;
+    Iterator(const Iterator& other) = default;
+
+    template <typename P, typename R,
+      typename = std::enable_if<std::is_convertible<P, pointer>::value>>
+      Iterator(const Iterator<P, R>& other)
+      : mIt(other.mIt)
+    {}
+
+    Iterator& operator=(const Iterator& other) = default;
+
+    Iterator& operator++() noexcept
+    {
+      ++mIt;
+      return *this;
+    }
+
+    Iterator operator++(int) noexcept
+    {
+      Iterator retval = *this;
+      ++(*this);
+      return retval;
+    }
+
+    bool operator==(const Iterator& other) const noexcept
+    {
+      return mIt == other.mIt;
+    }
+
+    bool operator!=(const Iterator& other) const noexcept
+    {
+      return mIt != other.mIt;
+    }
+
+    reference operator*() const noexcept
+    {
+      return *operator->();
+    }
+
+    pointer operator->() const noexcept
+    {
+      return reinterpret_cast<pointer>(std::addressof(const_cast<entry_type&>(*mIt).value));
+    }
+  };
+
+  using iterator = Iterator<iter_pointer, iter_reference>;
+  using const_iterator = Iterator<iter_const_pointer, iter_const_reference>;
+
+  // Iterate over items with equivalent keys (see `equal_range`), one lookup by rank on increment
+  // Invalidated by any modification of the table (including erasing the current item)
+  template <typename Pointer, typename Reference>
+  class EqualIterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = typename flat_umultitable::difference_type;
+    using pointer = Pointer;
+    using reference = Reference;
+
+  private:
+    friend flat_umultitable;
+    template <typename, typename> friend class EqualIterator;
+
+    const entry_table* mTable = nullptr;
+    entry_iterator mIt;
+    std::size_t mHash = 0u; // key hash
+    uint32_t mRank = 0u;
+    uint32_t mCount = 0u;
+
+    EqualIterator(const entry_table* table, const entry_iterator& first, std::size_t hash)
+      : mTable(table), mIt(first), mHash(hash), mCount(first->count())
+    {}
+
+  public:
+    EqualIterator() = default;
+    EqualIterator(const EqualIterator& other) = default;
+
+    template <typename P, typename R,
+      typename = std::enable_if<std::is_convertible<P, pointer>::value>>
+      EqualIterator(const EqualIterator<P, R>& other)
+      : mTable(other.mTable), mIt(other.mIt), mHash(other.mHash), mRank(other.mRank), mCount(other.mCount)
+    {}
+
+    EqualIterator& operator=(const EqualIterator& other) = default;
+
+    // Same item as a table iterator
+    operator Iterator<Pointer, Reference>() const noexcept
+    {
+      return Iterator<Pointer, Reference>(mIt);
+    }
+
+    EqualIterator& operator++()
+    {
+      if (++mRank < mCount)
+        mIt = mTable->find(multi_ref<Key>{ multi_key<Key>::item_key(mIt->value), mHash, mRank });
+      else
+        mIt = entry_table::cend();
+      return *this;
+    }
+
+    EqualIterator operator++(int)
+    {
+      EqualIterator retval = *this;
+      ++(*this);
+      return retval;
+    }
+
+    bool operator==(const EqualIterator& other) const noexcept
+    {
+      return mIt == other.mIt;
+    }
+
+    bool operator!=(const EqualIterator& other) const noexcept
+    {
+      return mIt != other.mIt;
+    }
+
+    reference operator*() const noexcept
+    {
+      return *operator->();
+    }
+
+    pointer operator->() const noexcept
+    {
+      return reinterpret_cast<pointer>(std::addressof(const_cast<entry_type&>(*mIt).value));
+    }
+  };
+
+  using equal_iterator = EqualIterator<iter_pointer, iter_reference>;
+  using const_equal_iterator = EqualIterator<iter_const_pointer, iter_const_reference>;
+
+public:
+  // Ctr/Dtr
+  explicit flat_umultitable(size_type bucket_count, const Hash& hash = Hash(), const key_equal& equal = key_equal(),
+                            const allocator_type& alloc = allocator_type())
+    : mTable(bucket_count, entry_hash(hash), entry_equal(equal), entry_allocator(alloc))
+  {}
+
+  flat_umultitable(const flat_umultitable& other)
+    : mTable(other.mTable)
+  {}
+
+  flat_umultitable(const flat_umultitable& other, const allocator_type& alloc)
+    : mTable(other.mTable, entry_allocator(alloc))
+  {}
+
+  flat_umultitable(flat_umultitable&& other) noexcept(std::is_nothrow_move_constructible<entry_table>::value)
+    : mTable(std::move(other.mTable))
+  {}
+
+  flat_umultitable(flat_umultitable&& other, const allocator_type& alloc)
+    : mTable(std::move(other.mTable), entry_allocator(alloc))
+  {}
+
+  ~flat_umultitable() = default;
+
+  // Assignment
+  void operator=(const flat_umultitable& other)
+  {
+    mTable = other.mTable;
+  }
+
+  void operator=(flat_umultitable&& other) noexcept(std::is_nothrow_move_assignable<entry_table>::value)
+  {
+    mTable = std::move(other.mTable);
+  }
+
+  // Iterators
+  iterator begin() noexcept { return iterator(mTable.cbegin()); }
+  const_iterator begin() const noexcept { return const_iterator(mTable.cbegin()); }
+  const_iterator cbegin() const noexcept { return const_iterator(mTable.cbegin()); }
+
+  static iterator end() noexcept { return iterator(); }
+  static const_iterator cend() noexcept { return const_iterator(); }
+
+  // Capacity
+  bool empty() const noexcept { return mTable.empty(); }
+  size_type size() const noexcept { return mTable.size(); }
+  size_type max_size() const noexcept { return mTable.max_size(); }
+
+  // Bucket interface
+  size_type bucket_count() const noexcept { return mTable.bucket_count(); }
+  size_type max_bucket_count() const noexcept { return mTable.max_bucket_count(); }
+
+  // Hash policy
+  float load_factor() const noexcept { return mTable.load_factor(); }
+  float max_load_factor() const noexcept { return mTable.max_load_factor(); }
+  void max_load_factor(float ml) { mTable.max_load_factor(ml); }
+  size_type growth_factor() const noexcept { return mTable.growth_factor(); }
+  void growth_factor(size_type factor) noexcept { mTable.growth_factor(factor); }
+  float min_load_factor() const noexcept { return mTable.min_load_factor(); }
+  void min_load_factor(float ml) noexcept { mTable.min_load_factor(ml); }
+  size_type rehash_threshold() const noexcept { return mTable.rehash_threshold(); }
+
+  void rehash(size_type count, unsigned int threadCount = 1u) { mTable.rehash(count, threadCount); }
+  void reserve(size_type count, unsigned int threadCount = 1u) { mTable.reserve(count, threadCount); }
+  void shrink_to_fit(unsigned int threadCount = 1u) { mTable.shrink_to_fit(threadCount); }
+
+  // Observers
+  hasher hash_function() const { return mTable.hash_function(); }
+  key_equal key_eq() const { return mTable.key_eq(); }
+  allocator_type get_allocator() const noexcept { return allocator_type(mTable.get_allocator()); }
+
+  // Lookup
+  template< typename K >
+  size_type count_multi(const K& key) const
+  {
+    entry_iterator first = find_rank(key, key_hash(key), 0u);
+    return (first != entry_table::cend()) ? first->count() : 0u;
+  }
+
+  template< typename K >
+  bool contains(const K& key) const
+  {
+    return find_rank(key, key_hash(key), 0u) != entry_table::cend();
+  }
+
+  // first item of key
+  template< typename K >
+  iterator find(const K& key)
+  {
+    return iterator(find_rank(key, key_hash(key), 0u));
+  }
+  template< typename K >
+  const_iterator find(const K& key) const
+  {
+    return const_iterator(find_rank(key, key_hash(key), 0u));
+  }
+
+  template< typename K >
+  std::pair<equal_iterator, equal_iterator> equal_range(const K& key)
+  {
+    std::size_t hash = key_hash(key);
+    entry_iterator first = find_rank(key, hash, 0u);
+    if (first == entry_table::cend())
+      return { equal_iterator(), equal_iterator() };
+    return { equal_iterator(&mTable, first, hash), equal_iterator() };
+  }
+  template< typename K >
+  std::pair<const_equal_iterator, const_equal_iterator> equal_range(const K& key) const
+  {
+    std::size_t hash = key_hash(key);
+    entry_iterator first = find_rank(key, hash, 0u);
+    if (first == entry_table::cend())
+      return { const_equal_iterator(), const_equal_iterator() };
+    return { const_equal_iterator(&mTable, first, hash), const_equal_iterator() };
+  }
+
+  // Modifiers
+  void clear() noexcept
+  {
+    mTable.clear();
+  }
+
+  template< typename U >
+  iterator insert_multi(U&& value)
+  {
+    return emplace_multi(std::forward<U>(value));
+  }
+
+  template< class... Args >
+  iterator emplace_multi(Args&&... args)
+  {
+    return insert_item(item_type(std::forward<Args>(args)...));
+  }
+
+  // The last item of key (if any) is moved into the erased slot, returned if not visited yet (keeps ranks dense)
+  iterator erase_(const_iterator pos)
+  {
+    INDIVI_UTABLE_ASSERT(pos.mIt != entry_table::cend());
+    entry_iterator it = pos.mIt;
+    entry_type& item = const_cast<entry_type&>(*it);
+    const Key& key = multi_key<Key>::item_key(item.value);
+    std::size_t hash = key_hash(key);
+    uint32_t rank = item.rank();
+    entry_iterator first = rank ? find_rank(key, hash, 0u) : it;
+    uint32_t lastRank = first->count() - 1u;
+    const_cast<entry_type&>(*first).link = HEAD | lastRank;
+    if (rank == lastRank)
+      return iterator(mTable.erase_(it));
+
+    entry_iterator last = find_rank(key, hash, lastRank);
+    item.value = std::move(const_cast<entry_type&>(*last).value);
+    bool visited = std::addressof(*last) > std::addressof(*it); // table iterators go downward
+    mTable.erase(last);
+    iterator next(it);
+    return visited ? ++next : next;
+  }
+
+  void erase(const_iterator pos)
+  {
+    erase_(pos);
+  }
+
+  // all items of key
+  template< typename K >
+  size_type erase_multi(const K& key)
+  {
+    std::size_t hash = key_hash(key);
+    entry_iterator first = find_rank(key, hash, 0u);
+    if (first == entry_table::cend())
+      return 0u;
+
+    uint32_t count = first->count();
+    for (uint32_t rank = count - 1u; rank > 0u; --rank)
+      mTable.erase(find_rank(key, hash, rank));
+    mTable.erase(multi_ref<K>{ key, hash, 0u }); // by key (auto downsizing)
+    return count;
+  }
+
+  void swap(flat_umultitable& other) noexcept(noexcept(mTable.swap(other.mTable)))
+  {
+    mTable.swap(other.mTable);
+  }
+
+  // Same items, with the same number of occurrences
+  bool equal_multi(const flat_umultitable& other) const
+  {
+    if (size() != other.size())
+      return false;
+
+    auto end_ = entry_table::cend();
+    for (auto it = mTable.cbegin(); it != end_; ++it)
+    {
+      if (it->rank()) // by key, from first item
+        continue;
+      const Key& key = multi_key<Key>::item_key(it->value);
+      std::size_t hash = key_hash(key);
+      std::size_t otherHash = other.key_hash(key);
+      entry_iterator oit = other.find_rank(key, otherHash, 0u);
+      if (oit == end_ || oit->count() != it->count()
+          || !same_items(other, key, hash, otherHash, it->count(), std::is_same<Key, item_type>{}))
+        return false;
+    }
+    return true;
+  }
+
+  // No auto downsizing (as erasing by iterator)
+  template< class Pred >
+  size_type erase_if(Pred& pred)
+  {
+    size_type oldSize = size();
+    for (iterator it = begin(); it != end();)
+    {
+      if (pred(*it))
+        it = erase_(it);
+      else
+        ++it;
+    }
+    return oldSize - size();
+  }
+
+#ifdef INDIVI_FLAT_U_DEBUG
+  bool is_cleared() const noexcept { return mTable.is_cleared(); }
+#endif
+#ifdef INDIVI_FLAT_U_STATS
+  using GroupStats = typename entry_table::GroupStats;
+  using FindStats = typename entry_table::FindStats;
+
+  GroupStats get_group_stats() const noexcept { return mTable.get_group_stats(); }
+  FindStats get_find_stats() const noexcept { return mTable.get_find_stats(); }
+  void reset_find_stats() noexcept { mTable.reset_find_stats(); }
+#endif
+#ifdef INDIVI_FLAT_U_TELEMETRY
+  flat_telemetry get_telemetry() const noexcept { return mTable.get_telemetry(); }
+  void reset_telemetry() noexcept { mTable.reset_telemetry(); }
+#endif
+
+private:
+  template< typename K >
+  std::size_t key_hash(const K& key) const
+  {
+    return mTable.hash_function().key_hash(key);
+  }
+
+  template< typename K >
+  entry_iterator find_rank(const K& key, std::size_t hash, uint32_t rank) const
+  {
+    return mTable.find(multi_ref<K>{ key, hash, rank });
+  }
+
+  iterator insert_item(item_type&& value)
+  {
+    const Key& key = multi_key<Key>::item_key(value);
+    std::size_t hash = key_hash(key);
+    entry_iterator first = find_rank(key, hash, 0u);
+    if (first == entry_table::cend())
+      return iterator(mTable.insert(entry_type(HEAD | 1u, std::move(value))).first);
+
+    uint32_t count = first->count();
+    if (count == entry_type::MAX_COUNT)
+      throw std::length_error("flat_umultitable: too many items with equivalent key");
+
+    size_type bucketCount = mTable.bucket_count();
+    entry_iterator it = mTable.insert(entry_type(count, std::move(value))).first;
+    if (mTable.bucket_count() != bucketCount) // rehashed
+      first = find_rank(multi_key<Key>::item_key(it->value), hash, 0u);
+    const_cast<entry_type&>(*first).link = HEAD | (count + 1u);
+    return iterator(it);
+  }
+
+  // Items of a key in both tables are a permutation of each other (multimap)
+  bool same_items(const flat_umultitable& other, const Key& key, std::size_t hash, std::size_t otherHash,
+                  uint32_t count, std::false_type /*isSet*/) const
+  {
+    std::vector<const item_type*> items, otherItems;
+    items.reserve(count);
+    otherItems.reserve(count);
+    for (uint32_t rank = 0u; rank < count; ++rank)
+    {
+      items.push_back(std::addressof(find_rank(key, hash, rank)->value));
+      otherItems.push_back(std::addressof(other.find_rank(key, otherHash, rank)->value));
+    }
+    return std::is_permutation(items.begin(), items.end(), otherItems.begin(),
+                               [](const item_type* lhs, const item_type* rhs) { return *lhs == *rhs; });
+  }
+
+  // Equivalent keys (multiset)
+  bool same_items(const flat_umultitable&, const Key&, std::size_t, std::size_t, uint32_t, std::true_type /*isSet*/) const
+  {
+    return true;
+  }
+};
+
+} // namespace detail
+} // namespace indivi
+
+#endif // INDIVI_FLAT_UMULTITABLE_H
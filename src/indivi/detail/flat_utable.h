@@ -9,12 +9,17 @@
 #include "indivi/hash.h"
 #include "indivi/detail/indivi_defines.h"
 #include "indivi/detail/indivi_utils.h"
+#include "indivi/detail/indivi_parallel.h"
+#include "indivi/detail/flat_node.h"
+#include "indivi/detail/flat_snapshot.h"
+#include "indivi/detail/flat_telemetry.h"
 
 #include <algorithm>
 #include <initializer_list>
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <new>
 #include <stdexcept>
 #include <tuple>
 #include <type_traits>
@@ -275,8 +280,29 @@ struct alignas(32) MetaGroup // actually aligned/init manually, see NewStorage
   }
 };
 
+/*
+ * Inline storage of a single group table (see `flat_utable` 'InlineN'), empty if 'Capa' is 0.
+ */
+template< class Storage, std::size_t Capa >
+struct flat_uinline
+{
+  Storage buffer[Capa];
+
+  Storage* inline_data() noexcept { return buffer; }
+  const Storage* inline_data() const noexcept { return buffer; }
+};
+
+template< class Storage >
+struct flat_uinline<Storage, 0u>
+{
+  Storage* inline_data() noexcept { return nullptr; }
+  const Storage* inline_data() const noexcept { return nullptr; }
+};
+
 /*
  * Underlying class of `flat_umap` and `flat_uset`.
+ * With 'InlineN' > 0, a single group storage of up to 'InlineN' entries (rounded up to a power of 2) is kept inside the object:
+ * heap storage is only allocated when growing past it (and released when shrinking back).
  */
 template<
   class Key,
@@ -285,7 +311,9 @@ template<
   class item_type,
   class size_type,
   class Hash,
-  class KeyEqual >
+  class KeyEqual,
+  class Allocator,
+  std::size_t InlineN = 0u >
 class flat_utable
 {
 public:
@@ -294,25 +322,48 @@ public:
   using difference_type = typename std::make_signed<size_type>::type;
   using hasher = Hash;
   using key_equal = KeyEqual;
+  using allocator_type = Allocator;
   using iter_reference = typename std::conditional<std::is_same<key_type, value_type>::value, const key_type&, value_type&>::type;
   using iter_const_reference = const value_type&; // for flat_uset, iter_reference is also const
   using iter_pointer = value_type*;
   using iter_const_pointer = const value_type*;
+  using node_type = flat_node<Key, T, value_type, item_type, Hash>;
 
 private:
   using init_type = item_type;
   using insert_type = std::pair<typename std::remove_const<Key>::type, const mapped_type>;
   using storage_type = typename std::aligned_storage<sizeof(item_type), alignof(item_type)>::type;
-  using mixer = typename std::conditional<hash_is_avalanching<Hash>::value, no_mix, bit_mix>::type;
-
-  static constexpr float MAX_LOAD_FACTOR{ 0.875f };
+  using storage_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<storage_type>;
+  using storage_traits = std::allocator_traits<storage_allocator>;
+  using mixer = hash_mixer<Hash>;
+  using stored_type = typename std::conditional<hash_is_32bits<Hash>::value, uint32_t, std::size_t>::type; // see `hashes_of`
+
+  static constexpr float MAX_LOAD_FACTOR{ 0.875f };      // default (see `max_load_factor(float)`)
+  static constexpr float MAX_LOAD_FACTOR_LOW{ 0.25f };   // runtime setting range
+  static constexpr float MAX_LOAD_FACTOR_HIGH{ 0.95f };  // (always keep empty slots for probing to stop)
+  static constexpr unsigned int MAX_GROWTH_SHIFT{ 8u };  // i.e. growth factor up to 256
+  static constexpr float MIN_LOAD_FACTOR_HIGH{ 0.25f };  // max of runtime setting (see `min_load_factor(float)`)
   static constexpr unsigned int MIN_CAPA{ 2u };
+  static constexpr unsigned int BATCH_SIZE{ 16u }; // number of interleaved probes in batched lookup
+  static constexpr bool BATCH_HASH{ hash_has_batch<Hash, Key>::value }; // hasher provides batched hashing
+  static constexpr unsigned int PARALLEL_MIN_PART{ 1u << 15 }; // min number of entries per thread in parallel rehash
+  static constexpr bool STORED_HASH{ hash_is_stored<Hash>::value }; // full hashes stored after groups
+  static constexpr bool SHARED_HASH{ std::is_empty<Hash>::value }; // stateless hasher, same hashes in all tables (see `flat_node`)
+  static constexpr unsigned int INLINE_CAPA{ InlineN == 0u ? 0u : InlineN <= MIN_CAPA ? MIN_CAPA : InlineN <= 4u ? 4u : InlineN <= 8u ? 8u : 16u };
+  static constexpr unsigned int FIRST_CAPA{ INLINE_CAPA ? INLINE_CAPA : MIN_CAPA }; // smallest storage (always inline if any)
+  static constexpr std::size_t INLINE_STORAGE{ INLINE_CAPA ? INLINE_CAPA + (sizeof(MetaGroup) + 31u // see `NewStorage::storageCapa`
+    + (STORED_HASH ? sizeof(stored_type) * INLINE_CAPA : 0u) + sizeof(item_type) - 1u) / sizeof(item_type) : 0u };
 
   static constexpr bool is_pow2(std::size_t v)  noexcept { return (v & (v - 1)) == 0u; }
 
   static_assert(MAX_LOAD_FACTOR > 0.f && MAX_LOAD_FACTOR <= 1.f, "flat_utable: MAX_LOAD_FACTOR must be > 0 and <= 1");
+  static_assert(MAX_LOAD_FACTOR_LOW <= MAX_LOAD_FACTOR && MAX_LOAD_FACTOR <= MAX_LOAD_FACTOR_HIGH && MAX_LOAD_FACTOR_HIGH < 1.f,
+                "flat_utable: MAX_LOAD_FACTOR must be in runtime range, and range < 1");
   static_assert(MIN_CAPA >= 2u, "flat_utable: MIN_CAPA must be >= 2");
   static_assert(is_pow2(MIN_CAPA), "flat_utable: MIN_CAPA must be a power of 2");
+  static_assert(InlineN <= 16u, "flat_utable: InlineN must be <= 16 (single group)");
+  static_assert(InlineN == 0u || std::is_nothrow_move_constructible<item_type>::value,
+                "flat_utable: inline storage requires nothrow move constructible items");
 
 #ifdef INDIVI_FLAT_U_STATS
   struct MFindStats
@@ -330,6 +381,9 @@ private:
   };
   mutable MFindStats mStats;
 #endif
+#ifdef INDIVI_FLAT_U_TELEMETRY
+  flat_telemetry_counters mTelemetry; // see `get_telemetry()`
+#endif
 
   struct Location
   {
@@ -352,18 +406,20 @@ private:
     Hash&& hash_move() noexcept { return std::move(hash()); }
   };
 
-  struct Values : KeyEqual // empty base optim
+  struct Values : KeyEqual, storage_allocator, flat_uinline<storage_type, INLINE_STORAGE> // empty base optim
   {
     item_type* data = nullptr;
 
-    Values(const KeyEqual& equal) : KeyEqual(equal) {}
-    Values(const Values& values) : KeyEqual(values) {}
-    Values(Values&& values) noexcept(std::is_nothrow_move_constructible<KeyEqual>::value)
-      : KeyEqual(std::move(values.equal_move())), data(values.data) {}
+    Values(const KeyEqual& equal, const storage_allocator& alloc) : KeyEqual(equal), storage_allocator(alloc) {}
+    Values(Values&& values) noexcept(std::is_nothrow_move_constructible<KeyEqual>::value
+                                     && std::is_nothrow_move_constructible<storage_allocator>::value)
+      : KeyEqual(std::move(values.equal_move())), storage_allocator(std::move(values.alloc())), data(values.data) {}
 
     KeyEqual& equal() noexcept { return *this; }
     const KeyEqual& equal() const noexcept { return *this; }
     KeyEqual&& equal_move() noexcept { return std::move(equal()); }
+    storage_allocator& alloc() noexcept { return *this; }
+    const storage_allocator& alloc() const noexcept { return *this; }
 
     value_type* cdata() const noexcept { return reinterpret_cast<value_type*>(data); }
   };
@@ -373,14 +429,30 @@ private:
   size_type mShift   = 0u;  // hash shift to keep highest bits (as group index)
   size_type mGMask   = 0u;  // group index mask (as power-of-2 capacity - 1)
   size_type mMaxSize = 0u;  // max size before rehash is needed
+  float mMaxLoadFactor = MAX_LOAD_FACTOR;
+  uint8_t mGrowthShift = 1u;      // log2 of growth factor
+  uint16_t mMinLoad = 0u;         // min load factor (in 1/65536), 0 if auto downsizing is disabled
   Groups mGroups;           // contains hash fragments and metadata (processed as 16-bytes groups)
-  Values mValues;           // contains key-mapped pairs (matching mGroups entries)
+  Values mValues;           // contains key-mapped pairs (matching mGroups entries), and inline storage if any
+
+  // Storage cannot be stolen if inline (items moved one by one, see `take_inline`)
+  bool is_inline() const noexcept
+  {
+    return INLINE_CAPA && mValues.data == reinterpret_cast<const item_type*>(mValues.inline_data());
+  }
+  // Inline storage for a new storage of 'capa' entries, if it fits and is not the current one
+  storage_type* inline_for(size_type capa) noexcept
+  {
+    return (capa == INLINE_CAPA && !is_inline()) ? mValues.inline_data() : nullptr;
+  }
 
   size_type group_capa() const noexcept { return mValues.data ? mGMask + 1u : 0u; }
   Hash& hash() noexcept { return mGroups.hash(); }
   const Hash& hash() const noexcept { return mGroups.hash(); }
   KeyEqual& equal() noexcept { return mValues.equal(); }
   const KeyEqual& equal() const noexcept { return mValues.equal(); }
+  storage_allocator& alloc() noexcept { return mValues.alloc(); }
+  const storage_allocator& alloc() const noexcept { return mValues.alloc(); }
 
 public:
   template <typename Pointer, typename Reference>
@@ -483,20 +555,40 @@ public:
   using iterator = Iterator<iter_pointer, iter_reference>;
   using const_iterator = Iterator<iter_const_pointer, iter_const_reference>;
 
+  struct insert_return_type
+  {
+    iterator position;
+    bool inserted;
+    node_type node;
+  };
+
+private:
+  // Heterogeneous lookup (if both Hash and KeyEqual define 'is_transparent')
+  template< class K, class R >
+  using if_transparent = typename std::enable_if<traits::are_transparent<K, Hash, KeyEqual>::value, R>::type;
+  // Same, excluding keys and iterators (for overloads taking a forwarding reference)
+  template< class K, class R >
+  using if_transparent_key = typename std::enable_if<
+    traits::are_transparent<K, Hash, KeyEqual>::value && !traits::is_similar<K, Key>::value
+      && !std::is_convertible<K, iterator>::value && !std::is_convertible<K, const_iterator>::value, R>::type;
+
+public:
   // Ctr/Dtr
   flat_utable() : flat_utable(0)
   {}
 
-  explicit flat_utable(size_type bucket_count, const Hash& hash = Hash(), const key_equal& equal = key_equal())
+  explicit flat_utable(size_type bucket_count, const Hash& hash = Hash(), const key_equal& equal = key_equal(),
+                       const allocator_type& alloc = allocator_type())
     : mGroups(hash)
-    , mValues(equal)
+    , mValues(equal, storage_allocator(alloc))
   {
     rehash(bucket_count);
   }
 
   template< class InputIt >
-  flat_utable(InputIt first, InputIt last, size_type bucket_count = 0, const Hash& hash = Hash(), const key_equal& equal = key_equal())
-    : flat_utable(bucket_count, hash, equal)
+  flat_utable(InputIt first, InputIt last, size_type bucket_count = 0, const Hash& hash = Hash(), const key_equal& equal = key_equal(),
+              const allocator_type& alloc = allocator_type())
+    : flat_utable(bucket_count, hash, equal, alloc)
   {
     try {
       insert(first, last);
@@ -507,13 +599,21 @@ public:
     }
   }
 
-  flat_utable(const std::initializer_list<value_type>& init, size_type bucket_count = 0, const Hash& hash = Hash(), const key_equal& equal = key_equal())
-    : flat_utable(init.begin(), init.end(), bucket_count, hash, equal)
+  flat_utable(const std::initializer_list<value_type>& init, size_type bucket_count = 0, const Hash& hash = Hash(), const key_equal& equal = key_equal(),
+              const allocator_type& alloc = allocator_type())
+    : flat_utable(init.begin(), init.end(), bucket_count, hash, equal, alloc)
   {}
 
   flat_utable(const flat_utable& other)
-    : mGroups(other.mGroups)
-    , mValues(other.mValues)
+    : flat_utable(other, allocator_type(storage_traits::select_on_container_copy_construction(other.alloc())))
+  {}
+
+  flat_utable(const flat_utable& other, const allocator_type& alloc)
+    : mMaxLoadFactor(other.mMaxLoadFactor)
+    , mGrowthShift(other.mGrowthShift)
+    , mMinLoad(other.mMinLoad)
+    , mGroups(other.mGroups)
+    , mValues(other.equal(), storage_allocator(alloc))
   {
     copy_content(other);
   }
@@ -524,9 +624,18 @@ public:
     , mShift(other.mShift)
     , mGMask(other.mGMask)
     , mMaxSize(other.mMaxSize)
+    , mMaxLoadFactor(other.mMaxLoadFactor)
+    , mGrowthShift(other.mGrowthShift)
+    , mMinLoad(other.mMinLoad)
     , mGroups(std::move(other.mGroups))
     , mValues(std::move(other.mValues))
   {
+    if (other.is_inline())
+    {
+      mValues.data = nullptr;
+      take_inline(other);
+      return;
+    }
     other.mSize = 0u;
     other.mShift = 0u;
     other.mGMask = 0u;
@@ -535,6 +644,16 @@ public:
     other.mValues.data = nullptr;
   }
 
+  flat_utable(flat_utable&& other, const allocator_type& alloc)
+    : flat_utable(0, other.hash(), other.equal(), alloc)
+  {
+    copy_policy(other);
+    if (this->alloc() == other.alloc())
+      swap_content(other);
+    else
+      move_content(other);
+  }
+
   ~flat_utable()
   {
     destroy();
@@ -546,18 +665,32 @@ public:
     if (this != std::addressof(other))
     {
       clear();
+      copy_assign_alloc(other);
 
       hash()  = other.hash();
       equal() = other.equal(); // if this throws, state might be inconsistent
 
+      copy_policy(other);
       copy_content(other);
     }
   }
 
-  void operator=(flat_utable&& other) noexcept(std::is_nothrow_move_assignable<Hash>::value && std::is_nothrow_move_assignable<KeyEqual>::value)
+  void operator=(flat_utable&& other) noexcept(std::is_nothrow_move_assignable<Hash>::value && std::is_nothrow_move_assignable<KeyEqual>::value
+                                               && storage_traits::propagate_on_container_move_assignment::value
+                                               && std::is_nothrow_move_assignable<storage_allocator>::value)
   {
     if (this != std::addressof(other))
     {
+      if (!storage_traits::propagate_on_container_move_assignment::value && alloc() != other.alloc())
+      {
+        // cannot steal storage: move items one by one
+        clear();
+        hash()  = std::move(other.hash());
+        equal() = std::move(other.equal()); // if this throws, state might be inconsistent
+        copy_policy(other);
+        move_content(other);
+        return;
+      }
       destroy();
       mSize = 0u;
       mShift = 0u;
@@ -568,6 +701,13 @@ public:
 
       hash()  = std::move(other.hash());
       equal() = std::move(other.equal()); // if this throws, state might be inconsistent
+      move_assign_alloc(other);
+      copy_policy(other);
+      if (other.is_inline())
+      {
+        take_inline(other);
+        return;
+      }
 
       mSize = other.mSize;
       mShift = other.mShift;
@@ -599,26 +739,58 @@ public:
   size_type max_size() const noexcept { return (size_type)(max_bucket_count() * max_load_factor()); }
 
   // Bucket interface
-  size_type bucket_count() const noexcept { return (mMaxSize > 16u) ? (mGMask + 1u) * 16 : mMaxSize; }
+  size_type bucket_count() const noexcept { return mGMask ? (mGMask + 1u) * 16 : mMaxSize; }
   size_type max_bucket_count() const noexcept { return (size_type)std::numeric_limits<difference_type>::max(); }
 
   // Hash policy
   float load_factor() const noexcept { return mSize ? (float)mSize / bucket_count() : mSize; }
-  float max_load_factor() const noexcept { return MAX_LOAD_FACTOR; }
-  void max_load_factor(float) noexcept { /*for compatibility*/ }
+  float max_load_factor() const noexcept { return mMaxLoadFactor; }
+  // Clamped to [0.25, 0.95], rehash if size exceeds new threshold (applies from 32 buckets, single group is always filled)
+  void max_load_factor(float ml)
+  {
+    mMaxLoadFactor = (ml < MAX_LOAD_FACTOR_LOW) ? MAX_LOAD_FACTOR_LOW : (ml > MAX_LOAD_FACTOR_HIGH) ? MAX_LOAD_FACTOR_HIGH : ml;
+    if (mGMask)
+    {
+      mMaxSize = capa_to_maxsize(bucket_count(), mMaxLoadFactor);
+      if (mSize > mMaxSize)
+        rehash(0u);
+    }
+  }
+  // non-standard, capacity multiplier when full (power of 2, default 2)
+  size_type growth_factor() const noexcept { return size_type(1u) << mGrowthShift; }
+  // Rounded up to a power of 2, clamped to [2, 256]
+  void growth_factor(size_type factor) noexcept
+  {
+    mGrowthShift = 1u;
+    while (mGrowthShift < MAX_GROWTH_SHIFT && (size_type(1u) << mGrowthShift) < factor)
+      ++mGrowthShift;
+  }
+  // non-standard, auto downsizing threshold (0 if disabled, default)
+  float min_load_factor() const noexcept { return (float)mMinLoad / 65536.f; }
+  // Clamped to [0, 0.25], applied by next erase by key (see `erase(const Key&)`)
+  void min_load_factor(float ml) noexcept
+  {
+    ml = !(ml > 0.f) ? 0.f : (ml > MIN_LOAD_FACTOR_HIGH) ? MIN_LOAD_FACTOR_HIGH : ml;
+    mMinLoad = (uint16_t)std::ceil(ml * 65536.f);
+  }
+  // non-standard, size at which next insertion triggers a rehash
+  size_type rehash_threshold() const noexcept { return mMaxSize; }
 
-  void rehash(size_type count)
+  // non-standard 'threadCount': move elements on up to 'threadCount' threads (large tables with nothrow move-constructible items only)
+  // in this case, hasher must not throw and be safe to call concurrently
+  void rehash(size_type count, unsigned int threadCount = 1u)
   {
     INDIVI_UTABLE_ASSERT(count <= max_size());
-    size_type minCapa = (size_type)std::ceil((float)size() / max_load_factor());
+    size_type minCapa = (size() <= INLINE_CAPA) ? size() // single group inline storage can be filled
+                                                 : (size_type)std::ceil((float)size() / max_load_factor());
     count = std::max(count, minCapa);
     if (count)
     {
-      count = std::max(count, (size_type)MIN_CAPA);
+      count = std::max(count, (size_type)FIRST_CAPA);
       count = std::min(count, max_bucket_count());
       count = round_up_pow2(count);
       if (count != bucket_count())
-        rehash_impl(count);
+        rehash_impl(count, threadCount);
     }
     else
     {
@@ -632,16 +804,20 @@ public:
     }
   }
 
-  void reserve(size_type count)
+  // non-standard, same as `rehash(0)`: smallest capacity for current size (free storage if empty)
+  void shrink_to_fit(unsigned int threadCount = 1u) { rehash(0u, threadCount); }
+
+  void reserve(size_type count, unsigned int threadCount = 1u)
   {
     INDIVI_UTABLE_ASSERT(count <= max_size());
     size_type bucketCount = (count > 16) ? (size_type)std::ceil((float)count / max_load_factor()) : count;
-    rehash(bucketCount);
+    rehash(bucketCount, threadCount);
   }
 
   // Obervers
   hasher hash_function() const { return hash(); }
   key_equal key_eq() const { return equal(); }
+  allocator_type get_allocator() const noexcept { return allocator_type(alloc()); }
 
   // Lookup
   mapped_type& at(const Key& key)
@@ -666,6 +842,30 @@ public:
   
     return loc.value->second;
   }
+  template< class K >
+  if_transparent<K, mapped_type&> at(const K& key)
+  {
+    std::size_t hash = get_hash(key);
+    size_type gIndex = hash_position(hash, mShift, mGMask);
+
+    Location loc = find_impl(hash, gIndex, key);
+    if (!loc.value)
+      throw std::out_of_range("flat_utable::at");
+  
+    return loc.value->second;
+  }
+  template< class K >
+  if_transparent<K, const mapped_type&> at(const K& key) const
+  {
+    std::size_t hash = get_hash(key);
+    size_type gIndex = hash_position(hash, mShift, mGMask);
+
+    Location loc = find_impl(hash, gIndex, key);
+    if (!loc.value)
+      throw std::out_of_range("flat_utable::at");
+  
+    return loc.value->second;
+  }
 
   mapped_type& operator[](const Key& key)
   {
@@ -680,6 +880,11 @@ public:
   {
     return contains(key);
   }
+  template< class K >
+  if_transparent<K, size_type> count(const K& key) const
+  {
+    return contains(key);
+  }
 
   bool contains(const Key& key) const
   {
@@ -689,6 +894,15 @@ public:
     Location loc = find_impl(hash, gIndex, key);
     return loc.value != nullptr;
   }
+  template< class K >
+  if_transparent<K, bool> contains(const K& key) const
+  {
+    std::size_t hash = get_hash(key);
+    size_type gIndex = hash_position(hash, mShift, mGMask);
+
+    Location loc = find_impl(hash, gIndex, key);
+    return loc.value != nullptr;
+  }
 
   iterator find(const Key& key)
   {
@@ -706,6 +920,45 @@ public:
     Location loc = find_impl(hash, gIndex, key);
     return { loc.subIndex, loc.group, mGroups.data, loc.value };
   }
+  template< class K >
+  if_transparent<K, iterator> find(const K& key)
+  {
+    std::size_t hash = get_hash(key);
+    size_type gIndex = hash_position(hash, mShift, mGMask);
+
+    Location loc = find_impl(hash, gIndex, key);
+    return { loc.subIndex, loc.group, mGroups.data, loc.value };
+  }
+  template< class K >
+  if_transparent<K, const_iterator> find(const K& key) const
+  {
+    std::size_t hash = get_hash(key);
+    size_type gIndex = hash_position(hash, mShift, mGMask);
+
+    Location loc = find_impl(hash, gIndex, key);
+    return { loc.subIndex, loc.group, mGroups.data, loc.value };
+  }
+
+  // non-standard, batched lookup (interleave probes to hide cache misses)
+  void find_batch(const Key* keys, size_type count, iterator* out)
+  {
+    find_batch_impl(keys, count, [&](size_type i, const Location& loc) {
+      out[i] = iterator(loc.subIndex, loc.group, mGroups.data, loc.value);
+    });
+  }
+  void find_batch(const Key* keys, size_type count, const_iterator* out) const
+  {
+    find_batch_impl(keys, count, [&](size_type i, const Location& loc) {
+      out[i] = const_iterator(loc.subIndex, loc.group, mGroups.data, loc.value);
+    });
+  }
+
+  void contains_batch(const Key* keys, size_type count, bool* out) const
+  {
+    find_batch_impl(keys, count, [&](size_type i, const Location& loc) {
+      out[i] = loc.value != nullptr;
+    });
+  }
 
   // Modifiers
   void clear() noexcept
@@ -739,6 +992,49 @@ public:
       emplace(*first);
   }
 
+  // non-standard, bulk insertion of elements with unique keys (unchecked: keys must not be in table nor duplicated in range)
+  // pre-size exactly, then hash keys by batch and prefetch their target before inserting (i.e. interleaved memory accesses)
+  template< class ForwardIt >
+  void insert_unique_range(ForwardIt first, ForwardIt last)
+  {
+    using iter_value = typename std::iterator_traits<ForwardIt>::value_type;
+    using iter_category = typename std::iterator_traits<ForwardIt>::iterator_category;
+    static_assert(std::is_base_of<std::forward_iterator_tag, iter_category>::value,
+                  "flat_utable: insert_unique_range requires forward iterators");
+    static_assert(std::is_same<iter_value, value_type>::value || std::is_same<iter_value, item_type>::value,
+                  "flat_utable: insert_unique_range requires value_type elements");
+
+    size_type count = (size_type)std::distance(first, last);
+    if (count == 0u)
+      return;
+    if (mSize + count > mMaxSize) // only grow (keep reserved capacity)
+      reserve(mSize + count);
+
+    // contiguous keys (i.e. set from pointers) hashed by hasher batch, if provided
+    using batch_keys = std::integral_constant<bool, BATCH_HASH && std::is_pointer<ForwardIt>::value && std::is_same<iter_value, Key>::value>;
+    std::size_t hashes[BATCH_SIZE];
+    size_type remaining = count;
+    while (remaining)
+    {
+      // hash a batch and prefetch targets
+      size_type batchSize = std::min(remaining, (size_type)BATCH_SIZE);
+      remaining -= batchSize;
+      hash_items(first, batchSize, hashes, batch_keys{});
+      for (size_type i = 0u; i < batchSize; ++i)
+      {
+        size_type gIndex = hash_position(hashes[i], mShift, mGMask);
+        INDIVI_PREFETCH(&mGroups.data[gIndex]);
+        INDIVI_PREFETCH(&mValues.data[gIndex * 16]);
+      }
+      // insert without duplicate check (targets should be in flight by now)
+      for (size_type i = 0u; i < batchSize; ++i, ++first)
+      {
+        INDIVI_UTABLE_ASSERT(!find_impl(hashes[i], hash_position(hashes[i], mShift, mGMask), get_key(*first)).value);
+        insert_unique(mGroups.data, mValues.data, mShift, mGMask, hashes[i], *first);
+        ++mSize;
+      }
+    }
+  }
   template <typename U>
   typename std::enable_if<
     std::is_same<U, value_type>::value || std::is_same<U, item_type>::value,
@@ -787,6 +1083,13 @@ public:
     return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
   }
 
+  // key is only constructed if not found
+  template< class K, class... Args >
+  if_transparent_key<K, std::pair<iterator, bool>> try_emplace(K&& key, Args&&... args)
+  {
+    return try_emplace_impl(std::forward<K>(key), std::forward<Args>(args)...);
+  }
+
   iterator erase_(iterator pos)
   {
     INDIVI_UTABLE_ASSERT(is_dereferenceable(pos));
@@ -814,7 +1117,7 @@ public:
   void erase(const_iterator pos)
   {
     INDIVI_UTABLE_ASSERT(is_dereferenceable(pos));
-    erase_impl(reinterpret_cast<item_type*>(pos.mValue), pos.mGroup, pos.mSubIndex);
+    erase_impl(reinterpret_cast<item_type*>(pos.mValue), const_cast<MetaGroup*>(pos.mGroup), pos.mSubIndex);
   }
 
   size_type erase(const Key& key)
@@ -826,18 +1129,247 @@ public:
     if (loc.value)
     {
       erase_impl(gIndex, hash, loc);
+      shrink_on_erase();
       return 1u;
     }
     return 0u;
   }
+  template< class K >
+  if_transparent_key<K, size_type> erase(K&& key)
+  {
+    std::size_t hash = get_hash(key);
+    size_type gIndex = hash_position(hash, mShift, mGMask);
+
+    Location loc = find_impl(hash, gIndex, key);
+    if (loc.value)
+    {
+      erase_impl(gIndex, hash, loc);
+      shrink_on_erase();
+      return 1u;
+    }
+    return 0u;
+  }
+
+  // Node handle
+  node_type extract(const_iterator pos)
+  {
+    INDIVI_UTABLE_ASSERT(is_dereferenceable(pos));
+    item_type* pValue = const_cast<item_type*>(reinterpret_cast<const item_type*>(pos.mValue));
+
+    node_type node(typename node_type::from_table(), item_hash(pValue), std::move(*pValue));
+    erase_impl(pValue, const_cast<MetaGroup*>(pos.mGroup), pos.mSubIndex);
+    return node;
+  }
+
+  node_type extract(const Key& key)
+  {
+    std::size_t hash = get_hash(key);
+    size_type gIndex = hash_position(hash, mShift, mGMask);
+
+    Location loc = find_impl(hash, gIndex, key);
+    if (!loc.value)
+      return node_type();
+
+    node_type node(typename node_type::from_table(), hash, std::move(*loc.value));
+    erase_impl(gIndex, hash, loc);
+    return node;
+  }
+
+  insert_return_type insert(node_type&& node)
+  {
+    if (node.empty())
+      return { end(), false, node_type() };
+
+    std::size_t hash = (SHARED_HASH && node.hashed()) ? node.hash() : get_hash(get_key(node.item()));
+    std::pair<iterator, bool> res = insert_hashed(hash, std::move(node.item()));
+    if (!res.second) // already exist
+      return { res.first, false, std::move(node) };
+
+    node.reset();
+    return { res.first, true, node_type() };
+  }
+
+  // Move elements from 'source' (same table type), except those with a key already present
+  // Hashes are reused with a stateless hasher (otherwise computed once per element)
+  void merge(flat_utable& source)
+  {
+    if (&source == this || source.mSize == 0u)
+      return;
+
+    if (mSize == 0u && bucket_count() <= source.bucket_count()
+        && SHARED_HASH && std::is_empty<key_equal>::value && alloc() == source.alloc())
+    {
+      take_all(source);
+      return;
+    }
+
+    source.uc_for_each([&](item_type* pValue) {
+      std::size_t hash = SHARED_HASH ? source.item_hash(pValue) : get_hash(get_key(*pValue));
+      if (insert_hashed(hash, std::move(*pValue)).second) // only moved if inserted
+      {
+        size_type index = (size_type)(pValue - source.mValues.data);
+        source.erase_impl(pValue, &source.mGroups.data[index / 16], (int)(index % 16));
+      }
+    });
+  }
+
+  // Snapshot (trivially copyable items only, see 'flat_mapped.h')
+  // Write header and storage in native layout (unused value slots zeroed)
+  void save_snapshot(std::ostream& out) const
+  {
+    static_assert(is_snapshot_safe<item_type>::value, "flat_utable: snapshot requires trivially copyable Key and T");
+    static_assert(alignof(item_type) <= snapshot_header::BLOCK_ALIGN, "flat_utable: snapshot requires item alignment <= 64");
+
+    snapshot_header header;
+    header.init(snapshot_layout(), sizeof(item_type), alignof(item_type));
+    header.size = mSize;
+    header.shift = mShift;
+    header.gMask = mGMask;
+    header.maxSize = mMaxSize;
+    header.fingerprint = snapshot_fingerprint();
+    header.blockBytes = mValues.data ? snapshot_block_bytes(bucket_count(), mGMask + 1u) : 0u;
+
+    snapshot_writer writer(out);
+    writer.write(&header, sizeof(header));
+    writer.pad_to(snapshot_header::BLOCK_OFFSET);
+    if (!mValues.data)
+      return;
+
+    size_type capa = bucket_count();
+    size_type gCapa = mGMask + 1u;
+    size_type next = 0u;
+    uc_for_each([&](item_type* pValue) {
+      size_type index = (size_type)(pValue - mValues.data);
+      writer.zeros(sizeof(item_type) * (index - next));
+      writer.write(pValue, sizeof(item_type));
+      next = index + 1u;
+    });
+    writer.zeros(sizeof(item_type) * (capa - next));
+
+    writer.pad_to(snapshot_header::BLOCK_OFFSET + snapshot_groups_offset(capa));
+    writer.write(mGroups.data, sizeof(MetaGroup) * gCapa);
+    if (STORED_HASH)
+      writer.write(hashes_of(mGroups.data, mGMask), sizeof(stored_type) * capa); // right after groups
+    writer.pad_to(snapshot_header::BLOCK_OFFSET + (std::size_t)header.blockBytes);
+  }
+
+  // Use snapshot storage in place ('data' must be 64-aligned and outlive the table, see `detach_snapshot`)
+  // Table must be empty without storage, only const member functions may be called afterward
+  bool attach_snapshot(const void* data, std::size_t bytes)
+  {
+    INDIVI_UTABLE_ASSERT(!mValues.data);
+    snapshot_header header;
+    if (bytes < snapshot_header::BLOCK_OFFSET)
+      return false;
+    std::memcpy((void*)&header, data, sizeof(header));
+    if (!header.compatible(snapshot_layout(), sizeof(item_type), alignof(item_type)))
+      return false;
+    if (header.blockBytes == 0u) // no storage
+      return header.size == 0u;
+
+    // check consistency (to never read out of bounds)
+    size_type gCapa = (size_type)header.gMask + 1u;
+    if (gCapa == 0u || !is_pow2(gCapa) || header.shift != hash_shift(gCapa))
+      return false;
+    size_type capa = (gCapa > 1u) ? gCapa * 16u : (size_type)header.maxSize; // see `bucket_count`
+    size_type maxSize = capa_to_maxsize(capa, MAX_LOAD_FACTOR_HIGH);
+    if (capa < MIN_CAPA || capa > 16u * gCapa || !is_pow2(capa) || header.maxSize > maxSize || header.size > header.maxSize
+        || (gCapa == 1u && header.maxSize != capa)
+        || header.blockBytes != snapshot_block_bytes(capa, gCapa) || bytes - snapshot_header::BLOCK_OFFSET < header.blockBytes)
+      return false;
+
+    char* block = const_cast<char*>(static_cast<const char*>(data) + snapshot_header::BLOCK_OFFSET);
+    mSize = (size_type)header.size;
+    mShift = (size_type)header.shift;
+    mGMask = (size_type)header.gMask;
+    mMaxSize = (size_type)header.maxSize;
+    mValues.data = reinterpret_cast<item_type*>(block);
+    mGroups.data = reinterpret_cast<MetaGroup*>(block + snapshot_groups_offset(capa));
+
+    if (snapshot_fingerprint() != header.fingerprint) // different hash function
+    {
+      detach_snapshot();
+      return false;
+    }
+    return true;
+  }
+
+  // Release snapshot storage (not deallocated), table is left empty
+  void detach_snapshot() noexcept
+  {
+    mSize = 0u;
+    mShift = 0u;
+    mGMask = 0u;
+    mMaxSize = 0u;
+    mGroups.data = MetaGroup::empty_group();
+    mValues.data = nullptr;
+  }
 
   void swap(flat_utable& other)
-    noexcept(traits::is_nothrow_swappable<Hash>::value && traits::is_nothrow_swappable<key_equal>::value)
+    noexcept(traits::is_nothrow_swappable<Hash>::value && traits::is_nothrow_swappable<key_equal>::value
+             && (!storage_traits::propagate_on_container_swap::value || traits::is_nothrow_swappable<storage_allocator>::value))
   {
     using std::swap;
     swap(hash(),  other.hash());
     swap(equal(), other.equal());
+    swap_alloc(other, std::integral_constant<bool, storage_traits::propagate_on_container_swap::value>{});
+
+    swap_content(other);
+  }
+
+private:
+  // Take all items of source (merge into empty table), each table keeping its own policies
+  void take_all(flat_utable& source)
+  {
+    float maxLoadFactor = mMaxLoadFactor;
+    uint8_t growthShift = mGrowthShift;
+    uint16_t minLoad = mMinLoad;
+
+    swap(source); // also swaps policies
+    source.max_load_factor(mMaxLoadFactor); // max size updated for its new storage
+    source.mGrowthShift = mGrowthShift;
+    source.mMinLoad = mMinLoad;
+    max_load_factor(maxLoadFactor);
+    mGrowthShift = growthShift;
+    mMinLoad = minLoad;
+  }
+
+  void copy_policy(const flat_utable& other) noexcept
+  {
+    mMaxLoadFactor = other.mMaxLoadFactor;
+    mGrowthShift = other.mGrowthShift;
+    mMinLoad = other.mMinLoad;
+  }
 
+  // Auto downsizing (see `min_load_factor(float)`), threshold kept below load after growth or shrink (no rehash ping-pong)
+  void shrink_on_erase()
+  {
+    if (mMinLoad && bucket_count() > 16u)
+    {
+      float minLoad = (float)mMinLoad / 65536.f;
+      float maxLoad = mMaxLoadFactor / (float)(size_type(2u) << mGrowthShift);
+      if ((float)mSize < (float)bucket_count() * ((minLoad < maxLoad) ? minLoad : maxLoad))
+      {
+        try
+        {
+          rehash(0u);
+        }
+        catch (const std::bad_alloc&) {} // best effort, keep current storage
+      }
+    }
+  }
+
+  void swap_content(flat_utable& other) noexcept
+  {
+    using std::swap;
+    swap(mMaxLoadFactor, other.mMaxLoadFactor);
+    swap(mGrowthShift,   other.mGrowthShift);
+    swap(mMinLoad,       other.mMinLoad);
+    if (is_inline() || other.is_inline())
+    {
+      swap_inline(other);
+      return;
+    }
     swap(mSize,        other.mSize);
     swap(mShift,       other.mShift);
     swap(mGMask,       other.mGMask);
@@ -846,6 +1378,149 @@ public:
     swap(mValues.data, other.mValues.data);
   }
 
+  // At least one inline storage: move items instead of swapping storages
+  void swap_inline(flat_utable& other) noexcept
+  {
+    if (!is_inline())
+    {
+      other.swap_inline(*this);
+      return;
+    }
+    if (!other.is_inline())
+    {
+      // give inline items to other, then take its storage (if any)
+      size_type otSize = other.mSize;
+      size_type otShift = other.mShift;
+      size_type otGMask = other.mGMask;
+      size_type otMaxSize = other.mMaxSize;
+      MetaGroup* otGroups = other.mGroups.data;
+      item_type* otValues = other.mValues.data;
+
+      other.mValues.data = nullptr;
+      other.take_inline(*this);
+
+      mSize = otSize;
+      mShift = otShift;
+      mGMask = otGMask;
+      mMaxSize = otMaxSize;
+      mGroups.data = otGroups;
+      mValues.data = otValues;
+      return;
+    }
+    // both inline (same single group layout): swap items in place
+    int sets = mGroups.data->match_set();
+    int otSets = other.mGroups.data->match_set();
+    int all = sets | otSets;
+    while (all)
+    {
+      int idx = first_bit_index(all);
+      all &= all - 1;
+
+      item_type* pValue = mValues.data + idx;
+      item_type* otValue = other.mValues.data + idx;
+      if ((sets & otSets) & (1 << idx))
+      {
+        using std::swap;
+        swap(*pValue, *otValue);
+      }
+      else if (sets & (1 << idx))
+      {
+        ::new (otValue) item_type(std::move(*pValue));
+        pValue->~item_type();
+      }
+      else
+      {
+        ::new (pValue) item_type(std::move(*otValue));
+        otValue->~item_type();
+      }
+    }
+    std::swap(*mGroups.data, *other.mGroups.data);
+    if (STORED_HASH)
+      std::swap_ranges(hashes_of(mGroups.data, 0u), hashes_of(mGroups.data, 0u) + INLINE_CAPA, hashes_of(other.mGroups.data, 0u));
+    std::swap(mSize, other.mSize);
+  }
+
+  // Move items of other inline storage into own one (at same positions), other is left empty without storage
+  void take_inline(flat_utable& other) noexcept
+  {
+    INDIVI_UTABLE_ASSERT(!mValues.data);
+    INDIVI_UTABLE_ASSERT(other.is_inline());
+
+    NewStorage newStorage(alloc(), INLINE_CAPA, 1u, mValues.inline_data());
+    MetaGroup* newGroups = newStorage.groups();
+    item_type* newValues = newStorage.values();
+
+    other.uc_for_each([&](item_type* otValue) {
+      ::new (newValues + (otValue - other.mValues.data)) item_type(std::move(*otValue));
+      otValue->~item_type();
+    });
+    std::memcpy((void*)newGroups, other.mGroups.data, sizeof(MetaGroup));
+    if (STORED_HASH)
+      std::memcpy(hashes_of(newGroups, 0u), hashes_of(other.mGroups.data, 0u), sizeof(stored_type) * INLINE_CAPA);
+
+    mSize = other.mSize;
+    mShift = other.mShift;
+    mGMask = other.mGMask;
+    mMaxSize = other.mMaxSize;
+    mGroups.data = newGroups;
+    mValues.data = newValues;
+    newStorage.release();
+
+    other.mSize = 0u;
+    other.mShift = 0u;
+    other.mGMask = 0u;
+    other.mMaxSize = 0u;
+    other.mGroups.data = MetaGroup::empty_group();
+    other.mValues.data = nullptr;
+  }
+
+  template <typename = void>
+  void swap_alloc(flat_utable& other, std::true_type) // propagate
+  {
+    using std::swap;
+    swap(alloc(), other.alloc());
+  }
+
+  template <typename = void>
+  void swap_alloc(flat_utable& other, std::false_type) noexcept // no propagate
+  {
+    INDIVI_UTABLE_ASSERT(alloc() == other.alloc());
+    (void)other;
+  }
+
+  void copy_assign_alloc(const flat_utable& other)
+  {
+    copy_assign_alloc(other, std::integral_constant<bool, storage_traits::propagate_on_container_copy_assignment::value>{});
+  }
+
+  template <typename = void>
+  void copy_assign_alloc(const flat_utable& other, std::true_type) // propagate
+  {
+    INDIVI_UTABLE_ASSERT(empty());
+    if (alloc() != other.alloc())
+      rehash(0); // release storage with current allocator
+
+    alloc() = other.alloc();
+  }
+
+  template <typename = void>
+  void copy_assign_alloc(const flat_utable&, std::false_type) noexcept {} // no propagate
+
+  void move_assign_alloc(flat_utable& other)
+  {
+    move_assign_alloc(other, std::integral_constant<bool, storage_traits::propagate_on_container_move_assignment::value>{});
+  }
+
+  template <typename = void>
+  void move_assign_alloc(flat_utable& other, std::true_type) noexcept(std::is_nothrow_move_assignable<storage_allocator>::value) // propagate
+  {
+    alloc() = std::move(other.alloc());
+  }
+
+  template <typename = void>
+  void move_assign_alloc(flat_utable&, std::false_type) noexcept {} // no propagate
+
+public:
   template <typename U>
   typename std::enable_if<
     !std::is_same<typename U::key_type, typename U::init_type>::value,
@@ -894,6 +1569,7 @@ public:
       if (pred(*it))
         erase(it);
     }
+    shrink_on_erase();
     return oldSize - mSize;
   }
 
@@ -1049,6 +1725,10 @@ public:
     mStats.cmp_miss_max = 0;
   }
 #endif // INDIVI_FLAT_U_STATS
+#ifdef INDIVI_FLAT_U_TELEMETRY
+  flat_telemetry get_telemetry() const noexcept { return mTelemetry.get(); }
+  void reset_telemetry() noexcept { mTelemetry.reset(); }
+#endif
 
 private:
   // static functions
@@ -1059,6 +1739,12 @@ private:
                          : sizeof(size_type) * CHAR_BIT - (size_type)(first_bit_index(gCapa));
   }
 
+  // Single group is filled up (see `bucket_count`)
+  static size_type capa_to_maxsize(size_type capa, float maxLoadFactor) noexcept
+  {
+    return (capa > 16u) ? (size_type)(capa * maxLoadFactor) : capa;
+  }
+
   static constexpr size_type hash_position(std::size_t hash, size_type shift, size_type mask) noexcept
   {
     return (hash >> shift) & mask; // keep (64 - n) highest bits, mask to handle single group case
@@ -1104,7 +1790,8 @@ private:
   }
 #endif
 
-  std::size_t get_hash(const Key& key) const
+  template< typename K >
+  std::size_t get_hash(const K& key) const
   {
     return mixer::mix(hash(), key);
   }
@@ -1161,6 +1848,56 @@ private:
     while (pGroup != last);
   }
 
+  // Stored hashes (one per item, after 32-aligned groups)
+  // Snapshot layout (storage offsets relative to a 64-aligned block)
+  static uint64_t snapshot_layout() noexcept
+  {
+    return snapshot_header::make_layout('U', sizeof(MetaGroup), STORED_HASH ? sizeof(stored_type) : 0u, sizeof(size_type));
+  }
+
+  static std::size_t snapshot_block_bytes(size_type capa, size_type gCapa) noexcept
+  {
+    return sizeof(item_type) * NewStorage::storageCapa(capa, gCapa);
+  }
+
+  static std::size_t snapshot_groups_offset(size_type capa) noexcept
+  {
+    return (sizeof(item_type) * capa + 31u) & ~(std::size_t)31u; // see `NewStorage::groups`
+  }
+
+  // Hashes of first keys (in storage order), to check hash function consistency
+  uint64_t snapshot_fingerprint() const
+  {
+    uint64_t accu = mSize;
+    unsigned int count = 0u;
+    for (auto it = cbegin(); it != cend() && count < snapshot_header::FINGERPRINT_KEYS; ++it, ++count)
+      accu = detail::snapshot_fingerprint(accu, get_hash(get_key(*it)));
+    return accu;
+  }
+
+  static stored_type* hashes_of(MetaGroup* groups, size_type gMask) noexcept
+  {
+    return reinterpret_cast<stored_type*>(groups + gMask + 1u);
+  }
+
+  static void store_hash(MetaGroup* groups, size_type gMask, size_type index, std::size_t hash) noexcept
+  {
+    if (STORED_HASH)
+      hashes_of(groups, gMask)[index] = (stored_type)hash;
+  }
+
+  static std::size_t stored_to_hash(stored_type stored) noexcept
+  {
+    return hash_is_32bits<Hash>::value ? spread32((uint32_t)stored) : (std::size_t)stored;
+  }
+
+  std::size_t item_hash(const item_type* pValue) const
+  {
+    if (STORED_HASH)
+      return stored_to_hash(hashes_of(mGroups.data, mGMask)[pValue - mValues.data]);
+    return get_hash(get_key(*pValue));
+  }
+
   void destroy()
   {
     if (mValues.data)
@@ -1168,7 +1905,7 @@ private:
       uc_for_each([&](item_type* pValue) {
         pValue->~item_type();
       });
-      delete[] reinterpret_cast<storage_type*>(mValues.data);
+      deallocate();
     }
   }
   
@@ -1176,18 +1913,33 @@ private:
   {
     INDIVI_UTABLE_ASSERT(empty());
     if (mValues.data)
-      delete[] reinterpret_cast<storage_type*>(mValues.data);
+      deallocate();
   }
 
-  Location find_impl(std::size_t hash, size_type gIndex, const Key& key) const
+  void deallocate() noexcept // current storage, items must be destroyed
   {
-  #ifdef INDIVI_FLAT_U_STATS
+    INDIVI_UTABLE_ASSERT(mValues.data);
+    if (is_inline())
+      return;
+    size_type groupsCapa = mGMask + 1u;
+    storage_traits::deallocate(alloc(), reinterpret_cast<storage_type*>(mValues.data),
+                               NewStorage::storageCapa(bucket_count(), groupsCapa));
+  }
+
+  template< typename K >
+  Location find_impl(std::size_t hash, size_type gIndex, const K& key) const
+  {
+  #if defined(INDIVI_FLAT_U_STATS) || defined(INDIVI_FLAT_U_TELEMETRY)
     std::size_t probLen = 1;
     std::size_t cmpCount = 0;
   #endif
+  #ifdef INDIVI_FLAT_U_TELEMETRY
+    const bool sampled = flat_telemetry_counters::sample();
+  #endif
   #ifdef INDIVI_FLAT_U_QUAD_PROB
     size_type delta = 0u;
   #endif
+    const stored_type* hashes = hashes_of(mGroups.data, mGMask);
     do {
       const auto& group = mGroups.data[gIndex];
       int matchs = group.match_hfrag(hash);
@@ -1196,12 +1948,17 @@ private:
         item_type* pValue = &mValues.data[gIndex * 16];
         INDIVI_PREFETCH(pValue);
         do {
-        #ifdef INDIVI_FLAT_U_STATS
+        #if defined(INDIVI_FLAT_U_STATS) || defined(INDIVI_FLAT_U_TELEMETRY)
           ++cmpCount;
         #endif
           int idx = first_bit_index(matchs);
-          if (equal()(key, get_key(pValue[idx]))) // found
+          if ((!STORED_HASH || hashes[gIndex * 16 + idx] == (stored_type)hash) // skip key compare on mismatch
+              && equal()(key, get_key(pValue[idx]))) // found
           {
+          #ifdef INDIVI_FLAT_U_TELEMETRY
+            if (sampled)
+              mTelemetry.record_lookup(true, probLen, cmpCount);
+          #endif
           #ifdef INDIVI_FLAT_U_STATS
             mStats.prob_hit_len += probLen;
             mStats.prob_hit_max = (mStats.prob_hit_max >= probLen) ? mStats.prob_hit_max : probLen;
@@ -1218,6 +1975,10 @@ private:
       // not found
       if (!group.get_overflow(hash))
       {
+      #ifdef INDIVI_FLAT_U_TELEMETRY
+        if (sampled)
+          mTelemetry.record_lookup(false, probLen, cmpCount);
+      #endif
       #ifdef INDIVI_FLAT_U_STATS
         mStats.prob_miss_len += probLen;
         mStats.prob_miss_max = (mStats.prob_miss_max >= probLen) ? mStats.prob_miss_max : probLen;
@@ -1227,7 +1988,7 @@ private:
       #endif
         return { nullptr, nullptr, 0 };
       }
-    #ifdef INDIVI_FLAT_U_STATS
+    #if defined(INDIVI_FLAT_U_STATS) || defined(INDIVI_FLAT_U_TELEMETRY)
       ++probLen;
     #endif
     #ifdef INDIVI_FLAT_U_QUAD_PROB
@@ -1242,6 +2003,63 @@ private:
     return { nullptr, nullptr, 0 };
   }
 
+  // Hash 'count' items from 'first' (see `insert_unique_range`)
+  template< class ForwardIt >
+  void hash_items(ForwardIt first, size_type count, std::size_t* hashes, std::false_type /*batchKeys*/) const
+  {
+    for (size_type i = 0u; i < count; ++i, ++first)
+      hashes[i] = get_hash(get_key(*first));
+  }
+
+  void hash_items(const Key* keys, size_type count, std::size_t* hashes, std::true_type /*batchKeys*/) const
+  {
+    detail::hash_batch<mixer>(hash(), keys, count, hashes, hash_has_batch<Hash, Key>{});
+  }
+
+  template< typename F >
+  void find_batch_impl(const Key* keys, size_type count, F fct) const
+  {
+    std::size_t hashes[BATCH_SIZE];
+    size_type gIndexes[BATCH_SIZE];
+
+    for (size_type first = 0u; first < count; first += BATCH_SIZE)
+    {
+      size_type batchSize = std::min(count - first, (size_type)BATCH_SIZE);
+      // hash all (by hasher batch, if provided) and prefetch groups
+      if (BATCH_HASH)
+        detail::hash_batch<mixer>(hash(), keys + first, batchSize, hashes, hash_has_batch<Hash, Key>{});
+      for (size_type i = 0u; i < batchSize; ++i)
+      {
+        if (!BATCH_HASH)
+          hashes[i] = get_hash(keys[first + i]);
+        gIndexes[i] = hash_position(hashes[i], mShift, mGMask);
+        INDIVI_PREFETCH(&mGroups.data[gIndexes[i]]);
+      }
+      // prefetch first matching value slots (groups should be in flight by now)
+      if (mValues.data)
+      {
+        for (size_type i = 0u; i < batchSize; ++i)
+        {
+          int matchs = mGroups.data[gIndexes[i]].match_hfrag(hashes[i]);
+          if (matchs)
+            INDIVI_PREFETCH(&mValues.data[gIndexes[i] * 16 + first_bit_index(matchs)]);
+        }
+      }
+      // probe
+      for (size_type i = 0u; i < batchSize; ++i)
+        fct(first + i, find_impl(hashes[i], gIndexes[i], keys[first + i]));
+    }
+  }
+
+  void inc_overflow(MetaGroup& group, std::size_t hash) noexcept
+  {
+  #ifdef INDIVI_FLAT_U_TELEMETRY
+    if (group.get_overflow(hash) == 255)
+      mTelemetry.record_saturation();
+  #endif
+    group.inc_overflow(hash);
+  }
+
   template< typename U >
   Location unchecked_insert(std::size_t hash, size_type gIndex, U&& value)
   {
@@ -1261,10 +2079,11 @@ private:
 
         group.set_hfrag(idx, hash);
         group.set_distance(idx, step);
+        store_hash(mGroups.data, mGMask, (gIndex * 16) + idx, hash);
         return { pValue, std::addressof(group), idx};
       }
       // set overflow flag
-      group.inc_overflow(hash);
+      inc_overflow(group, hash);
 
     #ifdef INDIVI_FLAT_U_QUAD_PROB
       gIndex = (gIndex + (++delta)) & mGMask;
@@ -1298,10 +2117,11 @@ private:
 
         group.set_hfrag(idx, hash);
         group.set_distance(idx, step);
+        store_hash(mGroups.data, mGMask, (gIndex * 16) + idx, hash);
         return { pValue, std::addressof(group), idx};
       }
       // set overflow flag
-      group.inc_overflow(hash);
+      inc_overflow(group, hash);
 
     #ifdef INDIVI_FLAT_U_QUAD_PROB
       gIndex = (gIndex + (++delta)) & mGMask;
@@ -1328,6 +2148,12 @@ private:
   std::pair<iterator, bool> try_insert_impl(U&& value)
   {
     std::size_t hash = get_hash(get_key(value));
+    return insert_hashed(hash, std::forward<U>(value));
+  }
+
+  template< typename U >
+  std::pair<iterator, bool> insert_hashed(std::size_t hash, U&& value)
+  {
     size_type gIndex = hash_position(hash, mShift, mGMask);
 
     Location loc = find_impl(hash, gIndex, get_key(value));
@@ -1416,9 +2242,8 @@ private:
   }
 
   template< typename U >
-  void insert_unique(MetaGroup* groups, item_type* values, size_type shift, size_type gMask, U&& value)
+  void insert_unique(MetaGroup* groups, item_type* values, size_type shift, size_type gMask, std::size_t hash, U&& value)
   {
-    std::size_t hash = get_hash(get_key(value));
     size_type gIndex = hash_position(hash, shift, gMask);
 
     uint32_t step = 0u;
@@ -1436,10 +2261,11 @@ private:
 
         group.set_hfrag(idx, hash);
         group.set_distance(idx, step);
+        store_hash(groups, gMask, (gIndex * 16) + idx, hash);
         return;
       }
       // full
-      group.inc_overflow(hash);
+      inc_overflow(group, hash);
 
     #ifdef INDIVI_FLAT_U_QUAD_PROB
       gIndex = (gIndex + (++delta)) & gMask;
@@ -1455,7 +2281,8 @@ private:
   template< typename U >
   void insert_unique(U&& value)
   {
-    insert_unique(mGroups.data, mValues.data, mShift, mGMask, std::forward<U>(value));
+    std::size_t hash = get_hash(get_key(value));
+    insert_unique(mGroups.data, mValues.data, mShift, mGMask, hash, std::forward<U>(value));
   }
 
   template< typename U >
@@ -1468,6 +2295,7 @@ private:
     ::new (pValue) item_type(std::forward<U>(value));
 
     group.set_hfrag(0, hash);
+    store_hash(groups, gMask, gIndex * 16, hash);
     return { pValue, std::addressof(group), 0 };
   }
 
@@ -1483,6 +2311,7 @@ private:
                              std::forward_as_tuple(std::forward<Args>(args)...));
 
     group.set_hfrag(0, hash);
+    store_hash(groups, gMask, gIndex * 16, hash);
     return { pValue, std::addressof(group), 0 };
   }
 
@@ -1549,8 +2378,8 @@ private:
     }
     else // saturated distance
     {
-      // fallback: recompute hash
-      std::size_t hash = get_hash(get_key(*value));
+      // fallback: recompute hash (or use stored one)
+      std::size_t hash = item_hash(value);
       size_type gIndex = hash_position(hash, mShift, mGMask);
 
       erase_impl(gIndex, hash, { value, group, subIndex });
@@ -1571,6 +2400,8 @@ private:
     {
       std::memcpy((void*)mValues.data, other.mValues.data, sizeof(item_type) * bucketCount);
       std::memcpy((void*)mGroups.data, other.mGroups.data, sizeof(MetaGroup) * (mGMask + 1u));
+      if (STORED_HASH)
+        std::memcpy(hashes_of(mGroups.data, mGMask), hashes_of(other.mGroups.data, mGMask), sizeof(stored_type) * bucketCount);
       mSize = other.mSize;
     }
     else
@@ -1598,27 +2429,38 @@ private:
       INDIVI_UTABLE_ASSERT(ctr_count == other.mSize);
 
       std::memcpy(mGroups.data, other.mGroups.data, sizeof(MetaGroup) * (mGMask + 1u));
+      if (STORED_HASH)
+        std::memcpy(hashes_of(mGroups.data, mGMask), hashes_of(other.mGroups.data, mGMask), sizeof(stored_type) * bucketCount);
       mSize = other.mSize;
     }
   }
 
+  // Storage for items of other: an inline one stays inline (full single group, not subject to max load factor)
+  void reserve_for(const flat_utable& other)
+  {
+    if (other.is_inline())
+      rehash(INLINE_CAPA);
+    else
+      reserve(other.mSize);
+  }
+
   void copy_content(const flat_utable& other)
   {
     INDIVI_UTABLE_ASSERT(empty());
     if (other.empty())
       return;
 
-    reserve(other.mSize);
+    reserve_for(other);
     try
     {
-      if (mMaxSize == other.mMaxSize) // same bucket count
+      if (mGMask == other.mGMask && mMaxSize == other.mMaxSize) // same bucket count
       {
         fast_copy(other);
       }
       else
       {
         other.uc_for_each([&](const item_type* pValue) {
-          insert_unique(*pValue);
+          insert_unique(mGroups.data, mValues.data, mShift, mGMask, other.item_hash(pValue), *pValue);
           ++mSize;
         });
       }
@@ -1630,12 +2472,26 @@ private:
     }
   }
 
+  void move_content(flat_utable& other) // unequal allocators
+  {
+    INDIVI_UTABLE_ASSERT(empty());
+    if (other.empty())
+      return;
+
+    reserve_for(other);
+    other.uc_for_each([&](item_type* pValue) {
+      insert_unique(mGroups.data, mValues.data, mShift, mGMask, other.item_hash(pValue), std::move(*pValue));
+      ++mSize;
+    });
+    other.clear();
+  }
+
   void move_to(MetaGroup* newGroups, item_type* newValues, size_type newShift, size_type newGMask)
   {
     try
     {
       uc_for_each([&](item_type* pValue) {
-        insert_unique(newGroups, newValues, newShift, newGMask, std::move(*pValue));
+        insert_unique(newGroups, newValues, newShift, newGMask, item_hash(pValue), std::move(*pValue));
         pValue->~item_type();
       });
     }
@@ -1664,38 +2520,107 @@ private:
 
   struct NewStorage // exception-safe helper
   {
+    storage_allocator& alloc;
     size_type itemsCapa;
-    std::unique_ptr<storage_type[]> data; // contains items then 32-aligned groups
-
-    NewStorage(size_type itemsCapa_, size_type groupsCapa_)
-      : itemsCapa(itemsCapa_)
-      , data(new storage_type[storageCapa(itemsCapa_, groupsCapa_)])
+    size_type capa;
+    storage_type* data; // contains items then 32-aligned groups
+    bool heap;          // not inline storage (see 'InlineN')
+
+    NewStorage(storage_allocator& alloc_, size_type itemsCapa_, size_type groupsCapa_, storage_type* inlineData = nullptr)
+      : alloc(alloc_)
+      , itemsCapa(itemsCapa_)
+      , capa(storageCapa(itemsCapa_, groupsCapa_))
+      , data(inlineData ? inlineData : std::addressof(*storage_traits::allocate(alloc_, capa)))
+      , heap(!inlineData)
     {
-      void* ptr = (void*)(data.get() + itemsCapa_);
+      INDIVI_UTABLE_ASSERT(heap || capa <= INLINE_STORAGE);
+      void* ptr = (void*)(data + itemsCapa_);
       std::memset(ptr, 0, sizeof(MetaGroup) * groupsCapa_ + 31); // init MetaGroups manually
     }
 
+    ~NewStorage()
+    {
+      if (data && heap)
+        storage_traits::deallocate(alloc, data, capa);
+    }
+
+    NewStorage(const NewStorage&) = delete;
+    NewStorage& operator=(const NewStorage&) = delete;
+
     static size_type storageCapa(size_type itemsCapa, size_type groupsCapa)
     {
       size_type grpsAsItemCapa = sizeof(MetaGroup) * groupsCapa + 31; // padding for alignment
+      if (STORED_HASH)
+        grpsAsItemCapa += sizeof(stored_type) * itemsCapa; // after groups (already aligned)
       grpsAsItemCapa = (grpsAsItemCapa + sizeof(item_type) - 1) / sizeof(item_type); // round-up
       return itemsCapa + grpsAsItemCapa; // storage uses item_type element size
     }
 
-    void release() noexcept { data.release(); }
+    void release() noexcept { data = nullptr; }
 
-    item_type* values() const noexcept { return reinterpret_cast<item_type*>(data.get()); }
+    item_type* values() const noexcept { return reinterpret_cast<item_type*>(data); }
     MetaGroup* groups() const noexcept
     {
       std::size_t space = 31 + sizeof(MetaGroup);
-      void* ptr = (void*)(data.get() + itemsCapa);
+      void* ptr = (void*)(data + itemsCapa);
       void* aligned = std::align(32, sizeof(MetaGroup), ptr, space);
       INDIVI_UTABLE_ASSERT(aligned);
       return reinterpret_cast<MetaGroup*>(aligned);
     }
   };
 
-  void rehash_impl(size_type newCapa)
+  // Move elements with room in their home group of the target part, one thread per part (others are left for 'move_to')
+  // Parts are contiguous ranges of groups (i.e. hash highest bits) in both tables, so threads never write the same groups
+  void parallel_move_to(MetaGroup* newGroups, item_type* newValues, size_type newShift, size_type newGMask, unsigned int threadCount)
+  {
+    if (!std::is_nothrow_move_constructible<item_type>::value)
+      return;
+
+    size_type gCapa = mGMask + 1u;
+    size_type newGCapa = newGMask + 1u;
+    unsigned int parts = parallel_parts(threadCount, std::min(gCapa, newGCapa) * 16u, PARALLEL_MIN_PART);
+    if (parts < 2u)
+      return;
+
+    size_type partGCapa = gCapa / parts;
+    size_type newPartGCapa = newGCapa / parts;
+    parallel_for(parts, [&](unsigned int part) {
+      size_type first = part * newPartGCapa;
+      size_type last = first + newPartGCapa;
+
+      item_type* pValue = mValues.data + part * partGCapa * 16u;
+      MetaGroup* pGroup = mGroups.data + part * partGCapa;
+      MetaGroup* end = pGroup + partGCapa;
+      for (; pGroup != end; ++pGroup, pValue += 16)
+      {
+        int sets = pGroup->match_set();
+        while (sets)
+        {
+          int idx = first_bit_index(sets);
+          sets &= sets - 1;
+
+          std::size_t hash = item_hash(&pValue[idx]);
+          size_type gIndex = hash_position(hash, newShift, newGMask);
+          if (gIndex < first || gIndex >= last)
+            continue;
+
+          auto& group = newGroups[gIndex];
+          int empties = group.match_empty();
+          if (!empties)
+            continue;
+
+          int newIdx = first_bit_index(empties);
+          ::new (&newValues[(gIndex * 16) + newIdx]) item_type(std::move(pValue[idx]));
+          pValue[idx].~item_type();
+          group.set_hfrag(newIdx, hash); // no distance (home group)
+          store_hash(newGroups, newGMask, (gIndex * 16) + newIdx, hash);
+          pGroup->reset_hfrag(idx); // skipped by 'move_to'
+        }
+      }
+    });
+  }
+
+  void rehash_impl(size_type newCapa, unsigned int threadCount = 1u)
   {
     INDIVI_UTABLE_ASSERT(newCapa >= MIN_CAPA);
     INDIVI_UTABLE_ASSERT(is_pow2(newCapa));
@@ -1707,22 +2632,27 @@ private:
 
     if (mValues.data)
     {
-      NewStorage newStorage(newCapa, newGCapa);
+    #ifdef INDIVI_FLAT_U_TELEMETRY
+      flat_telemetry_counters::rehash_scope scope(mTelemetry);
+    #endif
+      NewStorage newStorage(alloc(), newCapa, newGCapa, inline_for(newCapa));
       MetaGroup* newGroups = newStorage.groups();
       item_type* newValues = newStorage.values();
 
       // move existing
+      if (threadCount > 1u)
+        parallel_move_to(newGroups, newValues, newShift, newGMask, threadCount);
       move_to(newGroups, newValues, newShift, newGMask);
 
       // delete old and update
-      delete[] reinterpret_cast<storage_type*>(mValues.data);
+      deallocate();
       mGroups.data = newGroups;
       mValues.data = newValues;
       newStorage.release();
       
       mShift = newShift;
       mGMask = newGMask;
-      mMaxSize = (mGMask != 0) ? (size_type)(newCapa * MAX_LOAD_FACTOR) : newCapa;
+      mMaxSize = capa_to_maxsize(newCapa, mMaxLoadFactor);
     }
     else // first time
     {
@@ -1730,22 +2660,27 @@ private:
       INDIVI_UTABLE_ASSERT(mShift == 0u);
       INDIVI_UTABLE_ASSERT(mGMask == 0u);
 
-      NewStorage newStorage(newCapa, newGCapa);
+      NewStorage newStorage(alloc(), newCapa, newGCapa, inline_for(newCapa));
       mGroups.data = newStorage.groups();
       mValues.data = newStorage.values();
       newStorage.release();
       
       mShift = newShift;
       mGMask = newGMask;
-      mMaxSize = (mGMask != 0) ? (size_type)(newCapa * MAX_LOAD_FACTOR) : newCapa;
+      mMaxSize = capa_to_maxsize(newCapa, mMaxLoadFactor);
     }
   }
 
   template< typename U >
   Location grow_with_insert(std::size_t hash, U&& value)
   {
-    size_type newCapa = bucket_count() * 2;
-    newCapa = std::max(newCapa, (size_type)MIN_CAPA);
+  #ifdef INDIVI_FLAT_U_TELEMETRY
+    flat_telemetry_counters::rehash_scope scope(mTelemetry, mValues.data != nullptr);
+  #endif
+    size_type newCapa = bucket_count() << mGrowthShift;
+    newCapa = std::max(newCapa, (size_type)FIRST_CAPA);
+    while (capa_to_maxsize(newCapa, mMaxLoadFactor) <= mSize) // leaving single group with low max load factor
+      newCapa *= 2;
     INDIVI_UTABLE_ASSERT(is_pow2(newCapa));
     
     size_type newGCapa = newCapa / 16;
@@ -1753,7 +2688,7 @@ private:
     size_type newShift = hash_shift(newGCapa);
     size_type newGMask = newGCapa - 1u;
 
-    NewStorage newStorage(newCapa, newGCapa);
+    NewStorage newStorage(alloc(), newCapa, newGCapa, inline_for(newCapa));
     MetaGroup* newGroups = newStorage.groups();
     item_type* newValues = newStorage.values();
 
@@ -1766,7 +2701,7 @@ private:
       move_to(newGroups, newValues, newShift, newGMask);
 
       // delete old
-      delete[] reinterpret_cast<storage_type*>(mValues.data);
+      deallocate();
     }
     // update
     mGroups.data = newGroups;
@@ -1775,7 +2710,7 @@ private:
     
     mShift = newShift;
     mGMask = newGMask;
-    mMaxSize = (mGMask != 0) ? (size_type)(newCapa * MAX_LOAD_FACTOR) : newCapa;
+    mMaxSize = capa_to_maxsize(newCapa, mMaxLoadFactor);
     ++mSize;
 
     return loc;
@@ -1784,8 +2719,13 @@ private:
   template< typename U, class... Args >
   Location grow_with_emplace(std::size_t hash, U&& key, Args&&... args)
   {
-    size_type newCapa = bucket_count() * 2;
-    newCapa = std::max(newCapa, (size_type)MIN_CAPA);
+  #ifdef INDIVI_FLAT_U_TELEMETRY
+    flat_telemetry_counters::rehash_scope scope(mTelemetry, mValues.data != nullptr);
+  #endif
+    size_type newCapa = bucket_count() << mGrowthShift;
+    newCapa = std::max(newCapa, (size_type)FIRST_CAPA);
+    while (capa_to_maxsize(newCapa, mMaxLoadFactor) <= mSize) // leaving single group with low max load factor
+      newCapa *= 2;
     INDIVI_UTABLE_ASSERT(is_pow2(newCapa));
 
     size_type newGCapa = newCapa / 16;
@@ -1793,7 +2733,7 @@ private:
     size_type newShift = hash_shift(newGCapa);
     size_type newGMask = newGCapa - 1u;
 
-    NewStorage newStorage(newCapa, newGCapa);
+    NewStorage newStorage(alloc(), newCapa, newGCapa, inline_for(newCapa));
     MetaGroup* newGroups = newStorage.groups();
     item_type* newValues = newStorage.values();
 
@@ -1806,7 +2746,7 @@ private:
       move_to(newGroups, newValues, newShift, newGMask);
 
       // delete old
-      delete[] reinterpret_cast<storage_type*>(mValues.data);
+      deallocate();
     }
     // update
     mGroups.data = newGroups;
@@ -1815,7 +2755,7 @@ private:
     
     mShift = newShift;
     mGMask = newGMask;
-    mMaxSize = (mGMask != 0) ? (size_type)(newCapa * MAX_LOAD_FACTOR) : newCapa;
+    mMaxSize = capa_to_maxsize(newCapa, mMaxLoadFactor);
     ++mSize;
 
     return loc;
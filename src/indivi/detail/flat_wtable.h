@@ -9,12 +9,17 @@
 #include "indivi/hash.h"
 #include "indivi/detail/indivi_defines.h"
 #include "indivi/detail/indivi_utils.h"
+#include "indivi/detail/indivi_parallel.h"
+#include "indivi/detail/flat_node.h"
+#include "indivi/detail/flat_snapshot.h"
+#include "indivi/detail/flat_telemetry.h"
 
 #include <algorithm>
 #include <initializer_list>
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <new>
 #include <stdexcept>
 #include <tuple>
 #include <type_traits>
@@ -26,7 +31,20 @@
 #include <cstdint>
 #include <cstring>
 
-#ifdef INDIVI_SIMD_SSE2
+#ifdef INDIVI_FLAT_W_WIDE_SIMD // opt-in wider probing windows (if supported)
+  #if defined(INDIVI_SIMD_AVX512BW)
+    #define INDIVI_FLAT_W_SIMD_WIDTH 64
+  #elif defined(INDIVI_SIMD_AVX2)
+    #define INDIVI_FLAT_W_SIMD_WIDTH 32
+  #endif
+#endif
+#ifndef INDIVI_FLAT_W_SIMD_WIDTH
+  #define INDIVI_FLAT_W_SIMD_WIDTH 16
+#endif
+
+#if INDIVI_FLAT_W_SIMD_WIDTH > 16
+  #include <immintrin.h>
+#elif defined(INDIVI_SIMD_SSE2)
   #include <emmintrin.h>
 #elif defined(INDIVI_SIMD_L_ENDIAN_NEON)
   #include <arm_neon.h>
@@ -53,9 +71,18 @@ namespace detail
  * Metadata functions for group of 16 buckets.
  * SIMD-accelerated, used by `flat_wtable`.
  * Each entry is an 1-Byte hash fragment, or empty/tombstone.
+ * Probing windows can be widened to 32 (AVX2) or 64 (AVX-512BW) buckets,
+ * by defining 'INDIVI_FLAT_W_WIDE_SIMD' (iteration still uses 16-bytes groups).
  */
 namespace MetaWGroup
 {
+  static constexpr std::size_t WIDTH{ INDIVI_FLAT_W_SIMD_WIDTH }; // probing window size
+#if INDIVI_FLAT_W_SIMD_WIDTH == 64
+  using mask_type = uint64_t;
+#else
+  using mask_type = uint32_t;
+#endif
+
   static constexpr uint8_t EMPTY_FRAG{ 0x7F };     // 127
   static constexpr uint8_t TOMBSTONE_FRAG{ 0x7E }; // 126
   static constexpr uint8_t SETMAX_FRAG{ 0x7D };    // 125
@@ -117,49 +144,124 @@ namespace MetaWGroup
   
   static inline uint8_t* empty_group() noexcept
   {
-    // 16+1+1 as mShift is 'sizeof(size_type) - 1' when empty (so index is 0 or 1)
-    // plus a fake sentinel value past end to force stop iteration
+    // WIDTH+1+1 as mShift is 'sizeof(size_type) - 1' when empty (so index is 0 or 1)
+    // plus a fake sentinel value past end to force stop iteration (and padding for its 16-bytes load)
     static constexpr uint8_t sEmptyGroup[]{ // dummy extended group for empty tables
       EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,
       EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,
-      EMPTY_FRAG, SENTINEL_FRAG
+    #if INDIVI_FLAT_W_SIMD_WIDTH >= 32
+      EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,
+      EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,
+    #endif
+    #if INDIVI_FLAT_W_SIMD_WIDTH == 64
+      EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,
+      EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,
+      EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,
+      EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,
+    #endif
+      EMPTY_FRAG, SENTINEL_FRAG,
+      EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,
+      EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG,EMPTY_FRAG
     };
+    static_assert(sizeof(sEmptyGroup) == WIDTH + 16u, "MetaWGroup: invalid empty group size");
     return const_cast<uint8_t*>(sEmptyGroup);
   }
   
+#if INDIVI_FLAT_W_SIMD_WIDTH == 64
+  // Probing window functions (64 buckets)
+  static inline __m512i load_hfrags(const uint8_t* hfrags) noexcept
+  {
+    return _mm512_loadu_si512(reinterpret_cast<const void*>(hfrags));
+  }
+  
+  static inline mask_type match_hfrag(__m512i hfrags, std::size_t hash) noexcept
+  {
+    return _mm512_cmpeq_epi8_mask(hfrags, _mm512_set1_epi32(match_word(hash))); // == hfrag
+  }
+
+  static inline mask_type match_empty(__m512i hfrags) noexcept
+  {
+    return _mm512_cmpeq_epi8_mask(hfrags, _mm512_set1_epi32(EMPTY_FRAGS)); // == empty
+  }
+  
+  static inline mask_type match_empty(const uint8_t* hfrags) noexcept
+  {
+    return _mm512_cmpeq_epi8_mask(load_hfrags(hfrags), _mm512_set1_epi32(EMPTY_FRAGS)); // == empty
+  }
+  
+  static inline mask_type match_available(const uint8_t* hfrags) noexcept
+  {
+    return _mm512_cmpgt_epi8_mask(load_hfrags(hfrags), _mm512_set1_epi32(SETMAX_FRAGS)); // > max set
+  }
+#elif INDIVI_FLAT_W_SIMD_WIDTH == 32
+  // Probing window functions (32 buckets)
+  static inline __m256i load_hfrags(const uint8_t* hfrags) noexcept
+  {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hfrags));
+  }
+  
+  static inline mask_type match_hfrag(__m256i hfrags, std::size_t hash) noexcept
+  {
+    return (mask_type)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(hfrags, _mm256_set1_epi32(match_word(hash)))); // == hfrag
+  }
+
+  static inline mask_type match_empty(__m256i hfrags) noexcept
+  {
+    return (mask_type)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(hfrags, _mm256_set1_epi32(EMPTY_FRAGS))); // == empty
+  }
+  
+  static inline mask_type match_empty(const uint8_t* hfrags) noexcept
+  {
+    return (mask_type)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(load_hfrags(hfrags), _mm256_set1_epi32(EMPTY_FRAGS))); // == empty
+  }
+  
+  static inline mask_type match_available(const uint8_t* hfrags) noexcept
+  {
+    return (mask_type)_mm256_movemask_epi8(
+        _mm256_cmpgt_epi8(load_hfrags(hfrags), _mm256_set1_epi32(SETMAX_FRAGS))); // > max set
+  }
+#endif
+
 #ifdef INDIVI_SIMD_SSE2
+#if INDIVI_FLAT_W_SIMD_WIDTH == 16
   static inline __m128i load_hfrags(const uint8_t* hfrags) noexcept
   {
     return _mm_loadu_si128(reinterpret_cast<const __m128i*>(hfrags));
   }
   
-  static inline int match_hfrag(__m128i hfrags, std::size_t hash) noexcept
+  static inline mask_type match_hfrag(__m128i hfrags, std::size_t hash) noexcept
   {
-    return _mm_movemask_epi8(
+    return (mask_type)_mm_movemask_epi8(
         _mm_cmpeq_epi8(hfrags, _mm_set1_epi32(match_word(hash)))); // == hfrag
   }
 
-  static inline int match_empty(__m128i hfrags) noexcept
+  static inline mask_type match_empty(__m128i hfrags) noexcept
   {
-    return _mm_movemask_epi8(
+    return (mask_type)_mm_movemask_epi8(
         _mm_cmpeq_epi8(hfrags, _mm_set1_epi32(EMPTY_FRAGS))); // == empty
   }
   
-  static inline int match_empty(const uint8_t* hfrags) noexcept
+  static inline mask_type match_empty(const uint8_t* hfrags) noexcept
   {
-    return _mm_movemask_epi8(
+    return (mask_type)_mm_movemask_epi8(
         _mm_cmpeq_epi8(load_hfrags(hfrags), _mm_set1_epi32(EMPTY_FRAGS))); // == empty
   }
   
-  static inline int match_available(const uint8_t* hfrags) noexcept
+  static inline mask_type match_available(const uint8_t* hfrags) noexcept
   {
-    return _mm_movemask_epi8(
+    return (mask_type)_mm_movemask_epi8(
         _mm_cmpgt_epi8(load_hfrags(hfrags), _mm_set1_epi32(SETMAX_FRAGS))); // > max set
   }
+#endif
+  // Iteration function (16 buckets)
   static inline int match_set(const uint8_t* hfrags) noexcept
   {
     return _mm_movemask_epi8(
-        _mm_cmplt_epi8(load_hfrags(hfrags), _mm_set1_epi32(TOMBSTONE_FRAGS))); // < tombstone
+        _mm_cmplt_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hfrags)),
+                       _mm_set1_epi32(TOMBSTONE_FRAGS))); // < tombstone
   }
 #else // NEON
   static inline int mm_movemask_epi8(uint8x16_t v) noexcept
@@ -187,27 +289,27 @@ namespace MetaWGroup
     return vld1q_s8(reinterpret_cast<const int8_t*>(hfrags));
   }
   
-  static inline int match_hfrag(int8x16_t hfrags, std::size_t hash) noexcept
+  static inline mask_type match_hfrag(int8x16_t hfrags, std::size_t hash) noexcept
   {
-    return mm_movemask_epi8(
+    return (mask_type)mm_movemask_epi8(
         vceqq_s8(hfrags, vdupq_n_s8((int8_t)match_word(hash))));
   }
   
-  static inline int match_empty(int8x16_t hfrags) noexcept
+  static inline mask_type match_empty(int8x16_t hfrags) noexcept
   {
-    return mm_movemask_epi8(
+    return (mask_type)mm_movemask_epi8(
         vceqq_s8(hfrags, vdupq_n_s8((int8_t)EMPTY_FRAG)));
   }
   
-  static inline int match_empty(const uint8_t* hfrags) noexcept
+  static inline mask_type match_empty(const uint8_t* hfrags) noexcept
   {
-    return mm_movemask_epi8(
+    return (mask_type)mm_movemask_epi8(
         vceqq_s8(load_hfrags(hfrags), vdupq_n_s8((int8_t)EMPTY_FRAG)));
   }
   
-  static inline int match_available(const uint8_t* hfrags) noexcept
+  static inline mask_type match_available(const uint8_t* hfrags) noexcept
   {
-    return mm_movemask_epi8(
+    return (mask_type)mm_movemask_epi8(
         vcgtq_s8(load_hfrags(hfrags), vdupq_n_s8((int8_t)SETMAX_FRAG))); // > max set
   }
   static inline int match_set(const uint8_t* hfrags) noexcept
@@ -225,7 +327,7 @@ namespace MetaWGroup
     uint8_t hfrag = (uint8_t)match_word(hash);
     bool wasTombstone = groups[index] == TOMBSTONE_FRAG;
     groups[index] = hfrag;
-    std::size_t extra = (index >= 15) ? 0u : mask + 1; // sync first group duplicate at end
+    std::size_t extra = (index >= WIDTH - 1u) ? 0u : mask + 1; // sync first group duplicate at end
     groups[index + extra] = hfrag;
     return wasTombstone;
   }
@@ -237,21 +339,37 @@ namespace MetaWGroup
     INDIVI_WTABLE_ASSERT(index <= mask);
     INDIVI_WTABLE_ASSERT((int8_t)groups[index] < TOMBSTONE_FRAG);
     
-    std::size_t leftIdx = (index - 16u) & mask;
-    int leftEmpties = match_empty(groups + leftIdx); // not including self
-    int rightEmpties = match_empty(groups + index);  // including self
-    leftEmpties  |= 0x01;    // force first bit so not zero for clz
-    rightEmpties |= 0x10000; // force 17th bit so not zero for ctz
-    int leftNSize = last_bit_index(leftEmpties);   // before self (in [15,0])
-    int rightSize = first_bit_index(rightEmpties); // after and including self (in [1,16])
-    bool needTombstone = rightSize > leftNSize; // simplification of 'rightSize + (15 - leftNSize) >= 16'
+    std::size_t leftIdx = (index - WIDTH) & mask;
+    mask_type leftEmpties = match_empty(groups + leftIdx); // not including self
+    mask_type rightEmpties = match_empty(groups + index);  // including self
+    leftEmpties |= 0x01; // force first bit so not zero for clz
+    int leftNSize = last_bit_index(leftEmpties); // before self (in [WIDTH-1,0])
+    int rightSize = rightEmpties ? first_bit_index(rightEmpties) : (int)WIDTH; // after and including self (in [1,WIDTH])
+    bool needTombstone = rightSize > leftNSize; // simplification of 'rightSize + (WIDTH-1 - leftNSize) >= WIDTH'
     
     uint8_t val = needTombstone ? TOMBSTONE_FRAG : EMPTY_FRAG;
     groups[index] = val;
-    std::size_t extra = (index >= 15) ? 0u : mask + 1; // sync first group duplicate at end
+    std::size_t extra = (index >= WIDTH - 1u) ? 0u : mask + 1; // sync first group duplicate at end
     groups[index + extra] = val;
     return needTombstone;
   }
+
+  static inline void set_empty(uint8_t* groups, std::size_t index, std::size_t mask) noexcept
+  {
+    INDIVI_WTABLE_ASSERT(index <= mask);
+    groups[index] = EMPTY_FRAG;
+    std::size_t extra = (index >= WIDTH - 1u) ? 0u : mask + 1; // sync first group duplicate at end
+    groups[index + extra] = EMPTY_FRAG;
+  }
+
+  // Before in-place purge: set entries become tombstones (i.e. to be re-placed) and tombstones become empty
+  static inline void mark_for_purge(uint8_t* groups, std::size_t mask) noexcept
+  {
+    std::size_t capa = mask + 1u;
+    for (std::size_t i = 0u; i < capa; ++i)
+      groups[i] = ((int8_t)groups[i] < (int8_t)TOMBSTONE_FRAG) ? TOMBSTONE_FRAG : EMPTY_FRAG;
+    std::memcpy(groups + capa, groups, (capa < WIDTH - 1u) ? capa : WIDTH - 1u); // sync first group duplicate at end
+  }
 };
 
 /*
@@ -264,7 +382,8 @@ template<
   class item_type,
   class size_type,
   class Hash,
-  class KeyEqual >
+  class KeyEqual,
+  class Allocator >
 class flat_wtable
 {
 public:
@@ -273,24 +392,42 @@ public:
   using difference_type = typename std::make_signed<size_type>::type;
   using hasher = Hash;
   using key_equal = KeyEqual;
+  using allocator_type = Allocator;
   using iter_reference = typename std::conditional<std::is_same<key_type, value_type>::value, const key_type&, value_type&>::type;
   using iter_const_reference = const value_type&; // for flat_wset, iter_reference is also const
   using iter_pointer = value_type*;
   using iter_const_pointer = const value_type*;
+  using node_type = flat_node<Key, T, value_type, item_type, Hash>;
 
 private:
   using init_type = item_type;
   using insert_type = std::pair<typename std::remove_const<Key>::type, const mapped_type>;
   using storage_type = typename std::aligned_storage<sizeof(item_type), alignof(item_type)>::type;
-  using mixer = typename std::conditional<hash_is_avalanching<Hash>::value, no_mix, bit_mix>::type;
-
-  static constexpr float MAX_LOAD_FACTOR{ 0.8f };
+  using storage_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<storage_type>;
+  using storage_traits = std::allocator_traits<storage_allocator>;
+  using mixer = hash_mixer<Hash>;
+  using stored_type = typename std::conditional<hash_is_32bits<Hash>::value, uint32_t, std::size_t>::type; // see `hashes_of`
+
+  static constexpr float MAX_LOAD_FACTOR{ 0.8f };        // default (see `max_load_factor(float)`)
+  static constexpr float MAX_LOAD_FACTOR_LOW{ 0.25f };   // runtime setting range
+  static constexpr float MAX_LOAD_FACTOR_HIGH{ 0.95f };  // (always keep empty slots for probing to stop)
+  static constexpr unsigned int MAX_GROWTH_SHIFT{ 8u };  // i.e. growth factor up to 256
+  static constexpr float MIN_LOAD_FACTOR_HIGH{ 0.25f };  // max of runtime setting (see `min_load_factor(float)`)
   static constexpr unsigned int MIN_CAPA{ 2u };
+  static constexpr unsigned int BATCH_SIZE{ 16u }; // number of interleaved probes in batched lookup
+  static constexpr bool BATCH_HASH{ hash_has_batch<Hash, Key>::value }; // hasher provides batched hashing
+  static constexpr unsigned int PARALLEL_MIN_PART{ 1u << 15 }; // min number of entries per thread in parallel rehash
+  static constexpr bool STORED_HASH{ hash_is_stored<Hash>::value }; // full hashes stored after groups
+  static constexpr bool SHARED_HASH{ std::is_empty<Hash>::value }; // stateless hasher, same hashes in all tables (see `flat_node`)
+  static constexpr bool PURGE_IN_PLACE{ std::is_nothrow_move_constructible<item_type>::value // see `purge_tombstones()`
+                                        && (STORED_HASH || noexcept(std::declval<const Hash&>()(std::declval<const Key&>()))) };
   static constexpr size_type EMPTY_SHIFT{ sizeof(size_type) * CHAR_BIT - 1u };
 
   static constexpr bool is_pow2(std::size_t v)  noexcept { return (v & (v - 1)) == 0u; }
 
   static_assert(MAX_LOAD_FACTOR > 0.f && MAX_LOAD_FACTOR < 1.f, "flat_wtable: MAX_LOAD_FACTOR must be > 0 and < 1");
+  static_assert(MAX_LOAD_FACTOR_LOW <= MAX_LOAD_FACTOR && MAX_LOAD_FACTOR <= MAX_LOAD_FACTOR_HIGH && MAX_LOAD_FACTOR_HIGH < 1.f,
+                "flat_wtable: MAX_LOAD_FACTOR must be in runtime range, and range < 1");
   static_assert(MIN_CAPA >= 2u, "flat_wtable: MIN_CAPA must be >= 2");
   static_assert(is_pow2(MIN_CAPA), "flat_wtable: MIN_CAPA must be a power of 2");
 
@@ -310,6 +447,9 @@ private:
   };
   mutable MFindStats mStats;
 #endif
+#ifdef INDIVI_FLAT_W_TELEMETRY
+  flat_telemetry_counters mTelemetry; // see `get_telemetry()`
+#endif
 
   struct Location
   {
@@ -331,18 +471,20 @@ private:
     Hash&& hash_move() noexcept { return std::move(hash()); }
   };
 
-  struct Values : KeyEqual // empty base optim
+  struct Values : KeyEqual, storage_allocator // empty base optim
   {
     item_type* data = nullptr;
 
-    Values(const KeyEqual& equal) : KeyEqual(equal) {}
-    Values(const Values& values) : KeyEqual(values) {}
-    Values(Values&& values) noexcept(std::is_nothrow_move_constructible<KeyEqual>::value)
-      : KeyEqual(std::move(values.equal_move())), data(values.data) {}
+    Values(const KeyEqual& equal, const storage_allocator& alloc) : KeyEqual(equal), storage_allocator(alloc) {}
+    Values(Values&& values) noexcept(std::is_nothrow_move_constructible<KeyEqual>::value
+                                     && std::is_nothrow_move_constructible<storage_allocator>::value)
+      : KeyEqual(std::move(values.equal_move())), storage_allocator(std::move(values.alloc())), data(values.data) {}
 
     KeyEqual& equal() noexcept { return *this; }
     const KeyEqual& equal() const noexcept { return *this; }
     KeyEqual&& equal_move() noexcept { return std::move(equal()); }
+    storage_allocator& alloc() noexcept { return *this; }
+    const storage_allocator& alloc() const noexcept { return *this; }
 
     value_type* cdata() const noexcept { return reinterpret_cast<value_type*>(data); }
   };
@@ -352,6 +494,9 @@ private:
   size_type mShift   = EMPTY_SHIFT; // hash shift to keep highest bits (as location index)
   size_type mGMask   = 0u;          // group index mask (as power-of-2 capacity - 1)
   size_type mMaxSize = 0u;          // max size before rehash is needed
+  float mMaxLoadFactor = MAX_LOAD_FACTOR;
+  uint8_t mGrowthShift = 1u;        // log2 of growth factor
+  uint16_t mMinLoad = 0u;           // min load factor (in 1/65536), 0 if auto downsizing is disabled
   Groups mGroups;                   // contains hash fragments (processed as 16-bytes groups)
   Values mValues;                   // contains key-mapped pairs (matching mGroups entries)
 
@@ -360,6 +505,8 @@ private:
   const Hash& hash() const noexcept { return mGroups.hash(); }
   KeyEqual& equal() noexcept { return mValues.equal(); }
   const KeyEqual& equal() const noexcept { return mValues.equal(); }
+  storage_allocator& alloc() noexcept { return mValues.alloc(); }
+  const storage_allocator& alloc() const noexcept { return mValues.alloc(); }
 
 public:
   template <typename Pointer, typename Reference>
@@ -421,7 +568,7 @@ public:
       }
       while (mSets == 0);
 
-      INDIVI_WTABLE_ASSERT(mValue <= mValueLast + 16);
+      INDIVI_WTABLE_ASSERT(mValue <= mValueLast + MetaWGroup::WIDTH);
       INDIVI_PREFETCH(mValue);
       int idx = first_bit_index(mSets);
       mGroup += idx;
@@ -463,20 +610,40 @@ public:
   using iterator = Iterator<iter_pointer, iter_reference>;
   using const_iterator = Iterator<iter_const_pointer, iter_const_reference>;
 
+  struct insert_return_type
+  {
+    iterator position;
+    bool inserted;
+    node_type node;
+  };
+
+private:
+  // Heterogeneous lookup (if both Hash and KeyEqual define 'is_transparent')
+  template< class K, class R >
+  using if_transparent = typename std::enable_if<traits::are_transparent<K, Hash, KeyEqual>::value, R>::type;
+  // Same, excluding keys and iterators (for overloads taking a forwarding reference)
+  template< class K, class R >
+  using if_transparent_key = typename std::enable_if<
+    traits::are_transparent<K, Hash, KeyEqual>::value && !traits::is_similar<K, Key>::value
+      && !std::is_convertible<K, iterator>::value && !std::is_convertible<K, const_iterator>::value, R>::type;
+
+public:
   // Ctr/Dtr
   flat_wtable() : flat_wtable(0)
   {}
 
-  explicit flat_wtable(size_type bucket_count, const Hash& hash = Hash(), const key_equal& equal = key_equal())
+  explicit flat_wtable(size_type bucket_count, const Hash& hash = Hash(), const key_equal& equal = key_equal(),
+                       const allocator_type& alloc = allocator_type())
     : mGroups(hash)
-    , mValues(equal)
+    , mValues(equal, storage_allocator(alloc))
   {
     rehash(bucket_count);
   }
 
   template< class InputIt >
-  flat_wtable(InputIt first, InputIt last, size_type bucket_count = 0, const Hash& hash = Hash(), const key_equal& equal = key_equal())
-    : flat_wtable(bucket_count, hash, equal)
+  flat_wtable(InputIt first, InputIt last, size_type bucket_count = 0, const Hash& hash = Hash(), const key_equal& equal = key_equal(),
+              const allocator_type& alloc = allocator_type())
+    : flat_wtable(bucket_count, hash, equal, alloc)
   {
     try {
       insert(first, last);
@@ -487,13 +654,21 @@ public:
     }
   }
 
-  flat_wtable(const std::initializer_list<value_type>& init, size_type bucket_count = 0, const Hash& hash = Hash(), const key_equal& equal = key_equal())
-    : flat_wtable(init.begin(), init.end(), bucket_count, hash, equal)
+  flat_wtable(const std::initializer_list<value_type>& init, size_type bucket_count = 0, const Hash& hash = Hash(), const key_equal& equal = key_equal(),
+              const allocator_type& alloc = allocator_type())
+    : flat_wtable(init.begin(), init.end(), bucket_count, hash, equal, alloc)
   {}
 
   flat_wtable(const flat_wtable& other)
-    : mGroups(other.mGroups)
-    , mValues(other.mValues)
+    : flat_wtable(other, allocator_type(storage_traits::select_on_container_copy_construction(other.alloc())))
+  {}
+
+  flat_wtable(const flat_wtable& other, const allocator_type& alloc)
+    : mMaxLoadFactor(other.mMaxLoadFactor)
+    , mGrowthShift(other.mGrowthShift)
+    , mMinLoad(other.mMinLoad)
+    , mGroups(other.mGroups)
+    , mValues(other.equal(), storage_allocator(alloc))
   {
     copy_content(other);
   }
@@ -504,6 +679,9 @@ public:
     , mShift(other.mShift)
     , mGMask(other.mGMask)
     , mMaxSize(other.mMaxSize)
+    , mMaxLoadFactor(other.mMaxLoadFactor)
+    , mGrowthShift(other.mGrowthShift)
+    , mMinLoad(other.mMinLoad)
     , mGroups(std::move(other.mGroups))
     , mValues(std::move(other.mValues))
   {
@@ -515,6 +693,16 @@ public:
     other.mValues.data = nullptr;
   }
 
+  flat_wtable(flat_wtable&& other, const allocator_type& alloc)
+    : flat_wtable(0, other.hash(), other.equal(), alloc)
+  {
+    copy_policy(other);
+    if (this->alloc() == other.alloc())
+      swap_content(other);
+    else
+      move_content(other);
+  }
+
   ~flat_wtable()
   {
     destroy();
@@ -526,18 +714,32 @@ public:
     if (this != std::addressof(other))
     {
       clear();
+      copy_assign_alloc(other);
 
       hash()  = other.hash();
       equal() = other.equal(); // if this throws, state might be inconsistent
 
+      copy_policy(other);
       copy_content(other);
     }
   }
 
-  void operator=(flat_wtable&& other) noexcept(std::is_nothrow_move_assignable<Hash>::value && std::is_nothrow_move_assignable<KeyEqual>::value)
+  void operator=(flat_wtable&& other) noexcept(std::is_nothrow_move_assignable<Hash>::value && std::is_nothrow_move_assignable<KeyEqual>::value
+                                               && storage_traits::propagate_on_container_move_assignment::value
+                                               && std::is_nothrow_move_assignable<storage_allocator>::value)
   {
     if (this != std::addressof(other))
     {
+      if (!storage_traits::propagate_on_container_move_assignment::value && alloc() != other.alloc())
+      {
+        // cannot steal storage: move items one by one
+        clear();
+        hash()  = std::move(other.hash());
+        equal() = std::move(other.equal()); // if this throws, state might be inconsistent
+        copy_policy(other);
+        move_content(other);
+        return;
+      }
       destroy();
       mSize = 0u;
       mShift = EMPTY_SHIFT;
@@ -548,6 +750,8 @@ public:
 
       hash()  = std::move(other.hash());
       equal() = std::move(other.equal()); // if this throws, state might be inconsistent
+      move_assign_alloc(other);
+      copy_policy(other);
 
       mSize = other.mSize;
       mShift = other.mShift;
@@ -584,10 +788,49 @@ public:
 
   // Hash policy
   float load_factor() const noexcept { return mSize ? (float)mSize / bucket_count() : mSize; }
-  float max_load_factor() const noexcept { return MAX_LOAD_FACTOR; }
-  void max_load_factor(float) noexcept { /*for compatibility*/ }
+  float max_load_factor() const noexcept { return mMaxLoadFactor; }
+  // Clamped to [0.25, 0.95], rehash if size exceeds new threshold (applies from 32 buckets, see `capa_to_maxsize`)
+  void max_load_factor(float ml)
+  {
+    float prevLoadFactor = mMaxLoadFactor;
+    mMaxLoadFactor = (ml < MAX_LOAD_FACTOR_LOW) ? MAX_LOAD_FACTOR_LOW : (ml > MAX_LOAD_FACTOR_HIGH) ? MAX_LOAD_FACTOR_HIGH : ml;
+    if (bucket_count() > 16u)
+    {
+      // keep tombstones drift
+      size_type prevMaxSize = capa_to_maxsize(bucket_count(), prevLoadFactor);
+      size_type drift = (prevMaxSize > mMaxSize) ? prevMaxSize - mMaxSize : 0u;
+      size_type maxSize = capa_to_maxsize(bucket_count(), mMaxLoadFactor);
+      mMaxSize = (maxSize > drift) ? maxSize - drift : 0u;
+      if (mSize > mMaxSize)
+      {
+        size_type minCapa = (size_type)std::ceil((float)mSize / mMaxLoadFactor);
+        rehash_impl(std::max(bucket_count(), round_up_pow2(minCapa))); // also clear tombstones
+      }
+    }
+  }
+  // non-standard, capacity multiplier when full (power of 2, default 2)
+  size_type growth_factor() const noexcept { return size_type(1u) << mGrowthShift; }
+  // Rounded up to a power of 2, clamped to [2, 256]
+  void growth_factor(size_type factor) noexcept
+  {
+    mGrowthShift = 1u;
+    while (mGrowthShift < MAX_GROWTH_SHIFT && (size_type(1u) << mGrowthShift) < factor)
+      ++mGrowthShift;
+  }
+  // non-standard, auto downsizing threshold (0 if disabled, default)
+  float min_load_factor() const noexcept { return (float)mMinLoad / 65536.f; }
+  // Clamped to [0, 0.25], applied by next erase by key (see `erase(const Key&)`)
+  void min_load_factor(float ml) noexcept
+  {
+    ml = !(ml > 0.f) ? 0.f : (ml > MIN_LOAD_FACTOR_HIGH) ? MIN_LOAD_FACTOR_HIGH : ml;
+    mMinLoad = (uint16_t)std::ceil(ml * 65536.f);
+  }
+  // non-standard, size at which next insertion triggers a rehash
+  size_type rehash_threshold() const noexcept { return mMaxSize; }
 
-  void rehash(size_type count)
+  // non-standard 'threadCount': move elements on up to 'threadCount' threads (large tables with nothrow move-constructible items only)
+  // in this case, hasher must not throw and be safe to call concurrently
+  void rehash(size_type count, unsigned int threadCount = 1u)
   {
     INDIVI_WTABLE_ASSERT(count <= max_size());
     size_type minCapa = (size_type)std::ceil((float)size() / max_load_factor());
@@ -599,7 +842,7 @@ public:
       count += (count == 8 || count == 16); // avoid full single group issue
       count = round_up_pow2(count);
       if (count != bucket_count())
-        rehash_impl(count);
+        rehash_impl(count, threadCount);
     }
     else
     {
@@ -613,16 +856,33 @@ public:
     }
   }
 
-  void reserve(size_type count)
+  // non-standard, same as `rehash(0)`: smallest capacity for current size (free storage if empty)
+  void shrink_to_fit(unsigned int threadCount = 1u) { rehash(0u, threadCount); }
+
+  // non-standard, remove all tombstones in place (no reallocation, same capacity)
+  // also done instead of growing when inserting at steady size with many tombstones (over 1/8 of max size)
+  // fall back to a reallocating rehash if items are not nothrow move-constructible, or hasher may throw (without stored hash)
+  void purge_tombstones()
+  {
+    if (!mValues.data)
+      return;
+    if (PURGE_IN_PLACE)
+      purge_in_place();
+    else
+      rehash_impl(bucket_count());
+  }
+
+  void reserve(size_type count, unsigned int threadCount = 1u)
   {
     INDIVI_WTABLE_ASSERT(count <= max_size());
     count = (count >= 16) ? (size_type)std::ceil((float)count / max_load_factor()) : count;
-    rehash(count);
+    rehash(count, threadCount);
   }
 
   // Obervers
   hasher hash_function() const { return hash(); }
   key_equal key_eq() const { return equal(); }
+  allocator_type get_allocator() const noexcept { return allocator_type(alloc()); }
 
   // Lookup
   mapped_type& at(const Key& key)
@@ -647,6 +907,30 @@ public:
   
     return loc.value->second;
   }
+  template< class K >
+  if_transparent<K, mapped_type&> at(const K& key)
+  {
+    std::size_t hash = get_hash(key);
+    size_type gIndex = hash_position(hash, mShift);
+
+    Location loc = find_impl(hash, gIndex, key);
+    if (!loc.value)
+      throw std::out_of_range("flat_wtable::at");
+  
+    return loc.value->second;
+  }
+  template< class K >
+  if_transparent<K, const mapped_type&> at(const K& key) const
+  {
+    std::size_t hash = get_hash(key);
+    size_type gIndex = hash_position(hash, mShift);
+
+    Location loc = find_impl(hash, gIndex, key);
+    if (!loc.value)
+      throw std::out_of_range("flat_wtable::at");
+  
+    return loc.value->second;
+  }
 
   mapped_type& operator[](const Key& key)
   {
@@ -661,6 +945,11 @@ public:
   {
     return contains(key);
   }
+  template< class K >
+  if_transparent<K, size_type> count(const K& key) const
+  {
+    return contains(key);
+  }
 
   bool contains(const Key& key) const
   {
@@ -670,6 +959,15 @@ public:
     Location loc = find_impl(hash, gIndex, key);
     return loc.value != nullptr;
   }
+  template< class K >
+  if_transparent<K, bool> contains(const K& key) const
+  {
+    std::size_t hash = get_hash(key);
+    size_type gIndex = hash_position(hash, mShift);
+
+    Location loc = find_impl(hash, gIndex, key);
+    return loc.value != nullptr;
+  }
 
   iterator find(const Key& key)
   {
@@ -687,6 +985,66 @@ public:
     Location loc = find_impl(hash, gIndex, key);
     return as_const_iter(loc);
   }
+  template< class K >
+  if_transparent<K, iterator> find(const K& key)
+  {
+    std::size_t hash = get_hash(key);
+    size_type gIndex = hash_position(hash, mShift);
+
+    Location loc = find_impl(hash, gIndex, key);
+    return as_iter(loc);
+  }
+  template< class K >
+  if_transparent<K, const_iterator> find(const K& key) const
+  {
+    std::size_t hash = get_hash(key);
+    size_type gIndex = hash_position(hash, mShift);
+
+    Location loc = find_impl(hash, gIndex, key);
+    return as_const_iter(loc);
+  }
+
+  // non-standard, batched lookup (interleave probes to hide cache misses)
+  void find_batch(const Key* keys, size_type count, iterator* out)
+  {
+    find_batch_impl(keys, count, [&](size_type i, const Location& loc) {
+      out[i] = as_iter(loc);
+    });
+  }
+  void find_batch(const Key* keys, size_type count, const_iterator* out) const
+  {
+    find_batch_impl(keys, count, [&](size_type i, const Location& loc) {
+      out[i] = as_const_iter(loc);
+    });
+  }
+
+  void contains_batch(const Key* keys, size_type count, bool* out) const
+  {
+    find_batch_impl(keys, count, [&](size_type i, const Location& loc) {
+      out[i] = loc.value != nullptr;
+    });
+  }
+
+  // non-standard, prehashed interface (hash computed once by caller, e.g. for sharding)
+  // 'hash' must be the result of 'hash_key(key)'
+  template< class K >
+  std::size_t hash_key(const K& key) const
+  {
+    return get_hash(key);
+  }
+
+  template< class K >
+  iterator find_hashed(const K& key, std::size_t hash)
+  {
+    Location loc = find_impl(hash, hash_position(hash, mShift), key);
+    return as_iter(loc);
+  }
+  template< class K >
+  const_iterator find_hashed(const K& key, std::size_t hash) const
+  {
+    Location loc = find_impl(hash, hash_position(hash, mShift), key);
+    return as_const_iter(loc);
+  }
 
   // Modifiers
   void clear() noexcept
@@ -699,10 +1057,10 @@ public:
       });
       
       size_type capa = mGMask + 1u;
-      std::memset((void*)mGroups.data, MetaWGroup::EMPTY_FRAG, sizeof(uint8_t) * (capa + 15u)); // for extra group, not including sentinel
-      INDIVI_WTABLE_ASSERT(mGroups.data[sizeof(uint8_t) * (capa + 15u)] == MetaWGroup::SENTINEL_FRAG);
+      std::memset((void*)mGroups.data, MetaWGroup::EMPTY_FRAG, sizeof(uint8_t) * (capa + MetaWGroup::WIDTH - 1u)); // for extra group, not including sentinel
+      INDIVI_WTABLE_ASSERT(mGroups.data[sizeof(uint8_t) * (capa + MetaWGroup::WIDTH - 1u)] == MetaWGroup::SENTINEL_FRAG);
       mSize = 0u;
-      mMaxSize = capa_to_maxsize(capa);
+      mMaxSize = capa_to_maxsize(capa, mMaxLoadFactor);
     }
   }
 
@@ -724,6 +1082,52 @@ public:
       emplace(*first);
   }
 
+  // non-standard, bulk insertion of elements with unique keys (unchecked: keys must not be in table nor duplicated in range)
+  // pre-size exactly, then hash keys by batch and prefetch their target before inserting (i.e. interleaved memory accesses)
+  template< class ForwardIt >
+  void insert_unique_range(ForwardIt first, ForwardIt last)
+  {
+    using iter_value = typename std::iterator_traits<ForwardIt>::value_type;
+    using iter_category = typename std::iterator_traits<ForwardIt>::iterator_category;
+    static_assert(std::is_base_of<std::forward_iterator_tag, iter_category>::value,
+                  "flat_wtable: insert_unique_range requires forward iterators");
+    static_assert(std::is_same<iter_value, value_type>::value || std::is_same<iter_value, item_type>::value,
+                  "flat_wtable: insert_unique_range requires value_type elements");
+
+    size_type count = (size_type)std::distance(first, last);
+    if (count == 0u)
+      return;
+    if (mSize + count > mMaxSize) // only grow (keep reserved capacity)
+      reserve(mSize + count);
+    if (mSize + count > mMaxSize) // with tombstones
+      purge_tombstones();
+
+    // contiguous keys (i.e. set from pointers) hashed by hasher batch, if provided
+    using batch_keys = std::integral_constant<bool, BATCH_HASH && std::is_pointer<ForwardIt>::value && std::is_same<iter_value, Key>::value>;
+    std::size_t hashes[BATCH_SIZE];
+    size_type remaining = count;
+    while (remaining)
+    {
+      // hash a batch and prefetch targets
+      size_type batchSize = std::min(remaining, (size_type)BATCH_SIZE);
+      remaining -= batchSize;
+      hash_items(first, batchSize, hashes, batch_keys{});
+      for (size_type i = 0u; i < batchSize; ++i)
+      {
+        size_type index = hash_position(hashes[i], mShift);
+        INDIVI_PREFETCH(&mGroups.data[index]);
+        INDIVI_PREFETCH(&mValues.data[index]);
+      }
+      // insert without duplicate check (targets should be in flight by now)
+      for (size_type i = 0u; i < batchSize; ++i, ++first)
+      {
+        INDIVI_WTABLE_ASSERT(!find_impl(hashes[i], hash_position(hashes[i], mShift), get_key(*first)).value);
+        bool wasTombstone = insert_unique(mGroups.data, mValues.data, mShift, mGMask, hashes[i], *first);
+        mMaxSize += wasTombstone;
+        ++mSize;
+      }
+    }
+  }
   template <typename U>
   typename std::enable_if<
     std::is_same<U, value_type>::value || std::is_same<U, item_type>::value,
@@ -760,79 +1164,427 @@ public:
     return try_insert_impl(std::forward<P>(value));
   }
 
-  template< class... Args >
-  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+  template< class... Args >
+  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+  {
+    return try_emplace_impl(key, std::forward<Args>(args)...);
+  }
+
+  template< class... Args >
+  std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+  {
+    return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+  }
+
+  // key is only constructed if not found
+  template< class K, class... Args >
+  if_transparent_key<K, std::pair<iterator, bool>> try_emplace(K&& key, Args&&... args)
+  {
+    return try_emplace_impl(std::forward<K>(key), std::forward<Args>(args)...);
+  }
+
+  // non-standard, prehashed insertion (see `hash_key()`)
+  template< typename U >
+  std::pair<iterator, bool> insert_hashed(std::size_t hash, U&& value)
+  {
+    size_type gIndex = hash_position(hash, mShift);
+
+    Location loc = find_impl(hash, gIndex, get_key(value));
+    if (loc.value != nullptr) // already exist
+      return {  as_iter(loc), false };
+
+    if (mSize < mMaxSize)
+    {
+      loc = unchecked_insert(hash, gIndex, std::forward<U>(value));
+      return { as_iter(loc), true };
+    }
+    else // need rehash
+    {
+      if (mMaxSize > 0u || mGMask == 0u)
+      {
+        loc = grow_with_insert(hash, std::forward<U>(value));
+        return { as_iter(loc), true };
+      }
+      else // only tombstones
+      {
+        INDIVI_WTABLE_ASSERT(mSize == 0u);
+        clear();
+        loc = unchecked_insert(hash, gIndex, std::forward<U>(value));
+        return { as_iter(loc), true };
+      }
+    }
+  }
+
+  template< typename U, class... Args >
+  std::pair<iterator, bool> try_emplace_hashed(std::size_t hash, U&& key, Args&&... args)
+  {
+    size_type gIndex = hash_position(hash, mShift);
+
+    Location loc = find_impl(hash, gIndex, key);
+    if (loc.value != nullptr) // already exist
+      return { as_iter(loc), false };
+
+    if (mSize < mMaxSize)
+    {
+      loc = unchecked_emplace(hash, gIndex, std::forward<U>(key), std::forward<Args>(args)...);
+      return { as_iter(loc), true };
+    }
+    else // need rehash
+    {
+      if (mMaxSize > 0u || mGMask == 0u)
+      {
+        loc = grow_with_emplace(hash, std::forward<U>(key), std::forward<Args>(args)...);
+        return { as_iter(loc), true };
+      }
+      else // only tombstones
+      {
+        INDIVI_WTABLE_ASSERT(mSize == 0u);
+        clear();
+        loc = unchecked_emplace(hash, gIndex, std::forward<U>(key), std::forward<Args>(args)...);
+        return { as_iter(loc), true };
+      }
+    }
+  }
+
+  iterator erase_(iterator pos)
+  {
+    INDIVI_WTABLE_ASSERT(is_dereferenceable(pos));
+    iterator res = pos;
+    ++res;
+
+    erase_impl(Location{ reinterpret_cast<item_type*>(pos.mValue), (size_type)(reinterpret_cast<item_type*>(pos.mValue) - mValues.data) });
+    return res;
+  }
+  iterator erase_(const_iterator pos)
+  {
+    INDIVI_WTABLE_ASSERT(is_dereferenceable(pos));
+    iterator res = pos;
+    ++res;
+
+    erase_impl(Location{ const_cast<item_type*>(reinterpret_cast<item_type*>(pos.mValue)),
+                        (size_type)(reinterpret_cast<const item_type*>(pos.mValue) - mValues.data) });
+    return res;
+  }
+  // non-standard, see `erase_()`
+  void erase(iterator pos)
+  {
+    INDIVI_WTABLE_ASSERT(is_dereferenceable(pos));
+    erase_impl(Location{ reinterpret_cast<item_type*>(pos.mValue), (size_type)(reinterpret_cast<item_type*>(pos.mValue) - mValues.data) });
+  }
+  void erase(const_iterator pos)
+  {
+    INDIVI_WTABLE_ASSERT(is_dereferenceable(pos));
+    erase_impl(Location{ const_cast<item_type*>(reinterpret_cast<item_type*>(pos.mValue)),
+                        (size_type)(reinterpret_cast<const item_type*>(pos.mValue) - mValues.data) });
+  }
+
+  size_type erase(const Key& key)
+  {
+    std::size_t hash = get_hash(key);
+    size_type gIndex = hash_position(hash, mShift);
+
+    Location loc = find_impl(hash, gIndex, key);
+    if (loc.value)
+    {
+      erase_impl(loc);
+      shrink_on_erase();
+      return 1u;
+    }
+    return 0u;
+  }
+  template< class K >
+  if_transparent_key<K, size_type> erase(K&& key)
+  {
+    std::size_t hash = get_hash(key);
+    size_type gIndex = hash_position(hash, mShift);
+
+    Location loc = find_impl(hash, gIndex, key);
+    if (loc.value)
+    {
+      erase_impl(loc);
+      shrink_on_erase();
+      return 1u;
+    }
+    return 0u;
+  }
+
+  // non-standard, prehashed erase (see `hash_key()`)
+  template< class K >
+  size_type erase_hashed(const K& key, std::size_t hash)
+  {
+    Location loc = find_impl(hash, hash_position(hash, mShift), key);
+    if (loc.value)
+    {
+      erase_impl(loc);
+      shrink_on_erase();
+      return 1u;
+    }
+    return 0u;
+  }
+
+  // Node handle
+  node_type extract(const_iterator pos)
+  {
+    INDIVI_WTABLE_ASSERT(is_dereferenceable(pos));
+    item_type* pValue = const_cast<item_type*>(reinterpret_cast<const item_type*>(pos.mValue));
+
+    node_type node(typename node_type::from_table(), item_hash(pValue), std::move(*pValue));
+    erase_impl(Location{ pValue, (size_type)(pValue - mValues.data) });
+    return node;
+  }
+
+  node_type extract(const Key& key)
+  {
+    std::size_t hash = get_hash(key);
+    Location loc = find_impl(hash, hash_position(hash, mShift), key);
+    if (!loc.value)
+      return node_type();
+
+    node_type node(typename node_type::from_table(), hash, std::move(*loc.value));
+    erase_impl(loc);
+    return node;
+  }
+
+  insert_return_type insert(node_type&& node)
+  {
+    if (node.empty())
+      return { end(), false, node_type() };
+
+    std::size_t hash = (SHARED_HASH && node.hashed()) ? node.hash() : get_hash(get_key(node.item()));
+    std::pair<iterator, bool> res = insert_hashed(hash, std::move(node.item()));
+    if (!res.second) // already exist
+      return { res.first, false, std::move(node) };
+
+    node.reset();
+    return { res.first, true, node_type() };
+  }
+
+  // Move elements from 'source' (same table type), except those with a key already present
+  // Hashes are reused with a stateless hasher (otherwise computed once per element)
+  void merge(flat_wtable& source)
+  {
+    if (&source == this || source.mSize == 0u)
+      return;
+
+    if (mSize == 0u && bucket_count() <= source.bucket_count()
+        && SHARED_HASH && std::is_empty<key_equal>::value && alloc() == source.alloc())
+    {
+      take_all(source);
+      return;
+    }
+
+    source.uc_for_each([&](item_type* pValue) {
+      std::size_t hash = SHARED_HASH ? source.item_hash(pValue) : get_hash(get_key(*pValue));
+      if (insert_hashed(hash, std::move(*pValue)).second) // only moved if inserted
+        source.erase_impl(Location{ pValue, (size_type)(pValue - source.mValues.data) });
+    });
+  }
+
+  // Snapshot (trivially copyable items only, see 'flat_mapped.h')
+  // Write header and storage in native layout (unused value slots zeroed)
+  void save_snapshot(std::ostream& out) const
+  {
+    static_assert(is_snapshot_safe<item_type>::value, "flat_wtable: snapshot requires trivially copyable Key and T");
+    static_assert(alignof(item_type) <= snapshot_header::BLOCK_ALIGN, "flat_wtable: snapshot requires item alignment <= 64");
+
+    snapshot_header header;
+    header.init(snapshot_layout(), sizeof(item_type), alignof(item_type));
+    header.size = mSize;
+    header.shift = mShift;
+    header.gMask = mGMask;
+    header.maxSize = mMaxSize;
+    header.fingerprint = snapshot_fingerprint();
+    header.blockBytes = mValues.data ? snapshot_block_bytes(mGMask + 1u) : 0u;
+
+    snapshot_writer writer(out);
+    writer.write(&header, sizeof(header));
+    writer.pad_to(snapshot_header::BLOCK_OFFSET);
+    if (!mValues.data)
+      return;
+
+    size_type capa = mGMask + 1u;
+    size_type next = 0u;
+    uc_for_each([&](item_type* pValue) {
+      size_type index = (size_type)(pValue - mValues.data);
+      writer.zeros(sizeof(item_type) * (index - next));
+      writer.write(pValue, sizeof(item_type));
+      next = index + 1u;
+    });
+    writer.zeros(sizeof(item_type) * (capa - next));
+
+    size_type groupsCapa = capa + MetaWGroup::WIDTH;
+    writer.write(mGroups.data, sizeof(uint8_t) * groupsCapa + NewStorage::groupsPadding(groupsCapa)); // with sentinel
+    if (STORED_HASH)
+    {
+      writer.pad_to(snapshot_header::BLOCK_OFFSET + snapshot_hashes_offset(capa));
+      writer.write(hashes_of(mGroups.data, mGMask), sizeof(stored_type) * capa);
+    }
+    writer.pad_to(snapshot_header::BLOCK_OFFSET + (std::size_t)header.blockBytes);
+  }
+
+  // Use snapshot storage in place ('data' must be 64-aligned and outlive the table, see `detach_snapshot`)
+  // Table must be empty without storage, only const member functions may be called afterward
+  bool attach_snapshot(const void* data, std::size_t bytes)
+  {
+    INDIVI_WTABLE_ASSERT(!mValues.data);
+    snapshot_header header;
+    if (bytes < snapshot_header::BLOCK_OFFSET)
+      return false;
+    std::memcpy((void*)&header, data, sizeof(header));
+    if (!header.compatible(snapshot_layout(), sizeof(item_type), alignof(item_type)))
+      return false;
+    if (header.blockBytes == 0u) // no storage
+      return header.size == 0u;
+
+    // check consistency (to never read out of bounds)
+    size_type capa = (size_type)header.gMask + 1u;
+    if (capa < MIN_CAPA || !is_pow2(capa) || header.shift != hash_shift(capa)
+        || header.maxSize > capa_to_maxsize(capa, MAX_LOAD_FACTOR_HIGH) || header.size > header.maxSize
+        || header.blockBytes != snapshot_block_bytes(capa) || bytes - snapshot_header::BLOCK_OFFSET < header.blockBytes)
+      return false;
+
+    item_type* values = reinterpret_cast<item_type*>(const_cast<char*>(static_cast<const char*>(data) + snapshot_header::BLOCK_OFFSET));
+    mSize = (size_type)header.size;
+    mShift = (size_type)header.shift;
+    mGMask = (size_type)header.gMask;
+    mMaxSize = (size_type)header.maxSize;
+    mValues.data = values;
+    mGroups.data = reinterpret_cast<uint8_t*>(values + capa);
+
+    if (snapshot_fingerprint() != header.fingerprint) // different hash function
+    {
+      detach_snapshot();
+      return false;
+    }
+    return true;
+  }
+
+  // Release snapshot storage (not deallocated), table is left empty
+  void detach_snapshot() noexcept
   {
-    return try_emplace_impl(key, std::forward<Args>(args)...);
+    mSize = 0u;
+    mShift = EMPTY_SHIFT;
+    mGMask = 0u;
+    mMaxSize = 0u;
+    mGroups.data = MetaWGroup::empty_group();
+    mValues.data = nullptr;
   }
 
-  template< class... Args >
-  std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+  void swap(flat_wtable& other)
+    noexcept(traits::is_nothrow_swappable<Hash>::value && traits::is_nothrow_swappable<key_equal>::value
+             && (!storage_traits::propagate_on_container_swap::value || traits::is_nothrow_swappable<storage_allocator>::value))
   {
-    return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+    using std::swap;
+    swap(hash(),  other.hash());
+    swap(equal(), other.equal());
+    swap_alloc(other, std::integral_constant<bool, storage_traits::propagate_on_container_swap::value>{});
+
+    swap_content(other);
   }
 
-  iterator erase_(iterator pos)
+private:
+  // Take all items of source (merge into empty table), each table keeping its own policies
+  void take_all(flat_wtable& source)
   {
-    INDIVI_WTABLE_ASSERT(is_dereferenceable(pos));
-    iterator res = pos;
-    ++res;
+    float maxLoadFactor = mMaxLoadFactor;
+    uint8_t growthShift = mGrowthShift;
+    uint16_t minLoad = mMinLoad;
 
-    erase_impl(Location{ reinterpret_cast<item_type*>(pos.mValue), (size_type)(reinterpret_cast<item_type*>(pos.mValue) - mValues.data) });
-    return res;
+    swap(source); // also swaps policies
+    source.max_load_factor(mMaxLoadFactor); // max size updated for its new storage
+    source.mGrowthShift = mGrowthShift;
+    source.mMinLoad = mMinLoad;
+    max_load_factor(maxLoadFactor);
+    mGrowthShift = growthShift;
+    mMinLoad = minLoad;
   }
-  iterator erase_(const_iterator pos)
-  {
-    INDIVI_WTABLE_ASSERT(is_dereferenceable(pos));
-    iterator res = pos;
-    ++res;
 
-    erase_impl(Location{ const_cast<item_type*>(reinterpret_cast<item_type*>(pos.mValue)),
-                        (size_type)(reinterpret_cast<const item_type*>(pos.mValue) - mValues.data) });
-    return res;
-  }
-  // non-standard, see `erase_()`
-  void erase(iterator pos)
+  void copy_policy(const flat_wtable& other) noexcept
   {
-    INDIVI_WTABLE_ASSERT(is_dereferenceable(pos));
-    erase_impl(Location{ reinterpret_cast<item_type*>(pos.mValue), (size_type)(reinterpret_cast<item_type*>(pos.mValue) - mValues.data) });
-  }
-  void erase(const_iterator pos)
-  {
-    INDIVI_WTABLE_ASSERT(is_dereferenceable(pos));
-    erase_impl(Location{ const_cast<item_type*>(reinterpret_cast<item_type*>(pos.mValue)),
-                        (size_type)(reinterpret_cast<const item_type*>(pos.mValue) - mValues.data) });
+    mMaxLoadFactor = other.mMaxLoadFactor;
+    mGrowthShift = other.mGrowthShift;
+    mMinLoad = other.mMinLoad;
   }
 
-  size_type erase(const Key& key)
+  // Auto downsizing (see `min_load_factor(float)`), threshold kept below load after growth or shrink (no rehash ping-pong)
+  void shrink_on_erase()
   {
-    std::size_t hash = get_hash(key);
-    size_type gIndex = hash_position(hash, mShift);
-
-    Location loc = find_impl(hash, gIndex, key);
-    if (loc.value)
+    if (mMinLoad && bucket_count() > 16u)
     {
-      erase_impl(loc);
-      return 1u;
+      float minLoad = (float)mMinLoad / 65536.f;
+      float maxLoad = mMaxLoadFactor / (float)(size_type(2u) << mGrowthShift);
+      if ((float)mSize < (float)bucket_count() * ((minLoad < maxLoad) ? minLoad : maxLoad))
+      {
+        try
+        {
+          rehash(0u);
+        }
+        catch (const std::bad_alloc&) {} // best effort, keep current storage
+      }
     }
-    return 0u;
   }
 
-  void swap(flat_wtable& other)
-    noexcept(traits::is_nothrow_swappable<Hash>::value && traits::is_nothrow_swappable<key_equal>::value)
+  void swap_content(flat_wtable& other) noexcept
   {
     using std::swap;
-    swap(hash(),  other.hash());
-    swap(equal(), other.equal());
-
     swap(mSize,        other.mSize);
     swap(mShift,       other.mShift);
     swap(mGMask,       other.mGMask);
     swap(mMaxSize,     other.mMaxSize);
+    swap(mMaxLoadFactor, other.mMaxLoadFactor);
+    swap(mGrowthShift,   other.mGrowthShift);
+    swap(mMinLoad,       other.mMinLoad);
     swap(mGroups.data, other.mGroups.data);
     swap(mValues.data, other.mValues.data);
   }
 
+  template <typename = void>
+  void swap_alloc(flat_wtable& other, std::true_type) // propagate
+  {
+    using std::swap;
+    swap(alloc(), other.alloc());
+  }
+
+  template <typename = void>
+  void swap_alloc(flat_wtable& other, std::false_type) noexcept // no propagate
+  {
+    INDIVI_WTABLE_ASSERT(alloc() == other.alloc());
+    (void)other;
+  }
+
+  void copy_assign_alloc(const flat_wtable& other)
+  {
+    copy_assign_alloc(other, std::integral_constant<bool, storage_traits::propagate_on_container_copy_assignment::value>{});
+  }
+
+  template <typename = void>
+  void copy_assign_alloc(const flat_wtable& other, std::true_type) // propagate
+  {
+    INDIVI_WTABLE_ASSERT(empty());
+    if (alloc() != other.alloc())
+      rehash(0); // release storage with current allocator
+
+    alloc() = other.alloc();
+  }
+
+  template <typename = void>
+  void copy_assign_alloc(const flat_wtable&, std::false_type) noexcept {} // no propagate
+
+  void move_assign_alloc(flat_wtable& other)
+  {
+    move_assign_alloc(other, std::integral_constant<bool, storage_traits::propagate_on_container_move_assignment::value>{});
+  }
+
+  template <typename = void>
+  void move_assign_alloc(flat_wtable& other, std::true_type) noexcept(std::is_nothrow_move_assignable<storage_allocator>::value) // propagate
+  {
+    alloc() = std::move(other.alloc());
+  }
+
+  template <typename = void>
+  void move_assign_alloc(flat_wtable&, std::false_type) noexcept {} // no propagate
+
+public:
   template <typename U>
   typename std::enable_if<
     !std::is_same<typename U::key_type, typename U::init_type>::value,
@@ -881,6 +1633,7 @@ public:
       if (pred(*it))
         erase(it);
     }
+    shrink_on_erase();
     return oldSize - mSize;
   }
 
@@ -890,12 +1643,12 @@ public:
     if (mValues.data)
     {
       auto capa = group_capa();
-      for (size_type i = 0; i < capa + 15u; ++i) // with extra group
+      for (size_type i = 0; i < capa + MetaWGroup::WIDTH - 1u; ++i) // with extra group
       {
         if (mGroups.data[i] != MetaWGroup::EMPTY_FRAG)
           return false;
       }
-      if (mGroups.data[capa + 15u] != MetaWGroup::SENTINEL_FRAG)
+      if (mGroups.data[capa + MetaWGroup::WIDTH - 1u] != MetaWGroup::SENTINEL_FRAG)
         return false;
     }
     return true;
@@ -982,6 +1735,20 @@ public:
     mStats.cmp_miss_max = 0;
   }
 #endif // INDIVI_FLAT_W_STATS
+#ifdef INDIVI_FLAT_W_TELEMETRY
+  flat_telemetry get_telemetry() const noexcept
+  {
+    flat_telemetry telemetry = mTelemetry.get();
+    if (mValues.data) // each tombstone reduces max size (see `erase_impl`)
+    {
+      size_type maxSize = capa_to_maxsize(bucket_count(), mMaxLoadFactor);
+      telemetry.tombstone_ratio = (maxSize > mMaxSize) ? (float)(maxSize - mMaxSize) / bucket_count() : 0.f;
+    }
+    return telemetry;
+  }
+
+  void reset_telemetry() noexcept { mTelemetry.reset(); }
+#endif
 
 private:
   // static functions
@@ -996,9 +1763,9 @@ private:
     return hash >> shift; // keep (64 - n) highest bits
   }
   
-  static inline constexpr size_type capa_to_maxsize(size_type capa) noexcept
+  static inline size_type capa_to_maxsize(size_type capa, float maxLoadFactor) noexcept
   {
-    return (capa > 16) ? (size_type)(capa * MAX_LOAD_FACTOR)
+    return (capa > 16) ? (size_type)(capa * maxLoadFactor)
                : (capa < 8) ? capa : capa - 1u; // force at least one empty in single group
   }
   
@@ -1046,7 +1813,8 @@ private:
   }
 #endif
 
-  std::size_t get_hash(const Key& key) const
+  template< typename K >
+  std::size_t get_hash(const K& key) const
   {
     return mixer::mix(hash(), key);
   }
@@ -1105,6 +1873,59 @@ private:
     while (pGroup < end);
   }
 
+  // Stored hashes (one per item, after groups and padding)
+  // Snapshot layout (storage offsets relative to a 64-aligned block)
+  static uint64_t snapshot_layout() noexcept
+  {
+    return snapshot_header::make_layout('W', MetaWGroup::WIDTH, STORED_HASH ? sizeof(stored_type) : 0u, sizeof(size_type));
+  }
+
+  static std::size_t snapshot_block_bytes(size_type capa) noexcept
+  {
+    return sizeof(item_type) * NewStorage::storageCapa(capa, capa + MetaWGroup::WIDTH);
+  }
+
+  static std::size_t snapshot_hashes_offset(size_type capa) noexcept
+  {
+    std::size_t offset = sizeof(item_type) * capa + capa + MetaWGroup::WIDTH + 15u; // see `hashes_of`
+    return (offset + alignof(stored_type) - 1u) & ~(alignof(stored_type) - 1u);
+  }
+
+  // Hashes of first keys (in storage order), to check hash function consistency
+  uint64_t snapshot_fingerprint() const
+  {
+    uint64_t accu = mSize;
+    unsigned int count = 0u;
+    for (auto it = cbegin(); it != cend() && count < snapshot_header::FINGERPRINT_KEYS; ++it, ++count)
+      accu = detail::snapshot_fingerprint(accu, get_hash(get_key(*it)));
+    return accu;
+  }
+
+  static stored_type* hashes_of(uint8_t* groups, size_type gMask) noexcept
+  {
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(groups + gMask + 1u + MetaWGroup::WIDTH + 15u);
+    addr = (addr + alignof(stored_type) - 1u) & ~(std::uintptr_t)(alignof(stored_type) - 1u);
+    return reinterpret_cast<stored_type*>(addr);
+  }
+
+  static void store_hash(uint8_t* groups, size_type gMask, size_type index, std::size_t hash) noexcept
+  {
+    if (STORED_HASH)
+      hashes_of(groups, gMask)[index] = (stored_type)hash;
+  }
+
+  static std::size_t stored_to_hash(stored_type stored) noexcept
+  {
+    return hash_is_32bits<Hash>::value ? spread32((uint32_t)stored) : (std::size_t)stored;
+  }
+
+  std::size_t item_hash(const item_type* pValue) const
+  {
+    if (STORED_HASH)
+      return stored_to_hash(hashes_of(mGroups.data, mGMask)[pValue - mValues.data]);
+    return get_hash(get_key(*pValue));
+  }
+
   void destroy()
   {
     if (mValues.data)
@@ -1112,7 +1933,7 @@ private:
       uc_for_each([&](item_type* pValue) {
         pValue->~item_type();
       });
-      delete[] reinterpret_cast<storage_type*>(mValues.data);
+      deallocate();
     }
   }
   
@@ -1120,7 +1941,15 @@ private:
   {
     INDIVI_WTABLE_ASSERT(empty());
     if (mValues.data)
-      delete[] reinterpret_cast<storage_type*>(mValues.data);
+      deallocate();
+  }
+
+  void deallocate() noexcept // current storage, items must be destroyed
+  {
+    INDIVI_WTABLE_ASSERT(mValues.data);
+    size_type capa = mGMask + 1u;
+    storage_traits::deallocate(alloc(), reinterpret_cast<storage_type*>(mValues.data),
+                               NewStorage::storageCapa(capa, capa + MetaWGroup::WIDTH));
   }
   
   iterator as_iter(const Location& loc) const noexcept
@@ -1133,31 +1962,41 @@ private:
     return const_iterator(mGroups.data + loc.index, loc.value, mValues.data + mGMask);
   }
   
-  Location find_impl(std::size_t hash, size_type index, const Key& key) const
+  template< typename K >
+  Location find_impl(std::size_t hash, size_type index, const K& key) const
   {
-  #ifdef INDIVI_FLAT_W_STATS
+  #if defined(INDIVI_FLAT_W_STATS) || defined(INDIVI_FLAT_W_TELEMETRY)
     std::size_t probLen = 1;
     std::size_t cmpCount = 0;
   #endif
+  #ifdef INDIVI_FLAT_W_TELEMETRY
+    const bool sampled = flat_telemetry_counters::sample();
+  #endif
   #ifdef INDIVI_FLAT_W_QUAD_PROB
     size_type delta = 0u;
   #endif
+    const stored_type* hashes = hashes_of(mGroups.data, mGMask);
     do {
       const uint8_t* group = &mGroups.data[index];
       auto hfrags = MetaWGroup::load_hfrags(group);
-      int matchs = MetaWGroup::match_hfrag(hfrags, hash);
+      MetaWGroup::mask_type matchs = MetaWGroup::match_hfrag(hfrags, hash);
       if (matchs)
       {
         item_type* pValue = &mValues.data[index];
         INDIVI_PREFETCH(pValue);
         do {
-        #ifdef INDIVI_FLAT_W_STATS
+        #if defined(INDIVI_FLAT_W_STATS) || defined(INDIVI_FLAT_W_TELEMETRY)
           ++cmpCount;
         #endif
           int idx = first_bit_index(matchs);
           size_type valIdx = (index + idx) & mGMask;
-          if (equal()(key, get_key(mValues.data[valIdx]))) // found
+          if ((!STORED_HASH || hashes[valIdx] == (stored_type)hash) // skip key compare on mismatch
+              && equal()(key, get_key(mValues.data[valIdx]))) // found
           {
+          #ifdef INDIVI_FLAT_W_TELEMETRY
+            if (sampled)
+              mTelemetry.record_lookup(true, probLen, cmpCount);
+          #endif
           #ifdef INDIVI_FLAT_W_STATS
             mStats.prob_hit_len += probLen;
             mStats.prob_hit_max = (mStats.prob_hit_max >= probLen) ? mStats.prob_hit_max : probLen;
@@ -1174,6 +2013,10 @@ private:
       // not found
       if (MetaWGroup::match_empty(hfrags))
       {
+      #ifdef INDIVI_FLAT_W_TELEMETRY
+        if (sampled)
+          mTelemetry.record_lookup(false, probLen, cmpCount);
+      #endif
       #ifdef INDIVI_FLAT_W_STATS
         mStats.prob_miss_len += probLen;
         mStats.prob_miss_max = (mStats.prob_miss_max >= probLen) ? mStats.prob_miss_max : probLen;
@@ -1183,11 +2026,11 @@ private:
       #endif
         return { nullptr, 0 };
       }
-    #ifdef INDIVI_FLAT_W_STATS
+    #if defined(INDIVI_FLAT_W_STATS) || defined(INDIVI_FLAT_W_TELEMETRY)
       ++probLen;
     #endif
     #ifdef INDIVI_FLAT_W_QUAD_PROB
-      index = (index + (++delta)*16) & mGMask;
+      index = (index + (++delta)*MetaWGroup::WIDTH) & mGMask;
     #else
       index += prob_delta(hash);
       index &= mGMask;
@@ -1198,6 +2041,54 @@ private:
     return { nullptr, 0 };
   }
 
+  // Hash 'count' items from 'first' (see `insert_unique_range`)
+  template< class ForwardIt >
+  void hash_items(ForwardIt first, size_type count, std::size_t* hashes, std::false_type /*batchKeys*/) const
+  {
+    for (size_type i = 0u; i < count; ++i, ++first)
+      hashes[i] = get_hash(get_key(*first));
+  }
+
+  void hash_items(const Key* keys, size_type count, std::size_t* hashes, std::true_type /*batchKeys*/) const
+  {
+    detail::hash_batch<mixer>(hash(), keys, count, hashes, hash_has_batch<Hash, Key>{});
+  }
+
+  template< typename F >
+  void find_batch_impl(const Key* keys, size_type count, F fct) const
+  {
+    std::size_t hashes[BATCH_SIZE];
+    size_type indexes[BATCH_SIZE];
+
+    for (size_type first = 0u; first < count; first += BATCH_SIZE)
+    {
+      size_type batchSize = std::min(count - first, (size_type)BATCH_SIZE);
+      // hash all (by hasher batch, if provided) and prefetch groups
+      if (BATCH_HASH)
+        detail::hash_batch<mixer>(hash(), keys + first, batchSize, hashes, hash_has_batch<Hash, Key>{});
+      for (size_type i = 0u; i < batchSize; ++i)
+      {
+        if (!BATCH_HASH)
+          hashes[i] = get_hash(keys[first + i]);
+        indexes[i] = hash_position(hashes[i], mShift);
+        INDIVI_PREFETCH(&mGroups.data[indexes[i]]);
+      }
+      // prefetch first matching value slots (groups should be in flight by now)
+      if (mValues.data)
+      {
+        for (size_type i = 0u; i < batchSize; ++i)
+        {
+          MetaWGroup::mask_type matchs = MetaWGroup::match_hfrag(MetaWGroup::load_hfrags(&mGroups.data[indexes[i]]), hashes[i]);
+          if (matchs)
+            INDIVI_PREFETCH(&mValues.data[(indexes[i] + first_bit_index(matchs)) & mGMask]);
+        }
+      }
+      // probe
+      for (size_type i = 0u; i < batchSize; ++i)
+        fct(first + i, find_impl(hashes[i], indexes[i], keys[first + i]));
+    }
+  }
+
   template< typename U >
   Location unchecked_insert(std::size_t hash, size_type index, U&& value)
   {
@@ -1206,7 +2097,7 @@ private:
   #endif
     do {
       const uint8_t* group = &mGroups.data[index];
-      int avails = MetaWGroup::match_available(group);
+      MetaWGroup::mask_type avails = MetaWGroup::match_available(group);
       if (avails) // not full
       {
         int idx = first_bit_index(avails);
@@ -1217,10 +2108,11 @@ private:
         
         bool wasTombstone = MetaWGroup::set_hfrag(mGroups.data, hash, valIdx, mGMask);
         mMaxSize += wasTombstone;
+        store_hash(mGroups.data, mGMask, valIdx, hash);
         return { pValue, valIdx };
       }
     #ifdef INDIVI_FLAT_W_QUAD_PROB
-      index = (index + (++delta)*16) & mGMask;
+      index = (index + (++delta)*MetaWGroup::WIDTH) & mGMask;
     #else
       index += prob_delta(hash);
       index &= mGMask;
@@ -1237,7 +2129,7 @@ private:
   #endif
     do {
       uint8_t* group = &mGroups.data[index];
-      int avails = MetaWGroup::match_available(group);
+      MetaWGroup::mask_type avails = MetaWGroup::match_available(group);
       if (avails) // not full
       {
         int idx = first_bit_index(avails);
@@ -1250,10 +2142,11 @@ private:
 
         bool wasTombstone = MetaWGroup::set_hfrag(mGroups.data, hash, valIdx, mGMask);
         mMaxSize += wasTombstone;
+        store_hash(mGroups.data, mGMask, valIdx, hash);
         return { pValue, valIdx };
       }
     #ifdef INDIVI_FLAT_W_QUAD_PROB
-      index = (index + (++delta)*16) & mGMask;
+      index = (index + (++delta)*MetaWGroup::WIDTH) & mGMask;
     #else
       index += prob_delta(hash);
       index &= mGMask;
@@ -1276,64 +2169,14 @@ private:
   std::pair<iterator, bool> try_insert_impl(U&& value)
   {
     std::size_t hash = get_hash(get_key(value));
-    size_type gIndex = hash_position(hash, mShift);
-
-    Location loc = find_impl(hash, gIndex, get_key(value));
-    if (loc.value != nullptr) // already exist
-      return {  as_iter(loc), false };
-
-    if (mSize < mMaxSize)
-    {
-      loc = unchecked_insert(hash, gIndex, std::forward<U>(value));
-      return { as_iter(loc), true };
-    }
-    else // need rehash
-    {
-      if (mMaxSize > 0u || mGMask == 0u)
-      {
-        loc = grow_with_insert(hash, std::forward<U>(value));
-        return { as_iter(loc), true };
-      }
-      else // only tombstones
-      {
-        INDIVI_WTABLE_ASSERT(mSize == 0u);
-        clear();
-        loc = unchecked_insert(hash, gIndex, std::forward<U>(value));
-        return { as_iter(loc), true };
-      }
-    }
+    return insert_hashed(hash, std::forward<U>(value));
   }
 
   template< typename U, class... Args >
   std::pair<iterator, bool> try_emplace_impl(U&& key, Args&&... args)
   {
     std::size_t hash = get_hash(key);
-    size_type gIndex = hash_position(hash, mShift);
-
-    Location loc = find_impl(hash, gIndex, key);
-    if (loc.value != nullptr) // already exist
-      return { as_iter(loc), false };
-
-    if (mSize < mMaxSize)
-    {
-      loc = unchecked_emplace(hash, gIndex, std::forward<U>(key), std::forward<Args>(args)...);
-      return { as_iter(loc), true };
-    }
-    else // need rehash
-    {
-      if (mMaxSize > 0u || mGMask == 0u)
-      {
-        loc = grow_with_emplace(hash, std::forward<U>(key), std::forward<Args>(args)...);
-        return { as_iter(loc), true };
-      }
-      else // only tombstones
-      {
-        INDIVI_WTABLE_ASSERT(mSize == 0u);
-        clear();
-        loc = unchecked_emplace(hash, gIndex, std::forward<U>(key), std::forward<Args>(args)...);
-        return { as_iter(loc), true };
-      }
-    }
+    return try_emplace_hashed(hash, std::forward<U>(key), std::forward<Args>(args)...);
   }
 
   template< typename U >
@@ -1403,10 +2246,10 @@ private:
     }
   }
 
+  // Return true if a tombstone was reused (see `set_hfrag`)
   template< typename U >
-  void insert_unique(uint8_t* groups, item_type* values, size_type shift, size_type gMask, U&& value)
+  bool insert_unique(uint8_t* groups, item_type* values, size_type shift, size_type gMask, std::size_t hash, U&& value)
   {
-    std::size_t hash = get_hash(get_key(value));
     size_type index = hash_position(hash, shift);
 
   #ifdef INDIVI_FLAT_W_QUAD_PROB
@@ -1414,7 +2257,7 @@ private:
   #endif
     do {
       uint8_t* group = &groups[index];
-      int avails = MetaWGroup::match_available(group);
+      MetaWGroup::mask_type avails = MetaWGroup::match_available(group);
       if (avails) // not full
       {
         int idx = first_bit_index(avails);
@@ -1422,11 +2265,12 @@ private:
         item_type* pValue = &values[realIdx];
         ::new (pValue) item_type(std::forward<U>(value));
 
-        MetaWGroup::set_hfrag(groups, hash, realIdx, gMask);
-        return;
+        bool wasTombstone = MetaWGroup::set_hfrag(groups, hash, realIdx, gMask);
+        store_hash(groups, gMask, realIdx, hash);
+        return wasTombstone;
       }
     #ifdef INDIVI_FLAT_W_QUAD_PROB
-      index = (index + (++delta)*16) & gMask;
+      index = (index + (++delta)*MetaWGroup::WIDTH) & gMask;
     #else
       index += prob_delta(hash);
       index &= gMask;
@@ -1438,7 +2282,8 @@ private:
   template< typename U >
   void insert_unique(U&& value)
   {
-    insert_unique(mGroups.data, mValues.data, mShift, mGMask, std::forward<U>(value));
+    std::size_t hash = get_hash(get_key(value));
+    insert_unique(mGroups.data, mValues.data, mShift, mGMask, hash, std::forward<U>(value));
   }
 
   template< typename U >
@@ -1450,6 +2295,7 @@ private:
     ::new (pValue) item_type(std::forward<U>(value));
 
     MetaWGroup::set_hfrag(groups, hash, index, gMask);
+    store_hash(groups, gMask, index, hash);
     return { pValue, index };
   }
 
@@ -1464,6 +2310,7 @@ private:
                              std::forward_as_tuple(std::forward<Args>(args)...));
 
     MetaWGroup::set_hfrag(groups, hash, index, gMask);
+    store_hash(groups, gMask, index, hash);
     return { pValue, index };
   }
 
@@ -1477,6 +2324,85 @@ private:
     mMaxSize -= addedTombstone; // anti-drift: reduce max size for each tombstone
   }
 
+  // Purge instead of growing if tombstones are over 1/8 of max size (i.e. some headroom once purged)
+  bool purge_on_grow() const noexcept
+  {
+    size_type maxSize = capa_to_maxsize(bucket_count(), mMaxLoadFactor);
+    return PURGE_IN_PLACE && bucket_count() > 16u && mSize < maxSize - maxSize / 8u;
+  }
+
+  // Re-place all items by probing order within current storage, like Abseil's 'drop deletes without resize':
+  // items are first marked as tombstones (i.e. still to process), then each one is moved to its first available
+  // slot (possibly swapped with an unprocessed item), or kept in place if its own window comes first.
+  // Windows before a processed item only hold processed items, so lookups still stop at the first empty slot.
+  void purge_in_place() noexcept
+  {
+    INDIVI_WTABLE_ASSERT(mValues.data);
+  #ifdef INDIVI_FLAT_W_TELEMETRY
+    flat_telemetry_counters::rehash_scope scope(mTelemetry);
+  #endif
+    uint8_t* groups = mGroups.data;
+    MetaWGroup::mark_for_purge(groups, mGMask);
+
+    storage_type tmp;
+    item_type* pTmp = reinterpret_cast<item_type*>(&tmp);
+    size_type capa = mGMask + 1u;
+    for (size_type i = 0u; i < capa; ++i)
+    {
+      if (groups[i] != MetaWGroup::TOMBSTONE_FRAG) // empty or processed
+        continue;
+
+      item_type* pValue = &mValues.data[i];
+      std::size_t hash = item_hash(pValue);
+      size_type index = hash_position(hash, mShift);
+      size_type target = i;
+    #ifdef INDIVI_FLAT_W_QUAD_PROB
+      size_type delta = 0u;
+    #endif
+      while (((i - index) & mGMask) >= MetaWGroup::WIDTH) // until own window
+      {
+        MetaWGroup::mask_type avails = MetaWGroup::match_available(&groups[index]);
+        if (avails)
+        {
+          target = (index + first_bit_index(avails)) & mGMask;
+          break;
+        }
+      #ifdef INDIVI_FLAT_W_QUAD_PROB
+        index = (index + (++delta)*MetaWGroup::WIDTH) & mGMask;
+      #else
+        index += prob_delta(hash);
+        index &= mGMask;
+      #endif
+      }
+
+      if (target != i)
+      {
+        item_type* pTarget = &mValues.data[target];
+        if (groups[target] == MetaWGroup::EMPTY_FRAG) // move
+        {
+          ::new (pTarget) item_type(std::move(*pValue));
+          pValue->~item_type();
+          MetaWGroup::set_empty(groups, i, mGMask);
+        }
+        else // swap with unprocessed, then process it
+        {
+          ::new (pTmp) item_type(std::move(*pTarget));
+          pTarget->~item_type();
+          ::new (pTarget) item_type(std::move(*pValue));
+          pValue->~item_type();
+          ::new (pValue) item_type(std::move(*pTmp));
+          pTmp->~item_type();
+          if (STORED_HASH)
+            hashes_of(groups, mGMask)[i] = hashes_of(groups, mGMask)[target];
+          --i;
+        }
+      }
+      MetaWGroup::set_hfrag(groups, hash, target, mGMask);
+      store_hash(groups, mGMask, target, hash);
+    }
+    mMaxSize = capa_to_maxsize(capa, mMaxLoadFactor);
+  }
+
   void fast_copy(const flat_wtable& other)
   {
     INDIVI_WTABLE_ASSERT(empty());
@@ -1490,8 +2416,10 @@ private:
     if (std::is_trivially_copy_constructible<item_type>::value)
     {
       std::memcpy((void*)mValues.data, other.mValues.data, sizeof(item_type) * bucketCount);
-      std::memcpy((void*)mGroups.data, other.mGroups.data, sizeof(uint8_t) * (mGMask + 1u + 16u)); // extra group
-      INDIVI_WTABLE_ASSERT(mGroups.data[mGMask + 1u + 15u] == 0); // sentinel
+      std::memcpy((void*)mGroups.data, other.mGroups.data, sizeof(uint8_t) * (mGMask + 1u + MetaWGroup::WIDTH)); // extra group
+      INDIVI_WTABLE_ASSERT(mGroups.data[mGMask + MetaWGroup::WIDTH] == 0); // sentinel
+      if (STORED_HASH)
+        std::memcpy(hashes_of(mGroups.data, mGMask), hashes_of(other.mGroups.data, mGMask), sizeof(stored_type) * bucketCount);
       mSize = other.mSize;
     }
     else
@@ -1518,8 +2446,10 @@ private:
       }
       INDIVI_WTABLE_ASSERT(ctr_count == other.mSize);
 
-      std::memcpy(mGroups.data, other.mGroups.data, sizeof(uint8_t) * (mGMask + 1u + 16u)); // extra group
-      INDIVI_WTABLE_ASSERT(mGroups.data[mGMask + 1u + 15u] == 0); // sentinel
+      std::memcpy(mGroups.data, other.mGroups.data, sizeof(uint8_t) * (mGMask + 1u + MetaWGroup::WIDTH)); // extra group
+      INDIVI_WTABLE_ASSERT(mGroups.data[mGMask + MetaWGroup::WIDTH] == 0); // sentinel
+      if (STORED_HASH)
+        std::memcpy(hashes_of(mGroups.data, mGMask), hashes_of(other.mGroups.data, mGMask), sizeof(stored_type) * bucketCount);
       mSize = other.mSize;
     }
   }
@@ -1533,14 +2463,14 @@ private:
     reserve(other.mSize);
     try
     {
-      if (mMaxSize == other.mMaxSize) // same bucket count
+      if (mGMask == other.mGMask && mMaxSize == other.mMaxSize) // same bucket count (and no tombstone)
       {
         fast_copy(other);
       }
       else
       {
         other.uc_for_each([&](const item_type* pValue) {
-          insert_unique(*pValue);
+          insert_unique(mGroups.data, mValues.data, mShift, mGMask, other.item_hash(pValue), *pValue);
           ++mSize;
         });
       }
@@ -1552,12 +2482,26 @@ private:
     }
   }
 
+  void move_content(flat_wtable& other) // unequal allocators
+  {
+    INDIVI_WTABLE_ASSERT(empty());
+    if (other.empty())
+      return;
+
+    reserve(other.mSize);
+    other.uc_for_each([&](item_type* pValue) {
+      insert_unique(mGroups.data, mValues.data, mShift, mGMask, other.item_hash(pValue), std::move(*pValue));
+      ++mSize;
+    });
+    other.clear();
+  }
+
   void move_to(uint8_t* newGroups, item_type* newValues, size_type newShift, size_type newGMask)
   {
     try
     {
       uc_for_each([&](item_type* pValue) {
-        insert_unique(newGroups, newValues, newShift, newGMask, std::move(*pValue));
+        insert_unique(newGroups, newValues, newShift, newGMask, item_hash(pValue), std::move(*pValue));
         pValue->~item_type();
       });
     }
@@ -1587,53 +2531,129 @@ private:
 
   struct NewStorage // exception-safe helper
   {
+    storage_allocator& alloc;
     size_type itemsCapa;
-    std::unique_ptr<storage_type[]> data; // contains items then 16-aligned groups
-
-    NewStorage(size_type itemsCapa_, size_type groupsCapa_)
-      : itemsCapa(itemsCapa_)
-      , data(new storage_type[storageCapa(itemsCapa_, groupsCapa_)])
+    size_type capa;
+    storage_type* data; // contains items then 16-aligned groups
+
+    NewStorage(storage_allocator& alloc_, size_type itemsCapa_, size_type groupsCapa_)
+      : alloc(alloc_)
+      , itemsCapa(itemsCapa_)
+      , capa(storageCapa(itemsCapa_, groupsCapa_))
+      , data(std::addressof(*storage_traits::allocate(alloc_, capa)))
     {
-      std::size_t padding = (groupsCapa_ > 32u) ? 15u : 0u; // padding for iteration stop on sentinel group
-      void* ptr = (void*)(data.get() + itemsCapa_);
+      std::size_t padding = groupsPadding(groupsCapa_); // padding for iteration stop on sentinel group
+      void* ptr = (void*)(data + itemsCapa_);
       std::memset(ptr, MetaWGroup::EMPTY_FRAG, sizeof(uint8_t) * groupsCapa_ + padding); // init MetaWGroups manually
       ((uint8_t*)ptr)[sizeof(uint8_t) * (groupsCapa_ - 1)] = MetaWGroup::SENTINEL_FRAG; // fake entry to force stop iteration
     }
 
+    static constexpr std::size_t groupsPadding(size_type groupsCapa)
+    {
+      // with wide windows, iteration may reach sentinel group on any capacity
+      return (groupsCapa > 32u || MetaWGroup::WIDTH > 16u || STORED_HASH) ? 15u : 0u;
+    }
+
     static size_type storageCapa(size_type itemsCapa, size_type groupsCapa)
     {
-      std::size_t padding = (groupsCapa > 32u) ? 15u : 0u;
+      std::size_t padding = groupsPadding(groupsCapa);
       size_type grpsAsItemCapa = sizeof(uint8_t) * groupsCapa + padding;
+      if (STORED_HASH)
+        grpsAsItemCapa += alignof(stored_type) - 1u + sizeof(stored_type) * itemsCapa; // after groups (aligned)
       grpsAsItemCapa = (grpsAsItemCapa + sizeof(item_type) - 1) / sizeof(item_type); // round-up
       return itemsCapa + grpsAsItemCapa; // storage uses item_type element size
     }
 
-    void release() noexcept { data.release(); }
+    ~NewStorage()
+    {
+      if (data)
+        storage_traits::deallocate(alloc, data, capa);
+    }
+
+    NewStorage(const NewStorage&) = delete;
+    NewStorage& operator=(const NewStorage&) = delete;
+
+    void release() noexcept { data = nullptr; }
 
-    item_type* values() const noexcept { return reinterpret_cast<item_type*>(data.get()); }
-    uint8_t* groups() const noexcept { return reinterpret_cast<uint8_t*>(data.get() + itemsCapa); }
+    item_type* values() const noexcept { return reinterpret_cast<item_type*>(data); }
+    uint8_t* groups() const noexcept { return reinterpret_cast<uint8_t*>(data + itemsCapa); }
   };
 
-  void rehash_impl(size_type newCapa)
+  // Move elements landing in the first window of their target part, one thread per part (others are left for 'move_to')
+  // Parts are contiguous ranges of positions (i.e. hash highest bits) in both tables, so threads never write the same entries
+  void parallel_move_to(uint8_t* newGroups, item_type* newValues, size_type newShift, size_type newGMask, unsigned int threadCount)
+  {
+    if (!std::is_nothrow_move_constructible<item_type>::value)
+      return;
+
+    size_type capa = mGMask + 1u;
+    size_type newCapa = newGMask + 1u;
+    unsigned int parts = parallel_parts(threadCount, std::min(capa, newCapa), PARALLEL_MIN_PART);
+    if (parts < 2u)
+      return;
+
+    size_type partCapa = capa / parts;
+    size_type newPartCapa = newCapa / parts;
+    parallel_for(parts, [&](unsigned int part) {
+      size_type first = part * newPartCapa;
+      size_type last = first + newPartCapa;
+
+      item_type* pValue = mValues.data + part * partCapa;
+      uint8_t* pGroup = mGroups.data + part * partCapa;
+      uint8_t* end = pGroup + partCapa;
+      for (; pGroup != end; pGroup += 16, pValue += 16)
+      {
+        int sets = MetaWGroup::match_set(pGroup);
+        while (sets)
+        {
+          int idx = first_bit_index(sets);
+          sets &= sets - 1;
+
+          std::size_t hash = item_hash(&pValue[idx]);
+          size_type index = hash_position(hash, newShift);
+          if (index < first || index + MetaWGroup::WIDTH > last) // window crosses another part
+            continue;
+
+          MetaWGroup::mask_type avails = MetaWGroup::match_available(&newGroups[index]);
+          if (!avails)
+            continue;
+
+          size_type realIdx = index + first_bit_index(avails);
+          ::new (&newValues[realIdx]) item_type(std::move(pValue[idx]));
+          pValue[idx].~item_type();
+          MetaWGroup::set_hfrag(newGroups, hash, realIdx, newGMask); // first part only updates extra group
+          store_hash(newGroups, newGMask, realIdx, hash);
+          pGroup[idx] = MetaWGroup::EMPTY_FRAG; // skipped by 'move_to'
+        }
+      }
+    });
+  }
+
+  void rehash_impl(size_type newCapa, unsigned int threadCount = 1u)
   {
     INDIVI_WTABLE_ASSERT(newCapa >= MIN_CAPA);
     INDIVI_WTABLE_ASSERT(is_pow2(newCapa));
 
-    size_type newGCapa = newCapa + 16u; // with extra group (first group duplicate)
+    size_type newGCapa = newCapa + MetaWGroup::WIDTH; // with extra group (first group duplicate)
     size_type newShift = hash_shift(newCapa);
     size_type newGMask = newCapa - 1u;
 
     if (mValues.data)
     {
-      NewStorage newStorage(newCapa, newGCapa);
+    #ifdef INDIVI_FLAT_W_TELEMETRY
+      flat_telemetry_counters::rehash_scope scope(mTelemetry);
+    #endif
+      NewStorage newStorage(alloc(), newCapa, newGCapa);
       uint8_t* newGroups = newStorage.groups();
       item_type* newValues = newStorage.values();
 
       // move existing
+      if (threadCount > 1u)
+        parallel_move_to(newGroups, newValues, newShift, newGMask, threadCount);
       move_to(newGroups, newValues, newShift, newGMask);
 
       // delete old and update
-      delete[] reinterpret_cast<storage_type*>(mValues.data);
+      deallocate();
       mGroups.data = newGroups;
       mValues.data = newValues;
       newStorage.release();
@@ -1644,7 +2664,7 @@ private:
       INDIVI_WTABLE_ASSERT(mShift == EMPTY_SHIFT);
       INDIVI_WTABLE_ASSERT(mGMask == 0u);
 
-      NewStorage newStorage(newCapa, newGCapa);
+      NewStorage newStorage(alloc(), newCapa, newGCapa);
       mGroups.data = newStorage.groups();
       mValues.data = newStorage.values();
       newStorage.release();
@@ -1652,21 +2672,32 @@ private:
 
     mShift = newShift;
     mGMask = newGMask;
-    mMaxSize = capa_to_maxsize(newCapa);
+    mMaxSize = capa_to_maxsize(newCapa, mMaxLoadFactor);
   }
 
   template< typename U >
   Location grow_with_insert(std::size_t hash, U&& value)
   {
-    size_type newCapa = bucket_count() * 2;
+    if (purge_on_grow()) // steady size, full of tombstones
+    {
+      purge_in_place();
+      return unchecked_insert(hash, hash_position(hash, mShift), std::forward<U>(value));
+    }
+  #ifdef INDIVI_FLAT_W_TELEMETRY
+    flat_telemetry_counters::rehash_scope scope(mTelemetry, mValues.data != nullptr);
+  #endif
+
+    size_type newCapa = bucket_count() << mGrowthShift;
     newCapa = std::max(newCapa, (size_type)MIN_CAPA);
+    while (capa_to_maxsize(newCapa, mMaxLoadFactor) <= mSize) // leaving single group with low max load factor
+      newCapa *= 2;
     INDIVI_WTABLE_ASSERT(is_pow2(newCapa));
 
-    size_type newGCapa = newCapa + 16u; // with extra group (first group duplicate)
+    size_type newGCapa = newCapa + MetaWGroup::WIDTH; // with extra group (first group duplicate)
     size_type newShift = hash_shift(newCapa);
     size_type newGMask = newCapa - 1u;
 
-    NewStorage newStorage(newCapa, newGCapa);
+    NewStorage newStorage(alloc(), newCapa, newGCapa);
     uint8_t* newGroups = newStorage.groups();
     item_type* newValues = newStorage.values();
 
@@ -1679,7 +2710,7 @@ private:
       move_to(newGroups, newValues, newShift, newGMask);
 
       // delete old
-      delete[] reinterpret_cast<storage_type*>(mValues.data);
+      deallocate();
     }
     // update
     mGroups.data = newGroups;
@@ -1688,7 +2719,7 @@ private:
 
     mShift = newShift;
     mGMask = newGMask;
-    mMaxSize = capa_to_maxsize(newCapa);
+    mMaxSize = capa_to_maxsize(newCapa, mMaxLoadFactor);
     ++mSize;
 
     return loc;
@@ -1697,15 +2728,26 @@ private:
   template< typename U, class... Args >
   Location grow_with_emplace(std::size_t hash, U&& key, Args&&... args)
   {
-    size_type newCapa = bucket_count() * 2;
+    if (purge_on_grow()) // steady size, full of tombstones
+    {
+      purge_in_place();
+      return unchecked_emplace(hash, hash_position(hash, mShift), std::forward<U>(key), std::forward<Args>(args)...);
+    }
+  #ifdef INDIVI_FLAT_W_TELEMETRY
+    flat_telemetry_counters::rehash_scope scope(mTelemetry, mValues.data != nullptr);
+  #endif
+
+    size_type newCapa = bucket_count() << mGrowthShift;
     newCapa = std::max(newCapa, (size_type)MIN_CAPA);
+    while (capa_to_maxsize(newCapa, mMaxLoadFactor) <= mSize) // leaving single group with low max load factor
+      newCapa *= 2;
     INDIVI_WTABLE_ASSERT(is_pow2(newCapa));
 
-    size_type newGCapa = newCapa + 16u; // with extra group (first group duplicate)
+    size_type newGCapa = newCapa + MetaWGroup::WIDTH; // with extra group (first group duplicate)
     size_type newShift = hash_shift(newCapa);
     size_type newGMask = newCapa - 1u;
 
-    NewStorage newStorage(newCapa, newGCapa);
+    NewStorage newStorage(alloc(), newCapa, newGCapa);
     uint8_t* newGroups = newStorage.groups();
     item_type* newValues = newStorage.values();
 
@@ -1718,7 +2760,7 @@ private:
       move_to(newGroups, newValues, newShift, newGMask);
 
       // delete old
-      delete[] reinterpret_cast<storage_type*>(mValues.data);
+      deallocate();
     }
     // update
     mGroups.data = newGroups;
@@ -1727,7 +2769,7 @@ private:
     
     mShift = newShift;
     mGMask = newGMask;
-    mMaxSize = capa_to_maxsize(newCapa);
+    mMaxSize = capa_to_maxsize(newCapa, mMaxLoadFactor);
     ++mSize;
 
     return loc;
@@ -48,6 +48,15 @@
 #elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(__ARM_BIG_ENDIAN)
   #define INDIVI_SIMD_L_ENDIAN_NEON
 #endif
+#if defined(__AVX2__)
+  #define INDIVI_SIMD_AVX2
+#endif
+#if defined(__AVX512BW__)
+  #define INDIVI_SIMD_AVX512BW
+#endif
+#if defined(__AES__) && defined(INDIVI_SIMD_SSE2)
+  #define INDIVI_SIMD_AES
+#endif
 
 
 #endif // INDIVI_DEFINES_H
@@ -0,0 +1,54 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#ifndef INDIVI_PARALLEL_H
+#define INDIVI_PARALLEL_H
+
+#include <thread>
+#include <vector>
+
+#include <cstddef>
+
+namespace indivi
+{
+namespace detail
+{
+  // Number of parts (power of 2) to split 'capa' entries between up to 'threadCount' threads (at least 'minPart' entries each)
+  static inline unsigned int parallel_parts(unsigned int threadCount, std::size_t capa, std::size_t minPart) noexcept
+  {
+    unsigned int parts = 1u;
+    while (parts * 2u <= threadCount && capa / (parts * 2u) >= minPart)
+      parts *= 2u;
+    return parts;
+  }
+
+  // Call 'fct(part)' for each part in [0, parts), on up to 'parts' threads (including calling one)
+  // Parts not handed to a thread (e.g. thread creation failed) are run on the calling thread
+  template< typename F >
+  void parallel_for(unsigned int parts, F fct)
+  {
+    std::vector<std::thread> threads;
+    unsigned int started = 1u;
+    try
+    {
+      threads.reserve(parts - 1u);
+      for (; started < parts; ++started)
+        threads.emplace_back(fct, started);
+    }
+    catch (...)
+    {}
+
+    for (unsigned int part = started; part < parts; ++part)
+      fct(part);
+    fct(0u);
+
+    for (auto& thread : threads)
+      thread.join();
+  }
+
+} // namespace detail
+} // namespace indivi
+
+#endif // INDIVI_PARALLEL_H
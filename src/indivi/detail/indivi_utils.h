@@ -86,7 +86,7 @@ namespace detail
     return first_bit_index((unsigned int)v);
   }
 
-  static inline int last_bit_index(int v) noexcept
+  static inline int last_bit_index(uint32_t v) noexcept
   {
     assert(v != 0);
   #ifdef INDIVI_MSVC
@@ -98,6 +98,23 @@ namespace detail
   #endif
   }
 
+  static inline int last_bit_index(uint64_t v) noexcept
+  {
+    assert(v != 0);
+  #ifdef INDIVI_MSVC
+    unsigned long r;
+    _BitScanReverse64(&r, (unsigned __int64)v);
+    return (int)r;
+  #else
+    return 63 ^ __builtin_clzll((unsigned long long)v);
+  #endif
+  }
+
+  static inline int last_bit_index(int v) noexcept
+  {
+    return last_bit_index((uint32_t)v);
+  }
+
 namespace traits
 {
   template< typename... Ts >
@@ -136,6 +153,19 @@ namespace traits
     : public std::integral_constant<bool, is_nothrow_swappable_impl<T>::value>
   {};
 
+  // Detect 'T::is_transparent' type (for heterogeneous lookup)
+  template< class T, class = void >
+  struct is_transparent : std::false_type {};
+
+  template< class T >
+  struct is_transparent<T, void_t<typename T::is_transparent>> : std::true_type {};
+
+  // Both Hash and KeyEqual must be transparent (K only makes the check dependent, for SFINAE)
+  template< class K, class Hash, class KeyEqual >
+  struct are_transparent
+    : public std::integral_constant<bool, is_transparent<Hash>::value && is_transparent<KeyEqual>::value>
+  {};
+
 } // namespace traits
 } // namespace detail
 } // namespace indivi
@@ -0,0 +1,132 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#ifndef INDIVI_RW_SPINLOCK_H
+#define INDIVI_RW_SPINLOCK_H
+
+#include "indivi/detail/indivi_defines.h"
+
+#include <atomic>
+#include <thread>
+
+#include <cstdint>
+
+#ifdef INDIVI_SIMD_SSE2
+  #include <emmintrin.h> // for _mm_pause
+#endif
+
+namespace indivi
+{
+namespace detail
+{
+/*
+ * Reader-writer spinlock (4 Bytes, not recursive).
+ * Writer-preferring: pending writer blocks new readers, then waits for current ones to leave.
+ * Meant for short critical sections (e.g. per-shard locking), yields after a few spins.
+ */
+class rw_spinlock
+{
+  static constexpr uint32_t WRITER{ 0x80000000u }; // others bits count readers
+  static constexpr unsigned int MAX_SPINS{ 64u };  // before yielding
+
+  std::atomic<uint32_t> mState{ 0u };
+
+  static inline void backoff(unsigned int& spins) noexcept
+  {
+    if (++spins < MAX_SPINS)
+    {
+    #ifdef INDIVI_SIMD_SSE2
+      _mm_pause();
+    #endif
+    }
+    else
+    {
+      spins = 0u;
+      std::this_thread::yield();
+    }
+  }
+
+public:
+  rw_spinlock() = default;
+  rw_spinlock(const rw_spinlock&) = delete;
+  rw_spinlock& operator=(const rw_spinlock&) = delete;
+
+  // Exclusive
+  void lock() noexcept
+  {
+    unsigned int spins = 0u;
+    uint32_t state = mState.load(std::memory_order_relaxed);
+    while ((state & WRITER)
+           || !mState.compare_exchange_weak(state, state | WRITER, std::memory_order_acquire, std::memory_order_relaxed))
+    {
+      backoff(spins);
+      state = mState.load(std::memory_order_relaxed);
+    }
+    // wait for readers to leave
+    while (mState.load(std::memory_order_acquire) != WRITER)
+      backoff(spins);
+  }
+
+  bool try_lock() noexcept
+  {
+    uint32_t expected = 0u;
+    return mState.compare_exchange_strong(expected, WRITER, std::memory_order_acquire, std::memory_order_relaxed);
+  }
+
+  void unlock() noexcept
+  {
+    mState.fetch_and(~WRITER, std::memory_order_release); // keep transient reader counts
+  }
+
+  // Shared
+  void lock_shared() noexcept
+  {
+    unsigned int spins = 0u;
+    while (mState.fetch_add(1u, std::memory_order_acquire) & WRITER)
+    {
+      mState.fetch_sub(1u, std::memory_order_relaxed);
+      do {
+        backoff(spins);
+      }
+      while (mState.load(std::memory_order_relaxed) & WRITER);
+    }
+  }
+
+  bool try_lock_shared() noexcept
+  {
+    if (mState.fetch_add(1u, std::memory_order_acquire) & WRITER)
+    {
+      mState.fetch_sub(1u, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+  void unlock_shared() noexcept
+  {
+    mState.fetch_sub(1u, std::memory_order_release);
+  }
+};
+
+/*
+ * Scoped shared lock (C++11 equivalent of `std::shared_lock`, without deferring).
+ */
+template< class Mutex >
+class shared_lock_guard
+{
+  Mutex& mMutex;
+
+public:
+  explicit shared_lock_guard(Mutex& mutex) : mMutex(mutex) { mMutex.lock_shared(); }
+  ~shared_lock_guard() { mMutex.unlock_shared(); }
+
+  shared_lock_guard(const shared_lock_guard&) = delete;
+  shared_lock_guard& operator=(const shared_lock_guard&) = delete;
+};
+
+} // namespace detail
+} // namespace indivi
+
+#endif // INDIVI_RW_SPINLOCK_H
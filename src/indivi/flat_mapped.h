@@ -0,0 +1,233 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#ifndef INDIVI_FLAT_MAPPED_H
+#define INDIVI_FLAT_MAPPED_H
+
+#include "indivi/detail/flat_snapshot.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <cstddef>
+
+#if defined(_WIN32)
+  #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+  #endif
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace indivi
+{
+namespace detail
+{
+// Read-only, whole file memory mapping (page-aligned)
+class file_mapping
+{
+  const void* mData = nullptr;
+  std::size_t mBytes = 0u;
+#if defined(_WIN32)
+  HANDLE mMapping = NULL;
+#endif
+
+public:
+  file_mapping() = default;
+
+  // Throw `std::runtime_error` on failure (empty file included)
+  explicit file_mapping(const std::string& path)
+  {
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+      throw std::runtime_error("file_mapping: cannot open file");
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+      CloseHandle(file);
+      throw std::runtime_error("file_mapping: cannot map empty file");
+    }
+    mMapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file); // kept open by mapping
+    if (mMapping == NULL)
+      throw std::runtime_error("file_mapping: cannot map file");
+    mData = MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+    if (!mData)
+    {
+      CloseHandle(mMapping);
+      throw std::runtime_error("file_mapping: cannot map file");
+    }
+    mBytes = (std::size_t)fileSize.QuadPart;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error("file_mapping: cannot open file");
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+      ::close(fd);
+      throw std::runtime_error("file_mapping: cannot map empty file");
+    }
+    void* data = ::mmap(nullptr, (std::size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // kept open by mapping
+    if (data == MAP_FAILED)
+      throw std::runtime_error("file_mapping: cannot map file");
+    mData = data;
+    mBytes = (std::size_t)st.st_size;
+#endif
+  }
+
+  file_mapping(file_mapping&& other) noexcept
+    : mData(other.mData)
+    , mBytes(other.mBytes)
+#if defined(_WIN32)
+    , mMapping(other.mMapping)
+#endif
+  {
+    other.mData = nullptr;
+    other.mBytes = 0u;
+#if defined(_WIN32)
+    other.mMapping = NULL;
+#endif
+  }
+
+  file_mapping& operator=(file_mapping&& other) noexcept
+  {
+    if (this != &other)
+    {
+      unmap();
+      std::swap(mData, other.mData);
+      std::swap(mBytes, other.mBytes);
+#if defined(_WIN32)
+      std::swap(mMapping, other.mMapping);
+#endif
+    }
+    return *this;
+  }
+
+  file_mapping(const file_mapping&) = delete;
+  file_mapping& operator=(const file_mapping&) = delete;
+
+  ~file_mapping() { unmap(); }
+
+  const void* data() const noexcept { return mData; }
+  std::size_t size() const noexcept { return mBytes; }
+
+private:
+  void unmap() noexcept
+  {
+    if (!mData)
+      return;
+#if defined(_WIN32)
+    UnmapViewOfFile(mData);
+    CloseHandle(mMapping);
+    mMapping = NULL;
+#else
+    ::munmap(const_cast<void*>(mData), mBytes);
+#endif
+    mData = nullptr;
+    mBytes = 0u;
+  }
+};
+
+} // namespace detail
+
+/*
+ * Flat_mapped is a read-only view of a flat container snapshot (see `save()`), memory mapped from file.
+ * Lookups run directly on the mapped storage: no parsing, no allocation, pages loaded on demand (and shared between processes).
+ *
+ * Snapshots are native: same container type and options, same Key/T layout, size_t size and endianness are required (checked).
+ * The hash function must be the same as when saved (checked by re-hashing the first keys), so avoid seeded/per-process hashes.
+ * String hashes also depend on build options (AES-NI, see 'INDIVI_HASH_PORTABLE' in 'hash.h').
+ * Key and T must be trivially copyable (no pointers to owned memory).
+ * Only const member functions of the underlying container may be used (see `map()`).
+ */
+template< class Map >
+class flat_mapped
+{
+public:
+  using map_type = Map;
+  using key_type = typename Map::key_type;
+  using value_type = typename Map::value_type;
+  using size_type = typename Map::size_type;
+  using hasher = typename Map::hasher;
+  using key_equal = typename Map::key_equal;
+  using const_iterator = typename Map::const_iterator;
+
+private:
+  // Members
+  detail::file_mapping mFile;
+  Map mMap;
+
+public:
+  // Ctr/Dtr
+  // Throw `std::runtime_error` if file cannot be mapped, or snapshot is invalid/incompatible
+  explicit flat_mapped(const std::string& path, const hasher& hash = hasher(), const key_equal& equal = key_equal())
+    : mFile(path)
+    , mMap(0, hash, equal)
+  {
+    if (!mMap.mTable.attach_snapshot(mFile.data(), mFile.size()))
+      throw std::runtime_error("flat_mapped: invalid or incompatible snapshot");
+  }
+
+  flat_mapped(flat_mapped&& other)
+    : mFile(std::move(other.mFile))
+    , mMap(std::move(other.mMap)) // storage pointers moved
+  {}
+
+  flat_mapped& operator=(flat_mapped&& other)
+  {
+    if (this != &other)
+    {
+      mMap.mTable.detach_snapshot();
+      mMap = std::move(other.mMap);
+      mFile = std::move(other.mFile);
+    }
+    return *this;
+  }
+
+  flat_mapped(const flat_mapped&) = delete;
+  flat_mapped& operator=(const flat_mapped&) = delete;
+
+  ~flat_mapped() { mMap.mTable.detach_snapshot(); } // storage not owned
+
+  // Underlying container (const member functions only)
+  const Map& map() const noexcept { return mMap; }
+
+  // Iterators
+  const_iterator begin() const noexcept { return mMap.begin(); }
+  const_iterator cbegin() const noexcept { return mMap.cbegin(); }
+  const_iterator end() const noexcept { return mMap.end(); }
+  const_iterator cend() const noexcept { return mMap.cend(); }
+
+  // Capacity
+  bool empty() const noexcept { return mMap.empty(); }
+  size_type size() const noexcept { return mMap.size(); }
+
+  // Lookup
+  const_iterator find(const key_type& key) const { return mMap.find(key); }
+  bool contains(const key_type& key) const { return mMap.contains(key); }
+  size_type count(const key_type& key) const { return mMap.count(key); }
+};
+
+// Map snapshot file at 'path' (see `flat_mapped` constructor)
+template< class Map >
+flat_mapped<Map> open_mapped(const std::string& path, const typename Map::hasher& hash = typename Map::hasher())
+{
+  return flat_mapped<Map>(path, hash);
+}
+
+} // namespace indivi
+
+#endif // INDIVI_FLAT_MAPPED_H
@@ -0,0 +1,1002 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#ifndef INDIVI_FLAT_SPLIT_MAP_H
+#define INDIVI_FLAT_SPLIT_MAP_H
+
+#include "indivi/hash.h"
+#include "indivi/detail/flat_utable.h" // for MetaGroup
+#include "indivi/detail/indivi_utils.h"
+
+#include <algorithm>
+#include <functional> // for std::equal_to
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace indivi
+{
+/*
+ * Flat_split_map is an associative container that stores unordered unique key-value pairs, keys and mapped values apart.
+ * Same open-addressing schema as `flat_umap` (16-entry groups of hash fragments and overflow counters, quadratic probing),
+ * but the slot of an entry indexes two arrays: keys (followed by metadata, same allocation) and mapped values.
+ *
+ * Probing and key comparisons only touch keys and metadata: a lookup loads its mapped value once found (never on a miss),
+ * and key iteration (see `keys()`) or key-only lookups (`contains`, `count`) never load mapped values.
+ * Best for large mapped values (e.g. 200-byte structs) with miss-heavy lookups, or key-only scans.
+ *
+ * As keys and mapped values are not adjacent, iterators return proxy pairs (`std::pair<const Key&, T&>`, by value):
+ * use `auto&&` or `const auto&` in range-for loops, or `it.key()`/`it.mapped()`.
+ * Use a fixed max load factor of 0.875 and growth factor of 2. Rehash moves keys and mapped values (should not throw).
+ * Search, insertion, and removal of elements have average constant time 𝓞(1) complexity.
+ */
+template<
+  class Key,
+  class T,
+  class Hash = indivi::hash<Key>,
+  class KeyEqual = std::equal_to<Key>,
+  class Allocator = std::allocator<std::pair<const Key, T>> >
+class flat_split_map
+{
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using reference = std::pair<const Key&, T&>; // proxy
+  using const_reference = std::pair<const Key&, const T&>;
+
+  static_assert(std::is_same<typename Allocator::value_type, value_type>::value,
+                "flat_split_map: Allocator::value_type must be the same as value_type");
+
+private:
+  using init_type = std::pair<typename std::remove_const<Key>::type, typename std::remove_const<T>::type>;
+  using MetaGroup = detail::MetaGroup;
+  using mixer = detail::hash_mixer<Hash>;
+  using alloc_traits = std::allocator_traits<Allocator>;
+  using key_storage = typename std::aligned_storage<sizeof(Key), alignof(Key)>::type;
+  using key_allocator = typename alloc_traits::template rebind_alloc<key_storage>; // keys then 32-aligned groups
+  using key_traits = std::allocator_traits<key_allocator>;
+  using mapped_allocator = typename alloc_traits::template rebind_alloc<T>;
+  using mapped_traits = std::allocator_traits<mapped_allocator>;
+
+  static constexpr float MAX_LOAD_FACTOR{ 0.875f };
+  static constexpr size_type MIN_CAPA{ 2u };
+  static constexpr size_type NPOS{ ~size_type(0) };
+
+  // Members
+  MetaGroup* mGroups = MetaGroup::empty_group(); // hash fragments and overflow counters
+  Key* mKeys = nullptr;                          // key block (groups stored after keys)
+  T* mMapped = nullptr;                          // mapped values (same slot as keys)
+  size_type mSize = 0u;
+  size_type mShift = 0u;   // hash shift to keep highest bits (as group index)
+  size_type mGMask = 0u;   // group index mask (as power-of-2 capacity - 1)
+  size_type mMaxSize = 0u; // max size before rehash is needed
+  Hash mHash;
+  KeyEqual mKeyEqual;
+  key_allocator mKeyAlloc;
+  mapped_allocator mMappedAlloc;
+
+public:
+  template< class Mapped >
+  class Iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename flat_split_map::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::pair<const Key&, Mapped&>;
+
+    struct pointer // arrow proxy
+    {
+      reference ref;
+      const reference* operator->() const noexcept { return std::addressof(ref); }
+    };
+
+  private:
+    friend flat_split_map;
+    template< class > friend class Iterator;
+
+    int mSubIndex = 0;
+    const MetaGroup* mGroup = nullptr;
+    const MetaGroup* mGroupFirst = nullptr;
+    const Key* mKey = nullptr;
+    Mapped* mMapped = nullptr;
+
+    Iterator(int subIndex, const MetaGroup* group, const MetaGroup* groupFirst, const Key* key, Mapped* mapped)
+      : mSubIndex(subIndex), mGroup(group), mGroupFirst(groupFirst), mKey(key), mMapped(mapped)
+    {}
+
+    static Iterator find_begin(const MetaGroup* groups, const Key* keys, Mapped* mapped, size_type gCapa)
+    {
+      return ++Iterator(0, groups + gCapa, groups, keys + (gCapa * 16), mapped + (gCapa * 16));
+    }
+
+  public:
+    Iterator() = default;
+    Iterator(const Iterator& other) = default;
+
+    template <typename M,
+      typename = std::enable_if<std::is_convertible<M*, Mapped*>::value>>
+      Iterator(const Iterator<M>& other)
+      : mSubIndex(other.mSubIndex), mGroup(other.mGroup), mGroupFirst(other.mGroupFirst), mKey(other.mKey), mMapped(other.mMapped)
+    {}
+
+    Iterator& operator=(const Iterator& other) = default;
+
+    // Only metadata is read (keys and mapped values are not loaded)
+    Iterator& operator++() noexcept
+    {
+      // current group
+      while (mSubIndex)
+      {
+        --mSubIndex;
+        --mKey;
+        --mMapped;
+        if (mGroup->has_hfrag(mSubIndex))
+          return *this;
+      }
+      // next group
+      while (mGroup != mGroupFirst)
+      {
+        INDIVI_UTABLE_ASSERT(mGroup);
+        --mGroup;
+        int sets = mGroup->match_set();
+        if (sets)
+        {
+          int last = detail::last_bit_index(sets);
+          mSubIndex = last;
+          mKey -= 16 - last;
+          mMapped -= 16 - last;
+          return *this;
+        }
+        mKey -= 16;
+        mMapped -= 16;
+      }
+      // end
+      mKey = nullptr;
+      mMapped = nullptr;
+      return *this;
+    }
+
+    Iterator operator++(int) noexcept
+    {
+      Iterator retval = *this;
+      ++(*this);
+      return retval;
+    }
+
+    bool operator==(const Iterator& other) const noexcept
+    {
+      return mKey == other.mKey;
+    }
+
+    bool operator!=(const Iterator& other) const noexcept
+    {
+      return mKey != other.mKey;
+    }
+
+    // non-standard, key or mapped value only
+    const Key& key() const noexcept { return *mKey; }
+    Mapped& mapped() const noexcept { return *mMapped; }
+
+    reference operator*() const noexcept
+    {
+      return reference(*mKey, *mMapped);
+    }
+
+    pointer operator->() const noexcept
+    {
+      return pointer{ **this };
+    }
+  };
+
+  using iterator = Iterator<T>;
+  using const_iterator = Iterator<const T>;
+
+  // Iterate over keys only (see `keys()`)
+  class key_iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Key;
+    using difference_type = std::ptrdiff_t;
+    using reference = const Key&;
+    using pointer = const Key*;
+
+  private:
+    friend flat_split_map;
+
+    const_iterator mIt;
+
+    explicit key_iterator(const const_iterator& it) : mIt(it) {}
+
+  public:
+    key_iterator() = default;
+
+    key_iterator& operator++() noexcept
+    {
+      ++mIt;
+      return *this;
+    }
+
+    key_iterator operator++(int) noexcept
+    {
+      key_iterator retval = *this;
+      ++mIt;
+      return retval;
+    }
+
+    bool operator==(const key_iterator& other) const noexcept { return mIt == other.mIt; }
+    bool operator!=(const key_iterator& other) const noexcept { return mIt != other.mIt; }
+
+    reference operator*() const noexcept { return mIt.key(); }
+    pointer operator->() const noexcept { return std::addressof(mIt.key()); }
+  };
+
+  // Range over keys (same order as map iteration)
+  class key_view
+  {
+  private:
+    friend flat_split_map;
+
+    const flat_split_map* mMap;
+
+    explicit key_view(const flat_split_map* map) : mMap(map) {}
+
+  public:
+    key_iterator begin() const noexcept { return key_iterator(mMap->cbegin()); }
+    key_iterator end() const noexcept { return key_iterator(); }
+    size_type size() const noexcept { return mMap->size(); }
+    bool empty() const noexcept { return mMap->empty(); }
+  };
+
+private:
+  // Heterogeneous lookup (if both Hash and KeyEqual define 'is_transparent')
+  template< class K, class R >
+  using if_transparent = typename std::enable_if<detail::traits::are_transparent<K, Hash, KeyEqual>::value, R>::type;
+  template< class K, class R >
+  using if_transparent_key = typename std::enable_if<
+    detail::traits::are_transparent<K, Hash, KeyEqual>::value && !detail::traits::is_similar<K, Key>::value
+      && !std::is_convertible<K, iterator>::value && !std::is_convertible<K, const_iterator>::value, R>::type;
+
+public:
+  // Ctr/Dtr
+  flat_split_map() : flat_split_map(0)
+  {}
+
+  explicit flat_split_map(size_type bucket_count, const Hash& hash = Hash(), const key_equal& equal = key_equal(),
+                          const allocator_type& alloc = allocator_type())
+    : mHash(hash)
+    , mKeyEqual(equal)
+    , mKeyAlloc(alloc)
+    , mMappedAlloc(alloc)
+  {
+    if (bucket_count)
+      rehash(bucket_count);
+  }
+
+  explicit flat_split_map(const allocator_type& alloc)
+    : flat_split_map(0, Hash(), key_equal(), alloc)
+  {}
+
+  flat_split_map(size_type bucket_count, const allocator_type& alloc)
+    : flat_split_map(bucket_count, Hash(), key_equal(), alloc)
+  {}
+
+  template< class InputIt >
+  flat_split_map(InputIt first, InputIt last, size_type bucket_count = 0, const Hash& hash = Hash(), const key_equal& equal = key_equal(),
+                 const allocator_type& alloc = allocator_type())
+    : flat_split_map(bucket_count, hash, equal, alloc)
+  {
+    insert(first, last);
+  }
+
+  flat_split_map(std::initializer_list<value_type> init, size_type bucket_count = 0, const Hash& hash = Hash(), const key_equal& equal = key_equal(),
+                 const allocator_type& alloc = allocator_type())
+    : flat_split_map(init.begin(), init.end(), bucket_count, hash, equal, alloc)
+  {}
+
+  flat_split_map(const flat_split_map& other)
+    : flat_split_map(other, alloc_traits::select_on_container_copy_construction(other.get_allocator()))
+  {}
+
+  flat_split_map(const flat_split_map& other, const allocator_type& alloc)
+    : mHash(other.mHash)
+    , mKeyEqual(other.mKeyEqual)
+    , mKeyAlloc(alloc)
+    , mMappedAlloc(alloc)
+  {
+    copy_content(other);
+  }
+
+  flat_split_map(flat_split_map&& other) noexcept(std::is_nothrow_move_constructible<Hash>::value
+                                                  && std::is_nothrow_move_constructible<KeyEqual>::value)
+    : mHash(std::move(other.mHash))
+    , mKeyEqual(std::move(other.mKeyEqual))
+    , mKeyAlloc(std::move(other.mKeyAlloc))
+    , mMappedAlloc(std::move(other.mMappedAlloc))
+  {
+    steal_content(other);
+  }
+
+  flat_split_map(flat_split_map&& other, const allocator_type& alloc)
+    : mHash(other.mHash)
+    , mKeyEqual(other.mKeyEqual)
+    , mKeyAlloc(alloc)
+    , mMappedAlloc(alloc)
+  {
+    if (mKeyAlloc == other.mKeyAlloc)
+      steal_content(other);
+    else
+      move_content(other);
+  }
+
+  ~flat_split_map()
+  {
+    destroy_all();
+    deallocate();
+  }
+
+  // Assignment
+  flat_split_map& operator=(const flat_split_map& other)
+  {
+    if (this != &other)
+    {
+      destroy_all();
+      deallocate();
+      mHash = other.mHash;
+      mKeyEqual = other.mKeyEqual;
+      if (alloc_traits::propagate_on_container_copy_assignment::value)
+      {
+        mKeyAlloc = other.mKeyAlloc;
+        mMappedAlloc = other.mMappedAlloc;
+      }
+      copy_content(other);
+    }
+    return *this;
+  }
+
+  flat_split_map& operator=(flat_split_map&& other)
+  {
+    if (this != &other)
+    {
+      destroy_all();
+      deallocate();
+      mHash = std::move(other.mHash);
+      mKeyEqual = std::move(other.mKeyEqual);
+      if (alloc_traits::propagate_on_container_move_assignment::value)
+      {
+        mKeyAlloc = std::move(other.mKeyAlloc);
+        mMappedAlloc = std::move(other.mMappedAlloc);
+      }
+      if (mKeyAlloc == other.mKeyAlloc)
+        steal_content(other);
+      else
+        move_content(other);
+    }
+    return *this;
+  }
+
+  flat_split_map& operator=(std::initializer_list<value_type> ilist)
+  {
+    clear();
+    insert(ilist);
+    return *this;
+  }
+
+  // Iterators
+  iterator begin() noexcept { return iterator::find_begin(mGroups, mKeys, mMapped, group_capa()); }
+  const_iterator begin() const noexcept { return const_iterator::find_begin(mGroups, mKeys, mMapped, group_capa()); }
+  const_iterator cbegin() const noexcept { return const_iterator::find_begin(mGroups, mKeys, mMapped, group_capa()); }
+
+  static iterator end() noexcept { return iterator(); }
+  static const_iterator cend() noexcept { return const_iterator(); }
+
+  // non-standard, keys only (mapped values not loaded)
+  key_view keys() const noexcept { return key_view(this); }
+
+  // Capacity
+  bool empty() const noexcept { return mSize == 0u; }
+  size_type size() const noexcept { return mSize; }
+  size_type max_size() const noexcept { return (size_type)(max_bucket_count() * MAX_LOAD_FACTOR); }
+
+  // Bucket interface
+  size_type bucket_count() const noexcept { return mGMask ? (mGMask + 1u) * 16 : mMaxSize; }
+  size_type max_bucket_count() const noexcept { return (size_type)std::numeric_limits<difference_type>::max(); }
+
+  // Hash policy
+  float load_factor() const noexcept { return mSize ? (float)mSize / bucket_count() : 0.f; }
+  float max_load_factor() const noexcept { return MAX_LOAD_FACTOR; }
+
+  void rehash(size_type count)
+  {
+    size_type newCapa = std::max(count, (size_type)std::ceil(mSize / MAX_LOAD_FACTOR));
+    if (newCapa == 0u)
+    {
+      INDIVI_UTABLE_ASSERT(mSize == 0u);
+      deallocate();
+      return;
+    }
+    newCapa = std::max((size_type)detail::round_up_pow2((uint64_t)newCapa), MIN_CAPA);
+    while (capa_to_maxsize(newCapa) < mSize)
+      newCapa *= 2;
+    if (newCapa != bucket_count())
+      rehash_impl(newCapa);
+  }
+
+  void reserve(size_type count)
+  {
+    if (count > mMaxSize)
+      rehash((size_type)std::ceil(count / MAX_LOAD_FACTOR));
+  }
+
+  // non-standard, same as `rehash(0)`: smallest capacity for current size (free storage if empty)
+  void shrink_to_fit() { rehash(0u); }
+
+  // Observers
+  hasher hash_function() const { return mHash; }
+  key_equal key_eq() const { return mKeyEqual; }
+  allocator_type get_allocator() const noexcept { return allocator_type(mKeyAlloc); }
+
+  // Lookup
+  T& at(const Key& key)
+  {
+    size_type slot = find_impl(get_hash(key), key);
+    if (slot == NPOS)
+      throw std::out_of_range("flat_split_map::at");
+    return mMapped[slot];
+  }
+  const T& at(const Key& key) const
+  {
+    size_type slot = find_impl(get_hash(key), key);
+    if (slot == NPOS)
+      throw std::out_of_range("flat_split_map::at");
+    return mMapped[slot];
+  }
+  template< class K >
+  if_transparent<K, T&> at(const K& key)
+  {
+    size_type slot = find_impl(get_hash(key), key);
+    if (slot == NPOS)
+      throw std::out_of_range("flat_split_map::at");
+    return mMapped[slot];
+  }
+  template< class K >
+  if_transparent<K, const T&> at(const K& key) const
+  {
+    size_type slot = find_impl(get_hash(key), key);
+    if (slot == NPOS)
+      throw std::out_of_range("flat_split_map::at");
+    return mMapped[slot];
+  }
+
+  T& operator[](const Key& key) { return try_emplace(key).first.mapped(); }
+  T& operator[](Key&& key) { return try_emplace(std::move(key)).first.mapped(); }
+
+  size_type count(const Key& key) const { return contains(key) ? 1u : 0u; }
+  template< class K >
+  if_transparent<K, size_type> count(const K& key) const { return contains(key) ? 1u : 0u; }
+
+  bool contains(const Key& key) const { return find_impl(get_hash(key), key) != NPOS; }
+  template< class K >
+  if_transparent<K, bool> contains(const K& key) const { return find_impl(get_hash(key), key) != NPOS; }
+
+  iterator find(const Key& key) { return make_iterator<T>(find_impl(get_hash(key), key)); }
+  const_iterator find(const Key& key) const { return make_iterator<const T>(find_impl(get_hash(key), key)); }
+  template< class K >
+  if_transparent<K, iterator> find(const K& key) { return make_iterator<T>(find_impl(get_hash(key), key)); }
+  template< class K >
+  if_transparent<K, const_iterator> find(const K& key) const { return make_iterator<const T>(find_impl(get_hash(key), key)); }
+
+  // Modifiers
+  void clear() noexcept
+  {
+    destroy_all();
+    if (mKeys)
+      std::memset((void*)mGroups, 0, sizeof(MetaGroup) * (mGMask + 1u));
+  }
+
+  template< class P >
+  std::pair<iterator, bool> insert(P&& value) { return emplace_impl(std::forward<P>(value).first, std::forward<P>(value).second); }
+
+  std::pair<iterator, bool> insert(init_type&& value) { return emplace_impl(std::move(value.first), std::move(value.second)); }
+
+  template< class InputIt >
+  void insert(InputIt first, InputIt last)
+  {
+    for (; first != last; ++first)
+      insert(*first);
+  }
+
+  void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+  template< class M >
+  std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj)
+  {
+    auto res = emplace_impl(key, std::forward<M>(obj));
+    if (!res.second)
+      res.first.mapped() = std::forward<M>(obj);
+    return res;
+  }
+  template< class M >
+  std::pair<iterator, bool> insert_or_assign(Key&& key, M&& obj)
+  {
+    auto res = emplace_impl(std::move(key), std::forward<M>(obj));
+    if (!res.second)
+      res.first.mapped() = std::forward<M>(obj);
+    return res;
+  }
+
+  // Build a temporary pair (keys and mapped values are constructed apart)
+  template< class... Args >
+  std::pair<iterator, bool> emplace(Args&&... args)
+  {
+    init_type value(std::forward<Args>(args)...);
+    return emplace_impl(std::move(value.first), std::move(value.second));
+  }
+
+  template< class... Args >
+  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) { return emplace_impl(key, std::forward<Args>(args)...); }
+  template< class... Args >
+  std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) { return emplace_impl(std::move(key), std::forward<Args>(args)...); }
+
+  // non-standard, return next iterator (not iterator after erased element)
+  iterator erase_(const_iterator pos)
+  {
+    INDIVI_UTABLE_ASSERT(pos != cend());
+    iterator next(pos.mSubIndex, pos.mGroup, pos.mGroupFirst, pos.mKey, const_cast<T*>(pos.mMapped));
+    ++next;
+    erase_slot((size_type)(pos.mKey - mKeys));
+    return next;
+  }
+  void erase(const_iterator pos)
+  {
+    INDIVI_UTABLE_ASSERT(pos != cend());
+    erase_slot((size_type)(pos.mKey - mKeys));
+  }
+  void erase(iterator pos)
+  {
+    erase(const_iterator(pos));
+  }
+
+  size_type erase(const Key& key)
+  {
+    size_type slot = find_impl(get_hash(key), key);
+    if (slot == NPOS)
+      return 0u;
+    erase_slot(slot);
+    return 1u;
+  }
+  template< class K >
+  if_transparent_key<K, size_type> erase(K&& key)
+  {
+    size_type slot = find_impl(get_hash(key), key);
+    if (slot == NPOS)
+      return 0u;
+    erase_slot(slot);
+    return 1u;
+  }
+
+  void swap(flat_split_map& other)
+    noexcept(detail::traits::is_nothrow_swappable<Hash>::value && detail::traits::is_nothrow_swappable<KeyEqual>::value
+             && (!alloc_traits::propagate_on_container_swap::value || detail::traits::is_nothrow_swappable<key_allocator>::value))
+  {
+    using std::swap;
+    swap(mGroups, other.mGroups);
+    swap(mKeys, other.mKeys);
+    swap(mMapped, other.mMapped);
+    swap(mSize, other.mSize);
+    swap(mShift, other.mShift);
+    swap(mGMask, other.mGMask);
+    swap(mMaxSize, other.mMaxSize);
+    swap(mHash, other.mHash);
+    swap(mKeyEqual, other.mKeyEqual);
+    if (alloc_traits::propagate_on_container_swap::value)
+    {
+      swap(mKeyAlloc, other.mKeyAlloc);
+      swap(mMappedAlloc, other.mMappedAlloc);
+    }
+  }
+
+  // Non-member functions
+  friend void swap(flat_split_map& lhs, flat_split_map& rhs) noexcept(noexcept(lhs.swap(rhs))) { lhs.swap(rhs); }
+
+  friend bool operator==(const flat_split_map& lhs, const flat_split_map& rhs)
+  {
+    if (lhs.size() != rhs.size())
+      return false;
+    for (auto it = lhs.cbegin(); it != lhs.cend(); ++it)
+    {
+      size_type slot = rhs.find_impl(rhs.get_hash(it.key()), it.key());
+      if (slot == NPOS || !(rhs.mMapped[slot] == it.mapped()))
+        return false;
+    }
+    return true;
+  }
+  friend bool operator!=(const flat_split_map& lhs, const flat_split_map& rhs) { return !(lhs == rhs); }
+
+  template< class Pred >
+  friend size_type erase_if(flat_split_map& map, Pred pred)
+  {
+    size_type oldSize = map.size();
+    for (auto it = map.begin(); it != map.end();)
+    {
+      if (pred(*it))
+        it = map.erase_(it);
+      else
+        ++it;
+    }
+    return oldSize - map.size();
+  }
+
+private:
+  template< typename K >
+  std::size_t get_hash(const K& key) const
+  {
+    return mixer::mix(mHash, key);
+  }
+
+  size_type group_capa() const noexcept { return mKeys ? mGMask + 1u : 0u; }
+
+  static constexpr size_type hash_shift(size_type gCapa) noexcept
+  {
+    return (gCapa <= 2u) ? 1u // fake value, overridden by mask
+                         : sizeof(size_type) * CHAR_BIT - (size_type)(detail::first_bit_index(gCapa));
+  }
+
+  // Single group is filled up (see `bucket_count`)
+  static size_type capa_to_maxsize(size_type capa) noexcept
+  {
+    return (capa > 16u) ? (size_type)(capa * MAX_LOAD_FACTOR) : capa;
+  }
+
+  static constexpr size_type hash_position(std::size_t hash, size_type shift, size_type mask) noexcept
+  {
+    return (hash >> shift) & mask; // keep (64 - n) highest bits, mask to handle single group case
+  }
+
+  // Key block: 'capa' keys then 32-aligned groups
+  static size_type key_block_capa(size_type capa, size_type gCapa) noexcept
+  {
+    return capa + (sizeof(MetaGroup) * gCapa + 31u + sizeof(key_storage) - 1u) / sizeof(key_storage);
+  }
+
+  static MetaGroup* groups_of(Key* keys, size_type capa) noexcept
+  {
+    std::size_t space = 31 + sizeof(MetaGroup);
+    void* ptr = (void*)(keys + capa);
+    void* aligned = std::align(32, sizeof(MetaGroup), ptr, space);
+    INDIVI_UTABLE_ASSERT(aligned);
+    return reinterpret_cast<MetaGroup*>(aligned);
+  }
+
+  template< class Mapped >
+  Iterator<Mapped> make_iterator(size_type slot) const noexcept
+  {
+    if (slot == NPOS)
+      return Iterator<Mapped>();
+    return Iterator<Mapped>((int)(slot % 16), mGroups + slot / 16, mGroups, mKeys + slot, mMapped + slot);
+  }
+
+  // Slot of key (or NPOS), only keys and metadata are read
+  template< typename K >
+  size_type find_impl(std::size_t hash, const K& key) const
+  {
+    size_type gIndex = hash_position(hash, mShift, mGMask);
+    size_type delta = 0u;
+    do {
+      const MetaGroup& group = mGroups[gIndex];
+      int matchs = group.match_hfrag(hash);
+      if (matchs)
+      {
+        const Key* pKey = mKeys + gIndex * 16;
+        INDIVI_PREFETCH(pKey);
+        do {
+          int idx = detail::first_bit_index(matchs);
+          if (mKeyEqual(key, pKey[idx])) // found
+            return gIndex * 16 + (size_type)idx;
+          matchs &= matchs - 1; // remove match
+        }
+        while (matchs);
+      }
+      // not found
+      if (!group.get_overflow(hash))
+        return NPOS;
+      gIndex = (gIndex + (++delta)) & mGMask;
+    }
+    while (gIndex <= mGMask); // non-infinite loop helps optimization
+
+    return NPOS;
+  }
+
+  // First empty slot of the probing sequence, and number of full groups passed ('step')
+  static size_type find_empty(const MetaGroup* groups, size_type shift, size_type gMask, std::size_t hash, uint32_t& step) noexcept
+  {
+    size_type gIndex = hash_position(hash, shift, gMask);
+    size_type delta = 0u;
+    step = 0u;
+    do {
+      int empties = groups[gIndex].match_empty();
+      if (empties) // not full
+        return gIndex * 16 + (size_type)detail::first_bit_index(empties);
+      gIndex = (gIndex + (++delta)) & gMask;
+      ++step;
+    }
+    while (true);
+  }
+
+  // Update metadata of a slot found by `find_empty` (once its key and mapped value are constructed)
+  static void set_slot(MetaGroup* groups, size_type shift, size_type gMask, size_type slot, std::size_t hash, uint32_t step) noexcept
+  {
+    size_type gIndex = hash_position(hash, shift, gMask);
+    size_type delta = 0u;
+    for (uint32_t i = 0u; i < step; ++i)
+    {
+      groups[gIndex].inc_overflow(hash); // set overflow flag
+      gIndex = (gIndex + (++delta)) & gMask;
+    }
+    INDIVI_UTABLE_ASSERT(gIndex == slot / 16);
+    groups[gIndex].set_hfrag((int)(slot % 16), hash);
+    groups[gIndex].set_distance((int)(slot % 16), step);
+  }
+
+  template< typename K, class... Args >
+  std::pair<iterator, bool> emplace_impl(K&& key, Args&&... args)
+  {
+    std::size_t hash = get_hash(key);
+    size_type slot = find_impl(hash, key);
+    if (slot != NPOS)
+      return { make_iterator<T>(slot), false };
+
+    if (mSize >= mMaxSize)
+      rehash_impl(std::max(bucket_count() * 2u, MIN_CAPA));
+
+    uint32_t step;
+    slot = find_empty(mGroups, mShift, mGMask, hash, step);
+    ::new (mKeys + slot) Key(std::forward<K>(key));
+    try
+    {
+      ::new (mMapped + slot) T(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+      mKeys[slot].~Key();
+      throw;
+    }
+    set_slot(mGroups, mShift, mGMask, slot, hash, step);
+    ++mSize;
+    return { make_iterator<T>(slot), true };
+  }
+
+  void erase_slot(size_type slot)
+  {
+    MetaGroup& group = mGroups[slot / 16];
+    int idx = (int)(slot % 16);
+    INDIVI_UTABLE_ASSERT(group.has_hfrag(idx));
+    unsigned int dist = group.get_distance(idx);
+    if (dist < 15u) // valid distance
+    {
+      // decrement overflow counters (walk back the probing sequence)
+      std::size_t hfrag = group.get_hfrag(idx);
+      size_type gIndex = slot / 16;
+      for (; dist > 0u; --dist)
+      {
+        gIndex = (gIndex - dist) & mGMask;
+        mGroups[gIndex].dec_overflow(hfrag);
+      }
+    }
+    else // saturated distance
+    {
+      // fallback: recompute hash, walk from home group
+      std::size_t hash = get_hash(mKeys[slot]);
+      size_type gIndex = hash_position(hash, mShift, mGMask);
+      size_type delta = 0u;
+      while (gIndex != slot / 16)
+      {
+        mGroups[gIndex].dec_overflow(hash);
+        gIndex = (gIndex + (++delta)) & mGMask;
+      }
+    }
+    group.reset_hfrag(idx);
+    group.reset_distance(idx);
+    mKeys[slot].~Key();
+    mMapped[slot].~T();
+    --mSize;
+  }
+
+  template< typename F >
+  void for_each_slot(F fct) const
+  {
+    size_type gCapa = group_capa();
+    for (size_type g = 0u; g < gCapa; ++g)
+    {
+      int sets = mGroups[g].match_set();
+      while (sets)
+      {
+        fct(g * 16 + (size_type)detail::first_bit_index(sets));
+        sets &= sets - 1;
+      }
+    }
+  }
+
+  void destroy_all() noexcept
+  {
+    if (!mSize)
+      return;
+    for_each_slot([this](size_type slot) {
+      mKeys[slot].~Key();
+      mMapped[slot].~T();
+    });
+    mSize = 0u;
+  }
+
+  // Storage of 'capa' slots (metadata zeroed)
+  void allocate(size_type capa, Key*& keys, T*& mapped, MetaGroup*& groups)
+  {
+    size_type gCapa = std::max(capa / 16, (size_type)1u);
+    size_type keyCapa = key_block_capa(capa, gCapa);
+    keys = reinterpret_cast<Key*>(std::addressof(*key_traits::allocate(mKeyAlloc, keyCapa)));
+    try
+    {
+      mapped = std::addressof(*mapped_traits::allocate(mMappedAlloc, capa));
+    }
+    catch (...)
+    {
+      key_traits::deallocate(mKeyAlloc, reinterpret_cast<key_storage*>(keys), keyCapa);
+      throw;
+    }
+    groups = groups_of(keys, capa);
+    std::memset((void*)groups, 0, sizeof(MetaGroup) * gCapa);
+  }
+
+  void deallocate() noexcept
+  {
+    INDIVI_UTABLE_ASSERT(mSize == 0u);
+    if (!mKeys)
+      return;
+    size_type capa = bucket_count();
+    key_traits::deallocate(mKeyAlloc, reinterpret_cast<key_storage*>(mKeys), key_block_capa(capa, mGMask + 1u));
+    mapped_traits::deallocate(mMappedAlloc, mMapped, capa);
+    mGroups = MetaGroup::empty_group();
+    mKeys = nullptr;
+    mMapped = nullptr;
+    mShift = 0u;
+    mGMask = 0u;
+    mMaxSize = 0u;
+  }
+
+  void rehash_impl(size_type newCapa)
+  {
+    INDIVI_UTABLE_ASSERT(newCapa >= MIN_CAPA);
+    size_type newGCapa = std::max(newCapa / 16, (size_type)1u);
+    size_type newShift = hash_shift(newGCapa);
+    size_type newGMask = newGCapa - 1u;
+
+    Key* newKeys;
+    T* newMapped;
+    MetaGroup* newGroups;
+    allocate(newCapa, newKeys, newMapped, newGroups);
+
+    // move existing (keys are hashed again, mapped values only moved)
+    size_type size = mSize;
+    for_each_slot([&](size_type slot) {
+      std::size_t hash = get_hash(mKeys[slot]);
+      uint32_t step;
+      size_type newSlot = find_empty(newGroups, newShift, newGMask, hash, step);
+      ::new (newKeys + newSlot) Key(std::move(mKeys[slot]));
+      ::new (newMapped + newSlot) T(std::move(mMapped[slot]));
+      set_slot(newGroups, newShift, newGMask, newSlot, hash, step);
+    });
+    destroy_all();
+    deallocate();
+
+    mGroups = newGroups;
+    mKeys = newKeys;
+    mMapped = newMapped;
+    mSize = size;
+    mShift = newShift;
+    mGMask = newGMask;
+    mMaxSize = capa_to_maxsize(newCapa);
+  }
+
+  // Same capacity and slots as other (empty table, no storage)
+  void copy_content(const flat_split_map& other)
+  {
+    INDIVI_UTABLE_ASSERT(!mKeys && !mSize);
+    if (!other.mKeys)
+      return;
+
+    size_type capa = other.bucket_count();
+    allocate(capa, mKeys, mMapped, mGroups);
+    mShift = other.mShift;
+    mGMask = other.mGMask;
+    mMaxSize = other.mMaxSize;
+
+    try
+    {
+      other.for_each_slot([&](size_type slot) {
+        ::new (mKeys + slot) Key(other.mKeys[slot]);
+        try
+        {
+          ::new (mMapped + slot) T(other.mMapped[slot]);
+        }
+        catch (...)
+        {
+          mKeys[slot].~Key();
+          throw;
+        }
+        ++mSize;
+      });
+    }
+    catch (...)
+    {
+      // destroy copied (same slot order)
+      size_type copied = mSize;
+      mSize = 0u;
+      other.for_each_slot([&](size_type slot) {
+        if (copied)
+        {
+          mKeys[slot].~Key();
+          mMapped[slot].~T();
+          --copied;
+        }
+      });
+      deallocate();
+      throw;
+    }
+    // same slots, so same metadata (including overflow counters of groups without entries)
+    std::memcpy((void*)mGroups, other.mGroups, sizeof(MetaGroup) * (mGMask + 1u));
+  }
+
+  void steal_content(flat_split_map& other) noexcept
+  {
+    INDIVI_UTABLE_ASSERT(!mKeys && !mSize);
+    mGroups = other.mGroups;
+    mKeys = other.mKeys;
+    mMapped = other.mMapped;
+    mSize = other.mSize;
+    mShift = other.mShift;
+    mGMask = other.mGMask;
+    mMaxSize = other.mMaxSize;
+
+    other.mGroups = MetaGroup::empty_group();
+    other.mKeys = nullptr;
+    other.mMapped = nullptr;
+    other.mSize = 0u;
+    other.mShift = 0u;
+    other.mGMask = 0u;
+    other.mMaxSize = 0u;
+  }
+
+  // Element-wise (unequal allocators)
+  void move_content(flat_split_map& other)
+  {
+    INDIVI_UTABLE_ASSERT(!mKeys && !mSize);
+    reserve(other.size());
+    for (auto it = other.begin(); it != other.end(); ++it)
+      emplace_impl(std::move(*const_cast<Key*>(it.mKey)), std::move(it.mapped()));
+    other.clear();
+  }
+};
+
+} // namespace indivi
+
+#endif // INDIVI_FLAT_SPLIT_MAP_H
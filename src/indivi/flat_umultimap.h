@@ -0,0 +1,281 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#ifndef INDIVI_FLAT_UMULTIMAP_H
+#define INDIVI_FLAT_UMULTIMAP_H
+
+#include "indivi/hash.h"
+#include "indivi/detail/flat_umultitable.h"
+
+#include <functional> // for std::equal_to
+
+namespace indivi
+{
+/*
+ * Flat_umultimap is an associative container that stores unordered key-value pairs, with equivalent keys allowed.
+ * Similar to `std::unordered_multimap` but using the open-addressing schema of `flat_umap` (same table, same metadata).
+ *
+ * Items are stored inline in the table slots (no per-key allocation or indirection), each with its rank among items of its key:
+ * the slot of an item is found by hashing its key and rank, and the first item (rank 0) holds the count of its key.
+ * `count` and insertion are a single lookup, `equal_range` returns forward iterators probing ranks one by one:
+ * unlike `std::unordered_multimap`, items with equivalent keys are not adjacent in iteration order.
+ * Erasing an item moves the last item of its key into its slot (order of equivalent items is unspecified).
+ * Equal range iterators are invalidated by any modification (use `erase(key)` to remove all items of a key).
+ *
+ * Use a default max load factor of 0.875 (runtime setting in [0.25, 0.95]) and growth factor of 2 (any power of 2).
+ * Search and insertion have average constant time 𝓞(1) complexity, whatever the number of items per key (up to 2^31 - 1).
+ */
+template<
+  class Key,
+  class T,
+  class Hash = indivi::hash<Key>,
+  class KeyEqual = std::equal_to<Key>,
+  class Allocator = std::allocator<std::pair<const Key, T>> >
+class flat_umultimap
+{
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using size_type = std::size_t;
+  using difference_type = std::make_signed<size_type>::type;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+
+private:
+  using nc_key_type = typename std::remove_const<Key>::type;
+  using nc_mapped_type = typename std::remove_const<T>::type;
+  using item_type = std::pair<nc_key_type, nc_mapped_type>;
+  using init_type = item_type;
+  using flat_umultitable = detail::flat_umultitable<key_type, value_type, item_type, size_type, hasher, key_equal, allocator_type>;
+
+  static_assert(std::is_same<typename Allocator::value_type, value_type>::value,
+                "flat_umultimap: Allocator::value_type must be the same as value_type");
+
+  // Members
+  flat_umultitable mTable;
+
+public:
+  using iterator = typename flat_umultitable::iterator;
+  using const_iterator = typename flat_umultitable::const_iterator;
+  using equal_iterator = typename flat_umultitable::equal_iterator;
+  using const_equal_iterator = typename flat_umultitable::const_equal_iterator;
+
+private:
+  // Heterogeneous lookup (if both Hash and KeyEqual define 'is_transparent')
+  template< class K, class R >
+  using if_transparent = typename std::enable_if<detail::traits::are_transparent<K, Hash, KeyEqual>::value, R>::type;
+  template< class K, class R >
+  using if_transparent_key = typename std::enable_if<
+    detail::traits::are_transparent<K, Hash, KeyEqual>::value && !detail::traits::is_similar<K, Key>::value
+      && !std::is_convertible<K, iterator>::value && !std::is_convertible<K, const_iterator>::value, R>::type;
+
+public:
+
+  // Ctr/Dtr
+  flat_umultimap() : flat_umultimap(0)
+  {}
+
+  explicit flat_umultimap(const allocator_type& alloc)
+    : mTable(0, Hash(), key_equal(), alloc)
+  {}
+
+  explicit flat_umultimap(size_type bucket_count, const Hash& hash = Hash(), const key_equal& equal = key_equal(),
+                          const allocator_type& alloc = allocator_type())
+    : mTable(bucket_count, hash, equal, alloc)
+  {}
+
+  flat_umultimap(size_type bucket_count, const allocator_type& alloc)
+    : mTable(bucket_count, Hash(), key_equal(), alloc)
+  {}
+
+  flat_umultimap(size_type bucket_count, const Hash& hash, const allocator_type& alloc)
+    : mTable(bucket_count, hash, key_equal(), alloc)
+  {}
+
+  template< class InputIt >
+  flat_umultimap(InputIt first, InputIt last, size_type bucket_count = 0, const Hash& hash = Hash(), const key_equal& equal = key_equal(),
+                 const allocator_type& alloc = allocator_type())
+    : mTable(bucket_count, hash, equal, alloc)
+  {
+    insert(first, last);
+  }
+
+  flat_umultimap(std::initializer_list<value_type> init, size_type bucket_count = 0, const Hash& hash = Hash(), const key_equal& equal = key_equal(),
+                 const allocator_type& alloc = allocator_type())
+    : flat_umultimap(init.begin(), init.end(), bucket_count, hash, equal, alloc)
+  {}
+
+  flat_umultimap(const flat_umultimap& other)
+    : mTable(other.mTable)
+  {}
+
+  flat_umultimap(const flat_umultimap& other, const allocator_type& alloc)
+    : mTable(other.mTable, alloc)
+  {}
+
+  flat_umultimap(flat_umultimap&& other)
+    noexcept(std::is_nothrow_move_constructible<flat_umultitable>::value)
+    : mTable(std::move(other.mTable))
+  {}
+
+  flat_umultimap(flat_umultimap&& other, const allocator_type& alloc)
+    : mTable(std::move(other.mTable), alloc)
+  {}
+
+  ~flat_umultimap() = default;
+
+  // Assignment
+  flat_umultimap& operator=(const flat_umultimap& other)
+  {
+    mTable = other.mTable;
+    return *this;
+  }
+  flat_umultimap& operator=(flat_umultimap&& other) noexcept(std::is_nothrow_move_assignable<flat_umultitable>::value)
+  {
+    mTable = std::move(other.mTable);
+    return *this;
+  }
+  flat_umultimap& operator=(std::initializer_list<value_type> ilist)
+  {
+    clear();
+    insert(ilist.begin(), ilist.end());
+    return *this;
+  }
+
+  // Iterators
+  iterator begin() noexcept { return mTable.begin(); }
+  const_iterator begin() const noexcept { return mTable.begin(); }
+  const_iterator cbegin() const noexcept { return mTable.cbegin(); }
+
+  iterator end() noexcept { return mTable.end(); }
+  const_iterator end() const noexcept { return mTable.cend(); }
+  const_iterator cend() const noexcept { return mTable.cend(); }
+
+  // Capacity
+  bool empty() const noexcept { return mTable.empty(); }
+  size_type size() const noexcept { return mTable.size(); }
+  size_type max_size() const noexcept { return mTable.max_size(); }
+
+  // Bucket interface
+  size_type bucket_count() const noexcept { return mTable.bucket_count(); }
+  size_type max_bucket_count() const noexcept { return mTable.max_bucket_count(); }
+
+  // Hash policy
+  float load_factor() const noexcept { return mTable.load_factor(); }
+  float max_load_factor() const noexcept { return mTable.max_load_factor(); }
+  void max_load_factor(float ml) { mTable.max_load_factor(ml); }
+  // non-standard, capacity multiplier when full (power of 2 in [2, 256])
+  size_type growth_factor() const noexcept { return mTable.growth_factor(); }
+  void growth_factor(size_type factor) noexcept { mTable.growth_factor(factor); }
+  // non-standard, auto downsizing on erase by key below it (0 to disable, default)
+  float min_load_factor() const noexcept { return mTable.min_load_factor(); }
+  void min_load_factor(float ml) noexcept { mTable.min_load_factor(ml); }
+  // non-standard, size at which next insertion triggers a rehash
+  size_type rehash_threshold() const noexcept { return mTable.rehash_threshold(); }
+
+  void rehash(size_type count) { mTable.rehash(count); }
+  void reserve(size_type count) { mTable.reserve(count); }
+  void shrink_to_fit() { mTable.shrink_to_fit(); }
+  // non-standard, move keys on up to 'threadCount' threads (large tables only, hasher must not throw)
+  void rehash(size_type count, unsigned int threadCount) { mTable.rehash(count, threadCount); }
+  void reserve(size_type count, unsigned int threadCount) { mTable.reserve(count, threadCount); }
+
+  // Observers
+  hasher hash_function() const { return mTable.hash_function();  }
+  key_equal key_eq() const { return mTable.key_eq(); }
+  allocator_type get_allocator() const noexcept { return mTable.get_allocator(); }
+
+  // Lookup
+  size_type count(const Key& key) const { return mTable.count_multi(key); }
+  bool contains(const Key& key) const { return mTable.contains(key); }
+  template< class K >
+  if_transparent<K, size_type> count(const K& key) const { return mTable.count_multi(key); }
+  template< class K >
+  if_transparent<K, bool> contains(const K& key) const { return mTable.contains(key); }
+
+  // first item with equivalent key
+  iterator find(const Key& key) { return mTable.find(key); }
+  const_iterator find(const Key& key) const { return mTable.find(key); }
+  template< class K >
+  if_transparent<K, iterator> find(const K& key) { return mTable.find(key); }
+  template< class K >
+  if_transparent<K, const_iterator> find(const K& key) const { return mTable.find(key); }
+
+  // non-standard iterators, convertible to `iterator` (see `equal_iterator`)
+  std::pair<equal_iterator, equal_iterator> equal_range(const Key& key) { return mTable.equal_range(key); }
+  std::pair<const_equal_iterator, const_equal_iterator> equal_range(const Key& key) const { return mTable.equal_range(key); }
+  template< class K >
+  if_transparent<K, std::pair<equal_iterator, equal_iterator>> equal_range(const K& key) { return mTable.equal_range(key); }
+  template< class K >
+  if_transparent<K, std::pair<const_equal_iterator, const_equal_iterator>> equal_range(const K& key) const { return mTable.equal_range(key); }
+
+  // Modifiers
+  void clear() noexcept { mTable.clear(); }
+
+  template< class P >
+  iterator insert(P&& value) { return mTable.insert_multi(std::forward<P>(value)); }
+
+  iterator insert(init_type&& value) { return mTable.insert_multi(std::move(value)); }
+
+  template< class InputIt >
+  void insert(InputIt first, InputIt last)
+  {
+    for (; first != last; ++first)
+      mTable.emplace_multi(*first);
+  }
+
+  template< typename = void > // resolve ambiguities with item_type
+  void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+  void insert(std::initializer_list<item_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+  template< class... Args >
+  iterator emplace(Args&&... args) { return mTable.emplace_multi(std::forward<Args>(args)...); }
+
+  iterator erase_(iterator pos) { return mTable.erase_(pos); }
+  iterator erase_(const_iterator pos) { return mTable.erase_(pos); }
+  // non-standard, see `erase_()`
+  void erase(iterator pos) { mTable.erase(pos); }
+  void erase(const_iterator pos) { mTable.erase(pos); }
+
+  // all items with equivalent key
+  size_type erase(const Key& key) { return mTable.erase_multi(key); }
+  template< class K >
+  if_transparent_key<K, size_type> erase(K&& key) { return mTable.erase_multi(key); }
+
+  void swap(flat_umultimap& other) noexcept(noexcept(mTable.swap(other.mTable))) { mTable.swap(other.mTable); }
+
+  // Non-member
+  friend void swap(flat_umultimap& lhs, flat_umultimap& rhs) noexcept(noexcept(lhs.swap(rhs))) { lhs.swap(rhs); }
+
+  friend bool operator==(const flat_umultimap& lhs, const flat_umultimap& rhs) { return lhs.mTable.equal_multi(rhs.mTable); }
+
+  friend bool operator!=(const flat_umultimap& lhs, const flat_umultimap& rhs) { return !(lhs.mTable.equal_multi(rhs.mTable)); }
+
+  template< class Pred >
+  friend size_type erase_if(flat_umultimap& map, Pred pred) { return map.mTable.erase_if(pred); }
+
+#ifdef INDIVI_FLAT_U_DEBUG
+  bool is_cleared() const noexcept { return mTable.is_cleared(); }
+#endif
+#ifdef INDIVI_FLAT_U_STATS
+  typename flat_umultitable::GroupStats get_group_stats() const noexcept { return mTable.get_group_stats(); }
+  typename flat_umultitable::FindStats get_find_stats() const noexcept { return mTable.get_find_stats(); }
+  void reset_find_stats() noexcept { mTable.reset_find_stats(); }
+#endif
+#ifdef INDIVI_FLAT_U_TELEMETRY
+  flat_telemetry get_telemetry() const noexcept { return mTable.get_telemetry(); }
+  void reset_telemetry() noexcept { mTable.reset_telemetry(); }
+#endif
+};
+
+} // namespace indivi
+
+#endif // INDIVI_FLAT_UMULTIMAP_H
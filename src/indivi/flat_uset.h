@@ -10,6 +10,7 @@
 #include "indivi/detail/flat_utable.h"
 
 #include <functional> // for std::equal_to
+#include <string>
 
 namespace indivi
 {
@@ -17,22 +18,30 @@ namespace indivi
  * Flat_uset is a fast associative container that stores unordered unique keys.
  * Similar to `std::unordered_set` but using an open-addressing schema,
  * with a dynamically allocated, consolidated array of values and metadata (capacity grows based on power of 2).
- * It is optimized for small sizes (starting at 2, container sizeof is 48 Bytes on 64-bits).
+ * It is optimized for small sizes (starting at 2, container sizeof is 56 Bytes on 64-bits).
  *
  * Each entry uses 2 additional bytes of metadata (to store hash fragments, overflow counters and distances from original buckets).
  * Avoiding the need for a tombstone mechanism or rehashing on iterator erase (with a good hash function).
  * By grouping buckets, it also relies on SIMD operations for speed (SSE2 or NEON are mandatory).
  *
  * Come with an optimized 64-bits hash function by default (see `hash.h`).
- * Use a fixed max load factor of 0.875.
- * Iterators are invalidated on usual open-addressing operations (except the end iterator), but never on erase.
+ * Allocator-aware: the consolidated storage is allocated through a rebound `Allocator` (one allocation per rehash).
+ * Support heterogeneous lookup if both Hash and KeyEqual are transparent (e.g. `indivi::hash<std::string>` with `std::equal_to<>`).
+ * Opt-in stored hashes with `indivi::stored_hash<Hash>` (no re-hashing on rehash, key comparisons skipped on hash mismatch).
+ * Opt-in inline storage with 'InlineN' (up to 16 entries kept inside the object, heap storage only allocated past them).
+ * Moving or swapping an inline storage moves its items one by one (iterators are invalidated, items must be nothrow movable).
+ * Use a default max load factor of 0.875 (runtime setting in [0.25, 0.95]) and growth factor of 2 (any power of 2).
+ * Iterators are invalidated on usual open-addressing operations (except the end iterator), but never on erase
+ * (unless auto downsizing is enabled, see `min_load_factor(float)`).
  * Search, insertion, and removal of elements have average constant time 𝓞(1) complexity.
  * Best for general purpose scenarios, including erasure and iteration.
  */
 template<
   class Key,
   class Hash = indivi::hash<Key>,
-  class KeyEqual = std::equal_to<Key> >
+  class KeyEqual = std::equal_to<Key>,
+  class Allocator = std::allocator<Key>,
+  std::size_t InlineN = 0u >
 class flat_uset
 {
 public:
@@ -42,6 +51,7 @@ public:
   using difference_type = std::make_signed<size_type>::type;
   using hasher = Hash;
   using key_equal = KeyEqual;
+  using allocator_type = Allocator;
   using reference = value_type&;
   using const_reference = const value_type&;
   using pointer = value_type*;
@@ -50,11 +60,16 @@ public:
 private:
   using nc_key_type = typename std::remove_const<Key>::type;
   using item_type = nc_key_type;
-  using flat_utable = detail::flat_utable<key_type, void*, value_type, item_type, size_type, hasher, key_equal>;
+  using flat_utable = detail::flat_utable<key_type, void*, value_type, item_type, size_type, hasher, key_equal, allocator_type, InlineN>;
+
+  static_assert(std::is_same<typename Allocator::value_type, value_type>::value,
+                "flat_uset: Allocator::value_type must be the same as value_type");
 
   // Members
   flat_utable mTable;
 
+  template< class > friend class flat_mapped;
+
   size_type group_capa() const noexcept { return mTable.group_capa(); }
   Hash& hash() noexcept { return mTable.hash(); }
   const Hash& hash() const noexcept { return mTable.hash(); }
@@ -64,33 +79,69 @@ private:
 public:
   using iterator = typename flat_utable::iterator;
   using const_iterator = typename flat_utable::const_iterator;
+  using node_type = typename flat_utable::node_type;
+  using insert_return_type = typename flat_utable::insert_return_type;
+
+private:
+  // Heterogeneous lookup (if both Hash and KeyEqual define 'is_transparent')
+  template< class K, class R >
+  using if_transparent = typename std::enable_if<detail::traits::are_transparent<K, Hash, KeyEqual>::value, R>::type;
+  template< class K, class R >
+  using if_transparent_key = typename std::enable_if<
+    detail::traits::are_transparent<K, Hash, KeyEqual>::value && !detail::traits::is_similar<K, Key>::value
+      && !std::is_convertible<K, iterator>::value && !std::is_convertible<K, const_iterator>::value, R>::type;
+
+public:
 
   // Ctr/Dtr
   flat_uset() : flat_uset(0)
   {}
 
-  explicit flat_uset(size_type bucket_count, const Hash& hash = Hash(), const key_equal& equal = key_equal())
-    : mTable(bucket_count, hash, equal)
+  explicit flat_uset(const allocator_type& alloc)
+    : mTable(0, Hash(), key_equal(), alloc)
+  {}
+
+  explicit flat_uset(size_type bucket_count, const Hash& hash = Hash(), const key_equal& equal = key_equal(),
+                     const allocator_type& alloc = allocator_type())
+    : mTable(bucket_count, hash, equal, alloc)
+  {}
+
+  flat_uset(size_type bucket_count, const allocator_type& alloc)
+    : mTable(bucket_count, Hash(), key_equal(), alloc)
+  {}
+
+  flat_uset(size_type bucket_count, const Hash& hash, const allocator_type& alloc)
+    : mTable(bucket_count, hash, key_equal(), alloc)
   {}
 
   template< class InputIt >
-  flat_uset(InputIt first, InputIt last, size_type bucket_count = 0, const Hash& hash = Hash(), const key_equal& equal = key_equal())
-    : mTable(first, last, bucket_count, hash, equal)
+  flat_uset(InputIt first, InputIt last, size_type bucket_count = 0, const Hash& hash = Hash(), const key_equal& equal = key_equal(),
+            const allocator_type& alloc = allocator_type())
+    : mTable(first, last, bucket_count, hash, equal, alloc)
   {}
 
-  flat_uset(std::initializer_list<value_type> init, size_type bucket_count = 0, const Hash& hash = Hash(), const key_equal& equal = key_equal())
-    : mTable(init.begin(), init.end(), bucket_count, hash, equal)
+  flat_uset(std::initializer_list<value_type> init, size_type bucket_count = 0, const Hash& hash = Hash(), const key_equal& equal = key_equal(),
+            const allocator_type& alloc = allocator_type())
+    : mTable(init.begin(), init.end(), bucket_count, hash, equal, alloc)
   {}
 
   flat_uset(const flat_uset& other)
     : mTable(other.mTable)
   {}
 
+  flat_uset(const flat_uset& other, const allocator_type& alloc)
+    : mTable(other.mTable, alloc)
+  {}
+
   flat_uset(flat_uset&& other)
     noexcept(std::is_nothrow_move_constructible<flat_utable>::value)
     : mTable(std::move(other.mTable))
   {}
 
+  flat_uset(flat_uset&& other, const allocator_type& alloc)
+    : mTable(std::move(other.mTable), alloc)
+  {}
+
   ~flat_uset() = default;
 
   // Assignment
@@ -132,21 +183,47 @@ public:
   // Hash policy
   float load_factor() const noexcept { return mTable.load_factor(); }
   float max_load_factor() const noexcept { return mTable.max_load_factor(); }
-  void max_load_factor(float) noexcept { /*for compatibility*/ }
+  void max_load_factor(float ml) { mTable.max_load_factor(ml); }
+  // non-standard, capacity multiplier when full (power of 2 in [2, 256])
+  size_type growth_factor() const noexcept { return mTable.growth_factor(); }
+  void growth_factor(size_type factor) noexcept { mTable.growth_factor(factor); }
+  // non-standard, auto downsizing on erase by key below it (0 to disable, default)
+  float min_load_factor() const noexcept { return mTable.min_load_factor(); }
+  void min_load_factor(float ml) noexcept { mTable.min_load_factor(ml); }
+  // non-standard, size at which next insertion triggers a rehash
+  size_type rehash_threshold() const noexcept { return mTable.rehash_threshold(); }
 
   void rehash(size_type count) { mTable.rehash(count); }
   void reserve(size_type count) { mTable.reserve(count); }
+  void shrink_to_fit() { mTable.shrink_to_fit(); }
+  // non-standard, move elements on up to 'threadCount' threads (large tables only, hasher must not throw)
+  void rehash(size_type count, unsigned int threadCount) { mTable.rehash(count, threadCount); }
+  void reserve(size_type count, unsigned int threadCount) { mTable.reserve(count, threadCount); }
 
   // Observers
   hasher hash_function() const { return mTable.hash_function(); }
   key_equal key_eq() const { return mTable.key_eq(); }
+  allocator_type get_allocator() const noexcept { return mTable.get_allocator(); }
 
   // Lookup
   size_type count(const Key& key) const { return mTable.count(key); }
   bool contains(const Key& key) const { return mTable.contains(key); }
+  template< class K >
+  if_transparent<K, size_type> count(const K& key) const { return mTable.count(key); }
+  template< class K >
+  if_transparent<K, bool> contains(const K& key) const { return mTable.contains(key); }
 
   iterator find(const Key& key) { return mTable.find(key); }
   const_iterator find(const Key& key) const { return mTable.find(key); }
+  template< class K >
+  if_transparent<K, iterator> find(const K& key) { return mTable.find(key); }
+  template< class K >
+  if_transparent<K, const_iterator> find(const K& key) const { return mTable.find(key); }
+
+  // non-standard, batched lookup (hash and prefetch all keys first, then probe)
+  void find_batch(const Key* keys, size_type count, iterator* out) { mTable.find_batch(keys, count, out); }
+  void find_batch(const Key* keys, size_type count, const_iterator* out) const { mTable.find_batch(keys, count, out); }
+  void contains_batch(const Key* keys, size_type count, bool* out) const { mTable.contains_batch(keys, count, out); }
 
   // Modifiers
   void clear() noexcept { mTable.clear(); }
@@ -159,6 +236,10 @@ public:
   template< class InputIt >
   void insert(InputIt first, InputIt last) { mTable.insert(first, last); }
 
+  // non-standard, bulk insertion of unique keys (unchecked, faster for large ranges)
+  template< class ForwardIt >
+  void insert_unique_range(ForwardIt first, ForwardIt last) { mTable.insert_unique_range(first, last); }
+
   void insert(std::initializer_list<value_type> ilist) { mTable.insert_list(ilist); }
 
   template< class... Args >
@@ -171,6 +252,20 @@ public:
   void erase(const_iterator pos) { mTable.erase(pos); }
 
   size_type erase(const Key& key) { return mTable.erase(key); }
+  template< class K >
+  if_transparent_key<K, size_type> erase(K&& key) { return mTable.erase(std::forward<K>(key)); }
+
+  // Node handle (element moved out with its hash, see 'detail/flat_node.h')
+  node_type extract(const_iterator pos) { return mTable.extract(pos); }
+  node_type extract(const Key& key) { return mTable.extract(key); }
+  insert_return_type insert(node_type&& node) { return mTable.insert(std::move(node)); }
+
+  // non-standard, same container type only (elements whose key is already present are left in source)
+  void merge(flat_uset& source) { mTable.merge(source.mTable); }
+  void merge(flat_uset&& source) { mTable.merge(source.mTable); }
+
+  // Snapshot to file, for read-only memory mapping (trivially copyable Key/T only, see 'flat_mapped.h')
+  void save(const std::string& path) const { detail::save_snapshot_file(mTable, path); }
 
   void swap(flat_uset& other) noexcept(noexcept(mTable.swap(other.mTable))) { mTable.swap(other.mTable); }
 
@@ -192,6 +287,10 @@ public:
   typename flat_utable::FindStats get_find_stats() const noexcept { return mTable.get_find_stats(); }
   void reset_find_stats() noexcept { return mTable.reset_find_stats(); }
 #endif
+#ifdef INDIVI_FLAT_U_TELEMETRY
+  flat_telemetry get_telemetry() const noexcept { return mTable.get_telemetry(); }
+  void reset_telemetry() noexcept { mTable.reset_telemetry(); }
+#endif
 };
 
 } // namespace indivi
@@ -0,0 +1,422 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#ifndef INDIVI_FROZEN_MAP_H
+#define INDIVI_FROZEN_MAP_H
+
+#include "indivi/hash.h"
+#include "indivi/detail/indivi_utils.h"
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace indivi
+{
+/*
+ * Frozen_map is an immutable associative container, built once from a range of key-value pairs (e.g. a `flat_umap`).
+ * Keys are placed with a minimal perfect hash (hash-and-displace, similar to PTHash):
+ * - keys are spread into buckets (4 keys on average), each bucket storing a 16-bit 'pilot'
+ * - the pilot displaces all keys of its bucket into free slots (found by trial at build time, biggest buckets first)
+ * - slots above size (table is 3% bigger than needed during build) are remapped into holes below size
+ * Lookup is one hash, one pilot read and one key comparison (no probing loop, no metadata scan).
+ * As the value read depends on the pilot read, `find_batch` is preferred on large maps (interleaves lookups).
+ * Values are stored contiguously without holes (about 0.8 bytes of metadata per entry), iteration order is unspecified.
+ *
+ * Build is more expensive than inserting into a hash table (a few passes plus pilot search, not incremental).
+ * Duplicate keys in source range are ignored (first one kept).
+ * Distinct keys must have distinct hashes (always true with a good 64-bits hash), otherwise throws `std::invalid_argument`.
+ */
+template< class Key,
+          class T,
+          class Hash = indivi::hash<Key>,
+          class KeyEqual = std::equal_to<Key>,
+          class Allocator = std::allocator<std::pair<const Key, T>> >
+class frozen_map
+{
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = typename std::allocator_traits<Allocator>::pointer;
+  using const_pointer = typename std::allocator_traits<Allocator>::const_pointer;
+  using const_iterator = const value_type*; // immutable
+  using iterator = const_iterator;
+
+private:
+  using pilot_type = uint16_t;
+
+  using alloc_traits = std::allocator_traits<Allocator>;
+  using pilot_allocator = typename alloc_traits::template rebind_alloc<pilot_type>;
+  using size_allocator = typename alloc_traits::template rebind_alloc<size_type>;
+
+  static constexpr size_type BUCKET_LOAD{ 4u };         // average number of keys per bucket
+  static constexpr size_type SLOTS_EXTRA_SHIFT{ 5u };   // build table size: n + n/32 + 1
+  static constexpr uint32_t MAX_PILOT{ UINT16_MAX };
+  static constexpr unsigned int MAX_SEEDS{ 32u };       // build attempts before giving up
+  static constexpr size_type BATCH_SIZE{ 16u };         // number of interleaved lookups in batched lookup
+
+  // Members
+  std::vector<value_type, Allocator> mValues;           // in slot order
+  std::vector<pilot_type, pilot_allocator> mPilots;     // one per bucket
+  std::vector<size_type, size_allocator> mRemap;        // slots >= size, remapped into holes
+  uint64_t mSeed = 0u;
+  size_type mSlots = 0u;
+  Hash mHash;
+  KeyEqual mKeyEqual;
+
+  // Build entry
+  template< typename It >
+  struct Entry
+  {
+    It it;
+    uint64_t hash; // from hasher
+    uint64_t mixed; // seeded
+    size_type slot;
+  };
+
+public:
+  // Ctr/Dtr
+  frozen_map() : frozen_map(Hash(), KeyEqual(), Allocator())
+  {}
+
+  explicit frozen_map(const Hash& hash, const KeyEqual& equal = KeyEqual(), const Allocator& alloc = Allocator())
+    : mValues(alloc)
+    , mPilots(pilot_allocator(alloc))
+    , mRemap(size_allocator(alloc))
+    , mHash(hash)
+    , mKeyEqual(equal)
+  {}
+
+  explicit frozen_map(const Allocator& alloc)
+    : frozen_map(Hash(), KeyEqual(), alloc)
+  {}
+
+  // Build from a range of key-value pairs (e.g. `fum.begin(), fum.end()`)
+  template< class ForwardIt >
+  frozen_map(ForwardIt first, ForwardIt last,
+             const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual(), const Allocator& alloc = Allocator())
+    : frozen_map(hash, equal, alloc)
+  {
+    build(first, last);
+  }
+
+  frozen_map(std::initializer_list<value_type> init,
+             const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual(), const Allocator& alloc = Allocator())
+    : frozen_map(init.begin(), init.end(), hash, equal, alloc)
+  {}
+
+  frozen_map(const frozen_map&) = default;
+  frozen_map(frozen_map&&) = default;
+  ~frozen_map() = default;
+
+  // Assignment
+  frozen_map& operator=(const frozen_map& other)
+  {
+    if (this != &other)
+    {
+      frozen_map tmp(other); // const keys, no element-wise assignment
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  frozen_map& operator=(frozen_map&&) = default;
+
+  // Iterators
+  const_iterator begin() const noexcept { return mValues.data(); }
+  const_iterator cbegin() const noexcept { return mValues.data(); }
+  const_iterator end() const noexcept { return mValues.data() + mValues.size(); }
+  const_iterator cend() const noexcept { return mValues.data() + mValues.size(); }
+
+  // Capacity
+  bool empty() const noexcept { return mValues.empty(); }
+  size_type size() const noexcept { return mValues.size(); }
+  size_type bucket_count() const noexcept { return mPilots.size(); }
+
+  // Lookup
+  const_iterator find(const Key& key) const
+  {
+    if (mValues.empty())
+      return end();
+
+    const value_type& value = mValues[slot_index(mixed_hash(mHash(key)))];
+    return mKeyEqual(value.first, key) ? &value : end();
+  }
+
+  bool contains(const Key& key) const { return find(key) != end(); }
+  size_type count(const Key& key) const { return contains(key) ? 1u : 0u; }
+
+  // Batched lookup (hides pilots then values latencies by interleaving 'count' lookups)
+  void find_batch(const Key* keys, size_type count, const_iterator* out) const
+  {
+    find_batch_impl(keys, count, [&](size_type i, const_iterator it) { out[i] = it; });
+  }
+
+  void contains_batch(const Key* keys, size_type count, bool* out) const
+  {
+    find_batch_impl(keys, count, [&](size_type i, const_iterator it) { out[i] = it != end(); });
+  }
+
+  // Observers
+  hasher hash_function() const { return mHash; }
+  key_equal key_eq() const { return mKeyEqual; }
+  allocator_type get_allocator() const { return mValues.get_allocator(); }
+
+  // Modifiers
+  void swap(frozen_map& other)
+  {
+    using std::swap;
+    mValues.swap(other.mValues);
+    mPilots.swap(other.mPilots);
+    mRemap.swap(other.mRemap);
+    swap(mSeed, other.mSeed);
+    swap(mSlots, other.mSlots);
+    swap(mHash, other.mHash);
+    swap(mKeyEqual, other.mKeyEqual);
+  }
+
+  friend void swap(frozen_map& lhs, frozen_map& rhs) { lhs.swap(rhs); }
+
+private:
+  // 64x64 -> high 64 bits, i.e. uniform value in [0, range)
+  static inline uint64_t reduce(uint64_t x, uint64_t range) noexcept
+  {
+    detail::wyhash::mum(&x, &range);
+    return range;
+  }
+
+  inline uint64_t mixed_hash(std::size_t hash) const noexcept
+  {
+    return detail::wyhash::mix(static_cast<uint64_t>(hash) ^ mSeed, UINT64_C(0x9E3779B97F4A7C15));
+  }
+
+  // Bucket from high bits, slot from all bits re-mixed with pilot
+  static inline size_type bucket_of(uint64_t mixed, size_type buckets) noexcept
+  {
+    return static_cast<size_type>(reduce(mixed, buckets));
+  }
+
+  static inline size_type slot_of(uint64_t mixed, pilot_type pilot, size_type slots) noexcept
+  {
+    uint64_t x = (mixed ^ (UINT64_C(0xC6A4A7935BD1E995) * (pilot + 1u))) * UINT64_C(0xFF51AFD7ED558CCD);
+    x ^= x >> 32;
+    return static_cast<size_type>(reduce(x, slots));
+  }
+
+  inline size_type slot_index(uint64_t mixed) const noexcept
+  {
+    size_type slot = slot_of(mixed, mPilots[bucket_of(mixed, mPilots.size())], mSlots);
+    return slot < mValues.size() ? slot : mRemap[slot - mValues.size()];
+  }
+
+  template< typename F >
+  void find_batch_impl(const Key* keys, size_type count, F fct) const
+  {
+    uint64_t hashes[BATCH_SIZE];
+    size_type slots[BATCH_SIZE];
+
+    for (size_type first = 0u; first < count; first += BATCH_SIZE)
+    {
+      size_type batchSize = std::min(count - first, (size_type)BATCH_SIZE);
+      if (mValues.empty())
+      {
+        for (size_type i = 0u; i < batchSize; ++i)
+          fct(first + i, end());
+        continue;
+      }
+      // hash all and prefetch pilots
+      for (size_type i = 0u; i < batchSize; ++i)
+      {
+        hashes[i] = mixed_hash(mHash(keys[first + i]));
+        INDIVI_PREFETCH(&mPilots[bucket_of(hashes[i], mPilots.size())]);
+      }
+      // prefetch values (pilots should be in flight by now)
+      for (size_type i = 0u; i < batchSize; ++i)
+      {
+        slots[i] = slot_index(hashes[i]);
+        INDIVI_PREFETCH(&mValues[slots[i]]);
+      }
+      // compare
+      for (size_type i = 0u; i < batchSize; ++i)
+      {
+        const value_type& value = mValues[slots[i]];
+        fct(first + i, mKeyEqual(value.first, keys[first + i]) ? &value : end());
+      }
+    }
+  }
+
+  template< class ForwardIt >
+  void build(ForwardIt first, ForwardIt last)
+  {
+    using entry_type = Entry<ForwardIt>; // source elements are read twice (hashing, then copy)
+
+    std::vector<entry_type> entries;
+    for (; first != last; ++first)
+      entries.push_back(entry_type{ first, static_cast<uint64_t>(mHash((*first).first)), 0u, 0u });
+    if (entries.empty())
+      return;
+
+    std::vector<size_type> bucketStarts;
+    std::vector<size_type> order;
+    for (unsigned int attempt = 0u; attempt < MAX_SEEDS; ++attempt)
+    {
+      mSeed = detail::wyhash::mix(UINT64_C(0x2D358DCCAA6C78A5) + attempt, UINT64_C(0x8BB84B93962EACC9));
+      if (try_build(entries, bucketStarts, order))
+      {
+        place(entries);
+        return;
+      }
+    }
+    throw std::invalid_argument("frozen_map: failed to build perfect hash");
+  }
+
+  // Return false to retry with another seed
+  template< class Entries >
+  bool try_build(Entries& entries, std::vector<size_type>& bucketStarts, std::vector<size_type>& order)
+  {
+    size_type size = entries.size();
+    size_type buckets = size / BUCKET_LOAD + 1u;
+    mSlots = size + (size >> SLOTS_EXTRA_SHIFT) + 1u;
+    mPilots.assign(buckets, 0u);
+
+    // Bucket sort (stable, source order kept within buckets)
+    bucketStarts.assign(buckets + 1u, 0u);
+    for (auto& entry : entries)
+    {
+      entry.mixed = mixed_hash(static_cast<std::size_t>(entry.hash));
+      ++bucketStarts[bucket_of(entry.mixed, buckets) + 1u];
+    }
+    for (size_type i = 0u; i < buckets; ++i)
+      bucketStarts[i + 1u] += bucketStarts[i];
+
+    order.resize(size);
+    {
+      std::vector<size_type> cursors(bucketStarts.begin(), bucketStarts.end() - 1);
+      for (size_type i = 0u; i < size; ++i)
+        order[cursors[bucket_of(entries[i].mixed, buckets)]++] = i;
+    }
+
+    // Drop duplicate keys (first kept), detect hash collisions
+    bool dropped = false;
+    for (size_type b = 0u; b < buckets; ++b)
+    {
+      for (size_type i = bucketStarts[b]; i < bucketStarts[b + 1u]; ++i)
+      {
+        auto& lhs = entries[order[i]];
+        if (lhs.slot == SIZE_MAX)
+          continue;
+        for (size_type j = i + 1u; j < bucketStarts[b + 1u]; ++j)
+        {
+          auto& rhs = entries[order[j]];
+          if (rhs.mixed != lhs.mixed || rhs.slot == SIZE_MAX)
+            continue;
+          if (mKeyEqual((*lhs.it).first, (*rhs.it).first))
+          {
+            rhs.slot = SIZE_MAX; // duplicate
+            dropped = true;
+          }
+          else if (rhs.hash == lhs.hash)
+            throw std::invalid_argument("frozen_map: different keys with same hash");
+          else
+            return false; // seeded collision
+        }
+      }
+    }
+    if (dropped)
+    {
+      entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                   [](const typename Entries::value_type& entry) { return entry.slot == SIZE_MAX; }),
+                    entries.end());
+      return try_build(entries, bucketStarts, order);
+    }
+
+    // Biggest buckets first
+    std::vector<size_type> bucketOrder(buckets);
+    for (size_type b = 0u; b < buckets; ++b)
+      bucketOrder[b] = b;
+    std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&](size_type lhs, size_type rhs) {
+      return bucketStarts[lhs + 1u] - bucketStarts[lhs] > bucketStarts[rhs + 1u] - bucketStarts[rhs];
+    });
+
+    // Pilots search
+    std::vector<uint8_t> taken(mSlots, 0u);
+    for (size_type b : bucketOrder)
+    {
+      size_type start = bucketStarts[b];
+      size_type end = bucketStarts[b + 1u];
+      if (start == end)
+        break; // only empty buckets left
+
+      uint32_t pilot = 0u;
+      for (; pilot <= MAX_PILOT; ++pilot)
+      {
+        size_type i = start;
+        for (; i < end; ++i)
+        {
+          auto& entry = entries[order[i]];
+          entry.slot = slot_of(entry.mixed, static_cast<pilot_type>(pilot), mSlots);
+          if (taken[entry.slot])
+            break;
+          taken[entry.slot] = 1u;
+        }
+        if (i == end)
+          break; // found
+        for (size_type j = start; j < i; ++j) // rollback
+          taken[entries[order[j]].slot] = 0u;
+      }
+      if (pilot > MAX_PILOT)
+        return false;
+      mPilots[b] = static_cast<pilot_type>(pilot);
+    }
+
+    // Remap slots >= size into holes
+    mRemap.assign(mSlots - size, 0u);
+    size_type hole = 0u;
+    for (size_type slot = size; slot < mSlots; ++slot)
+    {
+      if (!taken[slot])
+        continue;
+      while (taken[hole])
+        ++hole;
+      mRemap[slot - size] = hole++;
+    }
+    return true;
+  }
+
+  template< class Entries >
+  void place(const Entries& entries)
+  {
+    size_type size = entries.size();
+    std::vector<size_type> bySlot(size);
+    for (size_type i = 0u; i < size; ++i)
+    {
+      size_type slot = entries[i].slot;
+      bySlot[slot < size ? slot : mRemap[slot - size]] = i;
+    }
+
+    mValues.reserve(size);
+    for (size_type i = 0u; i < size; ++i)
+      mValues.emplace_back(*entries[bySlot[i]].it);
+  }
+};
+
+} // namespace indivi
+
+#endif // INDIVI_FROZEN_MAP_H
@@ -4,7 +4,11 @@
  */
 
 // Based on wyhash, identity for basic types and fallback on std::hash
-// Only supports uint64_t version currently
+// Long strings hashed with AES-NI when available at compile time (build-dependent values)
+// 64-bit hashes (size_t), opt-in 32-bit hashes for flat containers (`hash_32bits`)
+// Opt-in seeded variant (`seeded_hash`), with per-process or per-table random seed
+// Composite keys (pair, tuple, array) combine their members hashes
+// Streaming hash of segmented byte sequences (`hash_state`), same as one-shot string hash
 // https://github.com/wangyi-fudan/wyhash
 // Free and unencumbered software released into the public domain.
 
@@ -14,8 +18,12 @@
 #include "indivi/detail/indivi_defines.h"
 #include "indivi/detail/indivi_utils.h"
 
+#include <array>
+#include <chrono>
 #include <memory>
+#include <random>
 #include <string>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
@@ -25,6 +33,10 @@
 #ifdef INDIVI_MSVC
   #include <intrin.h> // for _umul128
 #endif
+#if defined(INDIVI_SIMD_AES) && defined(INDIVI_ARCH_64) && !defined(INDIVI_HASH_PORTABLE)
+  #define INDIVI_HASH_AES // AES-NI kernel for long strings (define 'INDIVI_HASH_PORTABLE' for same hashes on all builds)
+  #include <wmmintrin.h>
+#endif
 #ifdef INDIVI_CPP17
   #include <cstddef>
   #include <string_view>
@@ -105,15 +117,22 @@ namespace wyhash
       | (static_cast<uint64_t>(p[k >> 1U]) << 8U) | p[k - 1];
   }
 
-  inline uint64_t hash(const void* key, size_t len)
+  static constexpr uint64_t secret[] { UINT64_C(0x2d358dccaa6c78a5),
+                                       UINT64_C(0x8bb84b93962eacc9),
+                                       UINT64_C(0x4b33a62ed433d4a3),
+                                       UINT64_C(0x4d5a2da51de1aa47) };
+
+  // Spread user seed into a secret key (0 for unseeded)
+  inline uint64_t seed_key(uint64_t seed)
   {
-    static constexpr uint64_t secret[] { UINT64_C(0x2d358dccaa6c78a5),
-                                         UINT64_C(0x8bb84b93962eacc9),
-                                         UINT64_C(0x4b33a62ed433d4a3),
-                                         UINT64_C(0x4d5a2da51de1aa47) };
+    return seed ? mix(seed ^ secret[0], secret[1]) : 0u;
+  }
 
+  // 'seedKey' from `seed_key()`
+  inline uint64_t hash(const void* key, size_t len, uint64_t seedKey = 0u)
+  {
     const uint8_t* p = static_cast<const uint8_t*>(key);
-    uint64_t seed = secret[0];
+    uint64_t seed = secret[0] ^ seedKey;
     uint64_t a{};
     uint64_t b{};
 
@@ -169,6 +188,98 @@ namespace wyhash
 
 } // namespace wyhash
 
+#ifdef INDIVI_HASH_AES
+// AES-NI kernel for long keys: 4 independent 16-bytes lanes (one keyed AES round per block, then one lane round, 64 bytes per loop),
+// then lanes merged and finalized with 3 rounds (full diffusion), folded to 64 bits
+namespace aeshash
+{
+  static constexpr std::size_t MIN_LEN{ 32u }; // shorter keys are faster with wyhash
+
+  inline __m128i load(const uint8_t* p)
+  {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  }
+
+  // Hashing lanes (64 bytes per update)
+  // All lanes and keys depend on the seed. Each block goes through a keyed round (off the lanes dependency chain)
+  // before being absorbed by a lane round: a block cannot cancel a known difference of the (seeded) lane state
+  struct state
+  {
+    __m128i k0;
+    __m128i k1;
+    __m128i s0;
+    __m128i s1;
+    __m128i s2;
+    __m128i s3;
+
+    explicit state(uint64_t seedKey)
+      : k0(_mm_set_epi64x((int64_t)wyhash::secret[1], (int64_t)(wyhash::secret[0] ^ seedKey)))
+      , k1(_mm_set_epi64x((int64_t)(wyhash::secret[3] ^ seedKey), (int64_t)wyhash::secret[2]))
+      , s0(k0)
+      , s1(k1)
+      , s2(_mm_shuffle_epi32(k0, 0x4E)) // swap halves
+      , s3(_mm_shuffle_epi32(k1, 0x4E))
+    {}
+
+    __m128i absorb(__m128i s, const uint8_t* p) const
+    {
+      return _mm_aesenc_si128(s, _mm_aesenc_si128(_mm_xor_si128(load(p), k0), k1));
+    }
+
+    void update(const uint8_t* p0, const uint8_t* p1, const uint8_t* p2, const uint8_t* p3)
+    {
+      s0 = absorb(s0, p0);
+      s1 = absorb(s1, p1);
+      s2 = absorb(s2, p2);
+      s3 = absorb(s3, p3);
+    }
+    void update(const uint8_t* p) { update(p, p + 16, p + 32, p + 48); }
+
+    uint64_t finish(size_t len) const
+    {
+      __m128i h = _mm_aesenc_si128(_mm_aesenc_si128(s0, s1), _mm_aesenc_si128(s2, s3));
+      h = _mm_xor_si128(h, _mm_set1_epi64x((int64_t)len));
+      h = _mm_aesenc_si128(h, k0);
+      h = _mm_aesenc_si128(h, k1);
+      h = _mm_aesenc_si128(h, k0);
+      return (uint64_t)_mm_cvtsi128_si64(h) ^ (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(h, h));
+    }
+  };
+
+  // 'len' > MIN_LEN, 'seedKey' from `wyhash::seed_key()`
+  inline uint64_t hash(const void* key, size_t len, uint64_t seedKey)
+  {
+    const uint8_t* p = static_cast<const uint8_t*>(key);
+    const uint8_t* end = p + len;
+    state st(seedKey);
+
+    if (len <= 64u)
+    {
+      st.update(p, p + 16, end - 32, end - 16); // first and last 32 bytes (may overlap)
+    }
+    else
+    {
+      for (; end - p > 64; p += 64)
+        st.update(p);
+      st.update(end - 64); // last 64 bytes (may overlap)
+    }
+    return st.finish(len);
+  }
+
+} // namespace aeshash
+#endif
+
+// Strings hashing (AES-NI kernel for long strings if available, else wyhash)
+// 'seedKey' from `wyhash::seed_key()` (0 for unseeded)
+inline uint64_t string_hash(const void* key, size_t len, uint64_t seedKey = 0u)
+{
+#ifdef INDIVI_HASH_AES
+  if (len > aeshash::MIN_LEN)
+    return aeshash::hash(key, len, seedKey);
+#endif
+  return wyhash::hash(key, len, seedKey);
+}
+
 // Abstraction for optional hash mixer
 struct no_mix
 {
@@ -177,6 +288,8 @@ struct no_mix
   {
     return hasher(v);
   }
+
+  static inline void mix_range(std::size_t*, std::size_t) {}
 };
 
 struct bit_mix
@@ -184,18 +297,91 @@ struct bit_mix
   template< typename H, typename V >
   static inline std::size_t mix(const H& hasher, const V& v)
   {
-    std::size_t hash = hasher(v);
+    return mix_hash(hasher(v));
+  }
+
+  static inline void mix_range(std::size_t* hashes, std::size_t count)
+  {
+    for (std::size_t i = 0u; i < count; ++i)
+      hashes[i] = mix_hash(hashes[i]);
+  }
+
+  // 'seedKey' from `wyhash::seed_key()` (0 for unseeded)
+  static inline std::size_t mix_hash(std::size_t hash, uint64_t seedKey = 0u)
+  {
   #ifdef INDIVI_ARCH_64
     constexpr uint64_t phi = UINT64_C(0x9E3779B97F4A7C15);
-    return wyhash::mix(hash, phi);
+    return wyhash::mix(hash ^ seedKey, phi);
   #else // 32-bits assumed
     // from https://arxiv.org/abs/2001.05304
     constexpr uint32_t multiplier = UINT32_C(0xE817FB2D);
-    return wyhash::mix32(hash, multiplier);
+    return wyhash::mix32(hash ^ (uint32_t)seedKey, multiplier);
   #endif
   }
 };
 
+// 32-bit hashes: same bits in both halves of size_t (highest bits for positions, lowest bits for fragments)
+inline std::size_t spread32(uint32_t hash)
+{
+#ifdef INDIVI_ARCH_64
+  return ((std::size_t)hash << 32) | hash;
+#else
+  return hash;
+#endif
+}
+
+struct no_mix32
+{
+  template< typename H, typename V >
+  static inline std::size_t mix(const H& hasher, const V& v)
+  {
+    return spread32((uint32_t)hasher(v));
+  }
+
+  static inline void mix_range(std::size_t* hashes, std::size_t count)
+  {
+    for (std::size_t i = 0u; i < count; ++i)
+      hashes[i] = spread32((uint32_t)hashes[i]);
+  }
+};
+
+struct bit_mix32
+{
+  template< typename H, typename V >
+  static inline std::size_t mix(const H& hasher, const V& v)
+  {
+    return mix_hash(hasher(v));
+  }
+
+  static inline std::size_t mix_hash(uint64_t hash)
+  {
+    // both halves in one 32-bit multiply (like wyhash32)
+    constexpr uint32_t salt = UINT32_C(0x53C5CA59);
+    constexpr uint32_t multiplier = UINT32_C(0xE817FB2D); // from https://arxiv.org/abs/2001.05304
+    return spread32(wyhash::mix32((uint32_t)hash ^ salt, (uint32_t)(hash >> 32) ^ multiplier));
+  }
+
+  static inline void mix_range(std::size_t* hashes, std::size_t count)
+  {
+    for (std::size_t i = 0u; i < count; ++i)
+      hashes[i] = mix_hash(hashes[i]);
+  }
+};
+
+// Random seed, from `std::random_device` (if available), clock and ASLR
+inline uint64_t make_random_seed() noexcept
+{
+  uint64_t seed = (uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count();
+  seed ^= (uint64_t)reinterpret_cast<std::uintptr_t>(&seed);
+  try
+  {
+    std::random_device device;
+    seed ^= ((uint64_t)device() << 32) ^ (uint64_t)device();
+  }
+  catch (...) {} // no entropy source
+  return wyhash::mix(seed, wyhash::secret[2]);
+}
+
 // Detect if Hash has avalanching trait
 // i.e. if 'Hash::is_avalanching' type is present
 // Default is false (triggers additional bit mixing)
@@ -210,9 +396,103 @@ struct hash_is_avalanching_impl<Hash, traits::void_t<typename Hash::is_avalanchi
 template< typename Hash >
 struct hash_is_avalanching : hash_is_avalanching_impl<Hash>::type {};
 
+// Detect if Hash has stored trait
+// i.e. if 'Hash::is_stored' type is present (see `stored_hash`)
+// Default is false (hash recomputed when needed)
+template< typename Hash, typename = void >
+struct hash_is_stored_impl
+  : std::false_type {};
+
+template< typename Hash >
+struct hash_is_stored_impl<Hash, traits::void_t<typename Hash::is_stored>>
+  : std::true_type {};
+
+template< typename Hash >
+struct hash_is_stored : hash_is_stored_impl<Hash>::type {};
+
+// Detect if Hash has 32-bits trait
+// i.e. if 'Hash::is_32bits' type is present (see `hash_32bits`)
+// Default is false (64-bit hashes on 64-bit platforms)
+template< typename Hash, typename = void >
+struct hash_is_32bits_impl
+  : std::false_type {};
+
+template< typename Hash >
+struct hash_is_32bits_impl<Hash, traits::void_t<typename Hash::is_32bits>>
+  : std::true_type {};
+
+template< typename Hash >
+struct hash_is_32bits : hash_is_32bits_impl<Hash>::type {};
+
+// Mixer used by flat containers (bit mixing if not avalanching, 32-bit hashes if requested)
+template< typename Hash >
+using hash_mixer = typename std::conditional<hash_is_32bits<Hash>::value,
+    typename std::conditional<hash_is_avalanching<Hash>::value, no_mix32, bit_mix32>::type,
+    typename std::conditional<hash_is_avalanching<Hash>::value, no_mix, bit_mix>::type>::type;
+
+// Detect if Hash has batched hashing
+// i.e. if 'void Hash::hash_batch(const Key*, std::size_t, std::size_t*) const' is present (same results as 'operator()')
+// Default is false (keys hashed one by one)
+template< typename Hash, typename Key, typename = void >
+struct hash_has_batch_impl
+  : std::false_type {};
+
+template< typename Hash, typename Key >
+struct hash_has_batch_impl<Hash, Key, traits::void_t<decltype(std::declval<const Hash&>().hash_batch(
+                                        std::declval<const Key*>(), std::size_t(), std::declval<std::size_t*>()))>>
+  : std::true_type {};
+
+template< typename Hash, typename Key >
+struct hash_has_batch : hash_has_batch_impl<Hash, Key>::type {};
+
+template< typename Mixer, typename Hash, typename Key >
+inline void hash_batch(const Hash& hasher, const Key* keys, std::size_t count, std::size_t* out, std::true_type /*hasBatch*/)
+{
+  hasher.hash_batch(keys, count, out);
+  Mixer::mix_range(out, count);
+}
+
+template< typename Mixer, typename Hash, typename Key >
+inline void hash_batch(const Hash& hasher, const Key* keys, std::size_t count, std::size_t* out, std::false_type /*hasBatch*/)
+{
+  for (std::size_t i = 0u; i < count; ++i) // independent hashes, no probing in-between
+    out[i] = Mixer::mix(hasher, keys[i]);
+}
+
 } // namespace detail
 
 
+// Opt-in hash adaptor for flat containers: full hash values are stored next to metadata
+// Rehash never recomputes hashes, and key comparisons are skipped on hash mismatch
+// Costs sizeof(size_t) additional bytes per entry (best for expensive keys, e.g. long strings)
+template< typename Hash >
+struct stored_hash : Hash
+{
+  using is_stored = void;
+
+  stored_hash() = default;
+  stored_hash(const Hash& hash) : Hash(hash) {}
+};
+
+// Opt-in hash adaptor for flat containers: 32-bit hashes (cheaper 32-bit multiply mixing, if not avalanching)
+// Only the lowest 32 bits of 'Hash' results are used (mixed with highest bits first, if not avalanching), meant for less than 2^32 entries
+// Combined with `stored_hash` (i.e. 'stored_hash<hash_32bits<Hash>>'), stored hashes only cost 4 additional bytes per entry
+template< typename Hash >
+struct hash_32bits : Hash
+{
+  using is_32bits = void;
+
+  hash_32bits() = default;
+  hash_32bits(const Hash& hash) : Hash(hash) {}
+};
+
+// Process-wide random seed (drawn once, on first call), default for `seeded_hash`
+inline uint64_t hash_seed() noexcept
+{
+  static const uint64_t seed = detail::make_random_seed();
+  return seed;
+}
+
 // Fallback (non avalanching)
 template< typename T, typename Enable = void >
 struct hash
@@ -225,26 +505,32 @@ struct hash
 };
 
 // Specializations
+// Strings are transparent: basic_string, basic_string_view and C strings hash the same
 template< typename CharT >
 struct hash<std::basic_string<CharT>>
 {
   using is_avalanching = void;
+  using is_transparent = void;
   uint64_t operator()(const std::basic_string<CharT>& str) const noexcept
   {
-    return detail::wyhash::hash(str.data(), sizeof(CharT) * str.size());
+    return detail::string_hash(str.data(), sizeof(CharT) * str.size());
+  }
+  uint64_t operator()(const CharT* str) const noexcept
+  {
+    return detail::string_hash(str, sizeof(CharT) * std::char_traits<CharT>::length(str));
   }
-};
-
 #ifdef INDIVI_CPP17
-template< typename CharT >
-struct hash<std::basic_string_view<CharT>>
-{
-  using is_avalanching = void;
   uint64_t operator()(const std::basic_string_view<CharT>& sv) const noexcept
   {
-    return detail::wyhash::hash(sv.data(), sizeof(CharT) * sv.size());
+    return detail::string_hash(sv.data(), sizeof(CharT) * sv.size());
   }
+#endif
 };
+
+#ifdef INDIVI_CPP17
+template< typename CharT >
+struct hash<std::basic_string_view<CharT>> : hash<std::basic_string<CharT>>
+{};
 #endif
 
 template< class T >
@@ -314,6 +600,335 @@ INDIVI_HASH_IMPL(unsigned long);
 INDIVI_HASH_IMPL(long long);
 INDIVI_HASH_IMPL(unsigned long long);
 
+namespace detail
+{
+// Order dependent combination of hashes (one multiply-mix per value, avalanching result)
+inline uint64_t hash_combine(uint64_t state, uint64_t hash) noexcept
+{
+  return wyhash::mix(state ^ hash, wyhash::secret[1]);
+}
+
+// Two hashes mixed independently (i.e. multiplies not chained, lower latency), avalanching result
+inline uint64_t hash_pair(uint64_t first, uint64_t second) noexcept
+{
+  return wyhash::mix(first ^ wyhash::secret[0], wyhash::secret[1]) ^ wyhash::mix(second ^ wyhash::secret[2], wyhash::secret[3]);
+}
+
+inline uint64_t hash_values(uint64_t state) noexcept
+{
+  return state;
+}
+
+template< typename T, typename... Ts >
+inline uint64_t hash_values(uint64_t state, const T& value, const Ts&... values)
+{
+  return hash_values(hash_combine(state, (uint64_t)hash<T>{}(value)), values...);
+}
+
+template< typename Tuple, std::size_t I = 0u, bool End = (I == std::tuple_size<Tuple>::value) >
+struct tuple_hash
+{
+  static uint64_t combine(uint64_t state, const Tuple& tuple)
+  {
+    using T = typename std::tuple_element<I, Tuple>::type;
+    return tuple_hash<Tuple, I + 1u>::combine(hash_combine(state, (uint64_t)hash<T>{}(std::get<I>(tuple))), tuple);
+  }
+};
+
+template< typename Tuple, std::size_t I >
+struct tuple_hash<Tuple, I, true>
+{
+  static uint64_t combine(uint64_t state, const Tuple&) noexcept { return state; }
+};
+
+// Equality is the same as bytes equality (no padding, no floating points)
+template< typename T >
+struct is_bytewise_comparable
+  : std::integral_constant<bool, std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value> {};
+
+} // namespace detail
+
+// Hash of several values (order dependent, avalanching), e.g. for user-defined composite keys:
+// 'uint64_t operator()(const Key& k) const { return indivi::hash_values(k.tenant, k.id); }' (with 'using is_avalanching = void;')
+template< typename... Ts >
+inline uint64_t hash_values(const Ts&... values)
+{
+  return detail::hash_values(detail::wyhash::secret[0], values...);
+}
+
+// Hash of object bytes (avalanching), only for types whose equality is bytewise (e.g. packed integers, no padding)
+template< typename T >
+inline uint64_t hash_bytes(const T& obj) noexcept
+{
+  static_assert(std::is_trivially_copyable<T>::value, "hash_bytes: T must be trivially copyable");
+  return detail::wyhash::hash(std::addressof(obj), sizeof(T));
+}
+
+// Composite keys (avalanching): members hashes combined in order
+template< typename T1, typename T2 >
+struct hash<std::pair<T1, T2>>
+{
+  using is_avalanching = void;
+
+  uint64_t operator()(const std::pair<T1, T2>& pair) const
+  {
+    return detail::hash_pair((uint64_t)hash<T1>{}(pair.first), (uint64_t)hash<T2>{}(pair.second));
+  }
+};
+
+template< typename... Ts >
+struct hash<std::tuple<Ts...>>
+{
+  using is_avalanching = void;
+
+  uint64_t operator()(const std::tuple<Ts...>& tuple) const
+  {
+    return detail::tuple_hash<std::tuple<Ts...>>::combine(detail::wyhash::secret[0], tuple);
+  }
+};
+
+// Arrays of integers, enums or pointers are hashed at once (as bytes), others by combining elements
+template< typename T, std::size_t N >
+struct hash<std::array<T, N>>
+{
+  using is_avalanching = void;
+
+  uint64_t operator()(const std::array<T, N>& array) const
+  {
+    return hash_array(array, detail::is_bytewise_comparable<T>{});
+  }
+
+private:
+  static uint64_t hash_array(const std::array<T, N>& array, std::true_type /*bytewise*/) noexcept
+  {
+    return detail::wyhash::hash(array.data(), sizeof(T) * N);
+  }
+
+  static uint64_t hash_array(const std::array<T, N>& array, std::false_type /*bytewise*/)
+  {
+    uint64_t state = detail::wyhash::secret[0];
+    for (const T& value : array)
+      state = detail::hash_combine(state, (uint64_t)hash<T>{}(value));
+    return state;
+  }
+};
+
+// Batched hashing of 'count' contiguous keys into 'out', same values as flat containers (i.e. bit mixed if not avalanching)
+// Use 'Hash::hash_batch(const Key*, std::size_t, std::size_t*)' if present (e.g. SIMD kernel of a user hasher), else hash keys one by one
+// Built-in hashes have no batched kernel: independent hashes already overlap when hashed one by one
+// (interleaved wyhash of same-length strings measured no faster, AVX2 emulation of 64-bit multiplies slower)
+template< typename Key, typename Hash = hash<Key> >
+inline void hash_batch(const Key* keys, std::size_t count, std::size_t* out, const Hash& hasher = Hash())
+{
+  detail::hash_batch<detail::hash_mixer<Hash>>(hasher, keys, count, out, detail::hash_has_batch<Hash, Key>{});
+}
+
+/*
+ * Seeded (keyed) variant of `indivi::hash`, against hash flooding: collisions cannot be precomputed without the seed.
+ * Strings are hashed with a seeded string hash, other types are mixed with the seed after `indivi::hash` (full hash collisions
+ * of the underlying hash, e.g. `std::hash` fallback, are kept). Not a cryptographic MAC.
+ * Default seed is per-process (see `hash_seed()`), or per-table by passing a seed (e.g. from `std::random_device`).
+ * The hash object is carried by the table (copied and swapped with it), a seed of 0 gives the same hashes as unseeded.
+ * Hashes differ between processes: don't use with snapshots (see `flat_mapped`).
+ */
+template< typename T >
+struct seeded_hash
+{
+  using is_avalanching = void;
+
+  seeded_hash() noexcept : seeded_hash(hash_seed()) {}
+  explicit seeded_hash(uint64_t seed) noexcept : mKey(detail::wyhash::seed_key(seed)) {}
+
+  uint64_t operator()(const T& obj) const
+    noexcept(noexcept(std::declval<const hash<T>&>()(std::declval<const T&>())))
+  {
+    return detail::bit_mix::mix_hash((std::size_t)hash<T>{}(obj), mKey);
+  }
+
+private:
+  uint64_t mKey; // derived from seed
+};
+
+template< typename CharT >
+struct seeded_hash<std::basic_string<CharT>>
+{
+  using is_avalanching = void;
+  using is_transparent = void;
+
+  seeded_hash() noexcept : seeded_hash(hash_seed()) {}
+  explicit seeded_hash(uint64_t seed) noexcept : mKey(detail::wyhash::seed_key(seed)) {}
+
+  uint64_t operator()(const std::basic_string<CharT>& str) const noexcept
+  {
+    return detail::string_hash(str.data(), sizeof(CharT) * str.size(), mKey);
+  }
+  uint64_t operator()(const CharT* str) const noexcept
+  {
+    return detail::string_hash(str, sizeof(CharT) * std::char_traits<CharT>::length(str), mKey);
+  }
+#ifdef INDIVI_CPP17
+  uint64_t operator()(const std::basic_string_view<CharT>& sv) const noexcept
+  {
+    return detail::string_hash(sv.data(), sizeof(CharT) * sv.size(), mKey);
+  }
+#endif
+
+private:
+  uint64_t mKey; // derived from seed
+};
+
+#ifdef INDIVI_CPP17
+template< typename CharT >
+struct seeded_hash<std::basic_string_view<CharT>> : seeded_hash<std::basic_string<CharT>>
+{
+  using seeded_hash<std::basic_string<CharT>>::seeded_hash;
+};
+#endif
+
+/*
+ * Streaming hash of a byte sequence given in segments (e.g. scatter-gather buffers, rope or multi-field records),
+ * without copying it into a contiguous buffer: same result as `indivi::hash<std::string>` (or `seeded_hash<std::string>`
+ * with same seed) on the concatenated bytes, whatever the segments.
+ * Up to 64 bytes are buffered (short keys hashed at once on `finish()`), longer ones are hashed by blocks.
+ */
+class hash_state
+{
+#ifdef INDIVI_HASH_AES
+  static constexpr std::size_t BLOCK{ 64u };
+#else
+  static constexpr std::size_t BLOCK{ 48u };
+#endif
+  static constexpr std::size_t SHORT_MAX{ 64u };    // buffered bytes before hashing by blocks
+  static constexpr std::size_t CAPACITY{ 2u * 64u }; // pending bytes
+
+  // Members
+  uint64_t mKey;          // derived from seed
+  uint64_t mLength = 0u;  // total bytes
+  std::size_t mCount = 0u; // pending bytes (at 'mBuffer + BLOCK')
+#ifdef INDIVI_HASH_AES
+  detail::aeshash::state mLanes;
+#else
+  uint64_t mSeed;
+  uint64_t mSee1;
+  uint64_t mSee2;
+#endif
+  uint8_t mBuffer[BLOCK + CAPACITY]; // last hashed block, then pending bytes
+
+public:
+  hash_state() noexcept : hash_state(0u) {}
+  explicit hash_state(uint64_t seed) noexcept
+    : mKey(detail::wyhash::seed_key(seed))
+#ifdef INDIVI_HASH_AES
+    , mLanes(mKey)
+#else
+    , mSeed(detail::wyhash::secret[0] ^ mKey)
+    , mSee1(mSeed)
+    , mSee2(mSeed)
+#endif
+  {}
+
+  void update(const void* data, std::size_t len) noexcept
+  {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint8_t* pending = mBuffer + BLOCK;
+    mLength += len;
+    if (mLength <= SHORT_MAX)
+    {
+      if (len)
+        std::memcpy(pending + mCount, p, len);
+      mCount += len;
+      return;
+    }
+
+    // complete pending blocks
+    std::size_t full = (mCount + BLOCK - 1u) / BLOCK * BLOCK;
+    std::size_t count = (len < full - mCount) ? len : full - mCount;
+    if (count)
+      std::memcpy(pending + mCount, p, count);
+    mCount += count;
+    p += count;
+    len -= count;
+
+    // hash blocks followed by more bytes (last one kept for `finish()`)
+    std::size_t offset = 0u;
+    while (mCount - offset > BLOCK || (len && mCount - offset == BLOCK))
+    {
+      update_block(pending + offset);
+      offset += BLOCK;
+    }
+    if (mCount == offset)
+    {
+      const uint8_t* last = pending + offset - BLOCK;
+      for (; len > BLOCK; p += BLOCK, len -= BLOCK)
+      {
+        update_block(p);
+        last = p;
+      }
+      std::memmove(mBuffer, last, BLOCK);
+      mCount = 0u;
+    }
+    else
+    {
+      std::memmove(mBuffer, mBuffer + offset, BLOCK + mCount - offset);
+      mCount -= offset;
+    }
+    if (len)
+      std::memcpy(pending + mCount, p, len);
+    mCount += len;
+  }
+
+  template< typename CharT >
+  void update(const std::basic_string<CharT>& str) noexcept
+  {
+    update(str.data(), sizeof(CharT) * str.size());
+  }
+#ifdef INDIVI_CPP17
+  template< typename CharT >
+  void update(const std::basic_string_view<CharT>& sv) noexcept
+  {
+    update(sv.data(), sizeof(CharT) * sv.size());
+  }
+#endif
+
+  // Hash of bytes so far (state unchanged)
+  uint64_t finish() const noexcept
+  {
+    const uint8_t* pending = mBuffer + BLOCK;
+    if (mLength <= SHORT_MAX)
+      return detail::string_hash(pending, (std::size_t)mLength, mKey);
+
+    // last loads may read back into the last hashed block (like one-shot overlapping loads)
+#ifdef INDIVI_HASH_AES
+    detail::aeshash::state lanes(mLanes);
+    lanes.update(pending + mCount - 64);
+    return lanes.finish((std::size_t)mLength);
+#else
+    using namespace detail::wyhash;
+    uint64_t seed = mSeed ^ mSee1 ^ mSee2;
+    const uint8_t* p = pending;
+    std::size_t i = mCount;
+    for (; i > 16; i -= 16, p += 16)
+      seed = mix(r8(p) ^ secret[1], r8(p + 8) ^ seed);
+    uint64_t a = r8(p + i - 16);
+    uint64_t b = r8(p + i - 8);
+    return mix(secret[1] ^ mLength, mix(a ^ secret[1], b ^ seed));
+#endif
+  }
+
+private:
+  void update_block(const uint8_t* p) noexcept
+  {
+#ifdef INDIVI_HASH_AES
+    mLanes.update(p);
+#else
+    using namespace detail::wyhash;
+    mSeed = mix(r8(p     ) ^ secret[1], r8(p + 8) ^ mSeed);
+    mSee1 = mix(r8(p + 16) ^ secret[2], r8(p + 24) ^ mSee1);
+    mSee2 = mix(r8(p + 32) ^ secret[3], r8(p + 40) ^ mSee2);
+#endif
+  }
+};
+
 } // namespace indivi
 
 #undef INDIVI_HASH_IMPL
@@ -0,0 +1,370 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#ifndef INDIVI_INCREMENTAL_MAP_H
+#define INDIVI_INCREMENTAL_MAP_H
+
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <cstddef>
+
+namespace indivi
+{
+/*
+ * Incremental_map is an adaptor over `flat_umap` or `flat_wmap`, spreading rehashes over subsequent operations.
+ * When the active map is full, it becomes the 'old' map and a new one (twice the capacity) takes its place.
+ * Then each mutating operation migrates up to `migrate_step()` elements from old to new, until the old map is released.
+ * Meanwhile, lookups check both maps and new elements are only inserted into the new map.
+ *
+ * Bound insert latency to allocating/initializing the new storage, instead of moving the whole table at once
+ * (better tail latency on large maps, at the cost of slower lookups/inserts while migrating and a higher memory peak).
+ * Require `migrate_step() >= 2` so that migration always completes before the new map is full.
+ * Iterators are invalidated by any mutating operation (migration included), no container-wide iterators (see `for_each`).
+ */
+template< class Map >
+class incremental_map
+{
+public:
+  using map_type = Map;
+  using key_type = typename Map::key_type;
+  using mapped_type = typename Map::mapped_type;
+  using value_type = typename Map::value_type;
+  using size_type = typename Map::size_type;
+  using difference_type = typename Map::difference_type;
+  using hasher = typename Map::hasher;
+  using key_equal = typename Map::key_equal;
+  using allocator_type = typename Map::allocator_type;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using iterator = typename Map::iterator;
+  using const_iterator = typename Map::const_iterator;
+
+  static constexpr size_type DEFAULT_MIGRATE_STEP{ 8u };
+
+private:
+  // Members
+  Map mMap;              // active map (receives all insertions)
+  Map mOld;              // previous map, being migrated (empty otherwise)
+  iterator mCursor;      // next element to migrate (i.e. `mOld.begin()`, cached)
+  size_type mStep = DEFAULT_MIGRATE_STEP;
+
+public:
+  // Ctr/Dtr
+  incremental_map() : incremental_map(0)
+  {}
+
+  explicit incremental_map(size_type bucket_count, const hasher& hash = hasher(), const key_equal& equal = key_equal(),
+                           const allocator_type& alloc = allocator_type())
+    : mMap(bucket_count, hash, equal, alloc)
+    , mOld(0, hash, equal, alloc)
+    , mCursor(mOld.end())
+  {}
+
+  incremental_map(const incremental_map& other)
+    : mMap(other.mMap)
+    , mOld(other.mOld)
+    , mCursor(old_begin())
+    , mStep(other.mStep)
+  {}
+
+  incremental_map(incremental_map&& other)
+    : mMap(std::move(other.mMap))
+    , mOld(std::move(other.mOld))
+    , mCursor(old_begin())
+    , mStep(other.mStep)
+  {
+    other.mCursor = other.mOld.end();
+  }
+
+  ~incremental_map() = default;
+
+  // Assignment
+  incremental_map& operator=(const incremental_map& other)
+  {
+    if (this != &other)
+    {
+      mMap = other.mMap;
+      mOld = other.mOld;
+      mCursor = old_begin();
+      mStep = other.mStep;
+    }
+    return *this;
+  }
+  incremental_map& operator=(incremental_map&& other)
+  {
+    if (this != &other)
+    {
+      mMap = std::move(other.mMap);
+      mOld = std::move(other.mOld);
+      mCursor = old_begin();
+      mStep = other.mStep;
+      other.mCursor = other.mOld.end();
+    }
+    return *this;
+  }
+
+  // Capacity
+  bool empty() const noexcept { return mMap.empty() && mOld.empty(); }
+  size_type size() const noexcept { return mMap.size() + mOld.size(); }
+  size_type max_size() const noexcept { return mMap.max_size(); }
+
+  // Bucket interface (active map)
+  size_type bucket_count() const noexcept { return mMap.bucket_count(); }
+  size_type max_bucket_count() const noexcept { return mMap.max_bucket_count(); }
+
+  // Hash policy
+  float load_factor() const noexcept { return bucket_count() ? (float)size() / bucket_count() : 0.f; }
+  float max_load_factor() const noexcept { return mMap.max_load_factor(); }
+  void max_load_factor(float ml) { mMap.max_load_factor(ml); } // next maps too
+  size_type growth_factor() const noexcept { return mMap.growth_factor(); }
+  void growth_factor(size_type factor) noexcept { mMap.growth_factor(factor); } // next maps too
+
+  // Complete any pending migration first (i.e. may take a while)
+  void rehash(size_type count)
+  {
+    finish_migration();
+    mMap.rehash(count);
+  }
+  void reserve(size_type count)
+  {
+    finish_migration();
+    mMap.reserve(count);
+  }
+  void shrink_to_fit()
+  {
+    finish_migration();
+    mMap.shrink_to_fit();
+  }
+
+  // non-standard, incremental rehash control
+  bool migrating() const noexcept { return !mOld.empty(); }
+  size_type migrate_step() const noexcept { return mStep; }
+  void migrate_step(size_type step) noexcept { mStep = (step > 2u) ? step : 2u; }
+  void finish_migration() { migrate(mOld.size()); }
+
+  // Observers
+  hasher hash_function() const { return mMap.hash_function(); }
+  key_equal key_eq() const { return mMap.key_eq(); }
+  allocator_type get_allocator() const noexcept { return mMap.get_allocator(); }
+
+  // Lookup
+  mapped_type& at(const key_type& key)
+  {
+    iterator it = find(key);
+    if (it == end())
+      throw std::out_of_range("incremental_map::at");
+    return it->second;
+  }
+  const mapped_type& at(const key_type& key) const
+  {
+    const_iterator it = find(key);
+    if (it == cend())
+      throw std::out_of_range("incremental_map::at");
+    return it->second;
+  }
+
+  mapped_type& operator[](const key_type& key) { return try_emplace(key).first->second; }
+  mapped_type& operator[](key_type&& key) { return try_emplace(std::move(key)).first->second; }
+
+  size_type count(const key_type& key) const { return contains(key) ? 1u : 0u; }
+  bool contains(const key_type& key) const { return mMap.contains(key) || (migrating() && mOld.contains(key)); }
+
+  iterator find(const key_type& key)
+  {
+    iterator it = mMap.find(key);
+    return (it == end() && migrating()) ? mOld.find(key) : it;
+  }
+  const_iterator find(const key_type& key) const
+  {
+    const_iterator it = mMap.find(key);
+    return (it == cend() && migrating()) ? mOld.find(key) : it;
+  }
+
+  // Sentinel shared by both maps
+  static iterator end() noexcept { return iterator(); }
+  static const_iterator cend() noexcept { return const_iterator(); }
+
+  // non-standard, visit all elements (old ones first while migrating)
+  template< class F >
+  void for_each(F f)
+  {
+    if (migrating())
+    {
+      for (auto& value : mOld)
+        f(value);
+    }
+    for (auto& value : mMap)
+      f(value);
+  }
+  template< class F >
+  void for_each(F f) const
+  {
+    if (migrating())
+    {
+      for (auto it = mOld.begin(); it != cend(); ++it)
+        f(*it);
+    }
+    for (auto it = mMap.begin(); it != cend(); ++it)
+      f(*it);
+  }
+
+  // Modifiers
+  void clear()
+  {
+    mMap.clear();
+    release_old();
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) { return insert_impl(value); }
+
+  template< class P >
+  std::pair<iterator, bool> insert(P&& value) { return insert_impl(std::forward<P>(value)); }
+
+  template< class M >
+  std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& obj) { return insert_or_assign_impl(key, std::forward<M>(obj)); }
+
+  template< class M >
+  std::pair<iterator, bool> insert_or_assign(key_type&& key, M&& obj) { return insert_or_assign_impl(std::move(key), std::forward<M>(obj)); }
+
+  template< class U1, class U2 >
+  std::pair<iterator, bool> emplace(U1&& key, U2&& obj) { return try_emplace_impl(std::forward<U1>(key), std::forward<U2>(obj)); }
+
+  template< class... Args >
+  std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args) { return try_emplace_impl(key, std::forward<Args>(args)...); }
+
+  template< class... Args >
+  std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args) { return try_emplace_impl(std::move(key), std::forward<Args>(args)...); }
+
+  size_type erase(const key_type& key)
+  {
+    migrate(mStep);
+    if (mMap.erase(key))
+      return 1u;
+
+    iterator it = find_old(key);
+    if (it == end())
+      return 0u;
+    if (it == mCursor)
+    {
+      mCursor = mOld.erase_(it);
+    }
+    else
+    {
+      mOld.erase(it);
+      // iterators cache next set entries of their group, refresh it
+      mCursor = mOld.find(mCursor->first);
+    }
+    if (mOld.empty())
+      release_old();
+    return 1u;
+  }
+
+  void swap(incremental_map& other)
+  {
+    mMap.swap(other.mMap);
+    mOld.swap(other.mOld);
+    std::swap(mCursor, other.mCursor);
+    std::swap(mStep, other.mStep);
+  }
+
+  // Non-member
+  friend void swap(incremental_map& lhs, incremental_map& rhs) { lhs.swap(rhs); }
+
+  template< class Pred >
+  friend size_type erase_if(incremental_map& map, Pred pred)
+  {
+    map.finish_migration();
+    return erase_if(map.mMap, pred);
+  }
+
+private:
+  iterator find_old(const key_type& key) { return migrating() ? mOld.find(key) : end(); }
+  iterator old_begin() { return migrating() ? mOld.begin() : end(); }
+
+  void release_old()
+  {
+    Map empty(0, mMap.hash_function(), mMap.key_eq(), mMap.get_allocator());
+    mOld.swap(empty);
+    mCursor = mOld.end();
+  }
+
+  // Move up to 'count' elements from old to active map
+  void migrate(size_type count)
+  {
+    if (!migrating())
+      return;
+
+    for (; count > 0u && mCursor != end(); --count)
+    {
+      value_type& value = *mCursor;
+      // keys are stored non-const (safe to move from, erased right after)
+      mMap.emplace(std::move(const_cast<key_type&>(value.first)), std::move(value.second));
+      mCursor = mOld.erase_(mCursor);
+    }
+    if (mCursor == end())
+      release_old();
+  }
+
+  // Start a new migration if active map is full (i.e. next insertion would rehash it)
+  void prepare_insert()
+  {
+    if (migrating())
+    {
+      migrate(mStep);
+    }
+    else if (!mMap.empty() && mMap.size() >= mMap.rehash_threshold())
+    {
+      Map next(mMap.bucket_count() * mMap.growth_factor(), mMap.hash_function(), mMap.key_eq(), mMap.get_allocator());
+      next.max_load_factor(mMap.max_load_factor());
+      next.growth_factor(mMap.growth_factor());
+      mOld.swap(mMap);
+      mMap.swap(next);
+      mCursor = old_begin();
+      migrate(mStep);
+    }
+  }
+
+  template< class P >
+  std::pair<iterator, bool> insert_impl(P&& value)
+  {
+    prepare_insert();
+    iterator it = find_old(value.first);
+    if (it != end())
+      return { it, false };
+    return mMap.insert(std::forward<P>(value));
+  }
+
+  template< class K, class... Args >
+  std::pair<iterator, bool> try_emplace_impl(K&& key, Args&&... args)
+  {
+    prepare_insert();
+    iterator it = find_old(key);
+    if (it != end())
+      return { it, false };
+    return mMap.try_emplace(std::forward<K>(key), std::forward<Args>(args)...);
+  }
+
+  template< class K, class M >
+  std::pair<iterator, bool> insert_or_assign_impl(K&& key, M&& obj)
+  {
+    prepare_insert();
+    iterator it = find_old(key);
+    if (it != end())
+    {
+      it->second = std::forward<M>(obj);
+      return { it, false };
+    }
+    return mMap.insert_or_assign(std::forward<K>(key), std::forward<M>(obj));
+  }
+};
+
+template< class Map >
+constexpr typename incremental_map<Map>::size_type incremental_map<Map>::DEFAULT_MIGRATE_STEP;
+
+} // namespace indivi
+
+#endif // INDIVI_INCREMENTAL_MAP_H
@@ -0,0 +1,277 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#include "gtest/gtest.h"
+
+#define INDIVI_FLAT_W_DEBUG
+#include "indivi/concurrent_flat_map.h"
+#include "utils/debug_utils.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <cstdint>
+
+using namespace indivi;
+
+TEST(ConcurrentFlatMapTest, Constructor)
+{
+  {
+    concurrent_flat_map<DbgClass, DbgClass> cfm;
+    EXPECT_TRUE(cfm.empty());
+    EXPECT_EQ(cfm.size(), 0u);
+    EXPECT_EQ(cfm.shard_count(), (concurrent_flat_map<DbgClass, DbgClass>::DEFAULT_SHARD_COUNT));
+    EXPECT_FALSE(cfm.contains(1));
+  }
+  {
+    concurrent_flat_map<int, int> cfm(5);
+    EXPECT_EQ(cfm.shard_count(), 8u);
+  }
+  {
+    concurrent_flat_map<int, int> cfm(0);
+    EXPECT_EQ(cfm.shard_count(), 1u);
+    EXPECT_TRUE(cfm.insert({ 1, 1 }));
+    EXPECT_TRUE(cfm.contains(1));
+  }
+  {
+    concurrent_flat_map<std::string, std::string> cfm;
+    EXPECT_FALSE(cfm.contains(""));
+    EXPECT_TRUE(cfm.get_allocator() == (std::allocator<std::pair<const std::string, std::string>>()));
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(ConcurrentFlatMapTest, InsertAndVisit)
+{
+  {
+    concurrent_flat_map<DbgClass, DbgClass> cfm(4);
+    for (int i = 1; i <= 100; ++i)
+      EXPECT_TRUE(cfm.try_emplace(i, i));
+    EXPECT_EQ(cfm.size(), 100u);
+
+    EXPECT_FALSE(cfm.try_emplace(42, 999));
+    EXPECT_FALSE(cfm.insert({ 42, 999 }));
+    EXPECT_FALSE(cfm.emplace(42, 999));
+    EXPECT_TRUE(cfm.emplace(101, 101));
+    EXPECT_TRUE(cfm.insert({ 102, 102 }));
+    std::pair<const DbgClass, DbgClass> value(103, 103);
+    EXPECT_TRUE(cfm.insert(value));
+    EXPECT_EQ(cfm.size(), 103u);
+    EXPECT_EQ(cfm.count(103), 1u);
+    EXPECT_EQ(cfm.count(104), 0u);
+
+    int found = 0;
+    EXPECT_EQ(cfm.cvisit(42, [&](const std::pair<const DbgClass, DbgClass>& kv) { found = kv.second.id; }), 1u);
+    EXPECT_EQ(found, 42);
+    EXPECT_EQ(cfm.cvisit(0x7FFF, [&](const std::pair<const DbgClass, DbgClass>&) { found = -1; }), 0u);
+    EXPECT_EQ(found, 42);
+
+    EXPECT_EQ(cfm.visit(42, [](std::pair<const DbgClass, DbgClass>& kv) { kv.second = DbgClass(4242); }), 1u);
+    const auto& ccfm = cfm;
+    EXPECT_EQ(ccfm.visit(42, [&](const std::pair<const DbgClass, DbgClass>& kv) { found = kv.second.id; }), 1u);
+    EXPECT_EQ(found, 4242);
+
+    EXPECT_FALSE(cfm.insert_or_assign(42, DbgClass(43)));
+    EXPECT_TRUE(cfm.insert_or_assign(104, DbgClass(104)));
+    cfm.cvisit(42, [&](const std::pair<const DbgClass, DbgClass>& kv) { found = kv.second.id; });
+    EXPECT_EQ(found, 43);
+    EXPECT_EQ(cfm.size(), 104u);
+  }
+  {
+    concurrent_flat_map<int, int> cfm;
+    cfm.reserve(1000);
+    for (int i = 0; i < 1000; ++i)
+      cfm.try_emplace(i, i);
+
+    long long sum = 0;
+    EXPECT_EQ(cfm.cvisit_all([&](const std::pair<const int, int>& kv) { sum += kv.second; }), 1000u);
+    EXPECT_EQ(sum, 999 * 1000 / 2);
+
+    EXPECT_EQ(cfm.visit_all([](std::pair<const int, int>& kv) { kv.second *= 2; }), 1000u);
+    sum = 0;
+    const auto& ccfm = cfm;
+    EXPECT_EQ(ccfm.visit_all([&](const std::pair<const int, int>& kv) { sum += kv.second; }), 1000u);
+    EXPECT_EQ(sum, 999 * 1000);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(ConcurrentFlatMapTest, InsertOrVisit)
+{
+  {
+    concurrent_flat_map<DbgClass, DbgClass> cfm;
+    auto increment = [](std::pair<const DbgClass, DbgClass>& kv) { ++kv.second.id; };
+
+    EXPECT_TRUE(cfm.insert_or_visit({ 1, 1 }, increment));
+    EXPECT_FALSE(cfm.insert_or_visit({ 1, 1 }, increment));
+    std::pair<const DbgClass, DbgClass> value(1, 1);
+    EXPECT_FALSE(cfm.insert_or_visit(value, increment));
+
+    int found = 0;
+    cfm.cvisit(1, [&](const std::pair<const DbgClass, DbgClass>& kv) { found = kv.second.id; });
+    EXPECT_EQ(found, 3);
+
+    EXPECT_FALSE(cfm.insert_or_cvisit({ 1, 10 }, [&](const std::pair<const DbgClass, DbgClass>& kv) { found = -kv.second.id; }));
+    EXPECT_EQ(found, -3);
+    EXPECT_TRUE(cfm.insert_or_cvisit({ 2, 2 }, [&](const std::pair<const DbgClass, DbgClass>&) { found = 0; }));
+    EXPECT_EQ(found, -3);
+    EXPECT_EQ(cfm.size(), 2u);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(ConcurrentFlatMapTest, Erase)
+{
+  {
+    concurrent_flat_map<DbgClass, DbgClass> cfm(2);
+    for (int i = 1; i <= 100; ++i)
+      cfm.try_emplace(i, i);
+
+    EXPECT_EQ(cfm.erase(42), 1u);
+    EXPECT_EQ(cfm.erase(42), 0u);
+    EXPECT_FALSE(cfm.contains(42));
+    EXPECT_EQ(cfm.size(), 99u);
+
+    auto isEven = [](const std::pair<const DbgClass, DbgClass>& kv) { return kv.second.id % 2 == 0; };
+    EXPECT_EQ(cfm.erase_if(43, isEven), 0u);
+    EXPECT_EQ(cfm.erase_if(44, isEven), 1u);
+    EXPECT_EQ(cfm.erase_if(44, isEven), 0u);
+    EXPECT_TRUE(cfm.contains(43));
+    EXPECT_EQ(cfm.size(), 98u);
+
+    EXPECT_EQ(cfm.erase_if(isEven), 48u);
+    EXPECT_EQ(cfm.size(), 50u);
+    EXPECT_EQ(cfm.cvisit_all([](const std::pair<const DbgClass, DbgClass>& kv) { EXPECT_EQ(kv.first.id % 2, 1); }), 50u);
+
+    cfm.clear();
+    EXPECT_TRUE(cfm.empty());
+    EXPECT_TRUE(cfm.try_emplace(1, 1));
+    EXPECT_EQ(cfm.size(), 1u);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+struct TransparentEqual
+{
+  using is_transparent = void;
+  template< class U, class V >
+  bool operator()(const U& lhs, const V& rhs) const { return lhs == rhs; }
+};
+
+TEST(ConcurrentFlatMapTest, TransparentLookup)
+{
+  {
+    concurrent_flat_map<std::string, int, indivi::hash<std::string>, TransparentEqual> cfm;
+    for (int i = 1; i <= 100; ++i)
+      cfm.try_emplace(std::to_string(i), i);
+
+    EXPECT_TRUE(cfm.contains("42"));
+    EXPECT_FALSE(cfm.contains("0"));
+    EXPECT_EQ(cfm.count("7"), 1u);
+
+    int found = 0;
+    EXPECT_EQ(cfm.cvisit("13", [&](const std::pair<const std::string, int>& kv) { found = kv.second; }), 1u);
+    EXPECT_EQ(found, 13);
+    EXPECT_EQ(cfm.visit("13", [](std::pair<const std::string, int>& kv) { kv.second = 31; }), 1u);
+    cfm.cvisit(std::string("13"), [&](const std::pair<const std::string, int>& kv) { found = kv.second; });
+    EXPECT_EQ(found, 31);
+
+    EXPECT_FALSE(cfm.try_emplace("42", 0));
+    EXPECT_TRUE(cfm.try_emplace("101", 101));
+    EXPECT_EQ(cfm.erase("101"), 1u);
+    EXPECT_EQ(cfm.erase_if("100", [](const std::pair<const std::string, int>& kv) { return kv.second == 100; }), 1u);
+    EXPECT_EQ(cfm.size(), 99u);
+  }
+}
+
+TEST(ConcurrentFlatMapTest, MultiThreaded)
+{
+  const int threadCount = 8;
+  const int perThread = 20000;
+  {
+    // Disjoint inserts with concurrent readers
+    concurrent_flat_map<uint64_t, uint64_t> cfm(16);
+    std::atomic<int> done(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+      threads.emplace_back([&, t]() {
+        for (int i = 0; i < perThread; ++i)
+        {
+          uint64_t key = (uint64_t)t * perThread + i;
+          EXPECT_TRUE(cfm.try_emplace(key, key + 1));
+          // read back own key and a random other one
+          uint64_t val = 0;
+          cfm.cvisit(key, [&](const std::pair<const uint64_t, uint64_t>& kv) { val = kv.second; });
+          EXPECT_EQ(val, key + 1);
+          cfm.cvisit((key * 7919u) % (threadCount * perThread), [&](const std::pair<const uint64_t, uint64_t>& kv) {
+            EXPECT_EQ(kv.second, kv.first + 1);
+          });
+        }
+        ++done;
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+
+    EXPECT_EQ(done.load(), threadCount);
+    EXPECT_EQ(cfm.size(), (std::size_t)threadCount * perThread);
+    for (uint64_t key = 0; key < (uint64_t)threadCount * perThread; ++key)
+      EXPECT_TRUE(cfm.contains(key));
+  }
+  {
+    // Shared counters (insert or update)
+    concurrent_flat_map<int, int> cfm(4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+      threads.emplace_back([&]() {
+        for (int i = 0; i < perThread; ++i)
+          cfm.insert_or_visit({ i % 100, 1 }, [](std::pair<const int, int>& kv) { ++kv.second; });
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+
+    EXPECT_EQ(cfm.size(), 100u);
+    long long total = 0;
+    cfm.cvisit_all([&](const std::pair<const int, int>& kv) {
+      EXPECT_EQ(kv.second, threadCount * perThread / 100);
+      total += kv.second;
+    });
+    EXPECT_EQ(total, (long long)threadCount * perThread);
+  }
+  {
+    // Concurrent erase and insert
+    concurrent_flat_map<int, int> cfm;
+    for (int i = 0; i < perThread; ++i)
+      cfm.try_emplace(i, i);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+      threads.emplace_back([&, t]() {
+        for (int i = t; i < perThread; i += threadCount)
+        {
+          EXPECT_EQ(cfm.erase(i), 1u);
+          EXPECT_TRUE(cfm.try_emplace(perThread + i, i));
+        }
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+
+    EXPECT_EQ(cfm.size(), (std::size_t)perThread);
+    EXPECT_FALSE(cfm.contains(0));
+    EXPECT_TRUE(cfm.contains(perThread));
+  }
+}
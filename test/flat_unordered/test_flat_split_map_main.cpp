@@ -0,0 +1,391 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#include "gtest/gtest.h"
+
+#define INDIVI_FLAT_U_DEBUG
+#define INDIVI_FLAT_U_TELEMETRY // same as umap tests (shared instantiations)
+#include "indivi/flat_split_map.h"
+#include "utils/bump_allocator.h"
+#include "utils/debug_utils.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <cstdlib>
+
+using namespace indivi;
+
+namespace
+{
+// Same home group for all keys (long probing sequences, saturated distances)
+struct BadHash
+{
+  using is_avalanching = void;
+  std::size_t operator()(int key) const noexcept { return (std::size_t)(key & 3); }
+};
+
+// Check content against 'ref' (lookups, iteration and key iteration)
+template< class SMap, class Map >
+void expect_same(const SMap& sm, const Map& ref)
+{
+  ASSERT_EQ(sm.size(), ref.size());
+  for (const auto& kv : ref)
+  {
+    auto it = sm.find(kv.first);
+    ASSERT_NE(it, sm.end());
+    EXPECT_EQ(it.key(), kv.first);
+    EXPECT_EQ(it.mapped(), kv.second);
+  }
+
+  std::size_t visited = 0u;
+  for (const auto& kv : sm)
+  {
+    EXPECT_EQ(ref.at(kv.first), kv.second);
+    ++visited;
+  }
+  EXPECT_EQ(visited, ref.size());
+
+  visited = 0u;
+  for (const auto& key : sm.keys())
+  {
+    EXPECT_EQ(ref.count(key), 1u);
+    ++visited;
+  }
+  EXPECT_EQ(visited, ref.size());
+}
+}
+
+TEST(FlatSplitMapTest, Constructor)
+{
+  {
+    flat_split_map<DbgClass, DbgClass> fsm;
+    EXPECT_TRUE(fsm.empty());
+    EXPECT_EQ(fsm.size(), 0u);
+    EXPECT_EQ(fsm.bucket_count(), 0u);
+    EXPECT_EQ(fsm.begin(), fsm.end());
+    EXPECT_EQ(fsm.find(1), fsm.end());
+    EXPECT_FALSE(fsm.contains(1));
+    EXPECT_EQ(fsm.count(1), 0u);
+    EXPECT_THROW(fsm.at(1), std::out_of_range);
+  }
+  {
+    flat_split_map<DbgClass, DbgClass> fsm(100);
+    EXPECT_TRUE(fsm.empty());
+    EXPECT_GE(fsm.bucket_count(), 100u);
+    EXPECT_EQ(fsm.begin(), fsm.end());
+  }
+  {
+    flat_split_map<DbgClass, DbgClass> fsm{{1, 2}, {3, 4}, {1, 5}};
+    EXPECT_EQ(fsm.size(), 2u);
+    EXPECT_EQ(fsm.at(1).id, 2);
+    EXPECT_EQ(fsm.at(3).id, 4);
+
+    flat_split_map<DbgClass, DbgClass> fsm2(fsm);
+    EXPECT_TRUE(fsm2 == fsm);
+    flat_split_map<DbgClass, DbgClass> fsm3(std::move(fsm));
+    EXPECT_TRUE(fsm.empty());
+    EXPECT_TRUE(fsm3 == fsm2);
+
+    fsm = fsm2;
+    EXPECT_TRUE(fsm == fsm2);
+    fsm2[5] = 6;
+    EXPECT_TRUE(fsm != fsm2);
+    fsm = std::move(fsm2);
+    EXPECT_EQ(fsm.size(), 3u);
+    EXPECT_EQ(fsm.at(5).id, 6);
+
+    swap(fsm, fsm3);
+    EXPECT_EQ(fsm.size(), 2u);
+    EXPECT_EQ(fsm3.size(), 3u);
+
+    fsm3 = {{7, 8}};
+    EXPECT_EQ(fsm3.size(), 1u);
+    EXPECT_EQ(fsm3.at(7).id, 8);
+  }
+  {
+    // copy of a table with erased entries (overflow counters kept)
+    flat_split_map<int, std::string> fsm;
+    for (int i = 0; i < 1000; ++i)
+      fsm.try_emplace(i, std::to_string(i));
+    for (int i = 0; i < 1000; i += 2)
+      fsm.erase(i);
+
+    flat_split_map<int, std::string> fsm2(fsm);
+    EXPECT_EQ(fsm2.bucket_count(), fsm.bucket_count());
+    EXPECT_TRUE(fsm2 == fsm);
+    for (int i = 1; i < 1000; i += 2)
+      EXPECT_EQ(fsm2.at(i), std::to_string(i));
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatSplitMapTest, Allocator)
+{
+  using alloc_type = bump_allocator<std::pair<const DbgClass, DbgClass>>;
+  using flat_split_map_alc = flat_split_map<DbgClass, DbgClass, indivi::hash<DbgClass>, std::equal_to<DbgClass>, alloc_type>;
+  {
+    flat_split_map_alc fsm;
+    for (int i = 1; i <= 40; ++i)
+      fsm.try_emplace(i, i + 1);
+    ASSERT_EQ(fsm.size(), 40u);
+
+    alloc_type alc;
+    flat_split_map_alc fsm1(fsm, alc);
+    EXPECT_EQ(fsm1, fsm);
+
+    // unequal allocators: move element-wise
+    flat_split_map_alc fsm2(std::move(fsm), alc);
+    EXPECT_TRUE(fsm.empty());
+    EXPECT_EQ(fsm2, fsm1);
+
+    flat_split_map_alc fsm3;
+    fsm3 = fsm1;
+    EXPECT_EQ(fsm3, fsm1);
+
+    fsm3 = std::move(fsm2);
+    EXPECT_TRUE(fsm2.empty());
+    EXPECT_EQ(fsm3, fsm1);
+
+    // propagate on swap
+    fsm2.swap(fsm3);
+    EXPECT_TRUE(fsm3.empty());
+    EXPECT_EQ(fsm2, fsm1);
+
+    fsm2.clear();
+    fsm2.rehash(0);
+    EXPECT_EQ(fsm2.bucket_count(), 0u);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatSplitMapTest, Insert)
+{
+  {
+    flat_split_map<DbgClass, DbgClass> fsm;
+    auto res = fsm.try_emplace(1, 2);
+    EXPECT_TRUE(res.second);
+    EXPECT_EQ(res.first->second.id, 2);
+    res = fsm.try_emplace(1, 3);
+    EXPECT_FALSE(res.second);
+    EXPECT_EQ(res.first.mapped().id, 2);
+
+    res = fsm.insert({4, 5});
+    EXPECT_TRUE(res.second);
+    std::pair<const DbgClass, DbgClass> value(4, 6);
+    res = fsm.insert(value);
+    EXPECT_FALSE(res.second);
+    EXPECT_EQ(res.first->first.id, 4);
+    EXPECT_EQ(res.first->second.id, 5);
+
+    res = fsm.emplace(12, 13);
+    EXPECT_TRUE(res.second);
+    EXPECT_EQ(fsm.at(12).id, 13);
+
+    res = fsm.insert_or_assign(4, 7);
+    EXPECT_FALSE(res.second);
+    EXPECT_EQ(fsm.at(4).id, 7);
+    res = fsm.insert_or_assign(8, 9);
+    EXPECT_TRUE(res.second);
+    EXPECT_EQ(fsm.at(8).id, 9);
+
+    EXPECT_EQ(fsm[8].id, 9);
+    EXPECT_EQ(fsm.size(), 4u);
+    fsm[10].id = 11;
+    EXPECT_EQ(fsm.size(), 5u);
+    EXPECT_EQ(fsm.at(10).id, 11);
+
+    fsm.clear();
+    EXPECT_TRUE(fsm.empty());
+    EXPECT_FALSE(fsm.contains(1));
+    EXPECT_EQ(fsm.begin(), fsm.end());
+    EXPECT_TRUE(fsm.try_emplace(1, 2).second);
+  }
+  {
+    flat_split_map<std::string, std::vector<int>> fsm;
+    fsm.reserve(500);
+    std::size_t bucketCount = fsm.bucket_count();
+    for (int i = 0; i < 500; ++i)
+      fsm.try_emplace(std::to_string(i), (std::size_t)i % 7, i);
+    EXPECT_EQ(fsm.bucket_count(), bucketCount);
+    EXPECT_LE(fsm.load_factor(), fsm.max_load_factor());
+    for (int i = 0; i < 500; ++i)
+      EXPECT_EQ(fsm.at(std::to_string(i)), std::vector<int>((std::size_t)i % 7, i));
+
+    // heterogeneous lookup
+    const char* key = "42";
+    EXPECT_TRUE(fsm.contains(key));
+    EXPECT_EQ(fsm.find(key).key(), "42");
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatSplitMapTest, Iterator)
+{
+  flat_split_map<int, std::string> fsm;
+  std::vector<int> expected;
+  for (int i = 0; i < 100; ++i)
+  {
+    fsm.try_emplace(i, std::to_string(i));
+    expected.push_back(i);
+  }
+
+  // proxy pairs, mutable mapped values
+  std::vector<int> keys;
+  for (auto&& kv : fsm)
+  {
+    EXPECT_EQ(kv.second, std::to_string(kv.first));
+    kv.second += "!";
+    keys.push_back(kv.first);
+  }
+  std::sort(keys.begin(), keys.end());
+  EXPECT_EQ(keys, expected);
+  for (auto it = fsm.cbegin(); it != fsm.cend(); ++it)
+    EXPECT_EQ(it->second, std::to_string(it->first) + "!");
+
+  // keys only, same order
+  auto it = fsm.cbegin();
+  for (const int& key : fsm.keys())
+  {
+    EXPECT_EQ(key, it.key());
+    ++it;
+  }
+  EXPECT_EQ(it, fsm.cend());
+  EXPECT_EQ(fsm.keys().size(), 100u);
+
+  flat_split_map<int, std::string>::const_iterator cit = fsm.find(7);
+  EXPECT_EQ(cit.mapped(), "7!");
+}
+
+TEST(FlatSplitMapTest, Erase)
+{
+  {
+    flat_split_map<DbgClass, DbgClass> fsm;
+    std::unordered_map<int, int> ref;
+    for (int i = 1; i <= 1000; ++i)
+    {
+      fsm.try_emplace(i, i + 1);
+      ref.emplace(i, i + 1);
+    }
+    for (int i = 1; i <= 1000; i += 3)
+    {
+      EXPECT_EQ(fsm.erase(i), 1u);
+      ref.erase(i);
+    }
+    EXPECT_EQ(fsm.erase(1), 0u);
+    EXPECT_EQ(fsm.erase(1001), 0u);
+    ASSERT_EQ(fsm.size(), ref.size());
+    for (const auto& kv : ref)
+      EXPECT_EQ(fsm.at(kv.first).id, kv.second);
+    for (int i = 1; i <= 1000; i += 3)
+      EXPECT_FALSE(fsm.contains(i));
+
+    auto erased = erase_if(fsm, [](const std::pair<const DbgClass&, DbgClass&>& kv) { return kv.first.id % 2 == 0; });
+    for (auto it = ref.begin(); it != ref.end();)
+      it = (it->first % 2 == 0) ? ref.erase(it) : std::next(it);
+    EXPECT_EQ(fsm.size(), ref.size());
+    EXPECT_EQ(erased, 1000u - 334u - ref.size());
+    for (const auto& kv : ref)
+      EXPECT_EQ(fsm.at(kv.first).id, kv.second);
+
+    // by iterator
+    fsm.erase(fsm.find(3));
+    EXPECT_FALSE(fsm.contains(3));
+    std::size_t count = 0u;
+    for (auto it = fsm.begin(); it != fsm.end(); ++count)
+      it = fsm.erase_(it);
+    EXPECT_EQ(count, ref.size() - 1u);
+    EXPECT_TRUE(fsm.empty());
+    EXPECT_EQ(fsm.begin(), fsm.end());
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatSplitMapTest, BadHash)
+{
+  flat_split_map<int, DbgClass, BadHash> fsm;
+  std::unordered_map<int, int> ref;
+  for (int i = 0; i < 300; ++i)
+  {
+    fsm.try_emplace(i, i + 1);
+    ref.emplace(i, i + 1);
+  }
+  for (int i = 0; i < 300; i += 3)
+  {
+    EXPECT_EQ(fsm.erase(i), 1u);
+    ref.erase(i);
+  }
+  for (int i = 300; i < 400; ++i)
+  {
+    fsm.try_emplace(i, i + 1);
+    ref.emplace(i, i + 1);
+  }
+  ASSERT_EQ(fsm.size(), ref.size());
+  for (const auto& kv : ref)
+    EXPECT_EQ(fsm.at(kv.first).id, kv.second);
+  for (int i = 0; i < 300; i += 3)
+    EXPECT_FALSE(fsm.contains(i));
+
+  while (!fsm.empty())
+    fsm.erase(fsm.begin());
+  EXPECT_FALSE(fsm.contains(1));
+  fsm.clear();
+}
+
+TEST(FlatSplitMapTest, Rehash)
+{
+  flat_split_map<int, int> fsm;
+  fsm.rehash(10);
+  EXPECT_EQ(fsm.bucket_count(), 16u);
+  for (int i = 0; i < 14; ++i)
+    fsm.try_emplace(i, -i);
+  EXPECT_EQ(fsm.bucket_count(), 16u);
+
+  fsm.rehash(1000);
+  EXPECT_EQ(fsm.bucket_count(), 1024u);
+  for (int i = 0; i < 14; ++i)
+    EXPECT_EQ(fsm.at(i), -i);
+
+  fsm.shrink_to_fit();
+  EXPECT_EQ(fsm.bucket_count(), 16u);
+  for (int i = 0; i < 14; ++i)
+    EXPECT_EQ(fsm.at(i), -i);
+
+  fsm.clear();
+  fsm.shrink_to_fit();
+  EXPECT_EQ(fsm.bucket_count(), 0u);
+}
+
+TEST(FlatSplitMapTest, Stress)
+{
+  flat_split_map<int, uint64_t> fsm;
+  std::unordered_map<int, uint64_t> ref;
+  std::srand(42);
+  for (int i = 0; i < 100000; ++i)
+  {
+    int key = std::rand() % 5000;
+    switch (std::rand() % 3)
+    {
+      case 0:
+        EXPECT_EQ(fsm.try_emplace(key, (uint64_t)i).second, ref.emplace(key, (uint64_t)i).second);
+        break;
+      case 1:
+        fsm.insert_or_assign(key, (uint64_t)i);
+        ref[key] = (uint64_t)i;
+        break;
+      default:
+        EXPECT_EQ(fsm.erase(key), ref.erase(key));
+    }
+  }
+  expect_same(fsm, ref);
+}
@@ -6,19 +6,26 @@
 #include "gtest/gtest.h"
 
 #define INDIVI_FLAT_U_DEBUG
+#define INDIVI_FLAT_U_TELEMETRY
+#include "indivi/flat_mapped.h"
 #include "indivi/flat_umap.h"
+#include "utils/bump_allocator.h"
 #include "utils/debug_utils.h"
 
+#include <array>
+#include <fstream>
 #include <initializer_list>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include <cassert>
+#include <cstdio>
 #include <cstdlib>
 
 using namespace indivi;
@@ -226,6 +233,61 @@ TEST(FlatUMapTest, Assignment2)
   EXPECT_EQ(DbgClass::count, 0);
 }
 
+TEST(FlatUMapTest, Allocator)
+{
+  using alloc_type = bump_allocator<std::pair<const DbgClass, DbgClass>>;
+  using flat_umap_alc = flat_umap<DbgClass, DbgClass, indivi::hash<DbgClass>, std::equal_to<DbgClass>, alloc_type>;
+  {
+    alloc_type alc;
+    flat_umap_alc fum0(alc);
+    EXPECT_TRUE(fum0.empty());
+    
+    flat_umap_alc fum1(10, alc);
+    EXPECT_GE(fum1.bucket_count(), 10u);
+    EXPECT_FALSE(fum1.contains(1));
+  }
+  {
+    flat_umap_alc fum;
+    for (int i = 1; i <= 40; ++i)
+      fum.emplace(i, i + 1);
+    ASSERT_EQ(fum.size(), 40u);
+    
+    alloc_type alc;
+    flat_umap_alc fum1(fum, alc);
+    EXPECT_EQ(fum1, fum);
+    
+    // unequal allocators: move element-wise
+    flat_umap_alc fum2(std::move(fum), alc);
+    EXPECT_TRUE(fum.empty());
+    EXPECT_EQ(fum2, fum1);
+    
+    flat_umap_alc fum3;
+    fum3 = fum1;
+    EXPECT_EQ(fum3, fum1);
+    
+    fum3 = std::move(fum2);
+    EXPECT_TRUE(fum2.empty());
+    EXPECT_EQ(fum3, fum1);
+    
+    // propagate on swap
+    fum2.swap(fum3);
+    EXPECT_TRUE(fum3.empty());
+    EXPECT_EQ(fum2, fum1);
+    
+    fum2.clear();
+    fum2.rehash(0);
+    EXPECT_EQ(fum2.bucket_count(), 0u);
+  }
+  {
+    flat_umap<int, int> fum{};
+    std::allocator<std::pair<const int, int>> alc = fum.get_allocator();
+    flat_umap<int, int> fum1(std::move(fum), alc);
+    EXPECT_TRUE(fum1.empty());
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatUMapTest, Capacity)
 {
   {
@@ -239,7 +301,8 @@ TEST(FlatUMapTest, Capacity)
     EXPECT_EQ(fum.max_load_factor(), 0.875f);
     EXPECT_EQ(fum.max_size(), max_size);
     EXPECT_GT(fum.max_bucket_count(), 0u);
-    fum.max_load_factor(0.f); // no-op
+    fum.max_load_factor(0.f); // clamped
+    EXPECT_EQ(fum.max_load_factor(), 0.25f);
     EXPECT_GT(fum.max_bucket_count(), 0u);
     
     fum = {{1, 2}, {3, 4}};
@@ -343,6 +406,216 @@ TEST(FlatUMapTest, Capacity2)
   EXPECT_EQ(DbgClass::count, 0);
 }
 
+TEST(FlatUMapTest, LoadFactor)
+{
+  {
+    flat_umap<int, int> fum;
+    EXPECT_EQ(fum.max_load_factor(), 0.875f);
+    EXPECT_EQ(fum.growth_factor(), 2u);
+    fum.max_load_factor(2.f); // clamped
+    EXPECT_EQ(fum.max_load_factor(), 0.95f);
+
+    // Low load factor
+    fum.max_load_factor(0.5f);
+    fum.reserve(1000);
+    EXPECT_GE(fum.bucket_count(), 2000u);
+    std::size_t bucketCount = fum.bucket_count();
+    for (int i = 0; i < 1000; ++i)
+      fum.emplace(i, i);
+    EXPECT_EQ(fum.bucket_count(), bucketCount);
+    EXPECT_LE(fum.load_factor(), 0.5f);
+
+    // Lowered below current load
+    fum.max_load_factor(0.25f);
+    EXPECT_LE(fum.load_factor(), 0.25f);
+    EXPECT_GT(fum.bucket_count(), bucketCount);
+    for (int i = 0; i < 1000; ++i)
+      EXPECT_EQ(fum.at(i), i);
+
+    // High load factor: grow when 95% full
+    fum.max_load_factor(0.95f);
+    fum.rehash(0);
+    bucketCount = fum.bucket_count();
+    EXPECT_EQ(bucketCount, 2048u);
+    int i = 1000;
+    for (; fum.bucket_count() == bucketCount; ++i)
+      fum.emplace(i, i);
+    EXPECT_EQ(fum.size(), (std::size_t)(bucketCount * 0.95f) + 1u);
+    EXPECT_EQ(fum.bucket_count(), bucketCount * 2);
+    for (int j = 0; j < i; ++j)
+      EXPECT_EQ(fum.at(j), j);
+
+    // Policy is copied, moved and swapped
+    flat_umap<int, int> fum2(fum);
+    EXPECT_EQ(fum2.max_load_factor(), 0.95f);
+    flat_umap<int, int> fum3(std::move(fum2));
+    EXPECT_EQ(fum3.max_load_factor(), 0.95f);
+    flat_umap<int, int> fum4;
+    fum4 = fum3;
+    EXPECT_EQ(fum4.max_load_factor(), 0.95f);
+    EXPECT_TRUE(fum4 == fum);
+    flat_umap<int, int> fum5;
+    fum4.swap(fum5);
+    EXPECT_EQ(fum5.max_load_factor(), 0.95f);
+    EXPECT_EQ(fum4.max_load_factor(), 0.875f);
+  }
+  {
+    // Growth factor
+    flat_umap<int, int> fum;
+    fum.growth_factor(3);
+    EXPECT_EQ(fum.growth_factor(), 4u);
+    fum.growth_factor(100000);
+    EXPECT_EQ(fum.growth_factor(), 256u);
+    fum.growth_factor(0);
+    EXPECT_EQ(fum.growth_factor(), 2u);
+
+    fum.growth_factor(4);
+    std::size_t bucketCount = 0u;
+    for (int i = 0; i < 100000; ++i)
+    {
+      fum.emplace(i, i);
+      if (fum.bucket_count() != bucketCount)
+      {
+        if (bucketCount >= 64u)
+        {
+          EXPECT_EQ(fum.bucket_count(), bucketCount * 4);
+        }
+        bucketCount = fum.bucket_count();
+      }
+    }
+    for (int i = 0; i < 100000; ++i)
+      EXPECT_EQ(fum.at(i), i);
+  }
+  {
+    // Tiny tables (single group) then low load factor
+    flat_umap<DbgClass, DbgClass> fum;
+    fum.max_load_factor(0.25f);
+    for (int i = 1; i <= 200; ++i)
+    {
+      fum.try_emplace(i, i);
+      EXPECT_LE(fum.size(), fum.bucket_count());
+      if (fum.bucket_count() > 16u)
+      {
+        EXPECT_LE(fum.load_factor(), 0.25f);
+      }
+    }
+    for (int i = 1; i <= 200; i += 2)
+      EXPECT_EQ(fum.erase(i), 1u);
+    fum.max_load_factor(0.9f);
+    for (int i = 1; i <= 400; i += 2)
+      fum.try_emplace(i, i);
+    EXPECT_EQ(fum.size(), 300u);
+    for (int i = 1; i <= 400; ++i)
+      EXPECT_EQ(fum.contains(i), i <= 200 || i % 2 == 1);
+  }
+  {
+    // Copy to a smaller storage with the same max size (32 buckets at 0.5 vs single group)
+    flat_umap<int, std::string> fum;
+    for (int i = 0; i <= 16; ++i)
+      fum.emplace(i, std::to_string(i));
+    for (int i = 10; i <= 16; ++i)
+      fum.erase(i);
+    fum.max_load_factor(0.5f);
+    EXPECT_EQ(fum.bucket_count(), 32u);
+
+    flat_umap<int, std::string> fum2(fum);
+    EXPECT_EQ(fum2.size(), 10u);
+    for (int i = 0; i < 10; ++i)
+      EXPECT_EQ(fum2.at(i), std::to_string(i));
+    EXPECT_TRUE(fum2 == fum);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUMapTest, Shrink)
+{
+  {
+    flat_umap<int, int> fum;
+    fum.shrink_to_fit();
+    EXPECT_EQ(fum.bucket_count(), 0u);
+
+    // Explicit shrink after mass erase
+    for (int i = 0; i < 10000; ++i)
+      fum.emplace(i, i);
+    std::size_t bucketCount = fum.bucket_count();
+    for (int i = 1000; i < 10000; ++i)
+      EXPECT_EQ(fum.erase(i), 1u);
+    EXPECT_EQ(fum.bucket_count(), bucketCount); // disabled by default
+    fum.shrink_to_fit();
+    EXPECT_EQ(fum.bucket_count(), 2048u);
+    for (int i = 0; i < 10000; ++i)
+      EXPECT_EQ(fum.contains(i), i < 1000);
+
+    fum.clear();
+    fum.shrink_to_fit();
+    EXPECT_EQ(fum.bucket_count(), 0u);
+    EXPECT_TRUE(fum.empty());
+  }
+  {
+    // Auto downsizing
+    flat_umap<int, int> fum;
+    EXPECT_EQ(fum.min_load_factor(), 0.f);
+    fum.min_load_factor(1.f); // clamped
+    EXPECT_EQ(fum.min_load_factor(), 0.25f);
+    fum.min_load_factor(-1.f);
+    EXPECT_EQ(fum.min_load_factor(), 0.f);
+    fum.min_load_factor(0.1f);
+    EXPECT_NEAR(fum.min_load_factor(), 0.1f, 0.0001f);
+
+    for (int i = 0; i < 10000; ++i)
+      fum.emplace(i, i);
+    std::size_t bucketCount = fum.bucket_count();
+
+    // never on iterator erase
+    auto it = fum.begin();
+    while (fum.size() > 500u)
+      fum.erase(it++);
+    EXPECT_EQ(fum.bucket_count(), bucketCount);
+
+    // on erase by key
+    for (int i = 0; i < 10000; ++i)
+    {
+      if (fum.erase(i) && fum.bucket_count() > 16u)
+      {
+        EXPECT_GE((float)fum.size(), fum.bucket_count() * fum.min_load_factor());
+      }
+      EXPECT_LE(fum.bucket_count(), bucketCount);
+    }
+    EXPECT_TRUE(fum.empty());
+    EXPECT_LE(fum.bucket_count(), 16u);
+
+    // and after erase_if
+    for (int i = 0; i < 10000; ++i)
+      fum.emplace(i, i);
+    bucketCount = fum.bucket_count();
+    EXPECT_EQ(erase_if(fum, [](const std::pair<const int, int>& p) { return p.first % 100 != 0; }), 9900u);
+    EXPECT_LT(fum.bucket_count(), bucketCount);
+    for (int i = 0; i < 10000; ++i)
+      EXPECT_EQ(fum.contains(i), i % 100 == 0);
+
+    // Policy is copied
+    flat_umap<int, int> fum2(fum);
+    EXPECT_EQ(fum2.min_load_factor(), fum.min_load_factor());
+  }
+  {
+    // No rehash ping-pong with high growth factor
+    flat_umap<DbgClass, DbgClass> fum;
+    fum.min_load_factor(0.25f);
+    fum.growth_factor(256);
+    int i = 1;
+    for (; fum.bucket_count() < 1024u; ++i)
+      fum.try_emplace(i, i);
+    std::size_t bucketCount = fum.bucket_count();
+    EXPECT_EQ(fum.erase(1), 1u);
+    EXPECT_EQ(fum.bucket_count(), bucketCount);
+    for (int j = 2; j < i; ++j)
+      EXPECT_EQ(fum.at(j).id, j);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatUMapTest, Observers)
 {
   {
@@ -497,6 +770,315 @@ TEST(FlatUMapTest, ElementAccess2)
   EXPECT_EQ(DbgClass::count, 0);
 }
 
+struct BatchHash
+{
+  int* batchs;
+  std::size_t operator()(int key) const { return (std::size_t)key * 31u; }
+  void hash_batch(const int* keys, std::size_t count, std::size_t* out) const
+  {
+    ++*batchs;
+    for (std::size_t i = 0u; i < count; ++i)
+      out[i] = (*this)(keys[i]);
+  }
+};
+
+TEST(FlatUMapTest, FindBatch)
+{
+  {
+    flat_umap<DbgClass, DbgClass> fum;
+    std::vector<DbgClass> keys{1, 2, 3};
+    std::unique_ptr<bool[]> found(new bool[keys.size()]);
+    fum.contains_batch(keys.data(), keys.size(), found.get());
+    for (size_t i = 0; i < keys.size(); ++i)
+      EXPECT_FALSE(found[i]);
+  }
+  {
+    flat_umap<DbgClass, DbgClass> fum;
+    for (int i = 1; i < 1000; i += 2)
+      fum.emplace(i, i + 1);
+    
+    std::vector<DbgClass> keys;
+    for (int i = 0; i < 1000; ++i)
+      keys.emplace_back((i * 7) % 1000 + 1);
+    
+    std::unique_ptr<bool[]> found(new bool[keys.size()]);
+    fum.contains_batch(keys.data(), keys.size(), found.get());
+    
+    std::vector<flat_umap<DbgClass, DbgClass>::iterator> its(keys.size());
+    fum.find_batch(keys.data(), keys.size(), its.data());
+    
+    const auto& cfum = fum;
+    std::vector<flat_umap<DbgClass, DbgClass>::const_iterator> cits(keys.size());
+    cfum.find_batch(keys.data(), keys.size(), cits.data());
+    
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+      bool exist = keys[i].id % 2 == 1;
+      EXPECT_EQ(found[i], exist);
+      EXPECT_EQ(its[i], fum.find(keys[i]));
+      EXPECT_EQ(cits[i], cfum.find(keys[i]));
+      if (exist)
+      {
+        ASSERT_NE(its[i], fum.end());
+        EXPECT_EQ(its[i]->second, keys[i].id + 1);
+      }
+    }
+  }
+  {
+    // user batched hashing
+    static_assert(detail::hash_has_batch<BatchHash, int>::value, "BatchHash: hash_batch not detected");
+    int batchs = 0;
+    flat_umap<int, int, BatchHash> fum(0u, BatchHash{ &batchs });
+    for (int i = 0; i < 1000; i += 2)
+      fum.emplace(i, i + 1);
+    
+    std::vector<int> keys;
+    for (int i = 0; i < 100; ++i)
+      keys.push_back(i * 3);
+    std::unique_ptr<bool[]> found(new bool[keys.size()]);
+    fum.contains_batch(keys.data(), keys.size(), found.get());
+    EXPECT_EQ(batchs, 7); // by 16
+    for (size_t i = 0; i < keys.size(); ++i)
+      EXPECT_EQ(found[i], keys[i] % 2 == 0);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+struct TransparentEqual
+{
+  using is_transparent = void;
+  template< class U, class V >
+  bool operator()(const U& lhs, const V& rhs) const { return lhs == rhs; }
+};
+
+TEST(FlatUMapTest, TransparentLookup)
+{
+  {
+    flat_umap<std::string, DbgClass, indivi::hash<std::string>, TransparentEqual> fum;
+    for (int i = 1; i <= 100; ++i)
+      fum.try_emplace(std::to_string(i), i);
+    ASSERT_EQ(fum.size(), 100u);
+    
+    EXPECT_TRUE(fum.contains("42"));
+    EXPECT_FALSE(fum.contains("0"));
+    EXPECT_EQ(fum.count("7"), 1u);
+    EXPECT_EQ(fum.find("13")->second.id, 13);
+    EXPECT_TRUE(fum.find("101") == fum.end());
+    EXPECT_EQ(fum.at("99").id, 99);
+    EXPECT_THROW(fum.at("x"), std::out_of_range);
+    
+    const auto& cfum = fum;
+    EXPECT_EQ(cfum.find("13")->second.id, 13);
+    EXPECT_EQ(cfum.at("14").id, 14);
+    
+    auto res = fum.try_emplace("42", 0);
+    EXPECT_FALSE(res.second);
+    EXPECT_EQ(res.first->second.id, 42);
+    res = fum.try_emplace("101", 101);
+    EXPECT_TRUE(res.second);
+    EXPECT_EQ(res.first->first, "101");
+    
+    EXPECT_EQ(fum.erase("101"), 1u);
+    EXPECT_EQ(fum.erase("101"), 0u);
+    EXPECT_EQ(fum.size(), 100u);
+  #ifdef INDIVI_CPP17
+    std::string_view sv("57");
+    EXPECT_TRUE(fum.contains(sv));
+    EXPECT_EQ(fum.find(sv)->second.id, 57);
+  #endif
+  }
+  {
+    indivi::hash<std::string> hash;
+    EXPECT_EQ(hash("abc"), hash(std::string("abc")));
+    EXPECT_EQ(hash(""), hash(std::string()));
+  #ifdef INDIVI_CPP17
+    EXPECT_EQ(indivi::hash<std::string_view>{}("abc"), hash(std::string("abc")));
+  #endif
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+struct CountedHash
+{
+  int* calls;
+  explicit CountedHash(int* calls_ = nullptr) : calls(calls_) {}
+  std::size_t operator()(const DbgClass& key) const
+  {
+    ++(*calls);
+    return std::hash<DbgClass>{}(key);
+  }
+};
+
+TEST(FlatUMapTest, StoredHash)
+{
+  {
+    int calls = 0;
+    flat_umap<DbgClass, DbgClass, stored_hash<CountedHash>> fum(0, stored_hash<CountedHash>(CountedHash(&calls)));
+    for (int i = 1; i <= 1000; ++i)
+      fum.try_emplace(i, i + 1);
+    ASSERT_EQ(fum.size(), 1000u);
+    EXPECT_EQ(calls, 1000); // never re-hashed on growth
+    
+    for (int i = 1; i <= 1000; ++i)
+      EXPECT_EQ(fum.find(i)->second.id, i + 1);
+    EXPECT_FALSE(fum.contains(1001));
+    
+    calls = 0;
+    flat_umap<DbgClass, DbgClass, stored_hash<CountedHash>> fum2(fum);
+    EXPECT_EQ(calls, 0);
+    EXPECT_TRUE(fum2 == fum);
+    
+    for (int i = 1; i <= 1000; i += 2)
+      EXPECT_EQ(fum.erase(i), 1u);
+    ASSERT_EQ(fum.size(), 500u);
+    
+    calls = 0;
+    fum.rehash(0); // shrink
+    EXPECT_EQ(calls, 0);
+    for (int i = 1; i <= 1000; ++i)
+      EXPECT_EQ(fum.contains(i), i % 2 == 0);
+  }
+  {
+    int calls = 0;
+    flat_umap<DbgClass, DbgClass, CountedHash> fum(0, CountedHash(&calls));
+    for (int i = 1; i <= 1000; ++i)
+      fum.try_emplace(i, i + 1);
+    ASSERT_EQ(fum.size(), 1000u);
+    EXPECT_GT(calls, 1000); // re-hashed on growth
+  }
+  {
+    flat_umap<std::string, int, stored_hash<indivi::hash<std::string>>> fum;
+    for (int i = 0; i < 500; ++i)
+      fum.emplace(std::to_string(i), i);
+    ASSERT_EQ(fum.size(), 500u);
+    for (int i = 0; i < 500; ++i)
+      EXPECT_EQ(fum.at(std::to_string(i)), i);
+    EXPECT_FALSE(fum.contains("500"));
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUMapTest, Hash32Bits)
+{
+  {
+    flat_umap<uint64_t, int, hash_32bits<indivi::hash<uint64_t>>> fum;
+    for (int i = 0; i < 10000; ++i)
+    {
+      fum.emplace((uint64_t)i, i);
+      fum.emplace((uint64_t)i << 32, -i - 1);
+    }
+    ASSERT_EQ(fum.size(), 19999u);
+    for (int i = 0; i < 10000; i += 2)
+      EXPECT_EQ(fum.erase((uint64_t)i), 1u);
+    for (int i = 1; i < 10000; ++i)
+    {
+      EXPECT_EQ(fum.count((uint64_t)i), (i % 2 == 0) ? 0u : 1u);
+      EXPECT_EQ(fum.at((uint64_t)i << 32), -i - 1);
+    }
+  }
+  {
+    // compact stored hashes
+    using Hash = stored_hash<hash_32bits<CountedHash>>;
+    int calls = 0;
+    flat_umap<DbgClass, DbgClass, Hash> fum(0, Hash(hash_32bits<CountedHash>(CountedHash(&calls))));
+    for (int i = 1; i <= 1000; ++i)
+      fum.try_emplace(i, i + 1);
+    ASSERT_EQ(fum.size(), 1000u);
+    EXPECT_EQ(calls, 1000); // never re-hashed on growth
+    
+    calls = 0;
+    flat_umap<DbgClass, DbgClass, Hash> fum2(fum);
+    for (int i = 1; i <= 1000; i += 2)
+      EXPECT_EQ(fum.erase(i), 1u);
+    fum.rehash(0);
+    EXPECT_EQ(calls, 500); // erase only
+    for (int i = 1; i <= 1000; ++i)
+    {
+      EXPECT_EQ(fum.contains(i), i % 2 == 0);
+      EXPECT_EQ(fum2.find(i)->second.id, i + 1);
+    }
+  }
+  {
+    const std::string path = testing::TempDir() + "indivi_flat_umap_snapshot32.bin";
+    using Map = flat_umap<uint64_t, uint32_t, stored_hash<hash_32bits<indivi::hash<uint64_t>>>>;
+    Map fum;
+    for (uint32_t i = 0; i < 5000; ++i)
+      fum.emplace((uint64_t)i * 0x9E3779B97F4A7C15u, i);
+    fum.save(path);
+    flat_mapped<Map> mapped(path);
+    EXPECT_TRUE(mapped.map() == fum);
+    // 64-bit stored hashes layout differs
+    using Mapped64 = flat_mapped<flat_umap<uint64_t, uint32_t, stored_hash<indivi::hash<uint64_t>>>>;
+    EXPECT_THROW(Mapped64 m(path), std::runtime_error);
+    std::remove(path.c_str());
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUMapTest, ParallelRehash)
+{
+  {
+    // large enough to be split between threads
+    flat_umap<int, std::string> fum;
+    for (int i = 0; i < 200000; ++i)
+      fum.try_emplace(i, std::to_string(i));
+    std::size_t bucketCount = fum.bucket_count();
+    
+    fum.rehash(bucketCount * 4, 4u); // grow
+    EXPECT_EQ(fum.bucket_count(), bucketCount * 4);
+    ASSERT_EQ(fum.size(), 200000u);
+    for (int i = 0; i < 200000; ++i)
+      EXPECT_EQ(fum.at(i), std::to_string(i));
+    EXPECT_FALSE(fum.contains(200000));
+    
+    for (int i = 0; i < 200000; i += 2)
+      EXPECT_EQ(fum.erase(i), 1u);
+    fum.rehash(0, 4u); // shrink
+    EXPECT_LT(fum.bucket_count(), bucketCount);
+    ASSERT_EQ(fum.size(), 100000u);
+    std::size_t visited = 0u;
+    for (const auto& item : fum)
+    {
+      EXPECT_EQ(item.first % 2, 1);
+      EXPECT_EQ(item.second, std::to_string(item.first));
+      ++visited;
+    }
+    EXPECT_EQ(visited, 100000u);
+    
+    fum.reserve(400000, 4u);
+    EXPECT_GE(fum.rehash_threshold(), 400000u);
+    for (int i = 1; i < 200000; i += 2)
+      EXPECT_EQ(fum.find(i)->second, std::to_string(i));
+  }
+  {
+    // stored hashes and single thread fallback
+    flat_umap<int, int, stored_hash<indivi::hash<int>>> fum;
+    fum.reserve(100000, 8u); // first time
+    for (int i = 0; i < 100000; ++i)
+      fum.try_emplace(i, i + 1);
+    fum.rehash(fum.bucket_count() * 2, 8u);
+    fum.rehash(fum.bucket_count() * 2, 1u);
+    ASSERT_EQ(fum.size(), 100000u);
+    for (int i = 0; i < 100000; ++i)
+      EXPECT_EQ(fum.at(i), i + 1);
+  }
+  {
+    flat_umap<DbgClass, DbgClass> fum;
+    for (int i = 1; i <= 1000; ++i)
+      fum.try_emplace(i, i);
+    fum.rehash(4096, 4u); // too small for threads
+    ASSERT_EQ(fum.size(), 1000u);
+    for (int i = 1; i <= 1000; ++i)
+      EXPECT_EQ(fum.at(i).id, i);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatUMapTest, Clear)
 {
   {
@@ -659,6 +1241,62 @@ TEST(FlatUMapTest, Insert2)
   EXPECT_EQ(DbgClass::count, 0);
 }
 
+TEST(FlatUMapTest, InsertUniqueRange)
+{
+  {
+    std::vector<std::pair<DbgClass, DbgClass>> vec;
+    for (int i = 1; i <= 100000; ++i)
+      vec.emplace_back(i, i + 1);
+    flat_umap<DbgClass, DbgClass> fum;
+    fum.insert_unique_range(vec.begin(), vec.end());
+    ASSERT_EQ(fum.size(), 100000u);
+    EXPECT_EQ(vec[0].first, 1);
+    for (int i = 1; i <= 100000; ++i)
+      EXPECT_EQ(fum.at(i).id, i + 1);
+    EXPECT_FALSE(fum.contains(100001));
+    
+    // moved, into non-empty table
+    std::vector<std::pair<DbgClass, DbgClass>> vec2;
+    for (int i = 100001; i <= 100100; ++i)
+      vec2.emplace_back(i, i + 1);
+    fum.insert_unique_range(std::make_move_iterator(vec2.begin()), std::make_move_iterator(vec2.end()));
+    EXPECT_EQ(fum.size(), 100100u);
+    EXPECT_NE(vec2[0].first, 100001);
+    for (int i = 100001; i <= 100100; ++i)
+      EXPECT_EQ(fum.at(i).id, i + 1);
+  }
+  {
+    std::vector<std::pair<const DbgClass, DbgClass>> vec{{1, 2}, {3, 4}, {5, 6}};
+    flat_umap<DbgClass, DbgClass> fum;
+    fum.insert_unique_range(vec.begin(), vec.begin());
+    EXPECT_TRUE(fum.empty());
+    fum.insert_unique_range(vec.begin(), vec.end());
+    EXPECT_EQ(fum.size(), 3u);
+    EXPECT_EQ(fum.at(3).id, 4);
+  }
+  {
+    // reserved capacity is kept
+    flat_umap<int, int> fum;
+    fum.reserve(100000);
+    size_t bucketCount = fum.bucket_count();
+    std::vector<std::pair<int, int>> vec{{1, 2}, {3, 4}};
+    fum.insert_unique_range(vec.begin(), vec.end());
+    EXPECT_EQ(fum.size(), 2u);
+    EXPECT_EQ(fum.bucket_count(), bucketCount);
+    
+    for (int i = 5; i < 1600; ++i)
+      fum.emplace(i, i);
+    fum.rehash(4096);
+    std::vector<std::pair<int, int>> vec2;
+    for (int i = 2000; i < 2100; ++i)
+      vec2.emplace_back(i, i);
+    fum.insert_unique_range(vec2.begin(), vec2.end());
+    EXPECT_EQ(fum.bucket_count(), 4096u);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatUMapTest, InsertOrAssign)
 {
   {
@@ -1029,6 +1667,260 @@ TEST(FlatUMapTest, EraseIf)
   EXPECT_EQ(DbgClass::count, 0);
 }
 
+TEST(FlatUMapTest, NodeHandle)
+{
+  {
+    flat_umap<DbgClass, DbgClass> fum;
+    for (int i = 1; i <= 100; ++i)
+      fum.try_emplace(i, i + 1);
+    
+    auto node = fum.extract(101); // missing
+    EXPECT_TRUE(node.empty());
+    EXPECT_FALSE(node);
+    EXPECT_EQ(fum.size(), 100u);
+    
+    node = fum.extract(50);
+    ASSERT_FALSE(node.empty());
+    EXPECT_EQ(node.key().id, 50);
+    EXPECT_EQ(node.mapped().id, 51);
+    EXPECT_EQ(fum.size(), 99u);
+    EXPECT_FALSE(fum.contains(50));
+    
+    node.mapped().id = 500;
+    auto res = fum.insert(std::move(node));
+    EXPECT_TRUE(res.inserted);
+    EXPECT_TRUE(res.node.empty());
+    EXPECT_EQ(res.position->first.id, 50);
+    EXPECT_EQ(res.position->second.id, 500);
+    EXPECT_EQ(fum.size(), 100u);
+    
+    node = fum.extract(fum.find(1));
+    ASSERT_TRUE(node);
+    EXPECT_EQ(node.key().id, 1);
+    EXPECT_EQ(fum.size(), 99u);
+    
+    fum.try_emplace(1, 10);
+    res = fum.insert(std::move(node)); // already exist
+    EXPECT_FALSE(res.inserted);
+    ASSERT_FALSE(res.node.empty());
+    EXPECT_EQ(res.node.mapped().id, 2);
+    EXPECT_EQ(res.position->second.id, 10);
+    EXPECT_EQ(fum.size(), 100u);
+    
+    res = fum.insert(decltype(fum)::node_type()); // empty
+    EXPECT_FALSE(res.inserted);
+    EXPECT_TRUE(res.position == fum.end());
+    EXPECT_EQ(fum.size(), 100u);
+    
+    // Move between maps
+    flat_umap<DbgClass, DbgClass> fum2;
+    while (!fum.empty())
+      fum2.insert(fum.extract(fum.begin()));
+    EXPECT_EQ(fum2.size(), 100u);
+    EXPECT_EQ(fum2.at(1).id, 10);
+    EXPECT_EQ(fum2.at(50).id, 500);
+  }
+  {
+    int calls = 0;
+    flat_umap<DbgClass, DbgClass, stored_hash<CountedHash>> fum(0, stored_hash<CountedHash>(CountedHash(&calls)));
+    for (int i = 1; i <= 100; ++i)
+      fum.try_emplace(i, i);
+    
+    calls = 0;
+    auto node = fum.extract(fum.find(7));
+    auto res = fum.insert(std::move(node));
+    EXPECT_TRUE(res.inserted);
+    EXPECT_EQ(calls, 2); // find and stateful hasher re-hashing on insert
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUMapTest, Merge)
+{
+  {
+    flat_umap<DbgClass, DbgClass> fum1;
+    flat_umap<DbgClass, DbgClass> fum2;
+    for (int i = 1; i <= 100; ++i)
+      fum1.try_emplace(i, i);
+    for (int i = 51; i <= 200; ++i)
+      fum2.try_emplace(i, i + 1000);
+    
+    fum1.merge(fum2);
+    EXPECT_EQ(fum1.size(), 200u);
+    EXPECT_EQ(fum2.size(), 50u); // duplicates left in source
+    for (int i = 1; i <= 200; ++i)
+      EXPECT_EQ(fum1.at(i).id, i <= 100 ? i : i + 1000);
+    for (int i = 51; i <= 100; ++i)
+      EXPECT_EQ(fum2.at(i).id, i + 1000);
+    
+    fum1.merge(fum1); // self
+    EXPECT_EQ(fum1.size(), 200u);
+    
+    fum2.clear();
+    fum1.merge(fum2); // empty source
+    EXPECT_EQ(fum1.size(), 200u);
+    
+    fum2.merge(std::move(fum1)); // into empty
+    EXPECT_EQ(fum2.size(), 200u);
+    EXPECT_TRUE(fum1.empty());
+    for (int i = 1; i <= 200; ++i)
+      EXPECT_EQ(fum2.at(i).id, i <= 100 ? i : i + 1000);
+    
+    fum1.reserve(1000);
+    fum1.merge(fum2); // into empty but bigger
+    EXPECT_EQ(fum1.size(), 200u);
+    EXPECT_TRUE(fum2.empty());
+    EXPECT_GE(fum1.bucket_count(), 1000u);
+  }
+  {
+    int calls = 0;
+    flat_umap<DbgClass, DbgClass, stored_hash<CountedHash>> fum1(0, stored_hash<CountedHash>(CountedHash(&calls)));
+    flat_umap<DbgClass, DbgClass, stored_hash<CountedHash>> fum2(0, stored_hash<CountedHash>(CountedHash(&calls)));
+    for (int i = 1; i <= 100; ++i)
+      fum1.try_emplace(i, i);
+    for (int i = 101; i <= 300; ++i)
+      fum2.try_emplace(i, i);
+    
+    calls = 0;
+    fum1.merge(fum2);
+    EXPECT_EQ(calls, 200); // stateful hasher, each element hashed once
+    EXPECT_EQ(fum1.size(), 300u);
+    EXPECT_TRUE(fum2.empty());
+    for (int i = 1; i <= 300; ++i)
+      EXPECT_EQ(fum1.at(i).id, i);
+  }
+  {
+    flat_umap<std::string, int> fum1{{"a", 1}, {"b", 2}};
+    flat_umap<std::string, int> fum2{{"b", 3}, {"c", 4}};
+    
+    fum1.merge(fum2);
+    EXPECT_EQ(fum1.size(), 3u);
+    EXPECT_EQ(fum1.at("b"), 2);
+    EXPECT_EQ(fum1.at("c"), 4);
+    ASSERT_EQ(fum2.size(), 1u);
+    EXPECT_EQ(fum2.at("b"), 3);
+  }
+  {
+    // merge into empty table: each table keeps its own policies
+    flat_umap<int, int> fum1;
+    fum1.max_load_factor(0.5f);
+    fum1.min_load_factor(0.1f);
+    fum1.growth_factor(4);
+    flat_umap<int, int> fum2;
+    for (int i = 0; i < 1000; ++i)
+      fum2.emplace(i, i);
+    float maxLoadFactor = fum2.max_load_factor();
+    
+    fum1.merge(fum2);
+    EXPECT_EQ(fum1.size(), 1000u);
+    EXPECT_TRUE(fum2.empty());
+    EXPECT_FLOAT_EQ(fum1.max_load_factor(), 0.5f);
+    EXPECT_NEAR(fum1.min_load_factor(), 0.1f, 0.001f);
+    EXPECT_EQ(fum1.growth_factor(), 4u);
+    EXPECT_LE(fum1.load_factor(), 0.5f);
+    EXPECT_LE(fum1.size(), fum1.rehash_threshold());
+    EXPECT_FLOAT_EQ(fum2.max_load_factor(), maxLoadFactor);
+    EXPECT_EQ(fum2.min_load_factor(), 0.f);
+    EXPECT_EQ(fum2.growth_factor(), 2u);
+    for (int i = 0; i < 1000; ++i)
+      EXPECT_EQ(fum1.at(i), i);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+struct SeededHash
+{
+  std::size_t seed;
+  explicit SeededHash(std::size_t seed_ = 0u) : seed(seed_) {}
+  std::size_t operator()(int key) const { return indivi::hash<int>{}(key) ^ seed; }
+};
+
+TEST(FlatUMapTest, Snapshot)
+{
+  const std::string path = testing::TempDir() + "indivi_flat_umap_snapshot.bin";
+  {
+    // Empty and tiny
+    flat_umap<int, int> fum;
+    fum.save(path);
+    flat_mapped<flat_umap<int, int>> mapped(path);
+    EXPECT_TRUE(mapped.empty());
+    EXPECT_EQ(mapped.find(1), mapped.end());
+    EXPECT_EQ(mapped.begin(), mapped.end());
+
+    fum.insert({{1, 2}, {3, 4}, {5, 6}});
+    fum.save(path);
+    flat_mapped<flat_umap<int, int>> mapped2(path);
+    EXPECT_EQ(mapped2.size(), 3u);
+    EXPECT_EQ(mapped2.find(3)->second, 4);
+    EXPECT_EQ(mapped2.map().at(5), 6);
+    EXPECT_FALSE(mapped2.contains(2));
+    EXPECT_TRUE(mapped2.map() == fum);
+  }
+  {
+    // Large, with erased elements
+    flat_umap<uint64_t, uint32_t> fum;
+    for (uint32_t i = 0; i < 20000; ++i)
+      fum.emplace((uint64_t)i * 0x9E3779B97F4A7C15u, i);
+    for (uint32_t i = 0; i < 20000; i += 3)
+      EXPECT_EQ(fum.erase((uint64_t)i * 0x9E3779B97F4A7C15u), 1u);
+    fum.save(path);
+
+    auto mapped = open_mapped<flat_umap<uint64_t, uint32_t>>(path);
+    EXPECT_EQ(mapped.size(), fum.size());
+    EXPECT_EQ(mapped.map().bucket_count(), fum.bucket_count());
+    EXPECT_TRUE(mapped.map() == fum);
+    for (uint32_t i = 0; i < 20000; ++i)
+      EXPECT_EQ(mapped.count((uint64_t)i * 0x9E3779B97F4A7C15u), (i % 3 == 0) ? 0u : 1u);
+    std::size_t iterated = 0u;
+    for (const auto& kv : mapped)
+    {
+      EXPECT_EQ(fum.at(kv.first), kv.second);
+      ++iterated;
+    }
+    EXPECT_EQ(iterated, fum.size());
+
+    flat_mapped<flat_umap<uint64_t, uint32_t>> moved(std::move(mapped));
+    EXPECT_EQ(moved.size(), fum.size());
+    EXPECT_TRUE(mapped.empty());
+  }
+  {
+    // Stored hash
+    flat_umap<int, int, stored_hash<indivi::hash<int>>> fum;
+    for (int i = 0; i < 1000; ++i)
+      fum.emplace(i, -i);
+    fum.save(path);
+    flat_mapped<flat_umap<int, int, stored_hash<indivi::hash<int>>>> mapped(path);
+    EXPECT_TRUE(mapped.map() == fum);
+
+    // Different options or layout
+    using Mapped = flat_mapped<flat_umap<int, int>>;
+    using Mapped2 = flat_mapped<flat_umap<int, int64_t, stored_hash<indivi::hash<int>>>>;
+    EXPECT_THROW(Mapped m(path), std::runtime_error);
+    EXPECT_THROW(Mapped2 m(path), std::runtime_error);
+  }
+  {
+    // Different hash function
+    flat_umap<int, int, SeededHash> fum;
+    for (int i = 0; i < 100; ++i)
+      fum.emplace(i, i);
+    fum.save(path);
+    using Mapped = flat_mapped<flat_umap<int, int, SeededHash>>;
+    EXPECT_EQ(Mapped(path).size(), 100u);
+    EXPECT_THROW(Mapped m(path, SeededHash(0x1234567u)), std::runtime_error);
+
+    // Truncated or missing file
+    using Mapped2 = flat_mapped<flat_umap<int, int>>;
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "INDIVIFT";
+    EXPECT_THROW(Mapped2 m(path), std::runtime_error);
+    std::remove(path.c_str());
+    EXPECT_THROW(Mapped2 m(path), std::runtime_error);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatUMapTest, Swap)
 {
   {
@@ -1189,6 +2081,366 @@ TEST(FlatUMapTest, BadHash)
   }
 }
 
+TEST(FlatUMapTest, InlineStorage)
+{
+  using flat_umap_inl = flat_umap<DbgClass, DbgClass, indivi::hash<DbgClass>, std::equal_to<DbgClass>,
+                                  std::allocator<std::pair<const DbgClass, DbgClass>>, 6>;
+  auto is_inline = [](const flat_umap_inl& fum) {
+    const char* first = reinterpret_cast<const char*>(&*fum.begin());
+    const char* object = reinterpret_cast<const char*>(&fum);
+    return first >= object && first < object + sizeof(fum);
+  };
+  {
+    flat_umap_inl fum;
+    EXPECT_EQ(fum.bucket_count(), 0u);
+    
+    for (int i = 1; i <= 8; ++i)
+      fum.emplace(i, i + 1);
+    EXPECT_EQ(fum.size(), 8u);
+    EXPECT_EQ(fum.bucket_count(), 8u); // rounded up
+    EXPECT_TRUE(is_inline(fum));
+    
+    fum.emplace(9, 10);
+    EXPECT_EQ(fum.bucket_count(), 16u);
+    EXPECT_FALSE(is_inline(fum));
+    for (int i = 1; i <= 9; ++i)
+      EXPECT_EQ(fum.at(i), i + 1);
+    
+    fum.erase(9);
+    fum.erase(8);
+    fum.shrink_to_fit();
+    EXPECT_EQ(fum.bucket_count(), 8u);
+    EXPECT_TRUE(is_inline(fum));
+    for (int i = 1; i <= 7; ++i)
+      EXPECT_EQ(fum.at(i), i + 1);
+    
+    fum.rehash(2); // never below inline capacity
+    EXPECT_EQ(fum.bucket_count(), 8u);
+    EXPECT_TRUE(is_inline(fum));
+  }
+  {
+    flat_umap_inl fum1{{1, 2}, {3, 4}};
+    flat_umap_inl fum2(fum1);
+    EXPECT_TRUE(is_inline(fum2));
+    EXPECT_EQ(fum2, fum1);
+    
+    flat_umap_inl fum3(std::move(fum2));
+    EXPECT_TRUE(is_inline(fum3));
+    EXPECT_TRUE(fum2.empty());
+    EXPECT_EQ(fum3, fum1);
+    
+    fum2 = std::move(fum3);
+    EXPECT_TRUE(is_inline(fum2));
+    EXPECT_TRUE(fum3.empty());
+    EXPECT_EQ(fum2, fum1);
+    
+    // inline with heap
+    flat_umap_inl fum4;
+    for (int i = 1; i <= 20; ++i)
+      fum4.emplace(i, i);
+    flat_umap_inl fum5(fum4);
+    
+    fum2.swap(fum4);
+    EXPECT_TRUE(is_inline(fum4));
+    EXPECT_FALSE(is_inline(fum2));
+    EXPECT_EQ(fum4, fum1);
+    EXPECT_EQ(fum2, fum5);
+    
+    fum2.swap(fum4);
+    EXPECT_TRUE(is_inline(fum2));
+    EXPECT_EQ(fum2, fum1);
+    EXPECT_EQ(fum4, fum5);
+    
+    // both inline
+    flat_umap_inl fum6{{5, 6}, {7, 8}, {9, 10}};
+    flat_umap_inl fum7(fum6);
+    fum2.swap(fum6);
+    EXPECT_EQ(fum2, fum7);
+    EXPECT_EQ(fum6, fum1);
+    fum2.erase(7);
+    EXPECT_EQ(fum2.size(), 2u);
+    EXPECT_TRUE(fum2.contains(5));
+    EXPECT_TRUE(fum2.contains(9));
+    
+    // inline with empty
+    flat_umap_inl fum8;
+    fum8.swap(fum6);
+    EXPECT_TRUE(fum6.empty());
+    EXPECT_EQ(fum8, fum1);
+  }
+  {
+    // full inline storage
+    flat_umap<int, int, indivi::hash<int>, std::equal_to<int>, std::allocator<std::pair<const int, int>>, 16> fum;
+    fum.max_load_factor(0.5f);
+    for (int i = 0; i < 16; ++i)
+      fum.emplace(i, i);
+    EXPECT_EQ(fum.bucket_count(), 16u);
+    auto is_inline16 = [](const decltype(fum)& m) {
+      const char* first = reinterpret_cast<const char*>(&*m.begin());
+      return first >= reinterpret_cast<const char*>(&m) && first < reinterpret_cast<const char*>(&m) + sizeof(m);
+    };
+    EXPECT_TRUE(is_inline16(fum));
+    
+    auto fum2(fum);
+    EXPECT_TRUE(is_inline16(fum2));
+    EXPECT_EQ(fum2, fum);
+    
+    decltype(fum) fum3;
+    fum3 = fum;
+    EXPECT_TRUE(is_inline16(fum3));
+    EXPECT_EQ(fum3, fum);
+  }
+  {
+    // stored hashes, against std
+    flat_umap<int, int, stored_hash<indivi::hash<int>>, std::equal_to<int>, std::allocator<std::pair<const int, int>>, 16> fum;
+    std::unordered_map<int, int> map;
+    for (int i = 0; i < 1000; ++i)
+    {
+      int k = rand() % 64;
+      if (rand() % 2)
+      {
+        fum.emplace(k, i);
+        map.emplace(k, i);
+      }
+      else
+      {
+        EXPECT_EQ(fum.erase(k), map.erase(k));
+      }
+      if (rand() % 16 == 0)
+        fum.shrink_to_fit();
+    }
+    EXPECT_EQ(fum.size(), map.size());
+    auto fum2 = std::move(fum);
+    for (const auto& item : map)
+      EXPECT_EQ(fum2.at(item.first), item.second);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+#ifdef INDIVI_FLAT_U_TELEMETRY
+TEST(FlatUMapTest, Telemetry)
+{
+  const uint64_t sampling = INDIVI_FLAT_TELEMETRY_SAMPLING;
+  {
+    flat_umap<int, int> fum;
+    for (int i = 0; i < 10000; ++i)
+      fum.emplace(i, i);
+    flat_telemetry telemetry = fum.get_telemetry();
+    EXPECT_GT(telemetry.rehash_count, 0u);
+    EXPECT_GT(telemetry.sampled_lookups(), 0u); // lookups of insertions
+    
+    fum.reset_telemetry();
+    telemetry = fum.get_telemetry();
+    EXPECT_EQ(telemetry.sampled_lookups(), 0u);
+    EXPECT_EQ(telemetry.sampled_compares, 0u);
+    EXPECT_EQ(telemetry.rehash_count, 0u);
+    EXPECT_EQ(telemetry.rehash_nanoseconds, 0u);
+    
+    for (int i = 0; i < 10000; ++i)
+      EXPECT_TRUE(fum.contains(i));
+    for (int i = 0; i < 10000; ++i)
+      EXPECT_FALSE(fum.contains(-1 - i));
+    telemetry = fum.get_telemetry();
+    uint64_t hits = 0u;
+    uint64_t misses = 0u;
+    for (unsigned int i = 0u; i < flat_telemetry::PROBE_BINS; ++i)
+    {
+      hits += telemetry.probe_hits[i];
+      misses += telemetry.probe_misses[i];
+    }
+    EXPECT_NEAR((double)(hits + misses), 20000. / sampling, 1.);
+    EXPECT_NEAR((double)hits, 10000. / sampling, 1.);
+    EXPECT_GE(telemetry.sampled_compares, hits);
+    EXPECT_GT(telemetry.probe_hits[0], hits / 2u); // mostly in first window
+    
+    // counters not copied
+    flat_umap<int, int> copy(fum);
+    EXPECT_EQ(copy.get_telemetry().sampled_lookups(), 0u);
+    copy = fum;
+    EXPECT_EQ(copy.get_telemetry().sampled_lookups(), 0u);
+    
+    fum.rehash(fum.bucket_count() * 2u);
+    EXPECT_EQ(fum.get_telemetry().rehash_count, 1u);
+  }
+  {
+    // poor hash: long probes
+    struct poor_hash {
+      using is_avalanching = void; // wrongly
+      size_t operator()(const int& x) const { return (size_t)(x % 8); }
+    };
+    flat_umap<int, int, poor_hash> fum;
+    for (int i = 0; i < 1000; ++i)
+      fum.emplace(i, i);
+    fum.reset_telemetry();
+    for (int n = 0; n < 4; ++n)
+      for (int i = 0; i < 1000; ++i)
+        EXPECT_TRUE(fum.contains(i));
+    flat_telemetry telemetry = fum.get_telemetry();
+    EXPECT_NEAR((double)telemetry.sampled_lookups(), 4000. / sampling, 1.);
+    uint64_t longProbes = 0u;
+    for (unsigned int i = 4u; i < flat_telemetry::PROBE_BINS; ++i)
+      longProbes += telemetry.probe_hits[i];
+    EXPECT_GT(longProbes, telemetry.sampled_lookups() / 2u);
+  }
+  {
+    // no overflow counter saturation with a fair hash
+    flat_umap<int, int> fum;
+    for (int i = 0; i < 100000; ++i)
+      fum.emplace(i, i);
+    EXPECT_EQ(fum.get_telemetry().overflow_saturations, 0u);
+  }
+}
+#endif
+
+TEST(FlatUMapTest, SeededHashing)
+{
+  {
+    using Map = flat_umap<std::string, int, seeded_hash<std::string>>;
+    Map fum(0u, seeded_hash<std::string>(0x1234567u));
+    for (int i = 0; i < 1000; ++i)
+      fum.emplace(std::to_string(i), i);
+    
+    Map fum2(fum); // seed copied
+    EXPECT_EQ(fum2.hash_function()("abc"), seeded_hash<std::string>(0x1234567u)("abc"));
+    EXPECT_EQ(fum2, fum);
+    
+    Map fum3; // per-process seed
+    fum3.insert(fum.begin(), fum.end());
+    EXPECT_EQ(fum3, fum);
+    fum3.swap(fum2);
+    EXPECT_EQ(fum3.hash_function()("abc"), seeded_hash<std::string>(0x1234567u)("abc"));
+    for (int i = 0; i < 1000; ++i)
+    {
+      EXPECT_EQ(fum2.at(std::to_string(i)), i);
+      EXPECT_EQ(fum3.at(std::to_string(i)), i);
+    }
+  }
+  {
+    // keys only differing in high bits
+    flat_umap<uint64_t, int, seeded_hash<uint64_t>> fum;
+    for (int i = 0; i < 10000; ++i)
+      fum.emplace((uint64_t)i << 40, i);
+    EXPECT_EQ(fum.size(), 10000u);
+    for (int i = 0; i < 10000; ++i)
+      EXPECT_EQ(fum.at((uint64_t)i << 40), i);
+  }
+}
+
+TEST(FlatUMapTest, LongStringKeys)
+{
+  {
+    // prefixes of a same long string
+    flat_umap<std::string, int> fum;
+    std::string str(1000, 'x');
+    for (int len = 0; len <= 1000; ++len)
+      EXPECT_TRUE(fum.emplace(str.substr(0u, (std::size_t)len), len).second);
+    EXPECT_EQ(fum.size(), 1001u);
+    for (int len = 0; len <= 1000; ++len)
+      EXPECT_EQ(fum.at(str.substr(0u, (std::size_t)len)), len);
+    EXPECT_FALSE(fum.contains(std::string(1001, 'x')));
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+namespace
+{
+// Key made of segments, equal if same concatenated bytes
+struct SegmentedKey
+{
+  std::vector<std::string> parts;
+  
+  std::string str() const
+  {
+    std::string res;
+    for (const std::string& part : parts)
+      res += part;
+    return res;
+  }
+  bool operator==(const SegmentedKey& other) const { return str() == other.str(); }
+};
+
+struct SegmentedHash
+{
+  using is_avalanching = void;
+  
+  uint64_t operator()(const SegmentedKey& key) const
+  {
+    hash_state hs;
+    for (const std::string& part : key.parts)
+      hs.update(part);
+    return hs.finish();
+  }
+};
+}
+
+TEST(FlatUMapTest, StreamingHash)
+{
+  {
+    flat_umap<SegmentedKey, int, SegmentedHash> fum;
+    for (int i = 0; i < 1000; ++i)
+    {
+      std::string num = std::to_string(i);
+      fum.emplace(SegmentedKey{ { std::string(60, 'k'), num, std::string(i % 100, 'v') } }, i);
+    }
+    EXPECT_EQ(fum.size(), 1000u);
+    for (int i = 0; i < 1000; ++i)
+    {
+      // other segmentation of same bytes
+      std::string key = std::string(60, 'k') + std::to_string(i) + std::string(i % 100, 'v');
+      SegmentedKey other{ { key.substr(0u, 5u), key.substr(5u, key.size() / 2u), key.substr(5u + key.size() / 2u) } };
+      EXPECT_EQ(fum.at(other), i);
+    }
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUMapTest, CompositeKeys)
+{
+  {
+    // (tenant, object) keys
+    flat_umap<std::pair<uint32_t, uint64_t>, int> fum;
+    for (uint32_t t = 0; t < 100; ++t)
+      for (uint64_t o = 0; o < 100; ++o)
+        EXPECT_TRUE(fum.emplace(std::make_pair(t, o << 20), (int)(t * 100 + o)).second);
+    ASSERT_EQ(fum.size(), 10000u);
+    for (uint32_t t = 0; t < 100; t += 2)
+      for (uint64_t o = 0; o < 100; ++o)
+        EXPECT_EQ(fum.erase(std::make_pair(t, o << 20)), 1u);
+    for (uint32_t t = 0; t < 100; ++t)
+      for (uint64_t o = 0; o < 100; ++o)
+      {
+        auto it = fum.find(std::make_pair(t, o << 20));
+        ASSERT_EQ(it != fum.end(), t % 2 == 1);
+        if (it != fum.end())
+        {
+          EXPECT_EQ(it->second, (int)(t * 100 + o));
+        }
+      }
+  }
+  {
+    flat_umap<std::tuple<int, std::string, bool>, int> fum;
+    for (int i = 0; i < 300; ++i)
+      fum.emplace(std::make_tuple(i / 2, std::to_string(i % 7), i % 2 == 0), i);
+    EXPECT_EQ(fum.size(), 300u);
+    for (int i = 0; i < 300; ++i)
+      EXPECT_EQ(fum.at(std::make_tuple(i / 2, std::to_string(i % 7), i % 2 == 0)), i);
+    
+    flat_umap<std::array<uint8_t, 4>, int> fum2;
+    for (int i = 0; i < 256; ++i)
+      fum2.emplace(std::array<uint8_t, 4>{{ (uint8_t)i, 0u, (uint8_t)(255 - i), 0u }}, i);
+    EXPECT_EQ(fum2.size(), 256u);
+    for (int i = 0; i < 256; ++i)
+      EXPECT_EQ(fum2.at(std::array<uint8_t, 4>{{ (uint8_t)i, 0u, (uint8_t)(255 - i), 0u }}), i);
+    
+    flat_umap<std::array<double, 2>, int> fum3;
+    EXPECT_TRUE(fum3.emplace(std::array<double, 2>{{ 0.0, 1.0 }}, 1).second);
+    EXPECT_FALSE(fum3.emplace(std::array<double, 2>{{ -0.0, 1.0 }}, 2).second);
+  }
+}
+
 TEST(FlatUMapTest, Stress)
 {
   {
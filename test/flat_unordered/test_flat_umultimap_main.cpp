@@ -0,0 +1,514 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#include "gtest/gtest.h"
+
+#define INDIVI_FLAT_U_DEBUG
+#define INDIVI_FLAT_U_TELEMETRY // same as umap tests (shared instantiations)
+#include "indivi/flat_umultimap.h"
+#include "utils/bump_allocator.h"
+#include "utils/debug_utils.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <cassert>
+#include <cstdlib>
+
+using namespace indivi;
+
+
+namespace
+{
+template< class Range >
+std::vector<int> sorted_values(const Range& range)
+{
+  std::vector<int> values;
+  for (auto it = range.first; it != range.second; ++it)
+    values.push_back(it->second);
+  std::sort(values.begin(), values.end());
+  return values;
+}
+
+template< class Range >
+size_t range_size(const Range& range)
+{
+  size_t size = 0u;
+  for (auto it = range.first; it != range.second; ++it)
+    ++size;
+  return size;
+}
+}
+
+TEST(FlatUMultiMapTest, Constructor)
+{
+  {
+    flat_umultimap<DbgClass, DbgClass> fumm;
+    EXPECT_TRUE(fumm.empty());
+    EXPECT_EQ(fumm.size(), 0u);
+    EXPECT_EQ(fumm.count(1), 0u);
+    EXPECT_FALSE(fumm.contains(1));
+  }
+  {
+    flat_umultimap<DbgClass, DbgClass> fumm{{1, 2}, {1, 3}, {2, 4}};
+    EXPECT_EQ(fumm.size(), 3u);
+    EXPECT_EQ(fumm.count(1), 2u);
+    EXPECT_EQ(fumm.count(2), 1u);
+    EXPECT_EQ(fumm.count(3), 0u);
+
+    flat_umultimap<DbgClass, DbgClass> fumm2(fumm);
+    EXPECT_EQ(fumm2.size(), 3u);
+    EXPECT_EQ(fumm2.count(1), 2u);
+    EXPECT_EQ(fumm2, fumm);
+
+    flat_umultimap<DbgClass, DbgClass> fumm3(std::move(fumm2));
+    EXPECT_EQ(fumm3.size(), 3u);
+    EXPECT_EQ(fumm3.count(1), 2u);
+    EXPECT_EQ(fumm3, fumm);
+  }
+  {
+    std::vector<std::pair<int, int>> vec{{1, 1}, {1, 1}, {1, 2}, {2, 2}};
+    flat_umultimap<int, int> fumm(vec.begin(), vec.end());
+    EXPECT_EQ(fumm.size(), 4u);
+    EXPECT_EQ(fumm.count(1), 3u);
+    EXPECT_EQ(fumm.count(2), 1u);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUMultiMapTest, Assignment)
+{
+  {
+    flat_umultimap<DbgClass, DbgClass> fumm{{1, 2}, {1, 3}};
+    flat_umultimap<DbgClass, DbgClass> fumm2{{5, 6}};
+
+    fumm2 = fumm;
+    EXPECT_EQ(fumm2.size(), 2u);
+    EXPECT_EQ(fumm2.count(1), 2u);
+    EXPECT_FALSE(fumm2.contains(5));
+
+    flat_umultimap<DbgClass, DbgClass> fumm3;
+    fumm3 = std::move(fumm2);
+    EXPECT_EQ(fumm3.size(), 2u);
+    EXPECT_EQ(fumm3.count(1), 2u);
+
+    fumm3 = {{7, 8}, {7, 8}};
+    EXPECT_EQ(fumm3.size(), 2u);
+    EXPECT_EQ(fumm3.count(7), 2u);
+    EXPECT_FALSE(fumm3.contains(1));
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUMultiMapTest, Allocator)
+{
+  using alloc_type = bump_allocator<std::pair<const DbgClass, DbgClass>>;
+  using flat_umultimap_alc = flat_umultimap<DbgClass, DbgClass, indivi::hash<DbgClass>, std::equal_to<DbgClass>, alloc_type>;
+  {
+    flat_umultimap_alc fumm;
+    for (int i = 1; i <= 40; ++i)
+      fumm.emplace(i % 5 + 1, i);
+    ASSERT_EQ(fumm.size(), 40u);
+
+    alloc_type alc;
+    flat_umultimap_alc fumm1(fumm, alc);
+    EXPECT_EQ(fumm1, fumm);
+
+    // unequal allocators: move element-wise
+    flat_umultimap_alc fumm2(std::move(fumm), alc);
+    EXPECT_TRUE(fumm.empty());
+    EXPECT_EQ(fumm2, fumm1);
+    EXPECT_EQ(fumm2.count(3), 8u);
+
+    fumm1.clear();
+    EXPECT_TRUE(fumm1.is_cleared());
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUMultiMapTest, Insert)
+{
+  {
+    flat_umultimap<DbgClass, DbgClass> fumm;
+    auto it = fumm.insert({1, 2});
+    ASSERT_NE(it, fumm.end());
+    EXPECT_EQ(it->first, 1);
+    EXPECT_EQ(it->second, 2);
+
+    it = fumm.insert({1, 2});
+    ASSERT_NE(it, fumm.end());
+    EXPECT_EQ(it->first, 1);
+    EXPECT_EQ(it->second, 2);
+
+    it = fumm.emplace(1, 3);
+    ASSERT_NE(it, fumm.end());
+    EXPECT_EQ(it->first, 1);
+    EXPECT_EQ(it->second, 3);
+
+    std::pair<const DbgClass, DbgClass> item{2, 4};
+    it = fumm.insert(item);
+    ASSERT_NE(it, fumm.end());
+    EXPECT_EQ(it->first, 2);
+    EXPECT_EQ(it->second, 4);
+
+    fumm.insert({{2, 5}, {3, 6}});
+    EXPECT_EQ(fumm.size(), 6u);
+    EXPECT_EQ(fumm.count(1), 3u);
+    EXPECT_EQ(fumm.count(2), 2u);
+    EXPECT_EQ(fumm.count(3), 1u);
+
+    int total = 0;
+    for (const auto& item_ : fumm)
+      total += item_.second.id;
+    EXPECT_EQ(total, 22);
+  }
+  {
+    // same key over several groups
+    flat_umultimap<int, int> fumm;
+    for (int i = 0; i < 100; ++i)
+    {
+      fumm.emplace(i % 3, i);
+      EXPECT_EQ(fumm.size(), (size_t)i + 1);
+    }
+    EXPECT_EQ(fumm.count(0), 34u);
+    EXPECT_EQ(fumm.count(1), 33u);
+    EXPECT_EQ(fumm.count(2), 33u);
+    EXPECT_EQ(fumm.count(3), 0u);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUMultiMapTest, EqualRange)
+{
+  {
+    flat_umultimap<DbgClass, DbgClass> fumm;
+    auto range = fumm.equal_range(1);
+    EXPECT_EQ(range.first, range.second);
+
+    fumm.emplace(2, 2);
+    range = fumm.equal_range(1);
+    EXPECT_EQ(range.first, range.second);
+  }
+  {
+    flat_umultimap<int, int> fumm{{1, 1}, {1, 2}, {2, 3}, {1, 3}};
+    const auto& cfumm = fumm;
+
+    auto values = sorted_values(fumm.equal_range(1));
+    EXPECT_EQ(values, (std::vector<int>{1, 2, 3}));
+    values = sorted_values(cfumm.equal_range(2));
+    EXPECT_EQ(values, (std::vector<int>{3}));
+    EXPECT_TRUE(sorted_values(cfumm.equal_range(3)).empty());
+
+    // mutable and convertible to iterator
+    auto range = fumm.equal_range(2);
+    ASSERT_NE(range.first, range.second);
+    range.first->second = 4;
+    flat_umultimap<int, int>::iterator it = range.first;
+    EXPECT_EQ(it->second, 4);
+
+    flat_umultimap<int, int>::const_equal_iterator cit = range.first;
+    EXPECT_EQ(cit->second, 4);
+    EXPECT_EQ(++cit, range.second);
+  }
+  {
+    // erase while iterating (last item of a key moved into erased slot)
+    flat_umultimap<int, int> fumm;
+    std::vector<size_t> counts(7, 0u);
+    for (int i = 0; i < 300; ++i)
+    {
+      fumm.emplace(i % 7, i);
+      if (i % 3)
+        ++counts[i % 7];
+    }
+    size_t visited = 0u;
+    for (auto it = fumm.begin(); it != fumm.end();)
+    {
+      ++visited;
+      if (it->second % 3 == 0)
+        it = fumm.erase_(it);
+      else
+        ++it;
+    }
+    EXPECT_EQ(visited, 300u);
+    EXPECT_EQ(fumm.size(), 200u);
+    for (int k = 0; k < 7; ++k)
+    {
+      EXPECT_EQ(fumm.count(k), counts[k]);
+      auto range = fumm.equal_range(k);
+      EXPECT_EQ(range_size(range), counts[k]);
+      for (auto it = range.first; it != range.second; ++it)
+        EXPECT_NE(it->second % 3, 0);
+    }
+  }
+  {
+    // long lists, against std
+    flat_umultimap<int, int> fumm;
+    std::unordered_multimap<int, int> map;
+    for (int i = 0; i < 2000; ++i)
+    {
+      int k = rand() % 50;
+      fumm.emplace(k, i);
+      map.emplace(k, i);
+    }
+    EXPECT_EQ(fumm.size(), map.size());
+
+    for (int k = 0; k < 60; ++k)
+    {
+      std::vector<int> expected;
+      auto rangeM = map.equal_range(k);
+      for (auto it = rangeM.first; it != rangeM.second; ++it)
+        expected.push_back(it->second);
+      std::sort(expected.begin(), expected.end());
+
+      EXPECT_EQ(sorted_values(fumm.equal_range(k)), expected);
+      EXPECT_EQ(fumm.count(k), map.count(k));
+    }
+  }
+}
+
+TEST(FlatUMultiMapTest, Rehash)
+{
+  flat_umultimap<DbgClass, DbgClass> fumm;
+  for (int i = 0; i < 200; ++i)
+    fumm.emplace(i % 20 + 1, i + 1);
+  EXPECT_EQ(fumm.size(), 200u);
+
+  fumm.rehash(2048);
+  EXPECT_EQ(fumm.size(), 200u);
+  for (int k = 1; k <= 20; ++k)
+    EXPECT_EQ(fumm.count(k), 10u);
+
+  fumm.max_load_factor(0.5f);
+  fumm.shrink_to_fit();
+  EXPECT_EQ(fumm.size(), 200u);
+  for (int k = 1; k <= 20; ++k)
+    EXPECT_EQ(fumm.count(k), 10u);
+
+  fumm.clear();
+  EXPECT_EQ(fumm.size(), 0u);
+  EXPECT_TRUE(fumm.is_cleared());
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUMultiMapTest, Erase)
+{
+  {
+    flat_umultimap<DbgClass, DbgClass> fumm{{1, 2}, {1, 3}, {3, 4}};
+    EXPECT_EQ(fumm.erase(1), 2u);
+    EXPECT_FALSE(fumm.contains(1));
+    EXPECT_TRUE(fumm.contains(3));
+    EXPECT_EQ(fumm.size(), 1u);
+
+    EXPECT_EQ(fumm.erase(1), 0u);
+    EXPECT_EQ(fumm.size(), 1u);
+
+    EXPECT_EQ(fumm.erase(3), 1u);
+    EXPECT_EQ(fumm.size(), 0u);
+  }
+  {
+    // items over several groups
+    flat_umultimap<int, int> fumm;
+    for (int i = 0; i < 300; ++i)
+      fumm.emplace(i % 4, i);
+
+    EXPECT_EQ(fumm.erase(2), 75u);
+    EXPECT_EQ(fumm.size(), 225u);
+    EXPECT_EQ(fumm.count(0), 75u);
+    EXPECT_EQ(fumm.count(1), 75u);
+    EXPECT_EQ(fumm.count(2), 0u);
+    EXPECT_EQ(fumm.count(3), 75u);
+
+    for (int i = 0; i < 10; ++i)
+      fumm.emplace(2, i);
+    EXPECT_EQ(fumm.count(2), 10u);
+    EXPECT_EQ(fumm.size(), 235u);
+  }
+  {
+    flat_umultimap<DbgClass, DbgClass> fumm{{1, 2}, {1, 3}, {3, 4}};
+    auto range = fumm.equal_range(1);
+    ASSERT_NE(range.first, range.second);
+    int erased = range.first->second.id;
+
+    fumm.erase(range.first);
+    EXPECT_EQ(fumm.count(1), 1u);
+    EXPECT_EQ(fumm.size(), 2u);
+    EXPECT_EQ(fumm.find(1)->second, erased == 2 ? 3 : 2);
+
+    auto it = fumm.begin();
+    while (!fumm.empty())
+      it = fumm.erase_(it);
+    EXPECT_EQ(fumm.size(), 0u);
+  }
+  {
+    flat_umultimap<int, int> fumm{{1, 1}, {1, 2}, {2, 3}, {1, 4}};
+    erase_if(fumm, [](const auto& item){ return (item.second % 2); });
+    EXPECT_EQ(fumm.size(), 2u);
+    EXPECT_EQ(fumm.count(1), 2u);
+    EXPECT_EQ(fumm.count(2), 0u);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUMultiMapTest, LongList)
+{
+  {
+    // many items under one key (spread by rank)
+    const int N = 20000;
+    flat_umultimap<int, int> fumm;
+    for (int i = 0; i < N; ++i)
+    {
+      fumm.emplace(42, i);
+      fumm.emplace(i, -i); // other keys
+    }
+    EXPECT_EQ(fumm.size(), 2u * N);
+    EXPECT_EQ(fumm.count(42), N + 1u);
+    EXPECT_EQ(fumm.count(43), 1u);
+
+    auto range = fumm.equal_range(42);
+    EXPECT_EQ(range_size(range), N + 1u);
+    std::vector<int> expected;
+    for (int i = 0; i < N; ++i)
+      expected.push_back(i);
+    expected.push_back(-42);
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(sorted_values(range), expected);
+
+    // erase odd values by iterator
+    for (auto it = fumm.begin(); it != fumm.end();)
+    {
+      if (it->first == 42 && it->second % 2)
+        it = fumm.erase_(it);
+      else
+        ++it;
+    }
+    EXPECT_EQ(fumm.count(42), N / 2 + 1u);
+    EXPECT_EQ(fumm.size(), 2u * N - N / 2);
+    expected.erase(std::remove_if(expected.begin(), expected.end(), [](int v) { return v % 2 != 0; }), expected.end());
+    EXPECT_EQ(sorted_values(fumm.equal_range(42)), expected);
+    EXPECT_EQ(fumm.count(43), 1u);
+
+    // erase all by key
+    EXPECT_EQ(fumm.erase(42), N / 2 + 1u);
+    EXPECT_EQ(fumm.count(42), 0u);
+    EXPECT_FALSE(fumm.contains(42));
+    EXPECT_EQ(fumm.size(), N - 1u);
+    auto empty = fumm.equal_range(42);
+    EXPECT_EQ(empty.first, empty.second);
+
+    for (int i = 0; i < 10; ++i)
+      fumm.emplace(42, i);
+    EXPECT_EQ(fumm.count(42), 10u);
+  }
+  {
+    // erase by iterator down to empty
+    flat_umultimap<DbgClass, DbgClass> fumm;
+    for (int i = 0; i < 10000; ++i)
+      fumm.emplace(7, i + 1);
+    EXPECT_EQ(fumm.count(7), 10000u);
+    EXPECT_EQ(fumm.get_telemetry().overflow_saturations, 0u); // spread by rank
+
+    while (!fumm.empty())
+      fumm.erase(fumm.begin());
+    EXPECT_FALSE(fumm.contains(7));
+    EXPECT_TRUE(fumm.is_cleared());
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUMultiMapTest, Equality)
+{
+  {
+    flat_umultimap<DbgClass, DbgClass> fumm1;
+    flat_umultimap<DbgClass, DbgClass> fumm2;
+    EXPECT_EQ(fumm1, fumm2);
+  }
+  {
+    flat_umultimap<DbgClass, DbgClass> fumm1{{1, 2}, {1, 3}};
+    flat_umultimap<DbgClass, DbgClass> fumm2{{1, 3}, {1, 2}};
+    EXPECT_EQ(fumm1, fumm2);
+    EXPECT_EQ(fumm2, fumm1);
+  }
+  {
+    flat_umultimap<DbgClass, DbgClass> fumm1{{1, 2}, {1, 2}, {1, 3}};
+    flat_umultimap<DbgClass, DbgClass> fumm2{{1, 2}, {1, 3}, {1, 3}};
+    EXPECT_NE(fumm1, fumm2);
+    EXPECT_NE(fumm2, fumm1);
+  }
+  {
+    flat_umultimap<DbgClass, DbgClass> fumm1{{1, 2}};
+    flat_umultimap<DbgClass, DbgClass> fumm2{{1, 2}, {1, 2}};
+    EXPECT_NE(fumm1, fumm2);
+    EXPECT_NE(fumm2, fumm1);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUMultiMapTest, Swap)
+{
+  {
+    flat_umultimap<DbgClass, DbgClass> fumm1{{1, 2}, {1, 4}};
+    flat_umultimap<DbgClass, DbgClass> fumm2{{5, 6}};
+
+    swap(fumm1, fumm2);
+    EXPECT_EQ(fumm1.size(), 1u);
+    EXPECT_EQ(fumm2.size(), 2u);
+    EXPECT_EQ(fumm2.count(1), 2u);
+    EXPECT_TRUE(fumm1.contains(5));
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUMultiMapTest, Stress)
+{
+  {
+    flat_umultimap<int, int> fumm;
+    std::unordered_multimap<int, int> map;
+
+    for (int i = 0; i < 100000; ++i)
+    {
+      int k = rand() % 2000;
+      switch (rand() % 4)
+      {
+        case 0:
+        case 1: // insert
+        {
+          fumm.emplace(k, i);
+          map.emplace(k, i);
+          break;
+        }
+        case 2: // erase all
+        {
+          EXPECT_EQ(fumm.erase(k), map.erase(k)) << "erase";
+          break;
+        }
+        case 3: // count
+        {
+          EXPECT_EQ(fumm.count(k), map.count(k)) << "count";
+          break;
+        }
+        default:
+          assert(false);
+      }
+    }
+    std::cout << "Stress final size: " << map.size() << "\n";
+    EXPECT_EQ(fumm.size(), map.size()) << "final";
+
+    for (int k = 0; k < 2000; ++k)
+      EXPECT_EQ(fumm.count(k), map.count(k));
+  }
+}
@@ -0,0 +1,198 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#include "gtest/gtest.h"
+
+#define INDIVI_FLAT_U_DEBUG
+#include "indivi/flat_umultiset.h"
+#include "utils/debug_utils.h"
+
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <cassert>
+#include <cstdlib>
+
+using namespace indivi;
+
+
+namespace
+{
+template< class Range >
+size_t range_size(const Range& range)
+{
+  size_t size = 0u;
+  for (auto it = range.first; it != range.second; ++it)
+    ++size;
+  return size;
+}
+}
+
+TEST(FlatUMultiSetTest, Constructor)
+{
+  {
+    flat_umultiset<DbgClass> fums;
+    EXPECT_TRUE(fums.empty());
+    EXPECT_EQ(fums.count(1), 0u);
+    EXPECT_FALSE(fums.contains(1));
+  }
+  {
+    flat_umultiset<DbgClass> fums{1, 1, 2};
+    EXPECT_EQ(fums.size(), 3u);
+    EXPECT_EQ(fums.count(1), 2u);
+    EXPECT_EQ(fums.count(2), 1u);
+
+    flat_umultiset<DbgClass> fums2(fums);
+    EXPECT_EQ(fums2.count(1), 2u);
+    EXPECT_EQ(fums2, fums);
+
+    flat_umultiset<DbgClass> fums3(std::move(fums2));
+    EXPECT_EQ(fums3.count(1), 2u);
+    EXPECT_EQ(fums3, fums);
+
+    fums3 = {4, 4, 4};
+    EXPECT_EQ(fums3.size(), 3u);
+    EXPECT_EQ(fums3.count(4), 3u);
+    EXPECT_FALSE(fums3.contains(1));
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUMultiSetTest, Insert)
+{
+  {
+    flat_umultiset<std::string> fums;
+    std::string str("abc");
+    auto it = fums.insert(str);
+    ASSERT_NE(it, fums.end());
+    EXPECT_EQ(*it, "abc");
+
+    it = fums.insert(std::string("abc"));
+    EXPECT_EQ(*it, "abc");
+
+    it = fums.emplace(3, 'a');
+    EXPECT_EQ(*it, "aaa");
+
+    fums.insert({"aaa", "abc", "b"});
+    EXPECT_EQ(fums.size(), 6u);
+    EXPECT_EQ(fums.count("abc"), 3u);
+    EXPECT_EQ(fums.count("aaa"), 2u);
+    EXPECT_EQ(fums.count("b"), 1u);
+    EXPECT_EQ(fums.count("c"), 0u);
+  }
+  {
+    flat_umultiset<int> fums;
+    for (int i = 0; i < 100; ++i)
+      fums.insert(i % 3);
+    EXPECT_EQ(fums.size(), 100u);
+    EXPECT_EQ(fums.count(0), 34u);
+    EXPECT_EQ(fums.count(1), 33u);
+    EXPECT_EQ(fums.count(2), 33u);
+
+    size_t count = 0u;
+    auto range = fums.equal_range(1);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+      EXPECT_EQ(*it, 1);
+      ++count;
+    }
+    EXPECT_EQ(count, 33u);
+  }
+}
+
+TEST(FlatUMultiSetTest, Erase)
+{
+  {
+    flat_umultiset<DbgClass> fums{1, 1, 3};
+    EXPECT_EQ(fums.erase(1), 2u);
+    EXPECT_FALSE(fums.contains(1));
+    EXPECT_TRUE(fums.contains(3));
+    EXPECT_EQ(fums.erase(1), 0u);
+    EXPECT_EQ(fums.size(), 1u);
+
+    fums.erase(fums.find(3));
+    EXPECT_TRUE(fums.empty());
+  }
+  {
+    flat_umultiset<int> fums;
+    std::unordered_multiset<int> set;
+    for (int i = 0; i < 50000; ++i)
+    {
+      int k = rand() % 1000;
+      if (rand() % 3)
+      {
+        fums.insert(k);
+        set.insert(k);
+      }
+      else
+      {
+        EXPECT_EQ(fums.erase(k), set.erase(k));
+      }
+    }
+    EXPECT_EQ(fums.size(), set.size());
+    for (int k = 0; k < 1000; ++k)
+      EXPECT_EQ(fums.count(k), set.count(k));
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUMultiSetTest, LongList)
+{
+  const int N = 10000;
+  flat_umultiset<int> fums;
+  for (int i = 0; i < N; ++i)
+  {
+    fums.insert(5);
+    fums.insert(i);
+  }
+  EXPECT_EQ(fums.size(), 2u * N);
+  EXPECT_EQ(fums.count(5), N + 1u);
+
+  auto range = fums.equal_range(5);
+  EXPECT_EQ(range_size(range), N + 1u);
+  for (auto it = range.first; it != range.second; ++it)
+    EXPECT_EQ(*it, 5);
+
+  // erase half by iterator
+  int erased = 0;
+  for (auto it = fums.begin(); it != fums.end();)
+  {
+    if (*it == 5 && erased < N / 2)
+    {
+      it = fums.erase_(it);
+      ++erased;
+    }
+    else
+      ++it;
+  }
+  EXPECT_EQ(fums.count(5), N / 2 + 1u);
+  EXPECT_EQ(*fums.find(5), 5);
+
+  EXPECT_EQ(fums.erase(5), N / 2 + 1u);
+  EXPECT_FALSE(fums.contains(5));
+  EXPECT_EQ(fums.size(), N - 1u);
+}
+
+TEST(FlatUMultiSetTest, Equality)
+{
+  {
+    flat_umultiset<DbgClass> fums1{1, 1, 2};
+    flat_umultiset<DbgClass> fums2{2, 1, 1};
+    EXPECT_EQ(fums1, fums2);
+  }
+  {
+    flat_umultiset<DbgClass> fums1{1, 1, 2};
+    flat_umultiset<DbgClass> fums2{1, 2, 2};
+    EXPECT_NE(fums1, fums2);
+    EXPECT_NE(fums2, fums1);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
@@ -6,18 +6,22 @@
 #include "gtest/gtest.h"
 
 #define INDIVI_FLAT_U_DEBUG
+#include "indivi/flat_mapped.h"
 #include "indivi/flat_uset.h"
+#include "utils/bump_allocator.h"
 #include "utils/debug_utils.h"
 
 #include <initializer_list>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include <cassert>
+#include <cstdio>
 #include <cstdlib>
 
 using namespace indivi;
@@ -226,6 +230,61 @@ TEST(FlatUSetTest, Assignment2)
   EXPECT_EQ(DbgClass::count, 0);
 }
 
+TEST(FlatUSetTest, Allocator)
+{
+  using alloc_type = bump_allocator<DbgClass>;
+  using flat_uset_alc = flat_uset<DbgClass, indivi::hash<DbgClass>, std::equal_to<DbgClass>, alloc_type>;
+  {
+    alloc_type alc;
+    flat_uset_alc fus0(alc);
+    EXPECT_TRUE(fus0.empty());
+    
+    flat_uset_alc fus1(10, alc);
+    EXPECT_GE(fus1.bucket_count(), 10u);
+    EXPECT_FALSE(fus1.contains(1));
+  }
+  {
+    flat_uset_alc fus;
+    for (int i = 1; i <= 40; ++i)
+      fus.emplace(i);
+    ASSERT_EQ(fus.size(), 40u);
+    
+    alloc_type alc;
+    flat_uset_alc fus1(fus, alc);
+    EXPECT_EQ(fus1, fus);
+    
+    // unequal allocators: move element-wise
+    flat_uset_alc fus2(std::move(fus), alc);
+    EXPECT_TRUE(fus.empty());
+    EXPECT_EQ(fus2, fus1);
+    
+    flat_uset_alc fus3;
+    fus3 = fus1;
+    EXPECT_EQ(fus3, fus1);
+    
+    fus3 = std::move(fus2);
+    EXPECT_TRUE(fus2.empty());
+    EXPECT_EQ(fus3, fus1);
+    
+    // propagate on swap
+    fus2.swap(fus3);
+    EXPECT_TRUE(fus3.empty());
+    EXPECT_EQ(fus2, fus1);
+    
+    fus2.clear();
+    fus2.rehash(0);
+    EXPECT_EQ(fus2.bucket_count(), 0u);
+  }
+  {
+    flat_uset<int> fus{};
+    std::allocator<int> alc = fus.get_allocator();
+    flat_uset<int> fus1(std::move(fus), alc);
+    EXPECT_TRUE(fus1.empty());
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatUSetTest, Capacity)
 {
   {
@@ -239,7 +298,8 @@ TEST(FlatUSetTest, Capacity)
     EXPECT_EQ(fus.max_load_factor(), 0.875f);
     EXPECT_EQ(fus.max_size(), max_size);
     EXPECT_GT(fus.max_bucket_count(), 0u);
-    fus.max_load_factor(0.f); // no-op
+    fus.max_load_factor(0.f); // clamped
+    EXPECT_EQ(fus.max_load_factor(), 0.25f);
     EXPECT_GT(fus.max_bucket_count(), 0u);
     
     fus = {1, 3};
@@ -476,6 +536,153 @@ TEST(FlatUSetTest, ElementAccess2)
   EXPECT_EQ(DbgClass::count, 0);
 }
 
+TEST(FlatUSetTest, FindBatch)
+{
+  {
+    flat_uset<DbgClass> fus;
+    std::vector<DbgClass> keys{1, 2, 3};
+    std::unique_ptr<bool[]> found(new bool[keys.size()]);
+    fus.contains_batch(keys.data(), keys.size(), found.get());
+    for (size_t i = 0; i < keys.size(); ++i)
+      EXPECT_FALSE(found[i]);
+  }
+  {
+    flat_uset<DbgClass> fus;
+    for (int i = 1; i < 1000; i += 2)
+      fus.emplace(i);
+    
+    std::vector<DbgClass> keys;
+    for (int i = 0; i < 1000; ++i)
+      keys.emplace_back((i * 7) % 1000 + 1);
+    
+    std::unique_ptr<bool[]> found(new bool[keys.size()]);
+    fus.contains_batch(keys.data(), keys.size(), found.get());
+    
+    std::vector<flat_uset<DbgClass>::iterator> its(keys.size());
+    fus.find_batch(keys.data(), keys.size(), its.data());
+    
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+      bool exist = keys[i].id % 2 == 1;
+      EXPECT_EQ(found[i], exist);
+      EXPECT_EQ(its[i], fus.find(keys[i]));
+      if (exist)
+      {
+        ASSERT_NE(its[i], fus.end());
+        EXPECT_EQ(*its[i], keys[i]);
+      }
+    }
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+struct TransparentEqual
+{
+  using is_transparent = void;
+  template< class U, class V >
+  bool operator()(const U& lhs, const V& rhs) const { return lhs == rhs; }
+};
+
+TEST(FlatUSetTest, TransparentLookup)
+{
+  {
+    flat_uset<std::string, indivi::hash<std::string>, TransparentEqual> fus;
+    for (int i = 1; i <= 100; ++i)
+      fus.insert(std::to_string(i));
+    ASSERT_EQ(fus.size(), 100u);
+    
+    EXPECT_TRUE(fus.contains("42"));
+    EXPECT_FALSE(fus.contains("0"));
+    EXPECT_EQ(fus.count("7"), 1u);
+    EXPECT_EQ(*fus.find("13"), "13");
+    EXPECT_TRUE(fus.find("101") == fus.end());
+    
+    const auto& cfus = fus;
+    EXPECT_EQ(*cfus.find("13"), "13");
+    
+    EXPECT_EQ(fus.erase("100"), 1u);
+    EXPECT_EQ(fus.erase("100"), 0u);
+    EXPECT_EQ(fus.size(), 99u);
+  #ifdef INDIVI_CPP17
+    std::string_view sv("57");
+    EXPECT_TRUE(fus.contains(sv));
+    EXPECT_EQ(*fus.find(sv), "57");
+  #endif
+  }
+  {
+    indivi::hash<std::string> hash;
+    EXPECT_EQ(hash("abc"), hash(std::string("abc")));
+    EXPECT_EQ(hash(""), hash(std::string()));
+  #ifdef INDIVI_CPP17
+    EXPECT_EQ(indivi::hash<std::string_view>{}("abc"), hash(std::string("abc")));
+  #endif
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+struct CountedHash
+{
+  int* calls;
+  explicit CountedHash(int* calls_ = nullptr) : calls(calls_) {}
+  std::size_t operator()(const DbgClass& key) const
+  {
+    ++(*calls);
+    return std::hash<DbgClass>{}(key);
+  }
+};
+
+TEST(FlatUSetTest, StoredHash)
+{
+  {
+    int calls = 0;
+    flat_uset<DbgClass, stored_hash<CountedHash>> fus(0, stored_hash<CountedHash>(CountedHash(&calls)));
+    for (int i = 1; i <= 1000; ++i)
+      fus.insert(i);
+    ASSERT_EQ(fus.size(), 1000u);
+    EXPECT_EQ(calls, 1000); // never re-hashed on growth
+    
+    for (int i = 1; i <= 1000; ++i)
+      EXPECT_EQ(fus.find(i)->id, i);
+    EXPECT_FALSE(fus.contains(1001));
+    
+    calls = 0;
+    flat_uset<DbgClass, stored_hash<CountedHash>> fus2(fus);
+    EXPECT_EQ(calls, 0);
+    EXPECT_TRUE(fus2 == fus);
+    
+    for (int i = 1; i <= 1000; i += 2)
+      EXPECT_EQ(fus.erase(i), 1u);
+    ASSERT_EQ(fus.size(), 500u);
+    
+    calls = 0;
+    fus.rehash(0); // shrink
+    EXPECT_EQ(calls, 0);
+    for (int i = 1; i <= 1000; ++i)
+      EXPECT_EQ(fus.contains(i), i % 2 == 0);
+  }
+  {
+    int calls = 0;
+    flat_uset<DbgClass, CountedHash> fus(0, CountedHash(&calls));
+    for (int i = 1; i <= 1000; ++i)
+      fus.insert(i);
+    ASSERT_EQ(fus.size(), 1000u);
+    EXPECT_GT(calls, 1000); // re-hashed on growth
+  }
+  {
+    flat_uset<std::string, stored_hash<indivi::hash<std::string>>> fus;
+    for (int i = 0; i < 500; ++i)
+      fus.insert(std::to_string(i));
+    ASSERT_EQ(fus.size(), 500u);
+    for (int i = 0; i < 500; ++i)
+      EXPECT_TRUE(fus.contains(std::to_string(i)));
+    EXPECT_FALSE(fus.contains("500"));
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatUSetTest, Clear)
 {
   {
@@ -601,6 +808,76 @@ TEST(FlatUSetTest, Insert2)
   EXPECT_EQ(DbgClass::count, 0);
 }
 
+namespace
+{
+// Hasher with batched hashing (counted)
+struct BatchCountedHash
+{
+  int* batchs;
+  std::size_t operator()(int key) const { return (std::size_t)key * 31u; }
+  void hash_batch(const int* keys, std::size_t count, std::size_t* out) const
+  {
+    ++*batchs;
+    for (std::size_t i = 0u; i < count; ++i)
+      out[i] = (*this)(keys[i]);
+  }
+};
+}
+
+TEST(FlatUSetTest, InsertUniqueRange)
+{
+  {
+    std::vector<DbgClass> vec;
+    for (int i = 1; i <= 100000; ++i)
+      vec.emplace_back(i);
+    flat_uset<DbgClass> fus;
+    fus.insert_unique_range(vec.begin(), vec.end());
+    ASSERT_EQ(fus.size(), 100000u);
+    EXPECT_EQ(vec[0], 1);
+    for (int i = 1; i <= 100000; ++i)
+      EXPECT_TRUE(fus.contains(i));
+    EXPECT_FALSE(fus.contains(100001));
+    
+    // moved, into non-empty table
+    std::vector<DbgClass> vec2;
+    for (int i = 100001; i <= 100100; ++i)
+      vec2.emplace_back(i);
+    fus.insert_unique_range(std::make_move_iterator(vec2.begin()), std::make_move_iterator(vec2.end()));
+    EXPECT_EQ(fus.size(), 100100u);
+    EXPECT_NE(vec2[0], 100001);
+    for (int i = 100001; i <= 100100; ++i)
+      EXPECT_TRUE(fus.contains(i));
+  }
+  {
+    std::vector<DbgClass> vec{1, 3, 5};
+    flat_uset<DbgClass> fus;
+    fus.insert_unique_range(vec.begin(), vec.begin());
+    EXPECT_TRUE(fus.empty());
+    fus.insert_unique_range(vec.begin(), vec.end());
+    EXPECT_EQ(fus.size(), 3u);
+    EXPECT_TRUE(fus.contains(3));
+  }
+  {
+    // contiguous keys hashed by hasher batch
+    std::vector<int> vec;
+    for (int i = 0; i < 100; ++i)
+      vec.push_back(i * 3);
+    int batchs = 0;
+    flat_uset<int, BatchCountedHash> fus(0u, BatchCountedHash{ &batchs });
+    fus.insert_unique_range(vec.data(), vec.data() + vec.size());
+    EXPECT_EQ(batchs, 7); // by 16
+    std::vector<int> vec2{ 1000, 1001, 1002 };
+    fus.insert_unique_range(vec2.begin(), vec2.end()); // not from pointers, one by one
+    EXPECT_EQ(batchs, 7);
+    ASSERT_EQ(fus.size(), 103u);
+    EXPECT_TRUE(fus.contains(1001));
+    for (int i = 0; i < 300; ++i)
+      EXPECT_EQ(fus.contains(i), i % 3 == 0);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatUSetTest, Emplace)
 {
   {
@@ -790,6 +1067,123 @@ TEST(FlatUSetTest, EraseIf)
   EXPECT_EQ(DbgClass::count, 0);
 }
 
+TEST(FlatUSetTest, NodeHandle)
+{
+  {
+    flat_uset<DbgClass> fus;
+    for (int i = 1; i <= 100; ++i)
+      fus.insert(i);
+    
+    auto node = fus.extract(101); // missing
+    EXPECT_TRUE(node.empty());
+    EXPECT_EQ(fus.size(), 100u);
+    
+    node = fus.extract(50);
+    ASSERT_TRUE(node);
+    EXPECT_EQ(node.value().id, 50);
+    EXPECT_EQ(fus.size(), 99u);
+    EXPECT_FALSE(fus.contains(50));
+    
+    node.value().id = 500; // non-const on extracted value
+    auto res = fus.insert(std::move(node));
+    EXPECT_TRUE(res.inserted);
+    EXPECT_TRUE(res.node.empty());
+    EXPECT_EQ(res.position->id, 500);
+    EXPECT_TRUE(fus.contains(500));
+    EXPECT_EQ(fus.size(), 100u);
+    
+    node = fus.extract(fus.find(1));
+    ASSERT_TRUE(node);
+    fus.insert(1);
+    res = fus.insert(std::move(node)); // already exist
+    EXPECT_FALSE(res.inserted);
+    ASSERT_FALSE(res.node.empty());
+    EXPECT_EQ(res.node.value().id, 1);
+    EXPECT_EQ(res.position->id, 1);
+    EXPECT_EQ(fus.size(), 100u);
+    
+    res = fus.insert(decltype(fus)::node_type()); // empty
+    EXPECT_FALSE(res.inserted);
+    EXPECT_TRUE(res.position == fus.end());
+    
+    flat_uset<DbgClass> fus2;
+    while (!fus.empty())
+      fus2.insert(fus.extract(fus.begin()));
+    EXPECT_EQ(fus2.size(), 100u);
+    EXPECT_TRUE(fus2.contains(500));
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUSetTest, Merge)
+{
+  {
+    flat_uset<DbgClass> fus1;
+    flat_uset<DbgClass> fus2;
+    for (int i = 1; i <= 100; ++i)
+      fus1.insert(i);
+    for (int i = 51; i <= 200; ++i)
+      fus2.insert(i);
+    
+    fus1.merge(fus2);
+    EXPECT_EQ(fus1.size(), 200u);
+    EXPECT_EQ(fus2.size(), 50u); // duplicates left in source
+    for (int i = 1; i <= 200; ++i)
+      EXPECT_TRUE(fus1.contains(i));
+    for (int i = 51; i <= 100; ++i)
+      EXPECT_TRUE(fus2.contains(i));
+    
+    fus1.merge(fus1); // self
+    EXPECT_EQ(fus1.size(), 200u);
+    
+    fus2.clear();
+    fus2.merge(std::move(fus1)); // into empty
+    EXPECT_EQ(fus2.size(), 200u);
+    EXPECT_TRUE(fus1.empty());
+  }
+  {
+    int calls = 0;
+    flat_uset<DbgClass, stored_hash<CountedHash>> fus1(0, stored_hash<CountedHash>(CountedHash(&calls)));
+    flat_uset<DbgClass, stored_hash<CountedHash>> fus2(0, stored_hash<CountedHash>(CountedHash(&calls)));
+    for (int i = 1; i <= 300; ++i)
+      (i <= 100 ? fus1 : fus2).insert(i);
+    
+    calls = 0;
+    fus1.merge(fus2);
+    EXPECT_EQ(calls, 200); // stateful hasher, each element hashed once
+    EXPECT_EQ(fus1.size(), 300u);
+    EXPECT_TRUE(fus2.empty());
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatUSetTest, Snapshot)
+{
+  const std::string path = testing::TempDir() + "indivi_flat_uset_snapshot.bin";
+  {
+    flat_uset<uint64_t> fus;
+    fus.save(path);
+    EXPECT_TRUE(flat_mapped<flat_uset<uint64_t>>(path).empty());
+
+    for (uint64_t i = 0; i < 5000; ++i)
+      fus.insert(i * 3);
+    fus.save(path);
+    flat_mapped<flat_uset<uint64_t>> mapped(path);
+    EXPECT_EQ(mapped.size(), 5000u);
+    EXPECT_TRUE(mapped.map() == fus);
+    for (uint64_t i = 0; i < 15000; ++i)
+      EXPECT_EQ(mapped.contains(i), i % 3 == 0);
+
+    using Mapped = flat_mapped<flat_uset<uint32_t>>;
+    EXPECT_THROW(Mapped m(path), std::runtime_error);
+    std::remove(path.c_str());
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatUSetTest, Swap)
 {
   {
@@ -943,6 +1337,44 @@ TEST(FlatUSetTest, BadHash)
   }
 }
 
+TEST(FlatUSetTest, InlineStorage)
+{
+  using flat_uset_inl = flat_uset<std::string, indivi::hash<std::string>, std::equal_to<std::string>, std::allocator<std::string>, 4>;
+  auto is_inline = [](const flat_uset_inl& fus) {
+    const char* first = reinterpret_cast<const char*>(&*fus.begin());
+    const char* object = reinterpret_cast<const char*>(&fus);
+    return first >= object && first < object + sizeof(fus);
+  };
+  {
+    flat_uset_inl fus{"a", "b", "c", "d"};
+    EXPECT_EQ(fus.bucket_count(), 4u);
+    EXPECT_TRUE(is_inline(fus));
+    
+    fus.insert("e");
+    EXPECT_EQ(fus.bucket_count(), 8u);
+    EXPECT_FALSE(is_inline(fus));
+    
+    fus.erase("e");
+    fus.shrink_to_fit();
+    EXPECT_TRUE(is_inline(fus));
+    EXPECT_EQ(fus.size(), 4u);
+    
+    flat_uset_inl fus2(std::move(fus));
+    EXPECT_TRUE(is_inline(fus2));
+    EXPECT_TRUE(fus.empty());
+    EXPECT_EQ(fus2, (flat_uset_inl{"a", "b", "c", "d"}));
+    
+    flat_uset_inl fus3{"x", "y"};
+    fus3.swap(fus2);
+    EXPECT_EQ(fus2, (flat_uset_inl{"x", "y"}));
+    EXPECT_EQ(fus3, (flat_uset_inl{"a", "b", "c", "d"}));
+    
+    fus3.clear();
+    fus3.rehash(0);
+    EXPECT_EQ(fus3.bucket_count(), 0u);
+  }
+}
+
 TEST(FlatUSetTest, Stress)
 {
   {
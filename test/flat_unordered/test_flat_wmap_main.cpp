@@ -7,19 +7,31 @@
 
 #define INDIVI_FLAT_W_DEBUG
 #define INDIVI_FLAT_W_STATS
+#define INDIVI_FLAT_W_TELEMETRY
+#include "indivi/flat_mapped.h"
 #include "indivi/flat_wmap.h"
+#include "utils/bump_allocator.h"
 #include "utils/debug_utils.h"
 
+#ifdef INDIVI_FLAT_W_EXPECTED_WIDTH // see wide SIMD test targets
+static_assert(indivi::detail::MetaWGroup::WIDTH == INDIVI_FLAT_W_EXPECTED_WIDTH, "flat_wmap tests: unexpected probing window width");
+#endif
+
+#include <algorithm>
+#include <array>
+#include <fstream>
 #include <initializer_list>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include <cassert>
+#include <cstdio>
 #include <cstdlib>
 
 using namespace indivi;
@@ -230,6 +242,61 @@ TEST(FlatWMapTest, Assignment2)
   EXPECT_EQ(DbgClass::count, 0);
 }
 
+TEST(FlatWMapTest, Allocator)
+{
+  using alloc_type = bump_allocator<std::pair<const DbgClass, DbgClass>>;
+  using flat_wmap_alc = flat_wmap<DbgClass, DbgClass, indivi::hash<DbgClass>, std::equal_to<DbgClass>, alloc_type>;
+  {
+    alloc_type alc;
+    flat_wmap_alc fwm0(alc);
+    EXPECT_TRUE(fwm0.empty());
+    
+    flat_wmap_alc fwm1(10, alc);
+    EXPECT_GE(fwm1.bucket_count(), 10u);
+    EXPECT_FALSE(fwm1.contains(1));
+  }
+  {
+    flat_wmap_alc fwm;
+    for (int i = 1; i <= 40; ++i)
+      fwm.emplace(i, i + 1);
+    ASSERT_EQ(fwm.size(), 40u);
+    
+    alloc_type alc;
+    flat_wmap_alc fwm1(fwm, alc);
+    EXPECT_EQ(fwm1, fwm);
+    
+    // unequal allocators: move element-wise
+    flat_wmap_alc fwm2(std::move(fwm), alc);
+    EXPECT_TRUE(fwm.empty());
+    EXPECT_EQ(fwm2, fwm1);
+    
+    flat_wmap_alc fwm3;
+    fwm3 = fwm1;
+    EXPECT_EQ(fwm3, fwm1);
+    
+    fwm3 = std::move(fwm2);
+    EXPECT_TRUE(fwm2.empty());
+    EXPECT_EQ(fwm3, fwm1);
+    
+    // propagate on swap
+    fwm2.swap(fwm3);
+    EXPECT_TRUE(fwm3.empty());
+    EXPECT_EQ(fwm2, fwm1);
+    
+    fwm2.clear();
+    fwm2.rehash(0);
+    EXPECT_EQ(fwm2.bucket_count(), 0u);
+  }
+  {
+    flat_wmap<int, int> fwm{};
+    std::allocator<std::pair<const int, int>> alc = fwm.get_allocator();
+    flat_wmap<int, int> fwm1(std::move(fwm), alc);
+    EXPECT_TRUE(fwm1.empty());
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatWMapTest, Capacity)
 {
   {
@@ -243,7 +310,8 @@ TEST(FlatWMapTest, Capacity)
     EXPECT_EQ(fwm.max_load_factor(), 0.8f);
     EXPECT_EQ(fwm.max_size(), max_size);
     EXPECT_GT(fwm.max_bucket_count(), 0u);
-    fwm.max_load_factor(0.f); // no-op
+    fwm.max_load_factor(0.f); // clamped
+    EXPECT_EQ(fwm.max_load_factor(), 0.25f);
     EXPECT_GT(fwm.max_bucket_count(), 0u);
     
     fwm = {{1, 2}, {3, 4}};
@@ -397,6 +465,200 @@ TEST(FlatWMapTest, Capacity3)
   EXPECT_EQ(DbgClass::count, 0);
 }
 
+TEST(FlatWMapTest, LoadFactor)
+{
+  {
+    flat_wmap<int, int> fwm;
+    EXPECT_EQ(fwm.max_load_factor(), 0.8f);
+    EXPECT_EQ(fwm.growth_factor(), 2u);
+    fwm.max_load_factor(2.f); // clamped
+    EXPECT_EQ(fwm.max_load_factor(), 0.95f);
+
+    // Low load factor
+    fwm.max_load_factor(0.5f);
+    fwm.reserve(1000);
+    EXPECT_GE(fwm.bucket_count(), 2000u);
+    std::size_t bucketCount = fwm.bucket_count();
+    for (int i = 0; i < 1000; ++i)
+      fwm.emplace(i, i);
+    EXPECT_EQ(fwm.bucket_count(), bucketCount);
+    EXPECT_LE(fwm.load_factor(), 0.5f);
+
+    // Lowered below current load
+    fwm.max_load_factor(0.25f);
+    EXPECT_LE(fwm.load_factor(), 0.25f);
+    EXPECT_GT(fwm.bucket_count(), bucketCount);
+    for (int i = 0; i < 1000; ++i)
+      EXPECT_EQ(fwm.at(i), i);
+
+    // High load factor: grow when 95% full
+    fwm.max_load_factor(0.95f);
+    fwm.rehash(0);
+    bucketCount = fwm.bucket_count();
+    EXPECT_EQ(bucketCount, 2048u);
+    int i = 1000;
+    for (; fwm.bucket_count() == bucketCount; ++i)
+      fwm.emplace(i, i);
+    EXPECT_EQ(fwm.size(), (std::size_t)(bucketCount * 0.95f) + 1u);
+    EXPECT_EQ(fwm.bucket_count(), bucketCount * 2);
+    for (int j = 0; j < i; ++j)
+      EXPECT_EQ(fwm.at(j), j);
+
+    // Policy is copied, moved and swapped
+    flat_wmap<int, int> fwm2(fwm);
+    EXPECT_EQ(fwm2.max_load_factor(), 0.95f);
+    flat_wmap<int, int> fwm3(std::move(fwm2));
+    EXPECT_EQ(fwm3.max_load_factor(), 0.95f);
+    flat_wmap<int, int> fwm4;
+    fwm4 = fwm3;
+    EXPECT_EQ(fwm4.max_load_factor(), 0.95f);
+    EXPECT_TRUE(fwm4 == fwm);
+    flat_wmap<int, int> fwm5;
+    fwm4.swap(fwm5);
+    EXPECT_EQ(fwm5.max_load_factor(), 0.95f);
+    EXPECT_EQ(fwm4.max_load_factor(), 0.8f);
+  }
+  {
+    // Growth factor
+    flat_wmap<int, int> fwm;
+    fwm.growth_factor(3);
+    EXPECT_EQ(fwm.growth_factor(), 4u);
+    fwm.growth_factor(100000);
+    EXPECT_EQ(fwm.growth_factor(), 256u);
+    fwm.growth_factor(0);
+    EXPECT_EQ(fwm.growth_factor(), 2u);
+
+    fwm.growth_factor(4);
+    std::size_t bucketCount = 0u;
+    for (int i = 0; i < 100000; ++i)
+    {
+      fwm.emplace(i, i);
+      if (fwm.bucket_count() != bucketCount)
+      {
+        if (bucketCount >= 64u)
+        {
+          EXPECT_EQ(fwm.bucket_count(), bucketCount * 4);
+        }
+        bucketCount = fwm.bucket_count();
+      }
+    }
+    for (int i = 0; i < 100000; ++i)
+      EXPECT_EQ(fwm.at(i), i);
+  }
+  {
+    // Tiny tables (single group) then low load factor
+    flat_wmap<DbgClass, DbgClass> fwm;
+    fwm.max_load_factor(0.25f);
+    for (int i = 1; i <= 200; ++i)
+    {
+      fwm.try_emplace(i, i);
+      EXPECT_LE(fwm.size(), fwm.bucket_count());
+      if (fwm.bucket_count() > 16u)
+      {
+        EXPECT_LE(fwm.load_factor(), 0.25f);
+      }
+    }
+    for (int i = 1; i <= 200; i += 2)
+      EXPECT_EQ(fwm.erase(i), 1u);
+    fwm.max_load_factor(0.9f);
+    for (int i = 1; i <= 400; i += 2)
+      fwm.try_emplace(i, i);
+    EXPECT_EQ(fwm.size(), 300u);
+    for (int i = 1; i <= 400; ++i)
+      EXPECT_EQ(fwm.contains(i), i <= 200 || i % 2 == 1);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatWMapTest, Shrink)
+{
+  {
+    flat_wmap<int, int> fwm;
+    fwm.shrink_to_fit();
+    EXPECT_EQ(fwm.bucket_count(), 0u);
+
+    // Explicit shrink after mass erase
+    for (int i = 0; i < 10000; ++i)
+      fwm.emplace(i, i);
+    std::size_t bucketCount = fwm.bucket_count();
+    for (int i = 1000; i < 10000; ++i)
+      EXPECT_EQ(fwm.erase(i), 1u);
+    EXPECT_EQ(fwm.bucket_count(), bucketCount); // disabled by default
+    fwm.shrink_to_fit();
+    EXPECT_EQ(fwm.bucket_count(), 2048u);
+    for (int i = 0; i < 10000; ++i)
+      EXPECT_EQ(fwm.contains(i), i < 1000);
+
+    fwm.clear();
+    fwm.shrink_to_fit();
+    EXPECT_EQ(fwm.bucket_count(), 0u);
+    EXPECT_TRUE(fwm.empty());
+  }
+  {
+    // Auto downsizing
+    flat_wmap<int, int> fwm;
+    EXPECT_EQ(fwm.min_load_factor(), 0.f);
+    fwm.min_load_factor(1.f); // clamped
+    EXPECT_EQ(fwm.min_load_factor(), 0.25f);
+    fwm.min_load_factor(-1.f);
+    EXPECT_EQ(fwm.min_load_factor(), 0.f);
+    fwm.min_load_factor(0.1f);
+    EXPECT_NEAR(fwm.min_load_factor(), 0.1f, 0.0001f);
+
+    for (int i = 0; i < 10000; ++i)
+      fwm.emplace(i, i);
+    std::size_t bucketCount = fwm.bucket_count();
+
+    // never on iterator erase
+    auto it = fwm.begin();
+    while (fwm.size() > 500u)
+      fwm.erase(it++);
+    EXPECT_EQ(fwm.bucket_count(), bucketCount);
+
+    // on erase by key
+    for (int i = 0; i < 10000; ++i)
+    {
+      if (fwm.erase(i) && fwm.bucket_count() > 16u)
+      {
+        EXPECT_GE((float)fwm.size(), fwm.bucket_count() * fwm.min_load_factor());
+      }
+      EXPECT_LE(fwm.bucket_count(), bucketCount);
+    }
+    EXPECT_TRUE(fwm.empty());
+    EXPECT_LE(fwm.bucket_count(), 16u);
+
+    // and after erase_if
+    for (int i = 0; i < 10000; ++i)
+      fwm.emplace(i, i);
+    bucketCount = fwm.bucket_count();
+    EXPECT_EQ(erase_if(fwm, [](const std::pair<const int, int>& p) { return p.first % 100 != 0; }), 9900u);
+    EXPECT_LT(fwm.bucket_count(), bucketCount);
+    for (int i = 0; i < 10000; ++i)
+      EXPECT_EQ(fwm.contains(i), i % 100 == 0);
+
+    // Policy is copied
+    flat_wmap<int, int> fwm2(fwm);
+    EXPECT_EQ(fwm2.min_load_factor(), fwm.min_load_factor());
+  }
+  {
+    // No rehash ping-pong with high growth factor
+    flat_wmap<DbgClass, DbgClass> fwm;
+    fwm.min_load_factor(0.25f);
+    fwm.growth_factor(256);
+    int i = 1;
+    for (; fwm.bucket_count() < 1024u; ++i)
+      fwm.try_emplace(i, i);
+    std::size_t bucketCount = fwm.bucket_count();
+    EXPECT_EQ(fwm.erase(1), 1u);
+    EXPECT_EQ(fwm.bucket_count(), bucketCount);
+    for (int j = 2; j < i; ++j)
+      EXPECT_EQ(fwm.at(j).id, j);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatWMapTest, Observers)
 {
   {
@@ -638,6 +900,315 @@ TEST(FlatWMapTest, ElementAccess2)
   EXPECT_EQ(DbgClass::count, 0);
 }
 
+struct BatchHash
+{
+  int* batchs;
+  std::size_t operator()(int key) const { return (std::size_t)key * 31u; }
+  void hash_batch(const int* keys, std::size_t count, std::size_t* out) const
+  {
+    ++*batchs;
+    for (std::size_t i = 0u; i < count; ++i)
+      out[i] = (*this)(keys[i]);
+  }
+};
+
+TEST(FlatWMapTest, FindBatch)
+{
+  {
+    flat_wmap<DbgClass, DbgClass> fum;
+    std::vector<DbgClass> keys{1, 2, 3};
+    std::unique_ptr<bool[]> found(new bool[keys.size()]);
+    fum.contains_batch(keys.data(), keys.size(), found.get());
+    for (size_t i = 0; i < keys.size(); ++i)
+      EXPECT_FALSE(found[i]);
+  }
+  {
+    flat_wmap<DbgClass, DbgClass> fum;
+    for (int i = 1; i < 1000; i += 2)
+      fum.emplace(i, i + 1);
+    
+    std::vector<DbgClass> keys;
+    for (int i = 0; i < 1000; ++i)
+      keys.emplace_back((i * 7) % 1000 + 1);
+    
+    std::unique_ptr<bool[]> found(new bool[keys.size()]);
+    fum.contains_batch(keys.data(), keys.size(), found.get());
+    
+    std::vector<flat_wmap<DbgClass, DbgClass>::iterator> its(keys.size());
+    fum.find_batch(keys.data(), keys.size(), its.data());
+    
+    const auto& cfum = fum;
+    std::vector<flat_wmap<DbgClass, DbgClass>::const_iterator> cits(keys.size());
+    cfum.find_batch(keys.data(), keys.size(), cits.data());
+    
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+      bool exist = keys[i].id % 2 == 1;
+      EXPECT_EQ(found[i], exist);
+      EXPECT_EQ(its[i], fum.find(keys[i]));
+      EXPECT_EQ(cits[i], cfum.find(keys[i]));
+      if (exist)
+      {
+        ASSERT_NE(its[i], fum.end());
+        EXPECT_EQ(its[i]->second, keys[i].id + 1);
+      }
+    }
+  }
+  {
+    // user batched hashing
+    static_assert(detail::hash_has_batch<BatchHash, int>::value, "BatchHash: hash_batch not detected");
+    int batchs = 0;
+    flat_wmap<int, int, BatchHash> fwm(0u, BatchHash{ &batchs });
+    for (int i = 0; i < 1000; i += 2)
+      fwm.emplace(i, i + 1);
+    
+    std::vector<int> keys;
+    for (int i = 0; i < 100; ++i)
+      keys.push_back(i * 3);
+    std::unique_ptr<bool[]> found(new bool[keys.size()]);
+    fwm.contains_batch(keys.data(), keys.size(), found.get());
+    EXPECT_EQ(batchs, 7); // by 16
+    for (size_t i = 0; i < keys.size(); ++i)
+      EXPECT_EQ(found[i], keys[i] % 2 == 0);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+struct TransparentEqual
+{
+  using is_transparent = void;
+  template< class U, class V >
+  bool operator()(const U& lhs, const V& rhs) const { return lhs == rhs; }
+};
+
+TEST(FlatWMapTest, TransparentLookup)
+{
+  {
+    flat_wmap<std::string, DbgClass, indivi::hash<std::string>, TransparentEqual> fwm;
+    for (int i = 1; i <= 100; ++i)
+      fwm.try_emplace(std::to_string(i), i);
+    ASSERT_EQ(fwm.size(), 100u);
+    
+    EXPECT_TRUE(fwm.contains("42"));
+    EXPECT_FALSE(fwm.contains("0"));
+    EXPECT_EQ(fwm.count("7"), 1u);
+    EXPECT_EQ(fwm.find("13")->second.id, 13);
+    EXPECT_TRUE(fwm.find("101") == fwm.end());
+    EXPECT_EQ(fwm.at("99").id, 99);
+    EXPECT_THROW(fwm.at("x"), std::out_of_range);
+    
+    const auto& cfwm = fwm;
+    EXPECT_EQ(cfwm.find("13")->second.id, 13);
+    EXPECT_EQ(cfwm.at("14").id, 14);
+    
+    auto res = fwm.try_emplace("42", 0);
+    EXPECT_FALSE(res.second);
+    EXPECT_EQ(res.first->second.id, 42);
+    res = fwm.try_emplace("101", 101);
+    EXPECT_TRUE(res.second);
+    EXPECT_EQ(res.first->first, "101");
+    
+    EXPECT_EQ(fwm.erase("101"), 1u);
+    EXPECT_EQ(fwm.erase("101"), 0u);
+    EXPECT_EQ(fwm.size(), 100u);
+  #ifdef INDIVI_CPP17
+    std::string_view sv("57");
+    EXPECT_TRUE(fwm.contains(sv));
+    EXPECT_EQ(fwm.find(sv)->second.id, 57);
+  #endif
+  }
+  {
+    indivi::hash<std::string> hash;
+    EXPECT_EQ(hash("abc"), hash(std::string("abc")));
+    EXPECT_EQ(hash(""), hash(std::string()));
+  #ifdef INDIVI_CPP17
+    EXPECT_EQ(indivi::hash<std::string_view>{}("abc"), hash(std::string("abc")));
+  #endif
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+struct CountedHash
+{
+  int* calls;
+  explicit CountedHash(int* calls_ = nullptr) : calls(calls_) {}
+  std::size_t operator()(const DbgClass& key) const
+  {
+    ++(*calls);
+    return std::hash<DbgClass>{}(key);
+  }
+};
+
+TEST(FlatWMapTest, StoredHash)
+{
+  {
+    int calls = 0;
+    flat_wmap<DbgClass, DbgClass, stored_hash<CountedHash>> fwm(0, stored_hash<CountedHash>(CountedHash(&calls)));
+    for (int i = 1; i <= 1000; ++i)
+      fwm.try_emplace(i, i + 1);
+    ASSERT_EQ(fwm.size(), 1000u);
+    EXPECT_EQ(calls, 1000); // never re-hashed on growth
+    
+    for (int i = 1; i <= 1000; ++i)
+      EXPECT_EQ(fwm.find(i)->second.id, i + 1);
+    EXPECT_FALSE(fwm.contains(1001));
+    
+    calls = 0;
+    flat_wmap<DbgClass, DbgClass, stored_hash<CountedHash>> fwm2(fwm);
+    EXPECT_EQ(calls, 0);
+    EXPECT_TRUE(fwm2 == fwm);
+    
+    for (int i = 1; i <= 1000; i += 2)
+      EXPECT_EQ(fwm.erase(i), 1u);
+    ASSERT_EQ(fwm.size(), 500u);
+    
+    calls = 0;
+    fwm.rehash(0); // shrink
+    EXPECT_EQ(calls, 0);
+    for (int i = 1; i <= 1000; ++i)
+      EXPECT_EQ(fwm.contains(i), i % 2 == 0);
+  }
+  {
+    int calls = 0;
+    flat_wmap<DbgClass, DbgClass, CountedHash> fwm(0, CountedHash(&calls));
+    for (int i = 1; i <= 1000; ++i)
+      fwm.try_emplace(i, i + 1);
+    ASSERT_EQ(fwm.size(), 1000u);
+    EXPECT_GT(calls, 1000); // re-hashed on growth
+  }
+  {
+    flat_wmap<std::string, int, stored_hash<indivi::hash<std::string>>> fwm;
+    for (int i = 0; i < 500; ++i)
+      fwm.emplace(std::to_string(i), i);
+    ASSERT_EQ(fwm.size(), 500u);
+    for (int i = 0; i < 500; ++i)
+      EXPECT_EQ(fwm.at(std::to_string(i)), i);
+    EXPECT_FALSE(fwm.contains("500"));
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatWMapTest, Hash32Bits)
+{
+  {
+    flat_wmap<uint64_t, int, hash_32bits<indivi::hash<uint64_t>>> fwm;
+    for (int i = 0; i < 10000; ++i)
+    {
+      fwm.emplace((uint64_t)i, i);
+      fwm.emplace((uint64_t)i << 32, -i - 1);
+    }
+    ASSERT_EQ(fwm.size(), 19999u);
+    for (int i = 0; i < 10000; i += 2)
+      EXPECT_EQ(fwm.erase((uint64_t)i), 1u);
+    for (int i = 1; i < 10000; ++i)
+    {
+      EXPECT_EQ(fwm.count((uint64_t)i), (i % 2 == 0) ? 0u : 1u);
+      EXPECT_EQ(fwm.at((uint64_t)i << 32), -i - 1);
+    }
+  }
+  {
+    // compact stored hashes
+    using Hash = stored_hash<hash_32bits<CountedHash>>;
+    int calls = 0;
+    flat_wmap<DbgClass, DbgClass, Hash> fwm(0, Hash(hash_32bits<CountedHash>(CountedHash(&calls))));
+    for (int i = 1; i <= 1000; ++i)
+      fwm.try_emplace(i, i + 1);
+    ASSERT_EQ(fwm.size(), 1000u);
+    EXPECT_EQ(calls, 1000); // never re-hashed on growth
+    
+    calls = 0;
+    flat_wmap<DbgClass, DbgClass, Hash> fwm2(fwm);
+    for (int i = 1; i <= 1000; i += 2)
+      EXPECT_EQ(fwm.erase(i), 1u);
+    fwm.rehash(0);
+    EXPECT_EQ(calls, 500); // erase only
+    for (int i = 1; i <= 1000; ++i)
+    {
+      EXPECT_EQ(fwm.contains(i), i % 2 == 0);
+      EXPECT_EQ(fwm2.find(i)->second.id, i + 1);
+    }
+  }
+  {
+    const std::string path = testing::TempDir() + "indivi_flat_wmap_snapshot32.bin";
+    using Map = flat_wmap<uint64_t, uint32_t, stored_hash<hash_32bits<indivi::hash<uint64_t>>>>;
+    Map fwm;
+    for (uint32_t i = 0; i < 5000; ++i)
+      fwm.emplace((uint64_t)i * 0x9E3779B97F4A7C15u, i);
+    fwm.save(path);
+    flat_mapped<Map> mapped(path);
+    EXPECT_TRUE(mapped.map() == fwm);
+    // 64-bit stored hashes layout differs
+    using Mapped64 = flat_mapped<flat_wmap<uint64_t, uint32_t, stored_hash<indivi::hash<uint64_t>>>>;
+    EXPECT_THROW(Mapped64 m(path), std::runtime_error);
+    std::remove(path.c_str());
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatWMapTest, ParallelRehash)
+{
+  {
+    // large enough to be split between threads
+    flat_wmap<int, std::string> fwm;
+    for (int i = 0; i < 200000; ++i)
+      fwm.try_emplace(i, std::to_string(i));
+    std::size_t bucketCount = fwm.bucket_count();
+    
+    fwm.rehash(bucketCount * 4, 4u); // grow
+    EXPECT_EQ(fwm.bucket_count(), bucketCount * 4);
+    ASSERT_EQ(fwm.size(), 200000u);
+    for (int i = 0; i < 200000; ++i)
+      EXPECT_EQ(fwm.at(i), std::to_string(i));
+    EXPECT_FALSE(fwm.contains(200000));
+    
+    for (int i = 0; i < 200000; i += 2)
+      EXPECT_EQ(fwm.erase(i), 1u);
+    fwm.rehash(0, 4u); // shrink
+    EXPECT_LT(fwm.bucket_count(), bucketCount);
+    ASSERT_EQ(fwm.size(), 100000u);
+    std::size_t visited = 0u;
+    for (const auto& item : fwm)
+    {
+      EXPECT_EQ(item.first % 2, 1);
+      EXPECT_EQ(item.second, std::to_string(item.first));
+      ++visited;
+    }
+    EXPECT_EQ(visited, 100000u);
+    
+    fwm.reserve(400000, 4u);
+    EXPECT_GE(fwm.rehash_threshold(), 400000u);
+    for (int i = 1; i < 200000; i += 2)
+      EXPECT_EQ(fwm.find(i)->second, std::to_string(i));
+  }
+  {
+    // stored hashes and single thread fallback
+    flat_wmap<int, int, stored_hash<indivi::hash<int>>> fwm;
+    fwm.reserve(100000, 8u); // first time
+    for (int i = 0; i < 100000; ++i)
+      fwm.try_emplace(i, i + 1);
+    fwm.rehash(fwm.bucket_count() * 2, 8u);
+    fwm.rehash(fwm.bucket_count() * 2, 1u);
+    ASSERT_EQ(fwm.size(), 100000u);
+    for (int i = 0; i < 100000; ++i)
+      EXPECT_EQ(fwm.at(i), i + 1);
+  }
+  {
+    flat_wmap<DbgClass, DbgClass> fwm;
+    for (int i = 1; i <= 1000; ++i)
+      fwm.try_emplace(i, i);
+    fwm.rehash(4096, 4u); // too small for threads
+    ASSERT_EQ(fwm.size(), 1000u);
+    for (int i = 1; i <= 1000; ++i)
+      EXPECT_EQ(fwm.at(i).id, i);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatWMapTest, Clear)
 {
   {
@@ -822,6 +1393,94 @@ TEST(FlatWMapTest, Insert2)
   EXPECT_EQ(DbgClass::count, 0);
 }
 
+TEST(FlatWMapTest, InsertUniqueRange)
+{
+  {
+    std::vector<std::pair<DbgClass, DbgClass>> vec;
+    for (int i = 1; i <= 100000; ++i)
+      vec.emplace_back(i, i + 1);
+    flat_wmap<DbgClass, DbgClass> fwm;
+    fwm.insert_unique_range(vec.begin(), vec.end());
+    ASSERT_EQ(fwm.size(), 100000u);
+    EXPECT_EQ(vec[0].first, 1);
+    for (int i = 1; i <= 100000; ++i)
+      EXPECT_EQ(fwm.at(i).id, i + 1);
+    EXPECT_FALSE(fwm.contains(100001));
+    
+    // moved, into non-empty table
+    std::vector<std::pair<DbgClass, DbgClass>> vec2;
+    for (int i = 100001; i <= 100100; ++i)
+      vec2.emplace_back(i, i + 1);
+    fwm.insert_unique_range(std::make_move_iterator(vec2.begin()), std::make_move_iterator(vec2.end()));
+    EXPECT_EQ(fwm.size(), 100100u);
+    EXPECT_NE(vec2[0].first, 100001);
+    for (int i = 100001; i <= 100100; ++i)
+      EXPECT_EQ(fwm.at(i).id, i + 1);
+  }
+  {
+    std::vector<std::pair<const DbgClass, DbgClass>> vec{{1, 2}, {3, 4}, {5, 6}};
+    flat_wmap<DbgClass, DbgClass> fwm;
+    fwm.insert_unique_range(vec.begin(), vec.begin());
+    EXPECT_TRUE(fwm.empty());
+    fwm.insert_unique_range(vec.begin(), vec.end());
+    EXPECT_EQ(fwm.size(), 3u);
+    EXPECT_EQ(fwm.at(3).id, 4);
+    
+    // with tombstones
+    for (int i = 6; i <= 12; ++i)
+      fwm.try_emplace(i, i + 1);
+    for (int i = 1; i <= 12; i += 2)
+      fwm.erase(i);
+    std::vector<std::pair<DbgClass, DbgClass>> vec2;
+    for (int i = 13; i <= 20; ++i)
+      vec2.emplace_back(i, i + 1);
+    fwm.insert_unique_range(vec2.begin(), vec2.end());
+    EXPECT_EQ(fwm.size(), 12u);
+    for (int i = 1; i <= 20; ++i)
+      EXPECT_EQ(fwm.contains(i), i > 12 || (i >= 6 && i % 2 == 0));
+  }
+  {
+    // reserved capacity is kept
+    flat_wmap<int, int> fwm;
+    fwm.reserve(100000);
+    size_t bucketCount = fwm.bucket_count();
+    std::vector<std::pair<int, int>> vec{{1, 2}, {3, 4}};
+    fwm.insert_unique_range(vec.begin(), vec.end());
+    EXPECT_EQ(fwm.size(), 2u);
+    EXPECT_EQ(fwm.bucket_count(), bucketCount);
+  }
+  {
+    // reused tombstones are accounted as with single insertions
+    flat_wmap<int, int> fwm1;
+    flat_wmap<int, int> fwm2;
+    for (int i = 0; i < 13000; ++i)
+    {
+      fwm1.emplace((i * 40503) ^ (i << 7), i);
+      fwm2.emplace((i * 40503) ^ (i << 7), i);
+    }
+    ASSERT_EQ(fwm1.size(), 13000u);
+    for (int i = 0; i < 13000; i += 2)
+    {
+      fwm1.erase((i * 40503) ^ (i << 7));
+      fwm2.erase((i * 40503) ^ (i << 7));
+    }
+    ASSERT_LT(fwm1.rehash_threshold(), fwm1.max_load_factor() * fwm1.bucket_count()); // with tombstones
+    ASSERT_EQ(fwm2.rehash_threshold(), fwm1.rehash_threshold());
+    
+    std::vector<std::pair<int, int>> vec;
+    for (int i = 0; i < 13000; i += 8) // no purge
+      vec.emplace_back((i * 40503) ^ (i << 7), i);
+    for (const auto& item : vec)
+      fwm1.emplace(item.first, item.second);
+    fwm2.insert_unique_range(vec.begin(), vec.end());
+    EXPECT_EQ(fwm2.size(), fwm1.size());
+    EXPECT_EQ(fwm2.bucket_count(), fwm1.bucket_count());
+    EXPECT_EQ(fwm2.rehash_threshold(), fwm1.rehash_threshold());
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatWMapTest, InsertOrAssign)
 {
   {
@@ -1292,6 +1951,340 @@ TEST(FlatWMapTest, EraseIf)
   EXPECT_EQ(DbgClass::count, 0);
 }
 
+namespace
+{
+// Insert/erase at steady size, checked against 'std::unordered_map' (tombstones purged in place, no growth)
+template< class Map, class MakeKey >
+void purge_churn(MakeKey makeKey)
+{
+  using Key = typename Map::key_type;
+  Map fwm;
+  std::unordered_map<Key, int> ref;
+  std::vector<Key> keys;
+  fwm.reserve(2800);
+  std::size_t bucketCount = fwm.bucket_count();
+  std::srand(7);
+  while (fwm.size() < 2800u)
+  {
+    Key key = makeKey(std::rand());
+    if (fwm.try_emplace(key, (int)keys.size()).second)
+    {
+      ref.emplace(key, (int)keys.size());
+      keys.push_back(key);
+    }
+  }
+
+  float maxTombstones = 0.f;
+  for (int i = 0; i < 100000; ++i)
+  {
+    std::size_t pos = (std::size_t)std::rand() % keys.size();
+    EXPECT_EQ(fwm.erase(keys[pos]), 1u);
+    ref.erase(keys[pos]);
+    Key key = makeKey(std::rand());
+    while (ref.count(key))
+      key = makeKey(std::rand());
+    EXPECT_TRUE(fwm.try_emplace(key, i).second);
+    ref.emplace(key, i);
+    keys[pos] = key;
+    if (i % 1000 == 0)
+      maxTombstones = std::max(maxTombstones, fwm.get_group_stats().tombstone_avg);
+  }
+  EXPECT_EQ(fwm.bucket_count(), bucketCount); // purged instead of growing
+  EXPECT_GT(maxTombstones, 0.f);
+  ASSERT_EQ(fwm.size(), ref.size());
+  for (const auto& kv : ref)
+    EXPECT_EQ(fwm.at(kv.first), kv.second);
+
+  fwm.purge_tombstones();
+  EXPECT_EQ(fwm.get_group_stats().tombstone_avg, 0.f);
+  EXPECT_EQ(fwm.bucket_count(), bucketCount);
+  for (const auto& kv : ref)
+    EXPECT_EQ(fwm.at(kv.first), kv.second);
+  for (const auto& kv : fwm)
+    EXPECT_EQ(ref.at(kv.first), kv.second);
+}
+}
+
+TEST(FlatWMapTest, PurgeTombstones)
+{
+  {
+    flat_wmap<DbgClass, DbgClass> fwm;
+    fwm.purge_tombstones(); // no-op
+    EXPECT_EQ(fwm.bucket_count(), 0u);
+
+    for (int i = 1; i <= 3000; ++i)
+      fwm.try_emplace(i, i);
+    std::size_t bucketCount = fwm.bucket_count();
+    for (int i = 1; i <= 3000; i += 2)
+      EXPECT_EQ(fwm.erase(i), 1u);
+    fwm.purge_tombstones(); // reallocating (hasher may throw)
+    EXPECT_EQ(fwm.get_group_stats().tombstone_avg, 0.f);
+    EXPECT_EQ(fwm.bucket_count(), bucketCount);
+    EXPECT_EQ(fwm.size(), 1500u);
+    for (int i = 1; i <= 3000; ++i)
+      EXPECT_EQ(fwm.contains(i), i % 2 == 0);
+  }
+  purge_churn<flat_wmap<int, int>>([](int r) { return r; });
+  purge_churn<flat_wmap<int, int, stored_hash<indivi::hash<int>>>>([](int r) { return r; });
+  purge_churn<flat_wmap<std::string, int>>([](int r) { return std::to_string(r) + "_long_enough_to_allocate"; });
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatWMapTest, NodeHandle)
+{
+  {
+    flat_wmap<DbgClass, DbgClass> fwm;
+    for (int i = 1; i <= 100; ++i)
+      fwm.try_emplace(i, i + 1);
+    
+    auto node = fwm.extract(101); // missing
+    EXPECT_TRUE(node.empty());
+    EXPECT_FALSE(node);
+    EXPECT_EQ(fwm.size(), 100u);
+    
+    node = fwm.extract(50);
+    ASSERT_FALSE(node.empty());
+    EXPECT_EQ(node.key().id, 50);
+    EXPECT_EQ(node.mapped().id, 51);
+    EXPECT_EQ(fwm.size(), 99u);
+    EXPECT_FALSE(fwm.contains(50));
+    
+    node.mapped().id = 500;
+    auto res = fwm.insert(std::move(node));
+    EXPECT_TRUE(res.inserted);
+    EXPECT_TRUE(res.node.empty());
+    EXPECT_EQ(res.position->first.id, 50);
+    EXPECT_EQ(res.position->second.id, 500);
+    EXPECT_EQ(fwm.size(), 100u);
+    
+    node = fwm.extract(fwm.find(1));
+    ASSERT_TRUE(node);
+    EXPECT_EQ(node.key().id, 1);
+    EXPECT_EQ(fwm.size(), 99u);
+    
+    fwm.try_emplace(1, 10);
+    res = fwm.insert(std::move(node)); // already exist
+    EXPECT_FALSE(res.inserted);
+    ASSERT_FALSE(res.node.empty());
+    EXPECT_EQ(res.node.mapped().id, 2);
+    EXPECT_EQ(res.position->second.id, 10);
+    EXPECT_EQ(fwm.size(), 100u);
+    
+    res = fwm.insert(decltype(fwm)::node_type()); // empty
+    EXPECT_FALSE(res.inserted);
+    EXPECT_TRUE(res.position == fwm.end());
+    EXPECT_EQ(fwm.size(), 100u);
+    
+    // Move between maps
+    flat_wmap<DbgClass, DbgClass> fwm2;
+    while (!fwm.empty())
+      fwm2.insert(fwm.extract(fwm.begin()));
+    EXPECT_EQ(fwm2.size(), 100u);
+    EXPECT_EQ(fwm2.at(1).id, 10);
+    EXPECT_EQ(fwm2.at(50).id, 500);
+  }
+  {
+    int calls = 0;
+    flat_wmap<DbgClass, DbgClass, stored_hash<CountedHash>> fwm(0, stored_hash<CountedHash>(CountedHash(&calls)));
+    for (int i = 1; i <= 100; ++i)
+      fwm.try_emplace(i, i);
+    
+    calls = 0;
+    auto node = fwm.extract(fwm.find(7));
+    auto res = fwm.insert(std::move(node));
+    EXPECT_TRUE(res.inserted);
+    EXPECT_EQ(calls, 2); // find and stateful hasher re-hashing on insert
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatWMapTest, Merge)
+{
+  {
+    flat_wmap<DbgClass, DbgClass> fwm1;
+    flat_wmap<DbgClass, DbgClass> fwm2;
+    for (int i = 1; i <= 100; ++i)
+      fwm1.try_emplace(i, i);
+    for (int i = 51; i <= 200; ++i)
+      fwm2.try_emplace(i, i + 1000);
+    
+    fwm1.merge(fwm2);
+    EXPECT_EQ(fwm1.size(), 200u);
+    EXPECT_EQ(fwm2.size(), 50u); // duplicates left in source
+    for (int i = 1; i <= 200; ++i)
+      EXPECT_EQ(fwm1.at(i).id, i <= 100 ? i : i + 1000);
+    for (int i = 51; i <= 100; ++i)
+      EXPECT_EQ(fwm2.at(i).id, i + 1000);
+    
+    fwm1.merge(fwm1); // self
+    EXPECT_EQ(fwm1.size(), 200u);
+    
+    fwm2.clear();
+    fwm1.merge(fwm2); // empty source
+    EXPECT_EQ(fwm1.size(), 200u);
+    
+    fwm2.merge(std::move(fwm1)); // into empty
+    EXPECT_EQ(fwm2.size(), 200u);
+    EXPECT_TRUE(fwm1.empty());
+    for (int i = 1; i <= 200; ++i)
+      EXPECT_EQ(fwm2.at(i).id, i <= 100 ? i : i + 1000);
+    
+    fwm1.reserve(1000);
+    fwm1.merge(fwm2); // into empty but bigger
+    EXPECT_EQ(fwm1.size(), 200u);
+    EXPECT_TRUE(fwm2.empty());
+    EXPECT_GE(fwm1.bucket_count(), 1000u);
+  }
+  {
+    int calls = 0;
+    flat_wmap<DbgClass, DbgClass, stored_hash<CountedHash>> fwm1(0, stored_hash<CountedHash>(CountedHash(&calls)));
+    flat_wmap<DbgClass, DbgClass, stored_hash<CountedHash>> fwm2(0, stored_hash<CountedHash>(CountedHash(&calls)));
+    for (int i = 1; i <= 100; ++i)
+      fwm1.try_emplace(i, i);
+    for (int i = 101; i <= 300; ++i)
+      fwm2.try_emplace(i, i);
+    
+    calls = 0;
+    fwm1.merge(fwm2);
+    EXPECT_EQ(calls, 200); // stateful hasher, each element hashed once
+    EXPECT_EQ(fwm1.size(), 300u);
+    EXPECT_TRUE(fwm2.empty());
+    for (int i = 1; i <= 300; ++i)
+      EXPECT_EQ(fwm1.at(i).id, i);
+  }
+  {
+    flat_wmap<std::string, int> fwm1{{"a", 1}, {"b", 2}};
+    flat_wmap<std::string, int> fwm2{{"b", 3}, {"c", 4}};
+    
+    fwm1.merge(fwm2);
+    EXPECT_EQ(fwm1.size(), 3u);
+    EXPECT_EQ(fwm1.at("b"), 2);
+    EXPECT_EQ(fwm1.at("c"), 4);
+    ASSERT_EQ(fwm2.size(), 1u);
+    EXPECT_EQ(fwm2.at("b"), 3);
+  }
+  {
+    // merge into empty table: each table keeps its own policies
+    flat_wmap<int, int> fwm1;
+    fwm1.max_load_factor(0.5f);
+    fwm1.min_load_factor(0.1f);
+    fwm1.growth_factor(4);
+    flat_wmap<int, int> fwm2;
+    for (int i = 0; i < 1000; ++i)
+      fwm2.emplace(i, i);
+    float maxLoadFactor = fwm2.max_load_factor();
+    
+    fwm1.merge(fwm2);
+    EXPECT_EQ(fwm1.size(), 1000u);
+    EXPECT_TRUE(fwm2.empty());
+    EXPECT_FLOAT_EQ(fwm1.max_load_factor(), 0.5f);
+    EXPECT_NEAR(fwm1.min_load_factor(), 0.1f, 0.001f);
+    EXPECT_EQ(fwm1.growth_factor(), 4u);
+    EXPECT_LE(fwm1.load_factor(), 0.5f);
+    EXPECT_LE(fwm1.size(), fwm1.rehash_threshold());
+    EXPECT_FLOAT_EQ(fwm2.max_load_factor(), maxLoadFactor);
+    EXPECT_EQ(fwm2.min_load_factor(), 0.f);
+    EXPECT_EQ(fwm2.growth_factor(), 2u);
+    for (int i = 0; i < 1000; ++i)
+      EXPECT_EQ(fwm1.at(i), i);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+struct SeededHash
+{
+  std::size_t seed;
+  explicit SeededHash(std::size_t seed_ = 0u) : seed(seed_) {}
+  std::size_t operator()(int key) const { return indivi::hash<int>{}(key) ^ seed; }
+};
+
+TEST(FlatWMapTest, Snapshot)
+{
+  const std::string path = testing::TempDir() + "indivi_flat_wmap_snapshot.bin";
+  {
+    // Empty and tiny
+    flat_wmap<int, int> fwm;
+    fwm.save(path);
+    flat_mapped<flat_wmap<int, int>> mapped(path);
+    EXPECT_TRUE(mapped.empty());
+    EXPECT_EQ(mapped.find(1), mapped.end());
+    EXPECT_EQ(mapped.begin(), mapped.end());
+
+    fwm.insert({{1, 2}, {3, 4}, {5, 6}});
+    fwm.save(path);
+    flat_mapped<flat_wmap<int, int>> mapped2(path);
+    EXPECT_EQ(mapped2.size(), 3u);
+    EXPECT_EQ(mapped2.find(3)->second, 4);
+    EXPECT_EQ(mapped2.map().at(5), 6);
+    EXPECT_FALSE(mapped2.contains(2));
+    EXPECT_TRUE(mapped2.map() == fwm);
+  }
+  {
+    // Large, with erased elements
+    flat_wmap<uint64_t, uint32_t> fwm;
+    for (uint32_t i = 0; i < 20000; ++i)
+      fwm.emplace((uint64_t)i * 0x9E3779B97F4A7C15u, i);
+    for (uint32_t i = 0; i < 20000; i += 3)
+      EXPECT_EQ(fwm.erase((uint64_t)i * 0x9E3779B97F4A7C15u), 1u);
+    fwm.save(path);
+
+    auto mapped = open_mapped<flat_wmap<uint64_t, uint32_t>>(path);
+    EXPECT_EQ(mapped.size(), fwm.size());
+    EXPECT_EQ(mapped.map().bucket_count(), fwm.bucket_count());
+    EXPECT_TRUE(mapped.map() == fwm);
+    for (uint32_t i = 0; i < 20000; ++i)
+      EXPECT_EQ(mapped.count((uint64_t)i * 0x9E3779B97F4A7C15u), (i % 3 == 0) ? 0u : 1u);
+    std::size_t iterated = 0u;
+    for (const auto& kv : mapped)
+    {
+      EXPECT_EQ(fwm.at(kv.first), kv.second);
+      ++iterated;
+    }
+    EXPECT_EQ(iterated, fwm.size());
+
+    flat_mapped<flat_wmap<uint64_t, uint32_t>> moved(std::move(mapped));
+    EXPECT_EQ(moved.size(), fwm.size());
+    EXPECT_TRUE(mapped.empty());
+  }
+  {
+    // Stored hash
+    flat_wmap<int, int, stored_hash<indivi::hash<int>>> fwm;
+    for (int i = 0; i < 1000; ++i)
+      fwm.emplace(i, -i);
+    fwm.save(path);
+    flat_mapped<flat_wmap<int, int, stored_hash<indivi::hash<int>>>> mapped(path);
+    EXPECT_TRUE(mapped.map() == fwm);
+
+    // Different options or layout
+    using Mapped = flat_mapped<flat_wmap<int, int>>;
+    using Mapped2 = flat_mapped<flat_wmap<int, int64_t, stored_hash<indivi::hash<int>>>>;
+    EXPECT_THROW(Mapped m(path), std::runtime_error);
+    EXPECT_THROW(Mapped2 m(path), std::runtime_error);
+  }
+  {
+    // Different hash function
+    flat_wmap<int, int, SeededHash> fwm;
+    for (int i = 0; i < 100; ++i)
+      fwm.emplace(i, i);
+    fwm.save(path);
+    using Mapped = flat_mapped<flat_wmap<int, int, SeededHash>>;
+    EXPECT_EQ(Mapped(path).size(), 100u);
+    EXPECT_THROW(Mapped m(path, SeededHash(0x1234567u)), std::runtime_error);
+
+    // Truncated or missing file
+    using Mapped2 = flat_mapped<flat_wmap<int, int>>;
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "INDIVIFT";
+    EXPECT_THROW(Mapped2 m(path), std::runtime_error);
+    std::remove(path.c_str());
+    EXPECT_THROW(Mapped2 m(path), std::runtime_error);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatWMapTest, Swap)
 {
   {
@@ -1452,6 +2445,240 @@ TEST(FlatWMapTest, BadHash)
   }
 }
 
+#ifdef INDIVI_FLAT_W_TELEMETRY
+TEST(FlatWMapTest, Telemetry)
+{
+  const uint64_t sampling = INDIVI_FLAT_TELEMETRY_SAMPLING;
+  {
+    flat_wmap<int, int> fwm;
+    for (int i = 0; i < 10000; ++i)
+      fwm.emplace(i, i);
+    flat_telemetry telemetry = fwm.get_telemetry();
+    EXPECT_GT(telemetry.rehash_count, 0u);
+    EXPECT_GT(telemetry.sampled_lookups(), 0u); // lookups of insertions
+    
+    fwm.reset_telemetry();
+    telemetry = fwm.get_telemetry();
+    EXPECT_EQ(telemetry.sampled_lookups(), 0u);
+    EXPECT_EQ(telemetry.sampled_compares, 0u);
+    EXPECT_EQ(telemetry.rehash_count, 0u);
+    EXPECT_EQ(telemetry.rehash_nanoseconds, 0u);
+    
+    for (int i = 0; i < 10000; ++i)
+      EXPECT_TRUE(fwm.contains(i));
+    for (int i = 0; i < 10000; ++i)
+      EXPECT_FALSE(fwm.contains(-1 - i));
+    telemetry = fwm.get_telemetry();
+    uint64_t hits = 0u;
+    uint64_t misses = 0u;
+    for (unsigned int i = 0u; i < flat_telemetry::PROBE_BINS; ++i)
+    {
+      hits += telemetry.probe_hits[i];
+      misses += telemetry.probe_misses[i];
+    }
+    EXPECT_NEAR((double)(hits + misses), 20000. / sampling, 1.);
+    EXPECT_NEAR((double)hits, 10000. / sampling, 1.);
+    EXPECT_GE(telemetry.sampled_compares, hits);
+    EXPECT_GT(telemetry.probe_hits[0], hits / 2u); // mostly in first window
+    
+    // counters not copied
+    flat_wmap<int, int> copy(fwm);
+    EXPECT_EQ(copy.get_telemetry().sampled_lookups(), 0u);
+    copy = fwm;
+    EXPECT_EQ(copy.get_telemetry().sampled_lookups(), 0u);
+    
+    fwm.rehash(fwm.bucket_count() * 2u);
+    EXPECT_EQ(fwm.get_telemetry().rehash_count, 1u);
+  }
+  {
+    // poor hash: long probes
+    struct poor_hash {
+      using is_avalanching = void; // wrongly
+      size_t operator()(const int& x) const { return (size_t)(x % 8); }
+    };
+    flat_wmap<int, int, poor_hash> fwm;
+    for (int i = 0; i < 1000; ++i)
+      fwm.emplace(i, i);
+    fwm.reset_telemetry();
+    for (int n = 0; n < 4; ++n)
+      for (int i = 0; i < 1000; ++i)
+        EXPECT_TRUE(fwm.contains(i));
+    flat_telemetry telemetry = fwm.get_telemetry();
+    EXPECT_NEAR((double)telemetry.sampled_lookups(), 4000. / sampling, 1.);
+    uint64_t longProbes = 0u;
+    for (unsigned int i = 4u; i < flat_telemetry::PROBE_BINS; ++i)
+      longProbes += telemetry.probe_hits[i];
+    EXPECT_GT(longProbes, telemetry.sampled_lookups() / 2u);
+  }
+  {
+    // tombstones ratio, purged in place
+    flat_wmap<int, int> fwm;
+    for (int i = 0; i < 13000; ++i) // near max load (scattered keys, sequential ones fill windows evenly)
+      fwm.emplace((i * 40503) ^ (i << 7), i);
+    EXPECT_EQ(fwm.size(), 13000u);
+    EXPECT_EQ(fwm.get_telemetry().tombstone_ratio, 0.f);
+    for (int i = 0; i < 13000; i += 2)
+      fwm.erase((i * 40503) ^ (i << 7));
+    float ratio = fwm.get_telemetry().tombstone_ratio;
+    EXPECT_GT(ratio, 0.f);
+    EXPECT_LT(ratio, 0.5f);
+    
+    std::size_t rehashCount = fwm.get_telemetry().rehash_count;
+    fwm.purge_tombstones();
+    EXPECT_EQ(fwm.get_telemetry().tombstone_ratio, 0.f);
+    EXPECT_EQ(fwm.get_telemetry().rehash_count, rehashCount + 1u);
+  }
+}
+#endif
+
+TEST(FlatWMapTest, SeededHashing)
+{
+  {
+    using Map = flat_wmap<std::string, int, seeded_hash<std::string>>;
+    Map fwm(0u, seeded_hash<std::string>(0x1234567u));
+    for (int i = 0; i < 1000; ++i)
+      fwm.emplace(std::to_string(i), i);
+    
+    Map fwm2(fwm); // seed copied
+    EXPECT_EQ(fwm2.hash_function()("abc"), seeded_hash<std::string>(0x1234567u)("abc"));
+    EXPECT_EQ(fwm2, fwm);
+    
+    Map fwm3; // per-process seed
+    fwm3.insert(fwm.begin(), fwm.end());
+    EXPECT_EQ(fwm3, fwm);
+    fwm3.swap(fwm2);
+    EXPECT_EQ(fwm3.hash_function()("abc"), seeded_hash<std::string>(0x1234567u)("abc"));
+    for (int i = 0; i < 1000; ++i)
+    {
+      EXPECT_EQ(fwm2.at(std::to_string(i)), i);
+      EXPECT_EQ(fwm3.at(std::to_string(i)), i);
+    }
+  }
+  {
+    // keys only differing in high bits
+    flat_wmap<uint64_t, int, seeded_hash<uint64_t>> fwm;
+    for (int i = 0; i < 10000; ++i)
+      fwm.emplace((uint64_t)i << 40, i);
+    EXPECT_EQ(fwm.size(), 10000u);
+    for (int i = 0; i < 10000; ++i)
+      EXPECT_EQ(fwm.at((uint64_t)i << 40), i);
+  }
+}
+
+TEST(FlatWMapTest, LongStringKeys)
+{
+  {
+    // prefixes of a same long string
+    flat_wmap<std::string, int> fwm;
+    std::string str(1000, 'x');
+    for (int len = 0; len <= 1000; ++len)
+      EXPECT_TRUE(fwm.emplace(str.substr(0u, (std::size_t)len), len).second);
+    EXPECT_EQ(fwm.size(), 1001u);
+    for (int len = 0; len <= 1000; ++len)
+      EXPECT_EQ(fwm.at(str.substr(0u, (std::size_t)len)), len);
+    EXPECT_FALSE(fwm.contains(std::string(1001, 'x')));
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+namespace
+{
+// Key made of segments, equal if same concatenated bytes
+struct SegmentedKey
+{
+  std::vector<std::string> parts;
+  
+  std::string str() const
+  {
+    std::string res;
+    for (const std::string& part : parts)
+      res += part;
+    return res;
+  }
+  bool operator==(const SegmentedKey& other) const { return str() == other.str(); }
+};
+
+struct SegmentedHash
+{
+  using is_avalanching = void;
+  
+  uint64_t operator()(const SegmentedKey& key) const
+  {
+    hash_state hs;
+    for (const std::string& part : key.parts)
+      hs.update(part);
+    return hs.finish();
+  }
+};
+}
+
+TEST(FlatWMapTest, StreamingHash)
+{
+  {
+    flat_wmap<SegmentedKey, int, SegmentedHash> fwm;
+    for (int i = 0; i < 1000; ++i)
+    {
+      std::string num = std::to_string(i);
+      fwm.emplace(SegmentedKey{ { std::string(60, 'k'), num, std::string(i % 100, 'v') } }, i);
+    }
+    EXPECT_EQ(fwm.size(), 1000u);
+    for (int i = 0; i < 1000; ++i)
+    {
+      // other segmentation of same bytes
+      std::string key = std::string(60, 'k') + std::to_string(i) + std::string(i % 100, 'v');
+      SegmentedKey other{ { key.substr(0u, 5u), key.substr(5u, key.size() / 2u), key.substr(5u + key.size() / 2u) } };
+      EXPECT_EQ(fwm.at(other), i);
+    }
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatWMapTest, CompositeKeys)
+{
+  {
+    // (tenant, object) keys
+    flat_wmap<std::pair<uint32_t, uint64_t>, int> fwm;
+    for (uint32_t t = 0; t < 100; ++t)
+      for (uint64_t o = 0; o < 100; ++o)
+        EXPECT_TRUE(fwm.emplace(std::make_pair(t, o << 20), (int)(t * 100 + o)).second);
+    ASSERT_EQ(fwm.size(), 10000u);
+    for (uint32_t t = 0; t < 100; t += 2)
+      for (uint64_t o = 0; o < 100; ++o)
+        EXPECT_EQ(fwm.erase(std::make_pair(t, o << 20)), 1u);
+    for (uint32_t t = 0; t < 100; ++t)
+      for (uint64_t o = 0; o < 100; ++o)
+      {
+        auto it = fwm.find(std::make_pair(t, o << 20));
+        ASSERT_EQ(it != fwm.end(), t % 2 == 1);
+        if (it != fwm.end())
+        {
+          EXPECT_EQ(it->second, (int)(t * 100 + o));
+        }
+      }
+  }
+  {
+    flat_wmap<std::tuple<int, std::string, bool>, int> fwm;
+    for (int i = 0; i < 300; ++i)
+      fwm.emplace(std::make_tuple(i / 2, std::to_string(i % 7), i % 2 == 0), i);
+    EXPECT_EQ(fwm.size(), 300u);
+    for (int i = 0; i < 300; ++i)
+      EXPECT_EQ(fwm.at(std::make_tuple(i / 2, std::to_string(i % 7), i % 2 == 0)), i);
+    
+    flat_wmap<std::array<uint8_t, 4>, int> fwm2;
+    for (int i = 0; i < 256; ++i)
+      fwm2.emplace(std::array<uint8_t, 4>{{ (uint8_t)i, 0u, (uint8_t)(255 - i), 0u }}, i);
+    EXPECT_EQ(fwm2.size(), 256u);
+    for (int i = 0; i < 256; ++i)
+      EXPECT_EQ(fwm2.at(std::array<uint8_t, 4>{{ (uint8_t)i, 0u, (uint8_t)(255 - i), 0u }}), i);
+    
+    flat_wmap<std::array<double, 2>, int> fwm3;
+    EXPECT_TRUE(fwm3.emplace(std::array<double, 2>{{ 0.0, 1.0 }}, 1).second);
+    EXPECT_FALSE(fwm3.emplace(std::array<double, 2>{{ -0.0, 1.0 }}, 2).second);
+  }
+}
+
 TEST(FlatWMapTest, Stress)
 {
   {
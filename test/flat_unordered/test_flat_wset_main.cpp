@@ -6,18 +6,22 @@
 #include "gtest/gtest.h"
 
 #define INDIVI_FLAT_W_DEBUG
+#include "indivi/flat_mapped.h"
 #include "indivi/flat_wset.h"
+#include "utils/bump_allocator.h"
 #include "utils/debug_utils.h"
 
 #include <initializer_list>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include <cassert>
+#include <cstdio>
 #include <cstdlib>
 
 using namespace indivi;
@@ -225,6 +229,61 @@ TEST(FlatWSetTest, Assignment2)
   EXPECT_EQ(DbgClass::count, 0);
 }
 
+TEST(FlatWSetTest, Allocator)
+{
+  using alloc_type = bump_allocator<DbgClass>;
+  using flat_wset_alc = flat_wset<DbgClass, indivi::hash<DbgClass>, std::equal_to<DbgClass>, alloc_type>;
+  {
+    alloc_type alc;
+    flat_wset_alc fws0(alc);
+    EXPECT_TRUE(fws0.empty());
+    
+    flat_wset_alc fws1(10, alc);
+    EXPECT_GE(fws1.bucket_count(), 10u);
+    EXPECT_FALSE(fws1.contains(1));
+  }
+  {
+    flat_wset_alc fws;
+    for (int i = 1; i <= 40; ++i)
+      fws.emplace(i);
+    ASSERT_EQ(fws.size(), 40u);
+    
+    alloc_type alc;
+    flat_wset_alc fws1(fws, alc);
+    EXPECT_EQ(fws1, fws);
+    
+    // unequal allocators: move element-wise
+    flat_wset_alc fws2(std::move(fws), alc);
+    EXPECT_TRUE(fws.empty());
+    EXPECT_EQ(fws2, fws1);
+    
+    flat_wset_alc fws3;
+    fws3 = fws1;
+    EXPECT_EQ(fws3, fws1);
+    
+    fws3 = std::move(fws2);
+    EXPECT_TRUE(fws2.empty());
+    EXPECT_EQ(fws3, fws1);
+    
+    // propagate on swap
+    fws2.swap(fws3);
+    EXPECT_TRUE(fws3.empty());
+    EXPECT_EQ(fws2, fws1);
+    
+    fws2.clear();
+    fws2.rehash(0);
+    EXPECT_EQ(fws2.bucket_count(), 0u);
+  }
+  {
+    flat_wset<int> fws{};
+    std::allocator<int> alc = fws.get_allocator();
+    flat_wset<int> fws1(std::move(fws), alc);
+    EXPECT_TRUE(fws1.empty());
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatWSetTest, Capacity)
 {
   {
@@ -238,7 +297,8 @@ TEST(FlatWSetTest, Capacity)
     EXPECT_EQ(fws.max_load_factor(), 0.8f);
     EXPECT_EQ(fws.max_size(), max_size);
     EXPECT_GT(fws.max_bucket_count(), 0u);
-    fws.max_load_factor(0.f); // no-op
+    fws.max_load_factor(0.f); // clamped
+    EXPECT_EQ(fws.max_load_factor(), 0.25f);
     EXPECT_GT(fws.max_bucket_count(), 0u);
     
     fws = {1, 3};
@@ -475,6 +535,153 @@ TEST(FlatWSetTest, ElementAccess)
 //   EXPECT_EQ(DbgClass::count, 0);
 // }
 
+TEST(FlatWSetTest, FindBatch)
+{
+  {
+    flat_wset<DbgClass> fus;
+    std::vector<DbgClass> keys{1, 2, 3};
+    std::unique_ptr<bool[]> found(new bool[keys.size()]);
+    fus.contains_batch(keys.data(), keys.size(), found.get());
+    for (size_t i = 0; i < keys.size(); ++i)
+      EXPECT_FALSE(found[i]);
+  }
+  {
+    flat_wset<DbgClass> fus;
+    for (int i = 1; i < 1000; i += 2)
+      fus.emplace(i);
+    
+    std::vector<DbgClass> keys;
+    for (int i = 0; i < 1000; ++i)
+      keys.emplace_back((i * 7) % 1000 + 1);
+    
+    std::unique_ptr<bool[]> found(new bool[keys.size()]);
+    fus.contains_batch(keys.data(), keys.size(), found.get());
+    
+    std::vector<flat_wset<DbgClass>::iterator> its(keys.size());
+    fus.find_batch(keys.data(), keys.size(), its.data());
+    
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+      bool exist = keys[i].id % 2 == 1;
+      EXPECT_EQ(found[i], exist);
+      EXPECT_EQ(its[i], fus.find(keys[i]));
+      if (exist)
+      {
+        ASSERT_NE(its[i], fus.end());
+        EXPECT_EQ(*its[i], keys[i]);
+      }
+    }
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+struct TransparentEqual
+{
+  using is_transparent = void;
+  template< class U, class V >
+  bool operator()(const U& lhs, const V& rhs) const { return lhs == rhs; }
+};
+
+TEST(FlatWSetTest, TransparentLookup)
+{
+  {
+    flat_wset<std::string, indivi::hash<std::string>, TransparentEqual> fws;
+    for (int i = 1; i <= 100; ++i)
+      fws.insert(std::to_string(i));
+    ASSERT_EQ(fws.size(), 100u);
+    
+    EXPECT_TRUE(fws.contains("42"));
+    EXPECT_FALSE(fws.contains("0"));
+    EXPECT_EQ(fws.count("7"), 1u);
+    EXPECT_EQ(*fws.find("13"), "13");
+    EXPECT_TRUE(fws.find("101") == fws.end());
+    
+    const auto& cfws = fws;
+    EXPECT_EQ(*cfws.find("13"), "13");
+    
+    EXPECT_EQ(fws.erase("100"), 1u);
+    EXPECT_EQ(fws.erase("100"), 0u);
+    EXPECT_EQ(fws.size(), 99u);
+  #ifdef INDIVI_CPP17
+    std::string_view sv("57");
+    EXPECT_TRUE(fws.contains(sv));
+    EXPECT_EQ(*fws.find(sv), "57");
+  #endif
+  }
+  {
+    indivi::hash<std::string> hash;
+    EXPECT_EQ(hash("abc"), hash(std::string("abc")));
+    EXPECT_EQ(hash(""), hash(std::string()));
+  #ifdef INDIVI_CPP17
+    EXPECT_EQ(indivi::hash<std::string_view>{}("abc"), hash(std::string("abc")));
+  #endif
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+struct CountedHash
+{
+  int* calls;
+  explicit CountedHash(int* calls_ = nullptr) : calls(calls_) {}
+  std::size_t operator()(const DbgClass& key) const
+  {
+    ++(*calls);
+    return std::hash<DbgClass>{}(key);
+  }
+};
+
+TEST(FlatWSetTest, StoredHash)
+{
+  {
+    int calls = 0;
+    flat_wset<DbgClass, stored_hash<CountedHash>> fws(0, stored_hash<CountedHash>(CountedHash(&calls)));
+    for (int i = 1; i <= 1000; ++i)
+      fws.insert(i);
+    ASSERT_EQ(fws.size(), 1000u);
+    EXPECT_EQ(calls, 1000); // never re-hashed on growth
+    
+    for (int i = 1; i <= 1000; ++i)
+      EXPECT_EQ(fws.find(i)->id, i);
+    EXPECT_FALSE(fws.contains(1001));
+    
+    calls = 0;
+    flat_wset<DbgClass, stored_hash<CountedHash>> fws2(fws);
+    EXPECT_EQ(calls, 0);
+    EXPECT_TRUE(fws2 == fws);
+    
+    for (int i = 1; i <= 1000; i += 2)
+      EXPECT_EQ(fws.erase(i), 1u);
+    ASSERT_EQ(fws.size(), 500u);
+    
+    calls = 0;
+    fws.rehash(0); // shrink
+    EXPECT_EQ(calls, 0);
+    for (int i = 1; i <= 1000; ++i)
+      EXPECT_EQ(fws.contains(i), i % 2 == 0);
+  }
+  {
+    int calls = 0;
+    flat_wset<DbgClass, CountedHash> fws(0, CountedHash(&calls));
+    for (int i = 1; i <= 1000; ++i)
+      fws.insert(i);
+    ASSERT_EQ(fws.size(), 1000u);
+    EXPECT_GT(calls, 1000); // re-hashed on growth
+  }
+  {
+    flat_wset<std::string, stored_hash<indivi::hash<std::string>>> fws;
+    for (int i = 0; i < 500; ++i)
+      fws.insert(std::to_string(i));
+    ASSERT_EQ(fws.size(), 500u);
+    for (int i = 0; i < 500; ++i)
+      EXPECT_TRUE(fws.contains(std::to_string(i)));
+    EXPECT_FALSE(fws.contains("500"));
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatWSetTest, Clear)
 {
   {
@@ -600,6 +807,89 @@ TEST(FlatWSetTest, Insert2)
   EXPECT_EQ(DbgClass::count, 0);
 }
 
+namespace
+{
+// Hasher with batched hashing (counted)
+struct BatchCountedHash
+{
+  int* batchs;
+  std::size_t operator()(int key) const { return (std::size_t)key * 31u; }
+  void hash_batch(const int* keys, std::size_t count, std::size_t* out) const
+  {
+    ++*batchs;
+    for (std::size_t i = 0u; i < count; ++i)
+      out[i] = (*this)(keys[i]);
+  }
+};
+}
+
+TEST(FlatWSetTest, InsertUniqueRange)
+{
+  {
+    std::vector<DbgClass> vec;
+    for (int i = 1; i <= 100000; ++i)
+      vec.emplace_back(i);
+    flat_wset<DbgClass> fws;
+    fws.insert_unique_range(vec.begin(), vec.end());
+    ASSERT_EQ(fws.size(), 100000u);
+    EXPECT_EQ(vec[0], 1);
+    for (int i = 1; i <= 100000; ++i)
+      EXPECT_TRUE(fws.contains(i));
+    EXPECT_FALSE(fws.contains(100001));
+    
+    // moved, into non-empty table
+    std::vector<DbgClass> vec2;
+    for (int i = 100001; i <= 100100; ++i)
+      vec2.emplace_back(i);
+    fws.insert_unique_range(std::make_move_iterator(vec2.begin()), std::make_move_iterator(vec2.end()));
+    EXPECT_EQ(fws.size(), 100100u);
+    EXPECT_NE(vec2[0], 100001);
+    for (int i = 100001; i <= 100100; ++i)
+      EXPECT_TRUE(fws.contains(i));
+  }
+  {
+    std::vector<DbgClass> vec{1, 3, 5};
+    flat_wset<DbgClass> fws;
+    fws.insert_unique_range(vec.begin(), vec.begin());
+    EXPECT_TRUE(fws.empty());
+    fws.insert_unique_range(vec.begin(), vec.end());
+    EXPECT_EQ(fws.size(), 3u);
+    EXPECT_TRUE(fws.contains(3));
+    
+    // with tombstones
+    for (int i = 6; i <= 12; ++i)
+      fws.insert(i);
+    for (int i = 1; i <= 12; i += 2)
+      fws.erase(i);
+    std::vector<DbgClass> vec2;
+    for (int i = 13; i <= 20; ++i)
+      vec2.emplace_back(i);
+    fws.insert_unique_range(vec2.begin(), vec2.end());
+    EXPECT_EQ(fws.size(), 12u);
+    for (int i = 1; i <= 20; ++i)
+      EXPECT_EQ(fws.contains(i), i > 12 || (i >= 6 && i % 2 == 0));
+  }
+  {
+    // contiguous keys hashed by hasher batch
+    std::vector<int> vec;
+    for (int i = 0; i < 100; ++i)
+      vec.push_back(i * 3);
+    int batchs = 0;
+    flat_wset<int, BatchCountedHash> fws(0u, BatchCountedHash{ &batchs });
+    fws.insert_unique_range(vec.data(), vec.data() + vec.size());
+    EXPECT_EQ(batchs, 7); // by 16
+    std::vector<int> vec2{ 1000, 1001, 1002 };
+    fws.insert_unique_range(vec2.begin(), vec2.end()); // not from pointers, one by one
+    EXPECT_EQ(batchs, 7);
+    ASSERT_EQ(fws.size(), 103u);
+    EXPECT_TRUE(fws.contains(1001));
+    for (int i = 0; i < 300; ++i)
+      EXPECT_EQ(fws.contains(i), i % 3 == 0);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatWSetTest, Emplace)
 {
   {
@@ -789,6 +1079,123 @@ TEST(FlatWSetTest, EraseIf)
   EXPECT_EQ(DbgClass::count, 0);
 }
 
+TEST(FlatWSetTest, NodeHandle)
+{
+  {
+    flat_wset<DbgClass> fws;
+    for (int i = 1; i <= 100; ++i)
+      fws.insert(i);
+    
+    auto node = fws.extract(101); // missing
+    EXPECT_TRUE(node.empty());
+    EXPECT_EQ(fws.size(), 100u);
+    
+    node = fws.extract(50);
+    ASSERT_TRUE(node);
+    EXPECT_EQ(node.value().id, 50);
+    EXPECT_EQ(fws.size(), 99u);
+    EXPECT_FALSE(fws.contains(50));
+    
+    node.value().id = 500; // non-const on extracted value
+    auto res = fws.insert(std::move(node));
+    EXPECT_TRUE(res.inserted);
+    EXPECT_TRUE(res.node.empty());
+    EXPECT_EQ(res.position->id, 500);
+    EXPECT_TRUE(fws.contains(500));
+    EXPECT_EQ(fws.size(), 100u);
+    
+    node = fws.extract(fws.find(1));
+    ASSERT_TRUE(node);
+    fws.insert(1);
+    res = fws.insert(std::move(node)); // already exist
+    EXPECT_FALSE(res.inserted);
+    ASSERT_FALSE(res.node.empty());
+    EXPECT_EQ(res.node.value().id, 1);
+    EXPECT_EQ(res.position->id, 1);
+    EXPECT_EQ(fws.size(), 100u);
+    
+    res = fws.insert(decltype(fws)::node_type()); // empty
+    EXPECT_FALSE(res.inserted);
+    EXPECT_TRUE(res.position == fws.end());
+    
+    flat_wset<DbgClass> fws2;
+    while (!fws.empty())
+      fws2.insert(fws.extract(fws.begin()));
+    EXPECT_EQ(fws2.size(), 100u);
+    EXPECT_TRUE(fws2.contains(500));
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatWSetTest, Merge)
+{
+  {
+    flat_wset<DbgClass> fws1;
+    flat_wset<DbgClass> fws2;
+    for (int i = 1; i <= 100; ++i)
+      fws1.insert(i);
+    for (int i = 51; i <= 200; ++i)
+      fws2.insert(i);
+    
+    fws1.merge(fws2);
+    EXPECT_EQ(fws1.size(), 200u);
+    EXPECT_EQ(fws2.size(), 50u); // duplicates left in source
+    for (int i = 1; i <= 200; ++i)
+      EXPECT_TRUE(fws1.contains(i));
+    for (int i = 51; i <= 100; ++i)
+      EXPECT_TRUE(fws2.contains(i));
+    
+    fws1.merge(fws1); // self
+    EXPECT_EQ(fws1.size(), 200u);
+    
+    fws2.clear();
+    fws2.merge(std::move(fws1)); // into empty
+    EXPECT_EQ(fws2.size(), 200u);
+    EXPECT_TRUE(fws1.empty());
+  }
+  {
+    int calls = 0;
+    flat_wset<DbgClass, stored_hash<CountedHash>> fws1(0, stored_hash<CountedHash>(CountedHash(&calls)));
+    flat_wset<DbgClass, stored_hash<CountedHash>> fws2(0, stored_hash<CountedHash>(CountedHash(&calls)));
+    for (int i = 1; i <= 300; ++i)
+      (i <= 100 ? fws1 : fws2).insert(i);
+    
+    calls = 0;
+    fws1.merge(fws2);
+    EXPECT_EQ(calls, 200); // stateful hasher, each element hashed once
+    EXPECT_EQ(fws1.size(), 300u);
+    EXPECT_TRUE(fws2.empty());
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FlatWSetTest, Snapshot)
+{
+  const std::string path = testing::TempDir() + "indivi_flat_wset_snapshot.bin";
+  {
+    flat_wset<uint64_t> fws;
+    fws.save(path);
+    EXPECT_TRUE(flat_mapped<flat_wset<uint64_t>>(path).empty());
+
+    for (uint64_t i = 0; i < 5000; ++i)
+      fws.insert(i * 3);
+    fws.save(path);
+    flat_mapped<flat_wset<uint64_t>> mapped(path);
+    EXPECT_EQ(mapped.size(), 5000u);
+    EXPECT_TRUE(mapped.map() == fws);
+    for (uint64_t i = 0; i < 15000; ++i)
+      EXPECT_EQ(mapped.contains(i), i % 3 == 0);
+
+    using Mapped = flat_mapped<flat_wset<uint32_t>>;
+    EXPECT_THROW(Mapped m(path), std::runtime_error);
+    std::remove(path.c_str());
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
 TEST(FlatWSetTest, Swap)
 {
   {
@@ -0,0 +1,242 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#include "gtest/gtest.h"
+
+#define INDIVI_FLAT_U_DEBUG
+#define INDIVI_FLAT_W_DEBUG
+#define INDIVI_FLAT_W_STATS // same as wmap tests (shared instantiations)
+#define INDIVI_FLAT_U_TELEMETRY // same as umap tests
+#define INDIVI_FLAT_W_TELEMETRY // same as wmap tests
+#include "indivi/flat_umap.h"
+#include "indivi/flat_wmap.h"
+#include "indivi/frozen_map.h"
+#include "utils/debug_utils.h"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+
+using namespace indivi;
+
+namespace
+{
+struct ConstantHash
+{
+  std::size_t operator()(int) const { return 42u; }
+};
+
+// Check all keys of 'ref' are found, with their value
+template< class FMap, class Map >
+void expect_same(const FMap& fm, const Map& ref)
+{
+  ASSERT_EQ(fm.size(), ref.size());
+  for (const auto& kv : ref)
+  {
+    auto it = fm.find(kv.first);
+    ASSERT_NE(it, fm.end());
+    EXPECT_EQ(it->first, kv.first);
+    EXPECT_EQ(it->second, kv.second);
+  }
+  std::size_t iterated = 0u;
+  for (const auto& kv : fm)
+  {
+    EXPECT_EQ(ref.at(kv.first), kv.second);
+    ++iterated;
+  }
+  EXPECT_EQ(iterated, ref.size());
+}
+}
+
+TEST(FrozenMapTest, Constructor)
+{
+  {
+    frozen_map<DbgClass, DbgClass> fm;
+    EXPECT_TRUE(fm.empty());
+    EXPECT_EQ(fm.size(), 0u);
+    EXPECT_EQ(fm.begin(), fm.end());
+    EXPECT_FALSE(fm.contains(1));
+    EXPECT_EQ(fm.find(1), fm.end());
+
+    DbgClass keys[2] = {1, 2};
+    bool founds[2] = {true, true};
+    fm.contains_batch(keys, 2, founds);
+    EXPECT_FALSE(founds[0]);
+    EXPECT_FALSE(founds[1]);
+  }
+  {
+    frozen_map<DbgClass, DbgClass> fm{{1, 2}};
+    EXPECT_EQ(fm.size(), 1u);
+    EXPECT_EQ(fm.find(1)->second.id, 2);
+    EXPECT_FALSE(fm.contains(2));
+  }
+  {
+    frozen_map<DbgClass, DbgClass> fm{{1, 2}, {3, 4}, {5, 6}, {1, 7}}; // duplicate ignored
+    EXPECT_EQ(fm.size(), 3u);
+    EXPECT_EQ(fm.find(1)->second.id, 2);
+    EXPECT_EQ(fm.find(3)->second.id, 4);
+    EXPECT_EQ(fm.find(5)->second.id, 6);
+    EXPECT_EQ(fm.count(5), 1u);
+    EXPECT_EQ(fm.count(7), 0u);
+  }
+  {
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < 1000; ++i)
+      pairs.emplace_back(i % 600, i);
+    frozen_map<int, int> fm(pairs.begin(), pairs.end());
+    EXPECT_EQ(fm.size(), 600u);
+    for (int i = 0; i < 600; ++i)
+      EXPECT_EQ(fm.find(i)->second, i); // first kept
+    EXPECT_FALSE(fm.contains(600));
+    EXPECT_FALSE(fm.contains(-1));
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FrozenMapTest, FromFlatMap)
+{
+  {
+    flat_umap<DbgClass, DbgClass> fum;
+    for (int i = 1; i <= 5000; ++i)
+      fum.try_emplace(i, i + 1);
+
+    frozen_map<DbgClass, DbgClass> fm(fum.begin(), fum.end());
+    EXPECT_EQ(fm.size(), fum.size());
+    EXPECT_GT(fm.bucket_count(), 0u);
+    for (int i = 1; i <= 5000; ++i)
+    {
+      auto it = fm.find(i);
+      ASSERT_NE(it, fm.end());
+      EXPECT_EQ(it->first.id, i);
+      EXPECT_EQ(it->second.id, i + 1);
+    }
+    for (int i = 5001; i <= 10000; ++i)
+      EXPECT_FALSE(fm.contains(i));
+  }
+  {
+    flat_wmap<uint64_t, uint64_t> fwm;
+    std::unordered_map<uint64_t, uint64_t> ref;
+    uint64_t key = 0x9E3779B97F4A7C15u;
+    for (int i = 0; i < 100000; ++i)
+    {
+      key = key * 6364136223846793005u + 1442695040888963407u;
+      fwm.emplace(key, (uint64_t)i);
+      ref.emplace(key, (uint64_t)i);
+    }
+
+    frozen_map<uint64_t, uint64_t> fm(fwm.begin(), fwm.end());
+    expect_same(fm, ref);
+    std::vector<uint64_t> keys;
+    for (const auto& kv : ref)
+    {
+      keys.push_back(kv.first);
+      keys.push_back(kv.first + 1u); // miss (most likely)
+      if (keys.size() >= 999u)
+        break;
+    }
+    std::vector<frozen_map<uint64_t, uint64_t>::const_iterator> its(keys.size());
+    std::unique_ptr<bool[]> founds(new bool[keys.size()]);
+    fm.find_batch(keys.data(), keys.size(), its.data());
+    fm.contains_batch(keys.data(), keys.size(), founds.get());
+    for (std::size_t i = 0u; i < keys.size(); ++i)
+    {
+      EXPECT_EQ(its[i], fm.find(keys[i]));
+      EXPECT_EQ(founds[i], ref.count(keys[i]) == 1u);
+    }
+    for (int i = 0; i < 10000; ++i)
+    {
+      key = key * 6364136223846793005u + 1442695040888963407u;
+      EXPECT_EQ(fm.contains(key), ref.count(key) == 1u);
+    }
+  }
+  {
+    flat_umap<std::string, int> fum;
+    std::unordered_map<std::string, int> ref;
+    for (int i = 0; i < 3000; ++i)
+    {
+      fum.emplace("key_" + std::to_string(i * 7), i);
+      ref.emplace("key_" + std::to_string(i * 7), i);
+    }
+
+    frozen_map<std::string, int> fm(fum.begin(), fum.end());
+    expect_same(fm, ref);
+    EXPECT_FALSE(fm.contains("key_1"));
+    EXPECT_FALSE(fm.contains(""));
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FrozenMapTest, Sizes)
+{
+  // Small sizes and identity hash (std::hash<int>)
+  for (int size = 0; size <= 300; ++size)
+  {
+    std::unordered_map<int, int> ref;
+    for (int i = 0; i < size; ++i)
+      ref.emplace(i * 3, i);
+
+    frozen_map<int, int, std::hash<int>> fm(ref.begin(), ref.end());
+    expect_same(fm, ref);
+    for (int i = 0; i < size; ++i)
+      EXPECT_FALSE(fm.contains(i * 3 + 1));
+  }
+}
+
+TEST(FrozenMapTest, Assignment)
+{
+  {
+    frozen_map<DbgClass, DbgClass> fm1{{1, 1}, {2, 2}, {3, 3}};
+    frozen_map<DbgClass, DbgClass> fm2(fm1);
+    EXPECT_EQ(fm2.size(), 3u);
+    EXPECT_EQ(fm2.find(2)->second.id, 2);
+
+    frozen_map<DbgClass, DbgClass> fm3{{4, 4}};
+    fm3 = fm1;
+    EXPECT_EQ(fm3.size(), 3u);
+    EXPECT_FALSE(fm3.contains(4));
+    EXPECT_EQ(fm3.find(3)->second.id, 3);
+
+    frozen_map<DbgClass, DbgClass> fm4(std::move(fm2));
+    EXPECT_EQ(fm4.size(), 3u);
+    EXPECT_EQ(fm4.find(1)->second.id, 1);
+
+    fm4 = frozen_map<DbgClass, DbgClass>{{5, 6}};
+    EXPECT_EQ(fm4.size(), 1u);
+    EXPECT_EQ(fm4.find(5)->second.id, 6);
+    EXPECT_FALSE(fm4.contains(1));
+
+    swap(fm1, fm4);
+    EXPECT_EQ(fm1.size(), 1u);
+    EXPECT_EQ(fm4.size(), 3u);
+    EXPECT_TRUE(fm1.contains(5));
+    EXPECT_TRUE(fm4.contains(3));
+    EXPECT_FALSE(fm4.contains(5));
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(FrozenMapTest, BadHash)
+{
+  {
+    frozen_map<int, int, ConstantHash> fm{{1, 1}, {1, 2}}; // same key
+    EXPECT_EQ(fm.size(), 1u);
+    EXPECT_EQ(fm.find(1)->second, 1);
+  }
+  {
+    std::vector<std::pair<int, int>> pairs{{1, 1}, {2, 2}};
+    using FMap = frozen_map<int, int, ConstantHash>;
+    EXPECT_THROW(FMap(pairs.begin(), pairs.end()), std::invalid_argument);
+  }
+}
@@ -0,0 +1,201 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#include "gtest/gtest.h"
+
+#include "indivi/hash.h"
+
+#include <array>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <cstdint>
+#include <cstring>
+
+using namespace indivi;
+
+
+TEST(HashTest, SeededHashing)
+{
+  seeded_hash<int> h1(1u), h1b(1u), h2(2u);
+  EXPECT_EQ(h1(42), h1b(42));
+  EXPECT_NE(h1(42), h2(42));
+  EXPECT_EQ(seeded_hash<int>(0u)(42), detail::bit_mix::mix(indivi::hash<int>(), 42)); // same as unseeded
+  EXPECT_EQ(seeded_hash<int>()(42), seeded_hash<int>(hash_seed())(42));                // per-process
+
+  seeded_hash<std::string> s1(1u), s2(2u);
+  EXPECT_EQ(s1("abc"), s1(std::string("abc")));
+  EXPECT_NE(s1("abc"), s2("abc"));
+  EXPECT_EQ(seeded_hash<std::string>(0u)("abc"), indivi::hash<std::string>()("abc"));
+}
+
+TEST(HashTest, HashBatch)
+{
+  // same hashes as one by one
+  std::vector<uint64_t> ikeys;
+  std::vector<std::string> skeys;
+  for (int i = 0; i < 100; ++i)
+  {
+    ikeys.push_back((uint64_t)i << 32);
+    skeys.push_back(std::to_string(i));
+  }
+  std::vector<std::size_t> hashes(100u);
+  hash_batch(ikeys.data(), ikeys.size(), hashes.data());
+  for (size_t i = 0; i < ikeys.size(); ++i)
+    EXPECT_EQ(hashes[i], detail::bit_mix::mix(indivi::hash<uint64_t>(), ikeys[i]));
+  hash_batch(skeys.data(), skeys.size(), hashes.data());
+  for (size_t i = 0; i < skeys.size(); ++i)
+    EXPECT_EQ(hashes[i], indivi::hash<std::string>()(skeys[i]));
+}
+
+TEST(HashTest, Hash32Bits)
+{
+  using Hash = hash_32bits<indivi::hash<uint64_t>>;
+  static_assert(detail::hash_is_32bits<Hash>::value, "hash_32bits: trait not detected");
+  static_assert(detail::hash_is_32bits<stored_hash<Hash>>::value, "hash_32bits: trait not inherited");
+  for (uint64_t key : { UINT64_C(0), UINT64_C(42), UINT64_C(42) << 32 })
+  {
+    uint64_t hash = detail::hash_mixer<Hash>::mix(Hash(), key);
+    EXPECT_EQ(hash >> 32, hash & 0xFFFFFFFFu); // spread
+  }
+  EXPECT_NE(detail::hash_mixer<Hash>::mix(Hash(), UINT64_C(42)), detail::hash_mixer<Hash>::mix(Hash(), UINT64_C(42) << 32));
+}
+
+TEST(HashTest, CompositeKeys)
+{
+  using Pair = std::pair<uint32_t, uint64_t>;
+  static_assert(detail::hash_is_avalanching<indivi::hash<Pair>>::value, "hash<pair>: not avalanching");
+  EXPECT_NE(indivi::hash<Pair>()(Pair(1u, 2u)), indivi::hash<Pair>()(Pair(2u, 1u))); // order dependent
+  using Tuple = std::tuple<uint32_t, uint64_t>;
+  EXPECT_EQ(indivi::hash<Tuple>()(Tuple(1u, 2u)), hash_values(1u, UINT64_C(2)));
+
+  using Ints = std::array<uint32_t, 3>;
+  Ints ints{{ 1u, 2u, 3u }};
+  EXPECT_EQ(indivi::hash<Ints>()(ints), hash_bytes(ints)); // at once
+  using Doubles = std::array<double, 2>;
+  Doubles zeros{{ 0.0, 1.0 }}, negZeros{{ -0.0, 1.0 }};
+  EXPECT_EQ(indivi::hash<Doubles>()(zeros), indivi::hash<Doubles>()(negZeros)); // by elements
+}
+
+TEST(HashTest, LongStringKeys)
+{
+  // same hashes whatever the path (string, c-string, seeded) and length (accelerated kernel above 32 bytes, if any)
+  std::string str(300, 'a');
+  for (std::size_t i = 0u; i < str.size(); ++i)
+    str[i] = (char)('a' + (i * 7u) % 26u);
+  for (std::size_t len = 0u; len <= str.size(); ++len)
+  {
+    std::string key = str.substr(0u, len);
+    EXPECT_EQ(indivi::hash<std::string>()(key), indivi::hash<std::string>()(key.c_str()));
+    EXPECT_EQ(seeded_hash<std::string>(0u)(key), indivi::hash<std::string>()(key));
+    EXPECT_NE(seeded_hash<std::string>(1u)(key), seeded_hash<std::string>(2u)(key));
+  }
+  // single byte changes
+  for (std::size_t len : { 33u, 64u, 65u, 128u, 300u })
+  {
+    std::string key = str.substr(0u, len);
+    std::size_t h = indivi::hash<std::string>()(key);
+    for (std::size_t i = 0u; i < len; ++i)
+    {
+      std::string key2 = key;
+      key2[i] ^= 1;
+      EXPECT_NE(indivi::hash<std::string>()(key2), h);
+    }
+  }
+}
+
+TEST(HashTest, StreamingHash)
+{
+  std::string str(300, 'a');
+  for (std::size_t i = 0u; i < str.size(); ++i)
+    str[i] = (char)(i * 37u + 11u);
+  for (std::size_t len = 0u; len <= str.size(); ++len)
+  {
+    std::string key = str.substr(0u, len);
+    const uint64_t expected = indivi::hash<std::string>()(key);
+    // all 2-segments splits
+    for (std::size_t cut = 0u; cut <= len; cut += 7u)
+    {
+      hash_state hs;
+      hs.update(key.data(), cut);
+      hs.update(key.data() + cut, len - cut);
+      EXPECT_EQ(hs.finish(), expected);
+    }
+    // byte by byte, with empty updates
+    hash_state hs;
+    for (char c : key)
+    {
+      hs.update(&c, 1u);
+      hs.update(nullptr, 0u);
+    }
+    EXPECT_EQ(hs.finish(), expected);
+    hs.update("!", 1u); // continued after finish
+    EXPECT_EQ(hs.finish(), indivi::hash<std::string>()(key + "!"));
+
+    hash_state seeded(42u);
+    seeded.update(key);
+    EXPECT_EQ(seeded.finish(), seeded_hash<std::string>(42u)(key));
+  }
+}
+
+#ifdef INDIVI_HASH_AES
+namespace
+{
+__m128i aes_round(__m128i x) { return _mm_aesenc_si128(x, _mm_setzero_si128()); }
+
+// Bytes 80..95 of 'str' (128 bytes) chosen to cancel a change of bytes 16..31 in the second lane,
+// given its state after the first block ('lane', 'changedLane') and its block transform (and inverse)
+template< class Transform, class InvTransform >
+void cancel_block(std::string& str, __m128i lane, __m128i changedLane, Transform transform, InvTransform invTransform)
+{
+  __m128i block;
+  std::memcpy(&block, &str[80], 16u);
+  block = invTransform(_mm_xor_si128(transform(block), _mm_xor_si128(aes_round(lane), aes_round(changedLane))));
+  std::memcpy(&str[80], &block, 16u);
+}
+}
+
+TEST(HashTest, AesLanesCollision)
+{
+  std::string str1(128, 'a');
+  std::string str2 = str1;
+  for (std::size_t i = 16u; i < 32u; ++i)
+    str2[i] = 'b';
+  __m128i block1, block2;
+  std::memcpy(&block1, &str1[16], 16u);
+  std::memcpy(&block2, &str2[16], 16u);
+
+  // lane from seed independent constants, absorbing blocks linearly (collides for all seeds if kernel is weak)
+  {
+    std::string str3 = str2;
+    __m128i k1 = _mm_set_epi64x((int64_t)detail::wyhash::secret[3], (int64_t)detail::wyhash::secret[2]);
+    auto identity = [](__m128i x) { return x; };
+    cancel_block(str3, _mm_xor_si128(aes_round(k1), block1), _mm_xor_si128(aes_round(k1), block2), identity, identity);
+    EXPECT_NE(str1, str3);
+    EXPECT_NE(seeded_hash<std::string>(1u)(str1), seeded_hash<std::string>(1u)(str3));
+    EXPECT_NE(seeded_hash<std::string>(2u)(str1), seeded_hash<std::string>(2u)(str3));
+  }
+  // actual lane of seed 0 (known state): does not carry over to other seeds
+  {
+    std::string str3 = str2;
+    detail::aeshash::state st1(0u), st2(0u);
+    st1.update(reinterpret_cast<const uint8_t*>(str1.data()));
+    st2.update(reinterpret_cast<const uint8_t*>(str2.data()));
+    __m128i k0 = st1.k0;
+    __m128i k1 = st1.k1;
+    cancel_block(str3, st1.s1, st2.s1, [&](__m128i x) { // keyed block round
+      return _mm_aesenc_si128(_mm_xor_si128(x, k0), k1);
+    }, [&](__m128i x) {
+      return _mm_xor_si128(_mm_aesdeclast_si128(_mm_aesimc_si128(_mm_xor_si128(x, k1)), _mm_setzero_si128()), k0);
+    });
+    EXPECT_EQ(indivi::hash<std::string>()(str1), indivi::hash<std::string>()(str3)); // unseeded: public state
+    EXPECT_NE(str1, str3);
+    EXPECT_NE(seeded_hash<std::string>(1u)(str1), seeded_hash<std::string>(1u)(str3));
+    EXPECT_NE(seeded_hash<std::string>(2u)(str1), seeded_hash<std::string>(2u)(str3));
+  }
+}
+#endif
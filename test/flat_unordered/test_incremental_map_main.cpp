@@ -0,0 +1,286 @@
+/**
+ * Copyright 2025 Guillaume AUJAY. All rights reserved.
+ * Distributed under the Apache License Version 2.0
+ */
+
+#include "gtest/gtest.h"
+
+#define INDIVI_FLAT_U_DEBUG
+#define INDIVI_FLAT_W_DEBUG
+#define INDIVI_FLAT_W_STATS // same as wmap tests (shared instantiations)
+#define INDIVI_FLAT_U_TELEMETRY // same as umap tests
+#define INDIVI_FLAT_W_TELEMETRY // same as wmap tests
+#include "indivi/flat_umap.h"
+#include "indivi/flat_wmap.h"
+#include "indivi/incremental_map.h"
+#include "utils/debug_utils.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <cstdlib>
+#include <ctime>
+
+using namespace indivi;
+
+namespace
+{
+// Insert until a migration starts, return next key
+template< class IMap >
+int fill_until_migrating(IMap& im, int first)
+{
+  int i = first;
+  while (!im.migrating())
+  {
+    EXPECT_TRUE(im.try_emplace(i, i).second);
+    ++i;
+  }
+  return i;
+}
+
+template< class Map >
+void test_migration()
+{
+  {
+    incremental_map<Map> im;
+    im.migrate_step(4);
+    EXPECT_FALSE(im.migrating());
+    EXPECT_EQ(im.migrate_step(), 4u);
+
+    int i = 1;
+    for (; i <= 64; ++i)
+      im.try_emplace(i, i);
+    im.finish_migration();
+    std::size_t bucketCount = im.bucket_count();
+
+    i = fill_until_migrating(im, i);
+    EXPECT_EQ(im.bucket_count(), bucketCount * 2);
+    EXPECT_EQ(im.size(), (std::size_t)i - 1);
+
+    // all elements found while migrating
+    int steps = 0;
+    while (im.migrating())
+    {
+      for (int k = 1; k < i; ++k)
+      {
+        EXPECT_TRUE(im.contains(k));
+        auto it = im.find(k);
+        ASSERT_NE(it, im.end());
+        EXPECT_EQ(it->second.id, k);
+      }
+      EXPECT_FALSE(im.contains(i));
+      EXPECT_EQ(im.count(i), 0u);
+      EXPECT_EQ(im.find(i), im.end());
+      EXPECT_FALSE(im.try_emplace(1, 2).second);
+      EXPECT_TRUE(im.insert({ i, i }).second);
+      ++i;
+      ++steps;
+    }
+    EXPECT_GT(steps, 1);
+    EXPECT_EQ(im.size(), (std::size_t)i - 1);
+    EXPECT_EQ(im.bucket_count(), bucketCount * 2);
+    EXPECT_EQ(im.at(1).id, 1);
+    EXPECT_THROW(im.at(i), std::out_of_range);
+
+    std::size_t visited = 0u;
+    im.for_each([&](const typename Map::value_type& kv) { EXPECT_EQ(kv.first.id, kv.second.id); ++visited; });
+    EXPECT_EQ(visited, im.size());
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+template< class Map >
+void test_modifiers()
+{
+  {
+    incremental_map<Map> im;
+    im.migrate_step(2);
+    int i = fill_until_migrating(im, 1);
+    std::size_t size = im.size();
+
+    // update elements still in old map
+    auto res = im.insert_or_assign(1, DbgClass(1001));
+    EXPECT_FALSE(res.second);
+    EXPECT_EQ(im.at(1).id, 1001);
+    im[2] = DbgClass(1002);
+    EXPECT_EQ(im.at(2).id, 1002);
+    EXPECT_FALSE(im.emplace(3, 999).second);
+    EXPECT_EQ(im.size(), size);
+
+    // erase from both maps (including next element to migrate)
+    for (int k = 1; k < i; k += 3)
+      EXPECT_EQ(im.erase(k), 1u);
+    for (int k = 1; k < i; k += 3)
+      EXPECT_EQ(im.erase(k), 0u);
+    size -= (std::size_t)(i + 1) / 3;
+    EXPECT_EQ(im.size(), size);
+    for (int k = 1; k < i; ++k)
+      EXPECT_EQ(im.contains(k), (k - 1) % 3 != 0);
+
+    // erase all
+    for (int k = 1; k < i; ++k)
+      im.erase(k);
+    EXPECT_TRUE(im.empty());
+    EXPECT_FALSE(im.migrating());
+
+    i = fill_until_migrating(im, 1);
+    im.clear();
+    EXPECT_TRUE(im.empty());
+    EXPECT_FALSE(im.migrating());
+    EXPECT_FALSE(im.contains(1));
+
+    // erase_if
+    i = fill_until_migrating(im, 1);
+    EXPECT_EQ(erase_if(im, [](const typename Map::value_type& kv) { return kv.first.id % 2 == 0; }), (std::size_t)(i - 1) / 2);
+    EXPECT_FALSE(im.migrating());
+    EXPECT_EQ(im.size(), (std::size_t)i / 2);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+template< class Map >
+void test_assignment()
+{
+  {
+    incremental_map<Map> im;
+    int i = fill_until_migrating(im, 1);
+
+    incremental_map<Map> copy(im);
+    EXPECT_TRUE(copy.migrating());
+    EXPECT_EQ(copy.size(), im.size());
+    copy.finish_migration();
+    EXPECT_FALSE(copy.migrating());
+    EXPECT_TRUE(im.migrating());
+    for (int k = 1; k < i; ++k)
+      EXPECT_TRUE(copy.contains(k));
+
+    incremental_map<Map> moved(std::move(im));
+    EXPECT_TRUE(moved.migrating());
+    EXPECT_TRUE(im.empty());
+    EXPECT_FALSE(im.migrating());
+    EXPECT_TRUE(im.try_emplace(1, 1).second);
+    while (moved.migrating())
+      moved.try_emplace(i++, 1);
+    EXPECT_EQ(moved.size(), (std::size_t)i - 1);
+
+    moved.swap(im);
+    EXPECT_EQ(im.size(), (std::size_t)i - 1);
+    EXPECT_EQ(moved.size(), 1u);
+
+    copy = im;
+    EXPECT_EQ(copy.size(), im.size());
+    moved = std::move(copy);
+    EXPECT_EQ(moved.size(), im.size());
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+template< class Map >
+void test_stress()
+{
+  {
+    auto seed = time(NULL);
+    std::cout << "Stress seed: " << seed << std::endl;
+    srand((unsigned int)seed);
+
+    incremental_map<Map> im;
+    im.migrate_step(2);
+    std::unordered_map<DbgClass, DbgClass> map;
+    int migrations = 0;
+
+    for (int i = 0; i < 200000; ++i)
+    {
+      int k = rand() % 20000 + 1;
+      int v = rand() + 1;
+      bool wasMigrating = im.migrating();
+      switch (rand() % 5)
+      {
+        case 0:
+        case 1:
+          EXPECT_EQ(im.try_emplace(k, v).second, map.emplace(k, v).second);
+          break;
+        case 2:
+          im.insert_or_assign(k, DbgClass(v));
+          map[k] = v;
+          break;
+        case 3:
+          EXPECT_EQ(im.erase(k), map.erase(k));
+          break;
+        default:
+        {
+          auto it = im.find(k);
+          auto mt = map.find(k);
+          EXPECT_EQ(it == im.end(), mt == map.end());
+          if (mt != map.end() && it != im.end())
+          {
+            EXPECT_EQ(it->second, mt->second);
+          }
+        }
+      }
+      migrations += (!wasMigrating && im.migrating());
+      ASSERT_EQ(im.size(), map.size());
+    }
+    EXPECT_GT(migrations, 0);
+    for (const auto& kv : map)
+      EXPECT_EQ(im.at(kv.first), kv.second);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+} // namespace
+
+TEST(IncrementalMapTest, Constructor)
+{
+  {
+    incremental_map<flat_wmap<DbgClass, DbgClass>> im;
+    EXPECT_TRUE(im.empty());
+    EXPECT_EQ(im.size(), 0u);
+    EXPECT_FALSE(im.contains(1));
+    EXPECT_EQ(im.migrate_step(), (incremental_map<flat_wmap<DbgClass, DbgClass>>::DEFAULT_MIGRATE_STEP));
+  }
+  {
+    incremental_map<flat_umap<DbgClass, DbgClass>> im(64);
+    EXPECT_EQ(im.bucket_count(), 64u);
+    EXPECT_FALSE(im.contains(1));
+  }
+  {
+    incremental_map<flat_wmap<std::string, std::string>> im;
+    im["a"] = "b";
+    EXPECT_EQ(im.at("a"), "b");
+    im.migrate_step(0);
+    EXPECT_EQ(im.migrate_step(), 2u);
+  }
+  // No object leak
+  EXPECT_EQ(DbgClass::count, 0);
+}
+
+TEST(IncrementalMapTest, Migration)
+{
+  test_migration<flat_umap<DbgClass, DbgClass>>();
+  test_migration<flat_wmap<DbgClass, DbgClass>>();
+}
+
+TEST(IncrementalMapTest, Modifiers)
+{
+  test_modifiers<flat_umap<DbgClass, DbgClass>>();
+  test_modifiers<flat_wmap<DbgClass, DbgClass>>();
+}
+
+TEST(IncrementalMapTest, Assignment)
+{
+  test_assignment<flat_umap<DbgClass, DbgClass>>();
+  test_assignment<flat_wmap<DbgClass, DbgClass>>();
+}
+
+TEST(IncrementalMapTest, Stress)
+{
+  test_stress<flat_umap<DbgClass, DbgClass>>();
+  test_stress<flat_wmap<DbgClass, DbgClass>>();
+}